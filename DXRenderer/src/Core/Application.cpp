@@ -7,6 +7,8 @@
 #include "Rendering/ResourcePool.h"
 
 #include "Rendering/CurrentGraphicsContext.h"
+#include "Rendering/FrameStatistics.h"
+#include "Rendering/StateCache.h"
 
 Application* Application::Instance = nullptr;
 
@@ -97,6 +99,10 @@ Application::Application()
 	Light->Properties.Position = { -12.0f, 12.0f, 15.0f };
 	Light->LinkTechniques();
 
+	// Synthetic lights around the first camera
+	ClusteredLights = MakeUnique<PointLightSet>();
+	ClusteredLights->Scatter(256, { { -13.5f, 8.0f, 3.5f }, { 60.0f, 8.0f, 60.0f } });
+
 	Cameras.LinkTechniques();
 	RenderGraph::SetUpLightSource(Light.get());
 }
@@ -113,17 +119,23 @@ void Application::Tick()
 	ImGui->Begin();
 	Cameras.GUI();
 	Light->Bind();
+	ClusteredLights->Bind();
+	// Actors only read the camera and the light, ImGui stays on this thread
+	RenderGraph::ParallelSubmit(Actors.size(), 1, [this, delta](size_t i)
+								{
+									Actors[i]->Tick(delta);
+									Actors[i]->Submit(Channels::Main);
+									Actors[i]->Submit(Channels::Shadow);
+								});
 	for (auto& c : Actors)
-	{
-		c->Tick(delta);
-		c->Submit(Channels::Main);
-		c->Submit(Channels::Shadow);
 		c->GUI();
-	}
 	Cameras.Submit(Channels::Main);
 	Light->Tick(delta);
 	Light->Submit(Channels::Main);
 	Light->GUI();
+	ClusteredLights->GUI();
+	FrameStatistics::GUI();
+	RenderGraph::GUI();
 	ImGui->Render();
 
 	if (MainWindow->Input.IsKeyPressed(VK_INSERT))
@@ -141,6 +153,8 @@ void Application::Tick()
 	}
 
 	RenderGraph::Execute();
+	StateCache::EndFrame();
+	FrameStatistics::EndFrame();
 	ImGui->End();
 
 	MainWindow->Tick(delta);
@@ -2,6 +2,7 @@
 #include "Events/Event.h"
 #include "Window/Window.h"
 #include "Rendering\Lights\PointLight.h"
+#include "Rendering\Lights\PointLightSet.h"
 #include "Timer.h"
 
 #include <vector>
@@ -30,5 +31,6 @@ private:
 	std::vector <UniquePtr< class Actor >> Actors;
 	CameraGroup Cameras;
 	UniquePtr<PointLight> Light;
+	UniquePtr<PointLightSet> ClusteredLights;
 	static Application* Instance;
 };
\ No newline at end of file
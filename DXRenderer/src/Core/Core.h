@@ -1,5 +1,6 @@
 #pragma once
 
+#ifdef _WIN32
 // target Windows 7 or later
 #define _WIN32_WINNT 0x0601
 #include <sdkddkver.h>
@@ -41,6 +42,13 @@
 #define NOMINMAX
 
 #include <Windows.h>
+#define DEBUG_BREAK() __debugbreak()
+#else
+// Device independent sources are also built by the tests outside Windows
+#define DEBUG_BREAK() __builtin_trap()
+#endif
+
+#include <cstdio>
 #include <memory>
 #include <functional>
 
@@ -72,7 +80,7 @@ constexpr WeakPtr<T> MakeWeak(Args&& ... args)
 }
 
 #ifndef NDEBUG
-#define ASSERT(x) { if(!(x)) { printf("Assertion Failed!"); __debugbreak(); } }
+#define ASSERT(x) { if(!(x)) { printf("Assertion Failed!"); DEBUG_BREAK(); } }
 #else
 #define ASSERT(x)
 #endif
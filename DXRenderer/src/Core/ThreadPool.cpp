@@ -0,0 +1,142 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool& ThreadPool::Get()
+{
+	static ThreadPool singleton;
+	return singleton;
+}
+
+size_t ThreadPool::GetConcurrency()
+{
+	return Get().Workers.size() + 1;
+}
+
+size_t ThreadPool::GetChunkCount(size_t count, size_t grain)
+{
+	if (count == 0)
+		return 0;
+
+	const size_t byGrain = (count + std::max<size_t>(grain, 1) - 1) / std::max<size_t>(grain, 1);
+	return std::min(byGrain, GetConcurrency());
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const ChunkFunction& function)
+{
+	Get().ParallelForImpl(count, grain, function);
+}
+
+ThreadPool::ThreadPool()
+{
+	const size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+	Workers.reserve(hardware - 1);
+	for (size_t i = 0; i + 1 < hardware; i++)
+		Workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		Stopping = true;
+	}
+	QueueCondition.notify_all();
+
+	for (auto& worker : Workers)
+		worker.join();
+}
+
+void ThreadPool::ParallelForImpl(size_t count, size_t grain, const ChunkFunction& function)
+{
+	const size_t chunks = GetChunkCount(count, grain);
+	if (chunks <= 1)
+	{
+		if (chunks == 1)
+			function(0, 0, count);
+		return;
+	}
+
+	auto range = [count, chunks](size_t chunk)
+	{
+		return std::pair<size_t, size_t>{ count * chunk / chunks, count * (chunk + 1) / chunks };
+	};
+
+	// The first exception of any chunk is rethrown once every chunk is done, the others still reference function
+	std::atomic<size_t> remaining = chunks - 1;
+	std::exception_ptr failure;
+	std::mutex failureMutex;
+	auto run = [&function, &failure, &failureMutex, range](size_t chunk)
+	{
+		try
+		{
+			const auto [begin, end] = range(chunk);
+			function(chunk, begin, end);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(failureMutex);
+			if (!failure)
+				failure = std::current_exception();
+		}
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		for (size_t chunk = 1; chunk < chunks; chunk++)
+		{
+			Queue.emplace_back([&run, &remaining, chunk]()
+							   {
+								   run(chunk);
+								   remaining.fetch_sub(1, std::memory_order_release);
+							   });
+		}
+	}
+	QueueCondition.notify_all();
+
+	run(0);
+
+	while (remaining.load(std::memory_order_acquire) != 0)
+	{
+		if (!RunOne())
+			std::this_thread::yield();
+	}
+
+	if (failure)
+		std::rethrow_exception(failure);
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(QueueMutex);
+			QueueCondition.wait(lock, [this]() { return Stopping || !Queue.empty(); });
+			if (Stopping && Queue.empty())
+				return;
+
+			task = std::move(Queue.front());
+			Queue.pop_front();
+		}
+		task();
+	}
+}
+
+bool ThreadPool::RunOne()
+{
+	std::function<void()> task;
+	{
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		if (Queue.empty())
+			return false;
+
+		task = std::move(Queue.front());
+		Queue.pop_front();
+	}
+	task();
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the engine. ParallelFor splits [0, count) into chunks whose
+// boundaries depend only on count and the worker count, so per-chunk results can be merged in a
+// deterministic order. A thread waiting on its chunks runs queued work, nested calls cannot deadlock.
+// An exception thrown by a chunk is rethrown by ParallelFor after all chunks have finished.
+class ThreadPool
+{
+public:
+	using ChunkFunction = std::function<void(size_t chunk, size_t begin, size_t end)>;
+
+	static ThreadPool& Get();
+
+	// Worker threads plus the calling thread
+	static size_t GetConcurrency();
+	static size_t GetChunkCount(size_t count, size_t grain);
+	static void ParallelFor(size_t count, size_t grain, const ChunkFunction& function);
+
+private:
+	ThreadPool();
+	~ThreadPool();
+
+	void ParallelForImpl(size_t count, size_t grain, const ChunkFunction& function);
+	void WorkerLoop();
+	bool RunOne();
+
+private:
+	std::vector<std::thread> Workers;
+	std::deque<std::function<void()>> Queue;
+	std::mutex QueueMutex;
+	std::condition_variable QueueCondition;
+	bool Stopping = false;
+};
\ No newline at end of file
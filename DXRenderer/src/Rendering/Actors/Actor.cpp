@@ -32,6 +32,11 @@ void Actor::Tick(float delta)
 	ModelView = Transform.GetMatrix() * CurrentGraphicsContext::GraphicsInfo->GetView();
 }
 
+float Actor::GetViewDepth() const
+{
+	return DirectX::XMVectorGetZ(ModelView.r[3]);
+}
+
 
 void Actor::SetPosition(const DirectX::XMFLOAT3& position)
 {
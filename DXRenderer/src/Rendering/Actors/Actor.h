@@ -28,6 +28,7 @@ public:
 	virtual void Tick(float delta);
 
 	virtual void GUI() {}
+	float GetViewDepth() const override;
 
 
 	void SetPosition(const DirectX::XMFLOAT3& position);
@@ -27,6 +27,9 @@ inline void Cube::Tick(float delta)
 {
 	Actor::Tick(delta);
 	ModelViewOutline = DirectX::XMMatrixScaling(1.03f, 1.03f, 1.03f) * ModelView;
+
+	static const Culling::Box unitCube{ {}, { 0.5f, 0.5f, 0.5f } };
+	WorldBounds = Culling::TransformBox(unitCube, GetTransform());
 }
 
 void Cube::Init()
@@ -86,8 +89,10 @@ void Cube::Init()
 		Step draw("shadowMap");
 		
 		VertexShader vs("ShadowMapUpdate");
+		draw.Add<VertexShader>(vs);
 		draw.Add<InputLayout>("Cube3", vertexBuffer->GetLayout(), vs.GetBlob());
-		draw.Add<UniformVS<XMMATRIX>>("Cube" + UIDTag(), Transform.GetMatrix());
+		draw.AddPerInstance<UniformVS<XMMATRIX>>("Cube" + UIDTag(), Transform.GetMatrix());
+		draw.SetInstancing("ShadowMapUpdateInstanced", "Cube3Instanced", vertexBuffer->GetLayout());
 		
 		shadowMap.PushBack(std::move(draw));
 	}
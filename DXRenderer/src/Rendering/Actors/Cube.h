@@ -13,11 +13,13 @@ public:
 
 	void Submit(size_t channelsIn) override;
 	void Tick(float delta) override;
+	const Culling::Box* GetWorldBounds() const override { return &WorldBounds; }
 private:
 	void Init();
 
 private:
 	DirectX::XMMATRIX ModelViewOutline;
+	Culling::Box WorldBounds;
 };
 
 class CubeOutline : public Actor
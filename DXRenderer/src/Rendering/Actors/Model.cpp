@@ -1,35 +1,153 @@
 #include "Model.h"
+#include "Core/Timer.h"
 #include "Rendering/CurrentGraphicsContext.h"
 #include "Rendering/Material.h"
+#include "Rendering/RenderGraph/RenderGraph.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <imgui.h>
+#include <numeric>
 
-Model::Model(const std::string& filename)
+Model::Model(const std::string& filename, const ImportSettings& settings)
+	:Settings(settings)
 {
 	Init(filename);
 }
 
-Model::Model(const std::string& filename, const TransformationIntrinsics& intrinsics)
-	:Actor(intrinsics)
+Model::Model(const std::string& filename, const TransformationIntrinsics& intrinsics, const ImportSettings& settings)
+	:Actor(intrinsics), Settings(settings)
 {
 	Init(filename);
 }
 
 void Model::Submit(size_t channelsIn)
 {
-	Root->Submit(channelsIn);
-	Components.Bind();
+	// The shadow map looks in every direction around the light, only the main channel is frustum culled
+	const bool cull = channelsIn & Channels::Main;
+	if (cull)
+	{
+		Timer timer;
+		const auto frustum = Culling::ExtractFrustum(CurrentGraphicsContext::GraphicsInfo->GetViewProjection());
+		if (UseSpatialIndex)
+		{
+			std::fill(Visible.begin(), Visible.end(), 0);
+			VisibleItems.clear();
+			SpatialIndex.QueryFrustum(frustum, VisibleItems);
+			for (uint32_t item : VisibleItems)
+				Visible[item] = 1;
+			LastCull.Visible = VisibleItems.size();
+		}
+		else
+			LastCull.Visible = Culling::CullBoxes(Bounds, frustum, Visible.data());
+		LastCull.Culled = SubmitList.size() - LastCull.Visible;
+		LastCull.Milliseconds = timer.Get() * 1000.0f;
+
+		if (UseOcclusionCulling)
+			CullOccluded(CurrentGraphicsContext::GraphicsInfo->GetViewProjection());
+	}
+
+	// Each mesh only updates its own LOD and visible ranges while submitting
+	static constexpr size_t grain = 64;
+	RenderGraph::ParallelSubmit(SubmitList.size(), grain, [this, channelsIn, cull](size_t i)
+								{
+									size_t channels = channelsIn;
+									if (cull && !Visible[i])
+										channels &= ~Channels::Main;
+
+									if (channels != 0)
+										SubmitList[i]->Submit(channels);
+								});
+}
+
+void Model::CullOccluded(const DirectX::XMMATRIX& viewProjection)
+{
+	using namespace DirectX;
+
+	Timer timer;
+	const XMVECTOR eye = XMMatrixInverse(nullptr, CurrentGraphicsContext::GraphicsInfo->GetView()).r[3];
+
+	// Larger projected bounds occlude more, they get the triangle budget first
+	OccluderCandidates.clear();
+	for (uint32_t i = 0; i < SubmitList.size(); i++)
+	{
+		if (!Visible[i] || SubmitList[i]->GetOccluder().Empty())
+			continue;
+
+		const Culling::Box& box = *SubmitList[i]->GetWorldBounds();
+		const float distance = std::max(XMVectorGetX(XMVector3Length(XMLoadFloat3(&box.Center) - eye)), 1e-3f);
+		OccluderCandidates.emplace_back(XMVectorGetX(XMVector3Length(XMLoadFloat3(&box.Extents))) / distance, i);
+	}
+	std::sort(OccluderCandidates.begin(), OccluderCandidates.end(), std::greater<>());
+
+	Occluders.clear();
+	size_t triangles = 0;
+	for (const auto& [size, i] : OccluderCandidates)
+	{
+		const auto& occluder = SubmitList[i]->GetOccluder();
+		if (triangles + occluder.GetTriangleCount() > static_cast<size_t>(OccluderTriangleBudget))
+			continue;
+
+		triangles += occluder.GetTriangleCount();
+		XMFLOAT4X4 modelViewProjection;
+		XMStoreFloat4x4(&modelViewProjection, SubmitList[i]->GetTransform() * viewProjection);
+
+		auto& instance = Occluders.emplace_back();
+		instance.Geometry = &occluder;
+		std::memcpy(instance.ModelViewProjection, modelViewProjection.m, sizeof(instance.ModelViewProjection));
+	}
+
+	OcclusionBuffer.Render(Occluders.data(), Occluders.size());
+
+	XMFLOAT4X4 clip;
+	XMStoreFloat4x4(&clip, viewProjection);
+	LastOcclusion.Occluded = 0;
+	for (size_t i = 0; i < SubmitList.size(); i++)
+	{
+		const Culling::Box& box = *SubmitList[i]->GetWorldBounds();
+		if (Visible[i] && OcclusionBuffer.IsOccluded(&box.Center.x, &box.Extents.x, clip.m))
+		{
+			Visible[i] = 0;
+			LastOcclusion.Occluded++;
+		}
+	}
+
+	LastOcclusion.Occluders = Occluders.size();
+	LastOcclusion.Triangles = OcclusionBuffer.GetTriangleCount();
+	LastOcclusion.Milliseconds = timer.Get() * 1000.0f;
 }
 
 void Model::Tick(float delta)
 {
 	Actor::Tick(delta);
-	Root->SetTransform(Transform.GetMatrix());
-	Root->Tick(delta);
+	Transforms.Update(GetTransform(), CurrentGraphicsContext::GraphicsInfo->GetView());
+
+	for (size_t i = 0; i < SubmitList.size(); i++)
+	{
+		SubmitList[i]->UpdateWorldBounds();
+		Bounds.Set(i, *SubmitList[i]->GetWorldBounds());
+	}
+
+	// World bounds exist after the first tick, later ones only refit what moved
+	if (Proxies.size() != SubmitList.size())
+	{
+		std::vector<Culling::Box> boxes(SubmitList.size());
+		std::vector<uint32_t> items(SubmitList.size());
+		for (size_t i = 0; i < SubmitList.size(); i++)
+			boxes[i] = *SubmitList[i]->GetWorldBounds();
+		std::iota(items.begin(), items.end(), 0);
+
+		SpatialIndex.Build(boxes.data(), items.data(), boxes.size(), Proxies);
+	}
+	else
+	{
+		for (size_t i = 0; i < SubmitList.size(); i++)
+			SpatialIndex.Update(Proxies[i], *SubmitList[i]->GetWorldBounds());
+	}
 }
 
 void Model::GUI()
@@ -40,6 +158,38 @@ void Model::GUI()
 
 		Root->ShowTree();
 
+		ImGui::Columns(1);
+		ImGui::Separator();
+		ImGui::Checkbox("Cull with spatial index", &UseSpatialIndex);
+		ImGui::Text("Frustum culling: %zu visible, %zu culled, %.3f ms", LastCull.Visible, LastCull.Culled, LastCull.Milliseconds);
+		ImGui::Checkbox("Occlusion culling", &UseOcclusionCulling);
+		if (UseOcclusionCulling)
+		{
+			ImGui::SliderInt("Occluder triangles", &OccluderTriangleBudget, 0, 65536);
+			ImGui::Text("Occlusion culling: %zu occluded by %zu occluders (%zu triangles), %.3f ms", LastOcclusion.Occluded,
+						LastOcclusion.Occluders, LastOcclusion.Triangles, LastOcclusion.Milliseconds);
+		}
+
+		if (Settings.OptimizeMeshes)
+		{
+			ImGui::Columns(1);
+			ImGui::Separator();
+			ImGui::Text("Vertex cache ACMR %.3f -> %.3f", VertexCacheBefore.GetACMR(), VertexCacheAfter.GetACMR());
+			ImGui::Text("Vertex cache ATVR %.3f -> %.3f", VertexCacheBefore.GetATVR(), VertexCacheAfter.GetATVR());
+		}
+
+		if (LevelStatistics.size() > 1)
+		{
+			ImGui::Columns(1);
+			ImGui::Separator();
+			const float fullTriangles = static_cast<float>(LevelStatistics[0].Triangles);
+			for (size_t i = 0; i < LevelStatistics.size(); i++)
+			{
+				const auto& level = LevelStatistics[i];
+				ImGui::Text("LOD %zu: %zu triangles (%.1f%%), error %.4f", i, level.Triangles,
+							100.0f * level.Triangles / fullTriangles, level.Error);
+			}
+		}
 	}
 	ImGui::End();
 }
@@ -54,4 +204,9 @@ void Model::Init(const std::string& filename)
 	Path = "\\Model\\" + filename;
 	Path = Path.substr(0, Path.find_last_of("\\/") + 1);
 	Root = Node::Build(*this, filename);
+
+	SubmitList.clear();
+	Root->CollectMeshes(SubmitList);
+	Bounds.Resize(SubmitList.size());
+	Visible.assign(SubmitList.size(), 1);
 }
\ No newline at end of file
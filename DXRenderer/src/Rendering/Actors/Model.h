@@ -1,26 +1,77 @@
 #pragma once
 
 #include "Actor.h"
+#include "Rendering/BoundingVolumeHierarchy.h"
 #include "Rendering/Mesh.h"
 #include "Rendering/Node.h"
+#include "Rendering/TransformHierarchy.h"
 
 class Model : public Actor 
 {
 public:
-	Model(const std::string& filename);
-	Model(const std::string& filename, const TransformationIntrinsics& intrinsics);
+	Model(const std::string& filename, const ImportSettings& settings = {});
+	Model(const std::string& filename, const TransformationIntrinsics& intrinsics, const ImportSettings& settings = {});
 
 	virtual void Submit(size_t channelsIn) override;
 	virtual void Tick(float delta) override;
 
 	virtual void GUI() override;
 	const std::string& GetPath() const { return Path; }
+	const ImportSettings& GetImportSettings() const { return Settings; }
+	// Items are indices of the meshes in submission order
+	const BoundingVolumeHierarchy& GetSpatialIndex() const { return SpatialIndex; }
 	virtual void LinkTechniques() override;
 protected:
 
 private:
 	void Init(const std::string& filename);
+	// Rasterizes the occluders of the largest visible meshes and clears Visible for the meshes behind them
+	void CullOccluded(const DirectX::XMMATRIX& viewProjection);
 
+	// Local, world and model view matrices of every node, meshes reference them so it outlives Root
+	TransformHierarchy Transforms;
 	UniquePtr<Node> Root;
+	// Flattened node tree, submitted in parallel
+	std::vector<Mesh*> SubmitList;
+	// World bounds of SubmitList, refreshed every tick and frustum culled before the main submission
+	Culling::BoxList Bounds;
+	std::vector<uint8_t> Visible;
+
+	// Same bounds indexed by space, culling walks it instead of every box when enabled
+	BoundingVolumeHierarchy SpatialIndex;
+	std::vector<uint32_t> Proxies;
+	std::vector<uint32_t> VisibleItems;
+	bool UseSpatialIndex = true;
+
+	struct CullStatistics
+	{
+		size_t Visible = 0;
+		size_t Culled = 0;
+		float Milliseconds = 0.0f;
+	} LastCull;
+
+	// Meshes surviving the frustum are tested against the depth of the nearest large occluders
+	Occlusion::DepthBuffer OcclusionBuffer;
+	std::vector<Occlusion::OccluderInstance> Occluders;
+	std::vector<std::pair<float, uint32_t>> OccluderCandidates;
+	bool UseOcclusionCulling = true;
+	int OccluderTriangleBudget = 8192;
+
+	struct OcclusionStatistics
+	{
+		size_t Occluders = 0;
+		size_t Triangles = 0;
+		size_t Occluded = 0;
+		float Milliseconds = 0.0f;
+	} LastOcclusion;
+
 	std::string Path;
+	ImportSettings Settings;
+
+	MeshOptimizer::Statistics VertexCacheBefore;
+	MeshOptimizer::Statistics VertexCacheAfter;
+	std::vector<Simplifier::LevelStatistics> LevelStatistics;
+
+	friend class Node;
+	friend class NodeInternal;
 };
\ No newline at end of file
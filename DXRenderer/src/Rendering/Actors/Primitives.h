@@ -24,8 +24,8 @@ namespace Primitives
 	class Cube
 	{
 	public:
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> Create()
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> Create()
 		{
 			constexpr float side = 0.5f;
 
@@ -56,8 +56,8 @@ namespace Primitives
 			};
 		}
 
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> CreateWNormals()
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> CreateWNormals()
 		{
 			constexpr float side = 0.5f;
 			std::vector<DirectX::XMFLOAT3> positions = {
@@ -91,7 +91,7 @@ namespace Primitives
 			for (size_t i = 0; i < positions.size(); i++)
 				vertices[i].Position = positions[i];
 
-			std::vector<unsigned short> indices = {
+			std::vector<Index> indices = {
 						0,2, 1,    2,3,1,
 						4,5, 7,    4,7,6,
 						8,10, 9,  10,11,9,
@@ -128,8 +128,8 @@ namespace Primitives
 	class Cone
 	{
 	public:
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> CreateTesselated(int divisions)
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> CreateTesselated(int divisions)
 		{
 			ASSERT(divisions >= 3);
 
@@ -149,42 +149,43 @@ namespace Primitives
 			// Central Vertices
 			vertices.emplace_back();
 			vertices.back().Position = { 0.0f, 0.0f, 1.0f };
-			const auto center = (unsigned short)(vertices.size() - 1);
+			const auto center = (Index)(vertices.size() - 1);
 
 			vertices.emplace_back();
 			vertices.back().Position = { 0.0f, 0.0f, -1.0f };
-			const auto tip = (unsigned short)(vertices.size() - 1);
+			const auto tip = (Index)(vertices.size() - 1);
 
 			// Indices
-			std::vector<unsigned short> indices;
-			for (unsigned short arc = 0; arc < divisions; arc++)
+			std::vector<Index> indices;
+			const Index count = static_cast<Index>(divisions);
+			for (Index arc = 0; arc < count; arc++)
 			{
 				// Base Triangles
 				indices.push_back(center);
-				indices.push_back((arc + 1) % divisions);
+				indices.push_back((arc + 1) % count);
 				indices.push_back(arc);
 
 				// Side Triangles
 				indices.push_back(arc);
-				indices.push_back((arc + 1) % divisions);
+				indices.push_back((arc + 1) % count);
 				indices.push_back(tip);
 			}
 
 			return { std::move(vertices), std::move(indices) };
 		}
 
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> Create()
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> Create()
 		{
-			return CreateTesselated<Vertex>(20);
+			return CreateTesselated<Vertex, Index>(20);
 		}
 	};
 
 	class Plane
 	{
 	public:
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> CreateTesselated(int divisionsX, int divisionsY)
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> CreateTesselated(int divisionsX, int divisionsY)
 		{
 			ASSERT(divisionsX >= 1);
 			ASSERT(divisionsY >= 1);
@@ -213,19 +214,19 @@ namespace Primitives
 				}
 			}
 
-			std::vector<unsigned short> indices;
+			std::vector<Index> indices;
 			indices.reserve(std::pow(divisionsX * divisionsY, 2) * 6);
 
 			const auto coordsToIndices = [numOfVerticesX](size_t x, size_t y)
 			{
-				return (unsigned short)(y * numOfVerticesX + x);
+				return (Index)(y * numOfVerticesX + x);
 			};
 
 			for (size_t y = 0; y < divisionsY; y++)
 			{
 				for (size_t x = 0; x < divisionsX; x++)
 				{
-					const std::array<unsigned short, 4> indexArray = {
+					const std::array<Index, 4> indexArray = {
 						coordsToIndices(x, y), coordsToIndices(x + 1 ,y), coordsToIndices(x, y + 1), coordsToIndices(x + 1, y + 1)
 					};
 					indices.push_back(indexArray[0]);
@@ -240,14 +241,14 @@ namespace Primitives
 			return { std::move(vertices), std::move(indices) };
 		}
 
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> Create()
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> Create()
 		{
-			return CreateTesselated<Vertex>(1, 1);
+			return CreateTesselated<Vertex, Index>(1, 1);
 		}
 
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> CreateWTextureCoords(int divisionsX = 1, int divisionsY = 1)
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> CreateWTextureCoords(int divisionsX = 1, int divisionsY = 1)
 		{
 			ASSERT(divisionsX >= 1);
 			ASSERT(divisionsY >= 1);
@@ -279,19 +280,19 @@ namespace Primitives
 				}
 			}
 
-			std::vector<unsigned short> indices;
+			std::vector<Index> indices;
 			indices.reserve(std::pow(divisionsX * divisionsY, 2) * 6);
 
 			const auto coordsToIndices = [numOfVerticesX](size_t x, size_t y)
 			{
-				return (unsigned short)(y * numOfVerticesX + x);
+				return (Index)(y * numOfVerticesX + x);
 			};
 
 			for (size_t y = 0; y < divisionsY; y++)
 			{
 				for (size_t x = 0; x < divisionsX; x++)
 				{
-					const std::array<unsigned short, 4> indexArray = {
+					const std::array<Index, 4> indexArray = {
 						coordsToIndices(x, y), coordsToIndices(x + 1 ,y), coordsToIndices(x, y + 1), coordsToIndices(x + 1, y + 1)
 					};
 					indices.push_back(indexArray[0]);
@@ -311,8 +312,8 @@ namespace Primitives
 	class Prism
 	{
 	public:
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> CreateTesselated(int divisions)
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> CreateTesselated(int divisions)
 		{
 			ASSERT(divisions >= 3);
 
@@ -323,11 +324,11 @@ namespace Primitives
 			std::vector<Vertex> vertices;
 			vertices.emplace_back();
 			vertices.back().Position = { 0.0f, 0.0f, -1.0f };
-			const auto centerNear = (unsigned short)(vertices.size() - 1);
+			const auto centerNear = (Index)(vertices.size() - 1);
 
 			vertices.emplace_back();
 			vertices.back().Position = { 0.0f, 0.0f, 1.0f };
-			const auto centerFar = (unsigned short)(vertices.size() - 1);
+			const auto centerFar = (Index)(vertices.size() - 1);
 
 			for (int arc = 0; arc < divisions; arc++)
 			{
@@ -341,11 +342,12 @@ namespace Primitives
 				DirectX::XMStoreFloat3(&vertices.back().Position, v);
 			}
 
-			std::vector<unsigned short> indices;
-			for (unsigned short arc = 0; arc < divisions; arc++)
+			std::vector<Index> indices;
+			const Index count = static_cast<Index>(divisions);
+			for (Index arc = 0; arc < count; arc++)
 			{
 				const auto i = arc * 2;
-				const auto d = divisions * 2;
+				const auto d = count * 2;
 				indices.push_back(i + 2);
 				indices.push_back((i + 2) % d + 2);
 				indices.push_back(i + 1 + 2);
@@ -364,18 +366,18 @@ namespace Primitives
 			return { std::move(vertices), std::move(indices) };
 		}
 
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> Create()
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> Create()
 		{
-			return CreateTesselated<Vertex>(24);
+			return CreateTesselated<Vertex, Index>(24);
 		}
 	};
 
 	class Sphere
 	{
 	public:
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> CreateTesselated(int divisionPhi, int divisionTheta)
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> CreateTesselated(int divisionPhi, int divisionTheta)
 		{
 			ASSERT(divisionPhi >= 3);
 			ASSERT(divisionTheta >= 3);
@@ -397,23 +399,28 @@ namespace Primitives
 				}
 			}
 
-			const auto northPole = (unsigned short)vertices.size();
+			const auto northPole = (Index)vertices.size();
 			vertices.emplace_back();
 			DirectX::XMStoreFloat3(&vertices.back().Position, base);
 
-			const auto southPole = (unsigned short)vertices.size();
+			const auto southPole = (Index)vertices.size();
 			vertices.emplace_back();
 			DirectX::XMStoreFloat3(&vertices.back().Position, DirectX::XMVectorNegate(base));
 
-			const auto calcIndex = [divisionTheta](unsigned short arcPhi, unsigned short arcTheta)
+			// Ring and segment counts in the index type, so the loops compare like types
+			const Index segments = static_cast<Index>(divisionTheta);
+			const Index lastSegment = static_cast<Index>(divisionTheta - 1);
+			const Index lastRing = static_cast<Index>(divisionPhi - 2);
+
+			const auto calcIndex = [segments](Index arcPhi, Index arcTheta)
 			{
-				return arcPhi * divisionTheta + arcTheta;
+				return static_cast<Index>(arcPhi * segments + arcTheta);
 			};
 
-			std::vector<unsigned short> indices;
-			for (unsigned short arcPhi = 0; arcPhi < divisionPhi - 2; arcPhi++)
+			std::vector<Index> indices;
+			for (Index arcPhi = 0; arcPhi < lastRing; arcPhi++)
 			{
-				for (unsigned short arcTheta = 0; arcTheta < divisionTheta - 1; arcTheta++)
+				for (Index arcTheta = 0; arcTheta < lastSegment; arcTheta++)
 				{
 					indices.push_back(calcIndex(arcPhi, arcTheta));
 					indices.push_back(calcIndex(arcPhi + 1, arcTheta));
@@ -422,40 +429,40 @@ namespace Primitives
 					indices.push_back(calcIndex(arcPhi + 1, arcTheta));
 					indices.push_back(calcIndex(arcPhi + 1, arcTheta + 1));
 				}
-				indices.push_back(calcIndex(arcPhi, divisionTheta - 1));
-				indices.push_back(calcIndex(arcPhi + 1, divisionTheta - 1));
+				indices.push_back(calcIndex(arcPhi, lastSegment));
+				indices.push_back(calcIndex(arcPhi + 1, lastSegment));
 				indices.push_back(calcIndex(arcPhi, 0));
 				indices.push_back(calcIndex(arcPhi, 0));
-				indices.push_back(calcIndex(arcPhi + 1, divisionTheta - 1));
+				indices.push_back(calcIndex(arcPhi + 1, lastSegment));
 				indices.push_back(calcIndex(arcPhi + 1, 0));
 			}
 
-			for (unsigned short arcTheta = 0; arcTheta < divisionTheta - 1; arcTheta++)
+			for (Index arcTheta = 0; arcTheta < lastSegment; arcTheta++)
 			{
 				indices.push_back(northPole);
 				indices.push_back(calcIndex(0, arcTheta));
 				indices.push_back(calcIndex(0, arcTheta + 1));
 
-				indices.push_back(calcIndex(divisionPhi - 2, arcTheta + 1));
-				indices.push_back(calcIndex(divisionPhi - 2, arcTheta));
+				indices.push_back(calcIndex(lastRing, arcTheta + 1));
+				indices.push_back(calcIndex(lastRing, arcTheta));
 				indices.push_back(southPole);
 			}
 
 			indices.push_back(northPole);
-			indices.push_back(calcIndex(0, divisionTheta - 1));
+			indices.push_back(calcIndex(0, lastSegment));
 			indices.push_back(calcIndex(0, 0));
 
-			indices.push_back(calcIndex(divisionPhi - 2, 0));
-			indices.push_back(calcIndex(divisionPhi - 2, divisionTheta - 1));
+			indices.push_back(calcIndex(lastRing, 0));
+			indices.push_back(calcIndex(lastRing, lastSegment));
 			indices.push_back(southPole);
 
 			return { std::move(vertices), std::move(indices) };
 		}
 
-		template<IsVertexElement Vertex>
-		static IndexedVertices<Vertex> Create()
+		template<IsVertexElement Vertex, IsIndex Index = uint16_t>
+		static IndexedVertices<Vertex, Index> Create()
 		{
-			return CreateTesselated<Vertex>(12, 24);
+			return CreateTesselated<Vertex, Index>(12, 24);
 		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,582 @@
+#include "BoundingVolumeHierarchy.h"
+#include "Core/Core.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	using Bounds = BoundingVolumeHierarchy::Bounds;
+
+	constexpr uint32_t BinCount = 16;
+	constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+	// Traversal stack, shared by the queries running on one thread
+	thread_local std::vector<uint32_t> Stack;
+
+	float Centroid(const Bounds& bounds, int axis)
+	{
+		return 0.5f * (bounds.Min[axis] + bounds.Max[axis]);
+	}
+
+	Bounds Empty()
+	{
+		return { { Infinity, Infinity, Infinity }, { -Infinity, -Infinity, -Infinity } };
+	}
+
+	// inside is cleared when the box straddles a plane
+	bool Intersects(const Bounds& bounds, const Culling::Frustum& frustum, bool& inside)
+	{
+		inside = true;
+		for (const float* plane : frustum.Planes)
+		{
+			float distance = plane[3], radius = 0.0f;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				distance += plane[axis] * Centroid(bounds, axis);
+				radius += std::fabs(plane[axis]) * 0.5f * (bounds.Max[axis] - bounds.Min[axis]);
+			}
+
+			if (distance + radius < 0.0f)
+				return false;
+			if (distance - radius < 0.0f)
+				inside = false;
+		}
+		return true;
+	}
+
+	bool Intersects(const Bounds& bounds, const DirectX::XMFLOAT3& center, float radius)
+	{
+		const float point[3] = { center.x, center.y, center.z };
+		float distanceSquared = 0.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float offset = point[axis] - std::clamp(point[axis], bounds.Min[axis], bounds.Max[axis]);
+			distanceSquared += offset * offset;
+		}
+		return distanceSquared <= radius * radius;
+	}
+
+	// Entry distance of the ray, infinity when it misses
+	float RayDistance(const Bounds& bounds, const float origin[3], const float inverseDirection[3])
+	{
+		float entry = 0.0f, exit = Infinity;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float t0 = (bounds.Min[axis] - origin[axis]) * inverseDirection[axis];
+			const float t1 = (bounds.Max[axis] - origin[axis]) * inverseDirection[axis];
+			entry = std::max(entry, std::min(t0, t1));
+			exit = std::min(exit, std::max(t0, t1));
+		}
+		return entry <= exit ? entry : Infinity;
+	}
+}
+
+BoundingVolumeHierarchy::Bounds BoundingVolumeHierarchy::Bounds::FromBox(const Culling::Box& box, float margin)
+{
+	return { { box.Center.x - box.Extents.x - margin, box.Center.y - box.Extents.y - margin, box.Center.z - box.Extents.z - margin },
+			 { box.Center.x + box.Extents.x + margin, box.Center.y + box.Extents.y + margin, box.Center.z + box.Extents.z + margin } };
+}
+
+BoundingVolumeHierarchy::Bounds BoundingVolumeHierarchy::Bounds::Union(const Bounds& a, const Bounds& b)
+{
+	Bounds result;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		result.Min[axis] = std::min(a.Min[axis], b.Min[axis]);
+		result.Max[axis] = std::max(a.Max[axis], b.Max[axis]);
+	}
+	return result;
+}
+
+bool BoundingVolumeHierarchy::Bounds::Contains(const Bounds& other) const
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (other.Min[axis] < Min[axis] || other.Max[axis] > Max[axis])
+			return false;
+	}
+	return true;
+}
+
+float BoundingVolumeHierarchy::Bounds::Area() const
+{
+	const float x = Max[0] - Min[0], y = Max[1] - Min[1], z = Max[2] - Min[2];
+	return x * y + y * z + z * x;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(float margin)
+	:Margin(margin)
+{}
+
+void BoundingVolumeHierarchy::Build(const Culling::Box* boxes, const uint32_t* items, size_t count, std::vector<uint32_t>& proxies)
+{
+	Clear();
+	Nodes.reserve(2 * count);
+	proxies.resize(count);
+
+	std::vector<uint32_t> leaves(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint32_t leaf = AllocateNode();
+		Nodes[leaf].Tight = Bounds::FromBox(boxes[i]);
+		Nodes[leaf].Box = Bounds::FromBox(boxes[i], Margin);
+		Nodes[leaf].Item = items[i];
+		proxies[i] = leaves[i] = leaf;
+	}
+
+	LeafCount = count;
+	if (count > 0)
+		Root = BuildRange(leaves.data(), count, Null);
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+	Nodes.clear();
+	Root = FreeList = Null;
+	LeafCount = 0;
+}
+
+uint32_t BoundingVolumeHierarchy::Insert(const Culling::Box& box, uint32_t item)
+{
+	const uint32_t leaf = AllocateNode();
+	Nodes[leaf].Tight = Bounds::FromBox(box);
+	Nodes[leaf].Box = Bounds::FromBox(box, Margin);
+	Nodes[leaf].Item = item;
+
+	InsertLeaf(leaf);
+	LeafCount++;
+	return leaf;
+}
+
+void BoundingVolumeHierarchy::Remove(uint32_t proxy)
+{
+	ASSERT(proxy < Nodes.size() && Nodes[proxy].IsLeaf());
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	LeafCount--;
+}
+
+bool BoundingVolumeHierarchy::Update(uint32_t proxy, const Culling::Box& box)
+{
+	ASSERT(proxy < Nodes.size() && Nodes[proxy].IsLeaf());
+	Node& leaf = Nodes[proxy];
+	leaf.Tight = Bounds::FromBox(box);
+	if (leaf.Box.Contains(leaf.Tight))
+		return false;
+
+	leaf.Box = Bounds::FromBox(box, Margin);
+	RefitUpwards(leaf.Parent);
+	return true;
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(const Culling::Frustum& frustum, std::vector<uint32_t>& items) const
+{
+	if (Root == Null)
+		return;
+
+	Stack.clear();
+	Stack.push_back(Root);
+	while (!Stack.empty())
+	{
+		const Node& node = Nodes[Stack.back()];
+		const uint32_t index = Stack.back();
+		Stack.pop_back();
+
+		bool inside;
+		if (!Intersects(node.IsLeaf() ? node.Tight : node.Box, frustum, inside))
+			continue;
+
+		if (node.IsLeaf())
+			items.push_back(node.Item);
+		else if (inside)
+			AppendLeaves(index, items);
+		else
+		{
+			Stack.push_back(node.Children[0]);
+			Stack.push_back(node.Children[1]);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::QuerySphere(const DirectX::XMFLOAT3& center, float radius, std::vector<uint32_t>& items) const
+{
+	if (Root == Null)
+		return;
+
+	Stack.clear();
+	Stack.push_back(Root);
+	while (!Stack.empty())
+	{
+		const Node& node = Nodes[Stack.back()];
+		Stack.pop_back();
+
+		if (!Intersects(node.IsLeaf() ? node.Tight : node.Box, center, radius))
+			continue;
+
+		if (node.IsLeaf())
+			items.push_back(node.Item);
+		else
+		{
+			Stack.push_back(node.Children[0]);
+			Stack.push_back(node.Children[1]);
+		}
+	}
+}
+
+uint32_t BoundingVolumeHierarchy::RayCast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxDistance,
+										  float* distance) const
+{
+	if (Root == Null)
+		return Null;
+
+	const float start[3] = { origin.x, origin.y, origin.z };
+	const float inverseDirection[3] = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+
+	uint32_t nearest = Null;
+	float nearestDistance = maxDistance;
+	Stack.clear();
+	Stack.push_back(Root);
+	while (!Stack.empty())
+	{
+		const Node& node = Nodes[Stack.back()];
+		Stack.pop_back();
+
+		const float entry = RayDistance(node.IsLeaf() ? node.Tight : node.Box, start, inverseDirection);
+		if (entry == Infinity || entry > nearestDistance)
+			continue;
+
+		if (node.IsLeaf())
+		{
+			nearest = node.Item;
+			nearestDistance = entry;
+			continue;
+		}
+
+		// Nearer child on top, so it can shorten the ray before the other one is visited
+		const uint32_t first = node.Children[0], second = node.Children[1];
+		const bool firstNearer = RayDistance(Nodes[first].Box, start, inverseDirection) <= RayDistance(Nodes[second].Box, start, inverseDirection);
+		Stack.push_back(firstNearer ? second : first);
+		Stack.push_back(firstNearer ? first : second);
+	}
+
+	if (distance && nearest != Null)
+		*distance = nearestDistance;
+	return nearest;
+}
+
+uint32_t BoundingVolumeHierarchy::GetHeight() const
+{
+	return Root == Null ? 0 : GetHeight(Root);
+}
+
+float BoundingVolumeHierarchy::GetAreaRatio() const
+{
+	if (Root == Null || Nodes[Root].IsLeaf())
+		return 0.0f;
+
+	float area = 0.0f;
+	for (uint32_t i = 0; i < Nodes.size(); i++)
+	{
+		// Freed nodes are leaves without a parent, never counted
+		if (!Nodes[i].IsLeaf())
+			area += Nodes[i].Box.Area();
+	}
+
+	const float rootArea = Nodes[Root].Box.Area();
+	return rootArea > 0.0f ? area / rootArea : 0.0f;
+}
+
+uint32_t BoundingVolumeHierarchy::AllocateNode()
+{
+	uint32_t index;
+	if (FreeList != Null)
+	{
+		index = FreeList;
+		FreeList = Nodes[index].Parent;
+	}
+	else
+	{
+		index = static_cast<uint32_t>(Nodes.size());
+		Nodes.emplace_back();
+	}
+
+	Node& node = Nodes[index];
+	node.Parent = Null;
+	node.Children[0] = node.Children[1] = Null;
+	node.Item = Null;
+	return index;
+}
+
+void BoundingVolumeHierarchy::FreeNode(uint32_t index)
+{
+	Nodes[index].Children[0] = Nodes[index].Children[1] = Null;
+	Nodes[index].Parent = FreeList;
+	FreeList = index;
+}
+
+uint32_t BoundingVolumeHierarchy::BuildRange(uint32_t* leaves, size_t count, uint32_t parent)
+{
+	if (count == 1)
+	{
+		Nodes[leaves[0]].Parent = parent;
+		return leaves[0];
+	}
+
+	Bounds centroids = Empty();
+	for (size_t i = 0; i < count; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float centroid = Centroid(Nodes[leaves[i]].Box, axis);
+			centroids.Min[axis] = std::min(centroids.Min[axis], centroid);
+			centroids.Max[axis] = std::max(centroids.Max[axis], centroid);
+		}
+	}
+
+	int axis = 0;
+	for (int a = 1; a < 3; a++)
+	{
+		if (centroids.Max[a] - centroids.Min[a] > centroids.Max[axis] - centroids.Min[axis])
+			axis = a;
+	}
+
+	// Binned surface area heuristic along the widest centroid axis
+	size_t split = 0;
+	const float extent = centroids.Max[axis] - centroids.Min[axis];
+	if (extent > 0.0f)
+	{
+		const float scale = BinCount / extent;
+		const auto binOf = [&](uint32_t leaf)
+		{
+			const uint32_t bin = static_cast<uint32_t>((Centroid(Nodes[leaf].Box, axis) - centroids.Min[axis]) * scale);
+			return std::min(bin, BinCount - 1);
+		};
+
+		Bounds binBounds[BinCount];
+		size_t binCounts[BinCount] = {};
+		std::fill(std::begin(binBounds), std::end(binBounds), Empty());
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint32_t bin = binOf(leaves[i]);
+			binBounds[bin] = Bounds::Union(binBounds[bin], Nodes[leaves[i]].Box);
+			binCounts[bin]++;
+		}
+
+		// Right to left sweep first, then pick the cheapest plane on the way back
+		float rightCost[BinCount] = {};
+		Bounds right = Empty();
+		size_t rightCount = 0;
+		for (uint32_t bin = BinCount - 1; bin > 0; bin--)
+		{
+			right = Bounds::Union(right, binBounds[bin]);
+			rightCount += binCounts[bin];
+			rightCost[bin] = rightCount ? rightCount * right.Area() : 0.0f;
+		}
+
+		Bounds left = Empty();
+		size_t leftCount = 0;
+		float bestCost = Infinity;
+		uint32_t bestPlane = 0;
+		for (uint32_t plane = 1; plane < BinCount; plane++)
+		{
+			left = Bounds::Union(left, binBounds[plane - 1]);
+			leftCount += binCounts[plane - 1];
+			if (leftCount == 0 || leftCount == count)
+				continue;
+
+			const float cost = leftCount * left.Area() + rightCost[plane];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestPlane = plane;
+			}
+		}
+
+		if (bestPlane != 0)
+			split = std::partition(leaves, leaves + count, [&](uint32_t leaf) { return binOf(leaf) < bestPlane; }) - leaves;
+	}
+
+	// Coincident centroids, fall back to a median split
+	if (split == 0 || split == count)
+	{
+		split = count / 2;
+		std::nth_element(leaves, leaves + split, leaves + count, [&](uint32_t a, uint32_t b)
+						 {
+							 return Centroid(Nodes[a].Box, axis) < Centroid(Nodes[b].Box, axis);
+						 });
+	}
+
+	const uint32_t node = AllocateNode();
+	Nodes[node].Parent = parent;
+	const uint32_t first = BuildRange(leaves, split, node);
+	const uint32_t second = BuildRange(leaves + split, count - split, node);
+
+	Nodes[node].Children[0] = first;
+	Nodes[node].Children[1] = second;
+	Nodes[node].Box = Bounds::Union(Nodes[first].Box, Nodes[second].Box);
+	return node;
+}
+
+void BoundingVolumeHierarchy::InsertLeaf(uint32_t leaf)
+{
+	if (Root == Null)
+	{
+		Root = leaf;
+		Nodes[leaf].Parent = Null;
+		return;
+	}
+
+	// Descend while pushing the leaf further down is cheaper than pairing it here
+	const Bounds leafBox = Nodes[leaf].Box;
+	uint32_t index = Root;
+	while (!Nodes[index].IsLeaf())
+	{
+		const Node& node = Nodes[index];
+		const float combinedArea = Bounds::Union(node.Box, leafBox).Area();
+		const float cost = 2.0f * combinedArea;
+		const float inheritance = 2.0f * (combinedArea - node.Box.Area());
+
+		const auto descendCost = [&](uint32_t child)
+		{
+			const Bounds& box = Nodes[child].Box;
+			const float area = Bounds::Union(box, leafBox).Area();
+			return (Nodes[child].IsLeaf() ? area : area - box.Area()) + inheritance;
+		};
+
+		const float firstCost = descendCost(node.Children[0]);
+		const float secondCost = descendCost(node.Children[1]);
+		if (cost < firstCost && cost < secondCost)
+			break;
+
+		index = firstCost < secondCost ? node.Children[0] : node.Children[1];
+	}
+
+	const uint32_t sibling = index;
+	const uint32_t oldParent = Nodes[sibling].Parent;
+	const uint32_t parent = AllocateNode();
+	Nodes[parent].Parent = oldParent;
+	Nodes[parent].Children[0] = sibling;
+	Nodes[parent].Children[1] = leaf;
+	Nodes[parent].Box = Bounds::Union(Nodes[sibling].Box, leafBox);
+	Nodes[sibling].Parent = parent;
+	Nodes[leaf].Parent = parent;
+
+	if (oldParent == Null)
+		Root = parent;
+	else
+	{
+		Node& node = Nodes[oldParent];
+		node.Children[node.Children[0] == sibling ? 0 : 1] = parent;
+	}
+
+	RefitUpwards(oldParent);
+}
+
+void BoundingVolumeHierarchy::RemoveLeaf(uint32_t leaf)
+{
+	if (leaf == Root)
+	{
+		Root = Null;
+		return;
+	}
+
+	const uint32_t parent = Nodes[leaf].Parent;
+	const uint32_t grandParent = Nodes[parent].Parent;
+	const uint32_t sibling = Nodes[parent].Children[Nodes[parent].Children[0] == leaf ? 1 : 0];
+
+	Nodes[sibling].Parent = grandParent;
+	FreeNode(parent);
+
+	if (grandParent == Null)
+	{
+		Root = sibling;
+		return;
+	}
+
+	Node& node = Nodes[grandParent];
+	node.Children[node.Children[0] == parent ? 0 : 1] = sibling;
+	RefitUpwards(grandParent);
+}
+
+void BoundingVolumeHierarchy::RefitUpwards(uint32_t index)
+{
+	while (index != Null)
+	{
+		Node& node = Nodes[index];
+		const Bounds refit = Bounds::Union(Nodes[node.Children[0]].Box, Nodes[node.Children[1]].Box);
+		const bool unchanged = refit.Contains(node.Box) && node.Box.Contains(refit);
+		node.Box = refit;
+		Rotate(index);
+
+		// Nothing above can change once a box stays the same
+		if (unchanged)
+			break;
+		index = Nodes[index].Parent;
+	}
+}
+
+void BoundingVolumeHierarchy::Rotate(uint32_t index)
+{
+	// Swapping a child with a grandchild on the other side keeps the box of index,
+	// the subtree that received the child is the only one changing area
+	Node& node = Nodes[index];
+	float bestGain = 0.0f;
+	int bestSide = -1, bestGrandChild = -1;
+
+	for (int side = 0; side < 2; side++)
+	{
+		const Node& other = Nodes[node.Children[1 - side]];
+		if (other.IsLeaf())
+			continue;
+
+		for (int grandChild = 0; grandChild < 2; grandChild++)
+		{
+			const Bounds& kept = Nodes[other.Children[1 - grandChild]].Box;
+			const float gain = other.Box.Area() - Bounds::Union(Nodes[node.Children[side]].Box, kept).Area();
+			if (gain > bestGain)
+			{
+				bestGain = gain;
+				bestSide = side;
+				bestGrandChild = grandChild;
+			}
+		}
+	}
+
+	if (bestSide < 0)
+		return;
+
+	const uint32_t child = node.Children[bestSide];
+	const uint32_t otherIndex = node.Children[1 - bestSide];
+	Node& other = Nodes[otherIndex];
+	const uint32_t grandChild = other.Children[bestGrandChild];
+
+	node.Children[bestSide] = grandChild;
+	Nodes[grandChild].Parent = index;
+	other.Children[bestGrandChild] = child;
+	Nodes[child].Parent = otherIndex;
+	other.Box = Bounds::Union(Nodes[other.Children[0]].Box, Nodes[other.Children[1]].Box);
+}
+
+void BoundingVolumeHierarchy::AppendLeaves(uint32_t index, std::vector<uint32_t>& items) const
+{
+	const Node& node = Nodes[index];
+	if (node.IsLeaf())
+	{
+		items.push_back(node.Item);
+		return;
+	}
+
+	AppendLeaves(node.Children[0], items);
+	AppendLeaves(node.Children[1], items);
+}
+
+uint32_t BoundingVolumeHierarchy::GetHeight(uint32_t index) const
+{
+	const Node& node = Nodes[index];
+	if (node.IsLeaf())
+		return 0;
+
+	return 1 + std::max(GetHeight(node.Children[0]), GetHeight(node.Children[1]));
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Rendering/Culling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Dynamic AABB tree over items identified by a caller chosen index. Leaves keep the tight box of their item
+// and a box grown by Margin, so small movements do not touch the tree. Larger ones refit the ancestors
+// in place and rotate them where that lowers the surface area, instead of reinserting the leaf.
+class BoundingVolumeHierarchy
+{
+public:
+	static constexpr uint32_t Null = ~0u;
+
+	struct Bounds
+	{
+		float Min[3];
+		float Max[3];
+
+		static Bounds FromBox(const Culling::Box& box, float margin = 0.0f);
+		static Bounds Union(const Bounds& a, const Bounds& b);
+		bool Contains(const Bounds& other) const;
+		// Half of the surface area
+		float Area() const;
+	};
+
+	explicit BoundingVolumeHierarchy(float margin = 0.1f);
+
+	// Replaces the tree with a binned SAH build over boxes, items[i] being the item of boxes[i].
+	// proxies receives the proxy of each box, in input order.
+	void Build(const Culling::Box* boxes, const uint32_t* items, size_t count, std::vector<uint32_t>& proxies);
+	void Clear();
+
+	uint32_t Insert(const Culling::Box& box, uint32_t item);
+	void Remove(uint32_t proxy);
+	// Returns true when the tree had to be refit
+	bool Update(uint32_t proxy, const Culling::Box& box);
+
+	// Queries append the items whose tight box passes the test
+	void QueryFrustum(const Culling::Frustum& frustum, std::vector<uint32_t>& items) const;
+	void QuerySphere(const DirectX::XMFLOAT3& center, float radius, std::vector<uint32_t>& items) const;
+	// Item with the nearest box hit along the ray within maxDistance, Null when nothing is hit
+	uint32_t RayCast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxDistance,
+					 float* distance = nullptr) const;
+
+	size_t Size() const { return LeafCount; }
+	uint32_t GetHeight() const;
+	// Sum of the internal node areas relative to the root area, lower is better
+	float GetAreaRatio() const;
+
+private:
+	struct Node
+	{
+		// Union of the children, or the tight box grown by Margin for leaves
+		Bounds Box;
+		// Leaves only
+		Bounds Tight;
+		uint32_t Parent;
+		uint32_t Children[2];
+		uint32_t Item;
+
+		bool IsLeaf() const { return Children[0] == Null; }
+	};
+
+	uint32_t AllocateNode();
+	void FreeNode(uint32_t index);
+
+	uint32_t BuildRange(uint32_t* leaves, size_t count, uint32_t parent);
+	void InsertLeaf(uint32_t leaf);
+	void RemoveLeaf(uint32_t leaf);
+	// Refits and rotates every node from index up to the root
+	void RefitUpwards(uint32_t index);
+	void Rotate(uint32_t index);
+	void AppendLeaves(uint32_t index, std::vector<uint32_t>& items) const;
+	uint32_t GetHeight(uint32_t index) const;
+
+private:
+	std::vector<Node> Nodes;
+	uint32_t Root = Null;
+	uint32_t FreeList = Null;
+	size_t LeafCount = 0;
+	float Margin;
+};
\ No newline at end of file
@@ -1,142 +1,17 @@
 #include "Buffer.h"
 #include "CurrentGraphicsContext.h"
 #include "Graphics.h"
+#include "MeshOptimizer.h"
+#include "StateCache.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
 #include <filesystem>
 
-LayoutElement::LayoutElement(const std::string& name, DataType type)
-	:Name(name), Type(type), Size(CalcSize(type)), Offset(0)
-{
-}
-
-LayoutElement::LayoutElement(ElementType type)
-	:Name(ResolveNameFromType(type)), Type(ResolveDataType(type)), Size(CalcSize(type)), Offset(0)
-{}
-
-const char* LayoutElement::ResolveNameFromType(ElementType type)
-{
-	switch (type)
-	{
-	case ElementType::Position2:
-	case ElementType::Position3: return "Position";
-	case ElementType::Color3:
-	case ElementType::Color4: return "Color";
-	case ElementType::Normal: return "Normal";
-	case ElementType::Tangent: return "Tangent";
-	case ElementType::Bitangent: return "Bitangent";
-	case ElementType::TexCoords: return "TexCoords";
-	}
-}
-
-DXGI_FORMAT LayoutElement::DataTypeToDXGI(DataType type)
-{
-	switch (type)
-	{
-	case DataType::UChar2Norm: return DXGI_FORMAT_R8G8_UNORM;
-	case DataType::UChar4Norm: return DXGI_FORMAT_R8G8B8A8_UNORM;
-	case DataType::UChar2: return DXGI_FORMAT_R8G8_UINT;
-	case DataType::UChar4: return DXGI_FORMAT_R8G8B8A8_UINT;
-	case DataType::Float: return DXGI_FORMAT_R32_FLOAT;
-	case DataType::Float2: return DXGI_FORMAT_R32G32_FLOAT;
-	case DataType::Float3: return DXGI_FORMAT_R32G32B32_FLOAT;
-	case DataType::Float4: return DXGI_FORMAT_R32G32B32A32_FLOAT;
-	case DataType::Int: return  DXGI_FORMAT_R32_SINT;
-	case DataType::Int2: return DXGI_FORMAT_R32G32_SINT;
-	case DataType::Int3: return DXGI_FORMAT_R32G32B32_SINT;
-	case DataType::Int4: return DXGI_FORMAT_R32G32B32A32_SINT;
-	}
-}
-
-LayoutElement::DataType LayoutElement::ResolveDataType(ElementType type)
-{
-	switch (type)
-	{
-	case ElementType::Position2: return DataType::Float2;
-	case ElementType::Position3: return DataType::Float3;
-	case ElementType::Color3: return DataType::Float3;
-	case ElementType::Color4: return DataType::Float4;
-	case ElementType::Normal: return DataType::Float3;
-	case ElementType::Tangent: return DataType::Float3;
-	case ElementType::Bitangent: return DataType::Float3;
-	case ElementType::TexCoords: return DataType::Float2;
-	}
-}
-
-uint32_t LayoutElement::CalcSize(DataType type)
-{
-	switch (type)
-	{
-	case DataType::UChar2:
-	case DataType::UChar2Norm: return sizeof(unsigned char) * 2;
-	case DataType::UChar4:
-	case DataType::UChar4Norm: return sizeof(unsigned char) * 4;
-	case DataType::Float: return sizeof(float);
-	case DataType::Float2: return sizeof(float) * 2;
-	case DataType::Float3: return sizeof(float) * 3;
-	case DataType::Float4: return sizeof(float) * 4;
-	case DataType::Int: return  sizeof(int);
-	case DataType::Int2: return sizeof(int) * 2;
-	case DataType::Int3: return sizeof(int) * 3;
-	case DataType::Int4: return sizeof(int) * 4;
-	}
-}
-
-uint32_t LayoutElement::CalcSize(ElementType type)
-{
-	switch (type)
-	{
-	case ElementType::Position2: return sizeof(float) * 2;
-	case ElementType::Position3: return sizeof(float) * 3;
-	case ElementType::Color3: return sizeof(float) * 3;
-	case ElementType::Color4: return sizeof(float) * 4;
-	case ElementType::Normal: return sizeof(float) * 3;
-	case ElementType::Tangent: return sizeof(float) * 3;
-	case ElementType::Bitangent: return sizeof(float) * 3;
-	case ElementType::TexCoords: return sizeof(float) * 2;
-	}
-}
-
-BufferLayout::BufferLayout(std::initializer_list<LayoutElement> elements)
-	: Elements(elements)
-{
-	uint32_t offset = 0;
-	for (auto& element : Elements)
-	{
-		element.Offset = offset;
-		offset += element.Size;
-		Stride += element.Size;
-	}
-}
-
-BufferLayout& BufferLayout::AddElement(LayoutElement element)
-{
-	uint32_t offset = Elements.empty() ? 0 : Elements.back().Offset + Elements.back().Size;
-	element.Offset = offset;
-	Stride = element.Offset + element.Size;
-	Elements.push_back(element);
-	return *this;
-}
-
-uint32_t BufferLayout::GetStride() const
-{
-	return Stride;
-}
-
-size_t BufferLayout::GetElementsSize() const
-{
-	return Elements.size();
-}
-
-const LayoutElement& BufferLayout::operator[](size_t i) const
-{
-	return Elements[i];
-}
-
-inline VertexBuffer::VertexBuffer(const std::string& tag,
-								  const BufferLayout& layout)
+VertexBuffer::VertexBuffer(const std::string& tag,
+						   const BufferLayout& layout)
 	:Buffer(tag), Layout(layout), Topology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
 {
 }
@@ -145,13 +20,18 @@ void VertexBuffer::Bind() const
 {
 	UINT stride = Layout.GetStride();
 	UINT offset = 0;
-	CurrentGraphicsContext::Context()->IASetVertexBuffers(0, 1, BufferID.GetAddressOf(), &stride, &offset);
-	CurrentGraphicsContext::Context()->IASetPrimitiveTopology(Topology);
+	StateCache::SetVertexBuffer(0, BufferID.Get(), stride, offset);
+	StateCache::SetPrimitiveTopology(Topology);
 }
 
 void VertexBuffer::Unbind() const
 {
-	CurrentGraphicsContext::Context()->IASetVertexBuffers(0, 0, nullptr, 0, 0);
+	StateCache::SetVertexBuffer(0, nullptr, 0, 0);
+}
+
+void VertexBuffer::Record(DrawPacket& packet) const
+{
+	packet.SetVertexBuffer(BufferID.Get(), Layout.GetStride(), Topology);
 }
 
 std::string VertexBuffer::GetID() const
@@ -166,78 +46,72 @@ BufferType VertexBuffer::GetType() const
 
 BufferLayout VertexBuffer::GetLayout() const { return Layout; }
 
-VertexBufferBuilder::VertexBufferBuilder(const std::string& tag,
-										 BufferLayout&& layout, const Microsoft::WRL::ComPtr<ID3DBlob>& blob)
-	: Object(tag, std::move(layout))
-{
-	//std::vector<D3D11_INPUT_ELEMENT_DESC> desc;
-	//desc.reserve(Object.Layout.GetElementsSize());
-
-	//for (size_t i = 0; i < Object.Layout.GetElementsSize(); i++)
-	//{
-	//	const auto& element = Object.Layout[i];
-	//	desc.emplace_back(element.Name.c_str(), 0, LayoutElement::DataTypeToDXGI(element.Type),
-	//		0, element.Offset, D3D11_INPUT_PER_VERTEX_DATA, 0);
-	//}
-
-	//CurrentGraphicsContext::Device()->CreateInputLayout(desc.data(), (UINT)std::size(desc), Object.Blob->GetBufferPointer(),
-	//	Object.Blob->GetBufferSize(), &Object.InputLayout);
-}
-
-UniquePtr<VertexBuffer> VertexBufferBuilder::Release()
+void VertexBuffer::Create(const void* data, uint32_t byteWidth)
 {
 	D3D11_BUFFER_DESC vertexBufferDesc;
 	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
 	vertexBufferDesc.CPUAccessFlags = 0;
 	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.ByteWidth = Vertices.size();
-	vertexBufferDesc.StructureByteStride = Object.Layout.GetStride();
+	vertexBufferDesc.ByteWidth = byteWidth;
+	vertexBufferDesc.StructureByteStride = Layout.GetStride();
 
 	D3D11_SUBRESOURCE_DATA subResourceData;
-	subResourceData.pSysMem = Vertices.data();
+	subResourceData.pSysMem = data;
 
-	CurrentGraphicsContext::Device()->CreateBuffer(&vertexBufferDesc, &subResourceData, &Object.BufferID);
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateBuffer(&vertexBufferDesc, &subResourceData, &BufferID));
+}
+
+VertexBufferBuilder::VertexBufferBuilder(const std::string& tag, BufferLayout&& layout, const Microsoft::WRL::ComPtr<ID3DBlob>& blob)
+	:Vertices(layout), Object(tag, std::move(layout))
+{}
 
+UniquePtr<VertexBuffer> VertexBufferBuilder::Release()
+{
+	Object.Create(Vertices.Data(), static_cast<uint32_t>(Vertices.GetByteSize()));
 	return MakeUnique<VertexBuffer>(std::move(Object));
 }
 
-Vertex VertexBufferBuilder::Back()
+IndexBuffer::IndexBuffer(const std::string& tag, const std::vector<uint16_t>& indices)
+	:Buffer(tag), Count(static_cast<UINT>(indices.size())), Format(DXGI_FORMAT_R16_UINT)
 {
-	ASSERT(Vertices.size() != 0);
-	return Vertex{ Vertices.data() + Vertices.size() - Object.Layout.GetStride(), Object.Layout };
+	Create(indices.data(), sizeof(uint16_t));
 }
 
-Vertex VertexBufferBuilder::Front()
+IndexBuffer::IndexBuffer(const std::string& tag, const std::vector<uint32_t>& indices)
+	:Buffer(tag), Count(static_cast<UINT>(indices.size())), Format(DXGI_FORMAT_R32_UINT)
 {
-	ASSERT(Vertices.size() != 0);
-	return Vertex{ Vertices.data(), Object.Layout };
+	Create(indices.data(), sizeof(uint32_t));
 }
 
-IndexBuffer::IndexBuffer(const std::string& tag, const std::vector<unsigned short>& indices)
-	:Buffer(tag), Count(static_cast<UINT>(indices.size()))
+void IndexBuffer::Create(const void* data, uint32_t indexSize)
 {
 	D3D11_BUFFER_DESC indexBufferDesc{};
 	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
 	indexBufferDesc.CPUAccessFlags = 0;
 	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.ByteWidth = sizeof(unsigned short) * indices.size();
-	indexBufferDesc.StructureByteStride = sizeof(unsigned short);
+	indexBufferDesc.ByteWidth = indexSize * Count;
+	indexBufferDesc.StructureByteStride = indexSize;
 
 	D3D11_SUBRESOURCE_DATA subResourceData;
-	subResourceData.pSysMem = indices.data();
+	subResourceData.pSysMem = data;
 	CurrentGraphicsContext::Device()->CreateBuffer(&indexBufferDesc, &subResourceData, &BufferID);
 }
 
 void IndexBuffer::Bind() const
 {
-	CurrentGraphicsContext::Context()->IASetIndexBuffer(BufferID.Get(), DXGI_FORMAT_R16_UINT, 0);
+	StateCache::SetIndexBuffer(BufferID.Get(), Format, 0);
 }
 
 void IndexBuffer::Unbind() const
 {
-	CurrentGraphicsContext::Context()->IASetIndexBuffer(nullptr, DXGI_FORMAT_R16_UINT, 0);
+	StateCache::SetIndexBuffer(nullptr, Format, 0);
+}
+
+void IndexBuffer::Record(DrawPacket& packet) const
+{
+	packet.SetIndexBuffer(BufferID.Get(), Format, Count);
 }
 
 BufferType IndexBuffer::GetType() const
@@ -250,6 +124,11 @@ UINT IndexBuffer::GetCount() const
 	return Count;
 }
 
+DXGI_FORMAT IndexBuffer::GetFormat() const
+{
+	return Format;
+}
+
 std::string IndexBuffer::GetID() const
 {
 	return std::string(typeid(IndexBuffer).name()) + "#" + Tag;
@@ -292,31 +171,26 @@ void BufferGroup::Unbind() const
 		buffer->Unbind();
 }
 
-inline Vertex::Vertex(char* ptr, const BufferLayout& layout)
-	: Ptr(ptr), Layout(layout)
+void BufferGroup::Record(DrawPacket& packet) const
 {
-	ASSERT(ptr);
+	for (const auto& buffer : Buffers)
+		buffer->Record(packet);
 }
 
 inline Buffer::Buffer(const std::string& tag)
 	: Tag(tag)
 {}
 
-void BufferPool::Add(SharedPtr<BufferBase> buffer)
+SharedPtr<BufferBase> BufferPool::Add(SharedPtr<BufferBase> buffer)
 {
-	if (Get(buffer->GetID()))
-		return;
-
-	Buffers[buffer->GetID()] = std::move(buffer);
+	const ResourceHandle handle = buffer->GetHandle();
+	return Buffers.Insert(handle, std::move(buffer)).first;
 }
 
-SharedPtr<BufferBase> BufferPool::Get(const std::string& id)
+SharedPtr<BufferBase> BufferPool::Get(ResourceHandle handle)
 {
-	auto it = Buffers.find(id);
-	if (it == Buffers.end())
-		return {};
-	else
-		return it->second;
+	auto* buffer = Buffers.Find(handle);
+	return buffer ? *buffer : SharedPtr<BufferBase>{};
 }
 
 InputLayout::InputLayout(const std::string& tag, const BufferLayout& layout, const Microsoft::WRL::ComPtr<ID3DBlob>& blob)
@@ -327,24 +201,167 @@ InputLayout::InputLayout(const std::string& tag, const BufferLayout& layout, con
 
 	for (auto& element : layout.Elements)
 	{
-		desc.emplace_back(element.Name.c_str(), 0, LayoutElement::DataTypeToDXGI(element.Type),
+		desc.emplace_back(element.Name.c_str(), 0, GetDXGIFormat(element.Type),
+						  0, element.Offset, D3D11_INPUT_PER_VERTEX_DATA, 0);
+	}
+
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateInputLayout(desc.data(), (UINT)std::size(desc), blob->GetBufferPointer(), blob->GetBufferSize(), &BufferID));
+}
+
+InputLayout::InputLayout(const std::string& tag, const D3D11_INPUT_ELEMENT_DESC* desc, size_t count, const Microsoft::WRL::ComPtr<ID3DBlob>& blob)
+	:Tag(tag)
+{
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateInputLayout(desc, (UINT)count, blob->GetBufferPointer(), blob->GetBufferSize(), &BufferID));
+}
+
+InputLayout::InputLayout(const std::string& tag, const BufferLayout& layout, uint32_t instanceMatrices,
+						 const Microsoft::WRL::ComPtr<ID3DBlob>& blob)
+	:Tag(tag)
+{
+	static constexpr const char* instanceSemantics[] = { "InstanceModel", "InstanceModelView" };
+	ASSERT(instanceMatrices <= std::size(instanceSemantics));
+
+	std::vector<D3D11_INPUT_ELEMENT_DESC> desc{};
+	desc.reserve(layout.GetElementsSize() + instanceMatrices * 4);
+
+	for (auto& element : layout.Elements)
+	{
+		desc.emplace_back(element.Name.c_str(), 0, GetDXGIFormat(element.Type),
 						  0, element.Offset, D3D11_INPUT_PER_VERTEX_DATA, 0);
 	}
 
+	for (uint32_t matrix = 0; matrix < instanceMatrices; matrix++)
+	{
+		for (uint32_t row = 0; row < 4; row++)
+		{
+			desc.emplace_back(instanceSemantics[matrix], row, DXGI_FORMAT_R32G32B32A32_FLOAT,
+							  1, (matrix * 4 + row) * 16, D3D11_INPUT_PER_INSTANCE_DATA, 1);
+		}
+	}
+
 	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateInputLayout(desc.data(), (UINT)std::size(desc), blob->GetBufferPointer(), blob->GetBufferSize(), &BufferID));
 }
 
 void InputLayout::Bind() const
 {
-	CurrentGraphicsContext::Context()->IASetInputLayout(BufferID.Get());
+	StateCache::SetInputLayout(BufferID.Get());
 }
 
 void InputLayout::Unbind() const
 {
-	CurrentGraphicsContext::Context()->IASetInputLayout(nullptr);
+	StateCache::SetInputLayout(nullptr);
+}
+
+void InputLayout::Record(DrawPacket& packet) const
+{
+	packet.SetInputLayout(BufferID.Get());
 }
 
 std::string InputLayout::GetID() const
 {
 	return std::string(typeid(InputLayout).name()) + "#" + Tag;
 }
+
+InstanceBuffer::InstanceBuffer(const std::string& tag, uint32_t stride)
+	:Buffer(tag), Stride(stride)
+{}
+
+void InstanceBuffer::Upload(const void* data, uint32_t count)
+{
+	if (count == 0)
+		return;
+
+	if (count > Capacity)
+	{
+		Capacity = std::max({ count, Capacity * 2, 64u });
+
+		D3D11_BUFFER_DESC instanceBufferDesc{};
+		instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		instanceBufferDesc.ByteWidth = Capacity * Stride;
+		instanceBufferDesc.StructureByteStride = Stride;
+
+		BufferID.Reset();
+		GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateBuffer(&instanceBufferDesc, nullptr, &BufferID));
+	}
+
+	D3D11_MAPPED_SUBRESOURCE subResource;
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Context()->Map(BufferID.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &subResource));
+	std::memcpy(subResource.pData, data, static_cast<size_t>(count) * Stride);
+	CurrentGraphicsContext::Context()->Unmap(BufferID.Get(), 0);
+}
+
+void InstanceBuffer::Bind() const
+{
+	BindFrom(0);
+}
+
+void InstanceBuffer::BindFrom(uint32_t firstInstance) const
+{
+	StateCache::SetVertexBuffer(1, BufferID.Get(), Stride, firstInstance * Stride);
+}
+
+void InstanceBuffer::Unbind() const
+{
+	StateCache::SetVertexBuffer(1, nullptr, 0, 0);
+}
+
+std::string InstanceBuffer::GetID() const
+{
+	return std::string(typeid(InstanceBuffer).name()) + "#" + Tag;
+}
+
+StructuredBuffer::StructuredBuffer(const std::string& tag, uint32_t stride, uint32_t slot)
+	:Buffer(tag), Stride(stride), Slot(slot)
+{}
+
+void StructuredBuffer::Upload(const void* data, uint32_t count)
+{
+	if (count == 0)
+		return;
+
+	if (count > Capacity)
+	{
+		Capacity = std::max({ count, Capacity * 2, 64u });
+
+		D3D11_BUFFER_DESC structuredBufferDesc{};
+		structuredBufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		structuredBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		structuredBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		structuredBufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		structuredBufferDesc.ByteWidth = Capacity * Stride;
+		structuredBufferDesc.StructureByteStride = Stride;
+
+		BufferID.Reset();
+		View.Reset();
+		GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateBuffer(&structuredBufferDesc, nullptr, &BufferID));
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc{};
+		viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+		viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		viewDesc.Buffer.FirstElement = 0;
+		viewDesc.Buffer.NumElements = Capacity;
+		GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateShaderResourceView(BufferID.Get(), &viewDesc, &View));
+	}
+
+	D3D11_MAPPED_SUBRESOURCE subResource;
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Context()->Map(BufferID.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &subResource));
+	std::memcpy(subResource.pData, data, static_cast<size_t>(count) * Stride);
+	CurrentGraphicsContext::Context()->Unmap(BufferID.Get(), 0);
+}
+
+void StructuredBuffer::Bind() const
+{
+	StateCache::PSSetShaderResource(Slot, View.Get());
+}
+
+void StructuredBuffer::Unbind() const
+{
+	StateCache::PSSetShaderResource(Slot, nullptr);
+}
+
+std::string StructuredBuffer::GetID() const
+{
+	return std::string(typeid(StructuredBuffer).name()) + "#" + Tag;
+}
\ No newline at end of file
@@ -1,8 +1,16 @@
 #pragma once
 
 #include "Core\Core.h"
+#include "ConstantRing.h"
 #include "CurrentGraphicsContext.h"
-
+#include "DrawPacket.h"
+#include "FrameStatistics.h"
+#include "HandleMap.h"
+#include "StateCache.h"
+#include "VertexArray.h"
+
+#include <array>
+#include <cstring>
 #include <d3d11.h>
 #include <DirectXMath.h>
 #include <DirectXPackedVector.h>
@@ -15,137 +23,29 @@
 
 #pragma warning(disable : 26800)
 
-struct LayoutElement
-{
-	enum class DataType
-	{
-		UChar2, UChar4,
-		UChar2Norm, UChar4Norm,
-		Float, Float2, Float3, Float4,
-		Int, Int2, Int3, Int4
-	};
-
-	enum class ElementType
-	{
-		Position2, Position3,
-		Color3, Color4,
-		Normal, Tangent, Bitangent,
-		TexCoords,
-	};
-
-public:
-	LayoutElement(const std::string& name, DataType type);
-	LayoutElement(ElementType type);
-
-	uint32_t GetSize() const { return Size; }
-	uint32_t GetOffset() const { return Offset; }
-	DataType GetType() const { return Type; }
-
-private:
-	static const char* ResolveNameFromType(ElementType type);
-	static DXGI_FORMAT DataTypeToDXGI(DataType type);
-	static DataType ResolveDataType(ElementType type);
-	static uint32_t CalcSize(DataType type);
-	static uint32_t CalcSize(ElementType type);
-
-private:
-	std::string Name;
-	DataType Type;
-	uint32_t Size;
-	uint32_t Offset;
-
-	friend class VertexBuffer;
-	friend class VertexBufferBuilder;
-	friend struct BufferLayout;
-	friend class InputLayout;
-};
-
-struct BufferLayout
+constexpr DXGI_FORMAT GetDXGIFormat(LayoutElement::DataType type)
 {
-	BufferLayout() = default;
-	BufferLayout(std::initializer_list<LayoutElement> elements);
-
-	BufferLayout& AddElement(LayoutElement element);
-
-	uint32_t GetStride() const;
-	size_t GetElementsSize() const;
-
-	template<LayoutElement::ElementType Type>
-	const LayoutElement& ResolveType() const
+	using DataType = LayoutElement::DataType;
+	switch (type)
 	{
-		for (auto& element : Elements)
-		{
-			if (element.GetType() == Type)
-				return element;
-		}
-		ASSERT(false);
-		return Elements.front();
+	case DataType::UChar2Norm: return DXGI_FORMAT_R8G8_UNORM;
+	case DataType::UChar4Norm: return DXGI_FORMAT_R8G8B8A8_UNORM;
+	case DataType::UChar2: return DXGI_FORMAT_R8G8_UINT;
+	case DataType::UChar4: return DXGI_FORMAT_R8G8B8A8_UINT;
+	case DataType::Float: return DXGI_FORMAT_R32_FLOAT;
+	case DataType::Float2: return DXGI_FORMAT_R32G32_FLOAT;
+	case DataType::Float3: return DXGI_FORMAT_R32G32B32_FLOAT;
+	case DataType::Float4: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+	case DataType::Int: return  DXGI_FORMAT_R32_SINT;
+	case DataType::Int2: return DXGI_FORMAT_R32G32_SINT;
+	case DataType::Int3: return DXGI_FORMAT_R32G32B32_SINT;
+	case DataType::Int4: return DXGI_FORMAT_R32G32B32A32_SINT;
+	case DataType::Short2Norm: return DXGI_FORMAT_R16G16_SNORM;
+	case DataType::Short4Norm: return DXGI_FORMAT_R16G16B16A16_SNORM;
+	case DataType::Half2: return DXGI_FORMAT_R16G16_FLOAT;
 	}
-
-	const LayoutElement& operator[](size_t i) const;
-private:
-
-	std::vector<LayoutElement> Elements;
-	uint32_t Stride = 0;
-
-	friend class VertexBuffer;
-	friend class InputLayout;
-};
-
-struct Vertex
-{
-public:
-	template<typename T>
-	void SetAttributeIndex(size_t i, T&& attr)
-	{
-		using namespace DirectX;
-		using namespace DirectX::PackedVector;
-		using DataType = LayoutElement::DataType;
-
-		const auto& element = Layout[i];
-		auto attributePtr = Ptr + element.GetOffset();
-
-		switch (element.GetType())
-		{
-			case DataType::UChar2Norm: SetAttribute<XMUBYTEN2>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::UChar4Norm: SetAttribute<XMUBYTEN4>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::UChar2: SetAttribute<XMUBYTE2>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::UChar4: SetAttribute<XMUBYTE4>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Float: SetAttribute<float>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Float2: SetAttribute<XMFLOAT2>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Float3: SetAttribute<XMFLOAT3>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Float4: SetAttribute<XMFLOAT4>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Int: SetAttribute<int>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Int2: SetAttribute<XMINT2>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Int3: SetAttribute<XMINT3>(attributePtr, std::forward<T>(attr)); break;
-			case DataType::Int4: SetAttribute<XMINT4>(attributePtr, std::forward<T>(attr)); break;
-		}
-	}
-
-private:
-	Vertex(char* ptr, const BufferLayout& layout);
-
-	template<typename First, typename ...Rest>
-	void SetAttributeIndex(size_t i, First&& first, Rest&&... rest)
-	{
-		SetAttributeIndex(i, std::forward<First>(first));
-		SetAttributeIndex(i + 1, std::forward<Rest>(rest)...);
-	}
-
-	template<typename Dest, typename Src>
-	void SetAttribute(char* attributePtr, Src&& attr)
-	{
-		if constexpr (std::is_assignable<Dest, Src>::value)
-			*reinterpret_cast<Dest*>(attributePtr) = attr;
-		else
-			ASSERT(false);
-	}
-private:
-	char* Ptr;
-	const BufferLayout& Layout;
-
-	friend class VertexBufferBuilder;
-};
+	return DXGI_FORMAT_UNKNOWN;
+}
 
 enum BufferType
 {
@@ -161,6 +61,19 @@ public:
 	virtual void Bind() const = 0;
 	virtual void Unbind() const = 0;
 	virtual std::string GetID() const = 0;
+	// Bakes the binding into a draw packet, by default it is rebound on every draw
+	virtual void Record(DrawPacket& packet) const { packet.AddDynamic(*this); }
+
+	// Interned GetID(), built once per resource
+	inline ResourceHandle GetHandle() const
+	{
+		if (Handle == InvalidResourceHandle)
+			Handle = InternResourceID(GetID());
+		return Handle;
+	}
+
+private:
+	mutable ResourceHandle Handle = InvalidResourceHandle;
 };
 
 class Buffer : public BufferBase
@@ -180,9 +93,20 @@ class InputLayout : public BufferBase
 public:
 	InputLayout(const std::string& tag, const BufferLayout& layout, const Microsoft::WRL::ComPtr<ID3DBlob>& blob);
 
+	template<size_t N>
+	InputLayout(const std::string& tag, const std::array<D3D11_INPUT_ELEMENT_DESC, N>& desc, const Microsoft::WRL::ComPtr<ID3DBlob>& blob)
+		:InputLayout(tag, desc.data(), N, blob)
+	{}
+
+	InputLayout(const std::string& tag, const D3D11_INPUT_ELEMENT_DESC* desc, size_t count, const Microsoft::WRL::ComPtr<ID3DBlob>& blob);
+	// Vertex layout followed by instanceMatrices row major matrices per instance in slot 1,
+	// named InstanceModel and InstanceModelView
+	InputLayout(const std::string& tag, const BufferLayout& layout, uint32_t instanceMatrices, const Microsoft::WRL::ComPtr<ID3DBlob>& blob);
+
 	virtual void Bind() const;
 	virtual void Unbind() const;
 	virtual std::string GetID() const;
+	void Record(DrawPacket& packet) const override;
 
 private:
 	std::string Tag;
@@ -218,6 +142,7 @@ public:
 	void Bind() const override;
 	void Unbind() const override;
 	std::string GetID() const override;
+	void Record(DrawPacket& packet) const override;
 
 	BufferType GetType() const;
 	BufferLayout GetLayout() const;
@@ -225,12 +150,17 @@ public:
 public:
 	D3D11_PRIMITIVE_TOPOLOGY Topology;
 
+private:
+	void Create(const void* data, uint32_t byteWidth);
+
 private:
 	BufferLayout Layout;
 
 	static const BufferType Type = BufferType::VertexB;
 
 	friend class VertexBufferBuilder;
+	template<typename Layout>
+	friend class StaticVertexBufferBuilder;
 };
 
 class VertexBufferBuilder
@@ -241,37 +171,80 @@ public:
 	template<typename ...Attributes>
 	void EmplaceBack(Attributes&&... attributes)
 	{
-		Vertices.resize(Vertices.size() + Object.Layout.GetStride());
-		Back().SetAttributeIndex(0, std::forward<Attributes>(attributes)...);
+		Vertices.EmplaceBack(std::forward<Attributes>(attributes)...);
 	}
 
-	UniquePtr<VertexBuffer> Release();
+	// Appends count vertices at once, streams[i] feeding the i-th element of the layout
+	void Interleave(std::initializer_list<VertexStream> streams, size_t count) { Vertices.Interleave(streams, count); }
 
-private:
+	// Moves vertex i to remap[i], dropping vertices mapped to ~0u
+	void Remap(const std::vector<uint32_t>& remap, size_t vertexCount) { Vertices.Remap(remap, vertexCount); }
 
-	Vertex Back();
+	UniquePtr<VertexBuffer> Release();
 
-	Vertex Front();
 private:
-	std::vector<char> Vertices{};
+	VertexArray Vertices;
 	VertexBuffer Object;
 };
 
 class IndexBuffer : public Buffer
 {
 public:
-	IndexBuffer(const std::string& tag, const std::vector<unsigned short>& indices);
+	IndexBuffer(const std::string& tag, const std::vector<uint16_t>& indices);
+	IndexBuffer(const std::string& tag, const std::vector<uint32_t>& indices);
 
 	void Bind() const override;
 	void Unbind() const override;
+	void Record(DrawPacket& packet) const override;
 
 	BufferType GetType() const;
 	UINT GetCount() const;
+	DXGI_FORMAT GetFormat() const;
 	std::string GetID() const override;
 
+private:
+	void Create(const void* data, uint32_t indexSize);
+
 private:
 	static const BufferType Type = BufferType::IndexB;
 	UINT Count;
+	DXGI_FORMAT Format;
+};
+
+// Per instance vertex stream in slot 1, rewritten every frame and grown on demand
+class InstanceBuffer : public Buffer
+{
+public:
+	InstanceBuffer(const std::string& tag, uint32_t stride);
+
+	void Upload(const void* data, uint32_t count);
+	void Bind() const override;
+	// Binds the stream starting at the given instance
+	void BindFrom(uint32_t firstInstance) const;
+	void Unbind() const override;
+	std::string GetID() const override;
+
+private:
+	uint32_t Stride;
+	uint32_t Capacity = 0;
+};
+
+// Structured buffer read by the pixel shaders, rewritten every frame and grown on demand
+class StructuredBuffer : public Buffer
+{
+public:
+	StructuredBuffer(const std::string& tag, uint32_t stride, uint32_t slot);
+
+	void Upload(const void* data, uint32_t count);
+	void Bind() const override;
+	void Unbind() const override;
+	std::string GetID() const override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> View;
+	uint32_t Stride;
+	uint32_t Slot;
+	uint32_t Capacity = 0;
 };
 
 template<typename T>
@@ -323,12 +296,22 @@ public:
 
 	void Bind() const override
 	{
-		CurrentGraphicsContext::Context()->VSSetConstantBuffers(Slot, 1, BufferID.GetAddressOf());
+		StateCache::VSSetConstantBuffer(Slot, BufferID.Get());
+	}
+
+	void BindRange(const ConstantRing::Allocation& allocation) const
+	{
+		StateCache::VSSetConstantBufferRange(Slot, allocation.Buffer, allocation.FirstConstant, allocation.ConstantCount);
 	}
 
 	void Unbind() const override
 	{
-		CurrentGraphicsContext::Context()->VSSetConstantBuffers(Slot, 1, nullptr);
+		StateCache::VSSetConstantBuffer(Slot, nullptr);
+	}
+
+	void Record(DrawPacket& packet) const override
+	{
+		packet.VSConstantBuffers.Set(Slot, BufferID.Get());
 	}
 
 	std::string GetID() const override
@@ -348,12 +331,22 @@ public:
 
 	void Bind() const override
 	{
-		CurrentGraphicsContext::Context()->PSSetConstantBuffers(Slot, 1, BufferID.GetAddressOf());
+		StateCache::PSSetConstantBuffer(Slot, BufferID.Get());
+	}
+
+	void BindRange(const ConstantRing::Allocation& allocation) const
+	{
+		StateCache::PSSetConstantBufferRange(Slot, allocation.Buffer, allocation.FirstConstant, allocation.ConstantCount);
 	}
 
 	void Unbind() const override
 	{
-		CurrentGraphicsContext::Context()->PSSetConstantBuffers(Slot, 1, nullptr);
+		StateCache::PSSetConstantBuffer(Slot, nullptr);
+	}
+
+	void Record(DrawPacket& packet) const override
+	{
+		packet.PSConstantBuffers.Set(Slot, BufferID.Get());
 	}
 
 	std::string GetID() const override
@@ -385,11 +378,22 @@ public:
 		ConstantBufferRef = MakeUnique<T>(std::forward<Args>(args)...);
 		Tag = ConstantBufferRef->Tag;
 		BufferID = ConstantBufferRef->BufferID;
+		std::memcpy(LastUpload.data(), Resource, sizeof(ResourceType));
 	}
 
 	void Bind() const override
 	{
-		Update();
+		if (auto* ring = CurrentGraphicsContext::Constants())
+		{
+			BindFromRing(*ring);
+			return;
+		}
+
+		if (std::memcmp(LastUpload.data(), Resource, sizeof(ResourceType)) != 0)
+			Update();
+		else
+			FrameStatistics::Increment(FrameStatistics::UniformUploadsSkipped);
+
 		ConstantBufferRef->Bind();
 	}
 
@@ -408,17 +412,48 @@ public:
 	inline const ResourceType& GetResourceRef() const { return *Resource; }
 
 private:
+	// Ring ranges are recycled after a few frames, so unchanged data is uploaded once per frame
+	void BindFromRing(ConstantRing& ring) const
+	{
+		if (RingFrame != ring.GetFrame() || std::memcmp(LastUpload.data(), Resource, sizeof(ResourceType)) != 0)
+		{
+			if (!ring.Upload(Resource, sizeof(ResourceType), RingAllocation))
+			{
+				// Ring exhausted, the private buffer may be stale since earlier uploads went to the ring
+				RingFrame = ~0ull;
+				Update();
+				ConstantBufferRef->Bind();
+				return;
+			}
+
+			RingFrame = ring.GetFrame();
+			std::memcpy(LastUpload.data(), Resource, sizeof(ResourceType));
+			FrameStatistics::Increment(FrameStatistics::UniformUploads);
+		}
+		else
+			FrameStatistics::Increment(FrameStatistics::UniformUploadsSkipped);
+
+		ConstantBufferRef->BindRange(RingAllocation);
+	}
+
 	void Update() const
 	{
 		D3D11_MAPPED_SUBRESOURCE subResource;
 		CurrentGraphicsContext::Context()->Map(BufferID.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &subResource);
 		memcpy(subResource.pData, Resource, sizeof(ResourceType));
 		CurrentGraphicsContext::Context()->Unmap(BufferID.Get(), 0);
+
+		std::memcpy(LastUpload.data(), Resource, sizeof(ResourceType));
+		FrameStatistics::Increment(FrameStatistics::UniformUploads);
 	}
 
 private:
 	UniquePtr<T> ConstantBufferRef;
 	ResourceType* Resource;
+	// Contents of the GPU buffer, the upload is skipped while the referenced resource still matches
+	mutable std::array<char, sizeof(ResourceType)> LastUpload{};
+	mutable ConstantRing::Allocation RingAllocation;
+	mutable uint64_t RingFrame = ~0ull;
 };
 
 template<typename T>
@@ -435,6 +470,7 @@ public:
 
 	virtual void Bind() const;
 	virtual void Unbind() const;
+	void Record(DrawPacket& packet) const;
 
 	inline size_t Size() const { return Buffers.size(); }
 private:
@@ -443,10 +479,10 @@ private:
 
 class BufferPool
 {
-	void Add(SharedPtr<BufferBase> buffer);
-	SharedPtr<BufferBase> Get(const std::string& id);
+	SharedPtr<BufferBase> Add(SharedPtr<BufferBase> buffer);
+	SharedPtr<BufferBase> Get(ResourceHandle handle);
 
-	std::unordered_map<std::string, SharedPtr<BufferBase>> Buffers;
+	HandleMap<SharedPtr<BufferBase>> Buffers;
 
 	friend class Pool;
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "CommandList.h"
+
+void CommandList::SetVertexBuffer(void* buffer, uint32_t stride, uint32_t topology)
+{
+	Command& command = Push(Command::Type::SetVertexBuffer);
+	command.Resource = buffer;
+	command.Values[0] = stride;
+	command.Values[1] = topology;
+}
+
+void CommandList::SetIndexBuffer(void* buffer, uint32_t format)
+{
+	Command& command = Push(Command::Type::SetIndexBuffer);
+	command.Resource = buffer;
+	command.Values[0] = format;
+}
+
+void CommandList::SetInputLayout(void* layout)
+{
+	Push(Command::Type::SetInputLayout).Resource = layout;
+}
+
+void CommandList::SetVertexShader(void* shader)
+{
+	Push(Command::Type::SetVertexShader).Resource = shader;
+}
+
+void CommandList::SetPixelShader(void* shader)
+{
+	Push(Command::Type::SetPixelShader).Resource = shader;
+}
+
+void CommandList::VSSetConstantBuffer(uint32_t slot, void* buffer)
+{
+	Command& command = Push(Command::Type::VSSetConstantBuffer);
+	command.Resource = buffer;
+	command.Values[0] = slot;
+}
+
+void CommandList::PSSetConstantBuffer(uint32_t slot, void* buffer)
+{
+	Command& command = Push(Command::Type::PSSetConstantBuffer);
+	command.Resource = buffer;
+	command.Values[0] = slot;
+}
+
+void CommandList::PSSetShaderResource(uint32_t slot, void* view)
+{
+	Command& command = Push(Command::Type::PSSetShaderResource);
+	command.Resource = view;
+	command.Values[0] = slot;
+}
+
+void CommandList::PSSetSampler(uint32_t slot, void* sampler)
+{
+	Command& command = Push(Command::Type::PSSetSampler);
+	command.Resource = sampler;
+	command.Values[0] = slot;
+}
+
+void CommandList::DrawIndexed(uint32_t indexCount, uint32_t firstIndex)
+{
+	Command& command = Push(Command::Type::DrawIndexed);
+	command.Values[0] = indexCount;
+	command.Values[1] = firstIndex;
+}
+
+void CommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount)
+{
+	Command& command = Push(Command::Type::DrawIndexedInstanced);
+	command.Values[0] = indexCount;
+	command.Values[1] = instanceCount;
+}
+
+void CommandList::Callback(CommandCallback function, const void* object, uint32_t argument)
+{
+	Command& command = Push(Command::Type::Callback);
+	command.Object = object;
+	command.Function = function;
+	command.Values[0] = argument;
+}
+
+void CommandList::Reset()
+{
+	Commands.clear();
+}
+
+Command& CommandList::Push(Command::Type type)
+{
+	Command& command = Commands.emplace_back();
+	command.CommandType = type;
+	command.Values[0] = command.Values[1] = command.Values[2] = 0;
+	command.Resource = nullptr;
+	command.Function = nullptr;
+	return command;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Work run on the device thread during playback
+using CommandCallback = void (*)(const void* object, uint32_t argument);
+
+// Compact record of the device work of a pass. Objects are opaque pointers and enums plain integers,
+// so lists are recorded on any thread without a device and played back later by a DeviceBackend.
+struct Command
+{
+	enum class Type : uint32_t
+	{
+		SetVertexBuffer, // Values: stride, topology
+		SetIndexBuffer, // Values: format
+		SetInputLayout,
+		SetVertexShader,
+		SetPixelShader,
+		VSSetConstantBuffer, // Values: slot
+		PSSetConstantBuffer, // Values: slot
+		PSSetShaderResource, // Values: slot
+		PSSetSampler, // Values: slot
+		DrawIndexed, // Values: index count, first index
+		DrawIndexedInstanced, // Values: index count, instance count
+		Callback, // Values: argument
+	};
+
+	Type CommandType;
+	uint32_t Values[3];
+	union
+	{
+		void* Resource;
+		const void* Object;
+	};
+	CommandCallback Function;
+};
+
+static_assert(sizeof(Command) <= 32);
+
+class DeviceBackend;
+
+class CommandList
+{
+public:
+	void SetVertexBuffer(void* buffer, uint32_t stride, uint32_t topology);
+	void SetIndexBuffer(void* buffer, uint32_t format);
+	void SetInputLayout(void* layout);
+	void SetVertexShader(void* shader);
+	void SetPixelShader(void* shader);
+	void VSSetConstantBuffer(uint32_t slot, void* buffer);
+	void PSSetConstantBuffer(uint32_t slot, void* buffer);
+	void PSSetShaderResource(uint32_t slot, void* view);
+	void PSSetSampler(uint32_t slot, void* sampler);
+	void DrawIndexed(uint32_t indexCount, uint32_t firstIndex);
+	void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount);
+	void Callback(CommandCallback function, const void* object, uint32_t argument = 0);
+
+	// Defers object.*Method() to playback
+	template<auto Method, typename T>
+	void Call(const T& object)
+	{
+		Callback([](const void* o, uint32_t) { (static_cast<const T*>(o)->*Method)(); }, &object);
+	}
+
+	template<auto Method, typename T>
+	void Call(const T& object, uint32_t argument)
+	{
+		Callback([](const void* o, uint32_t a) { (static_cast<const T*>(o)->*Method)(a); }, &object, argument);
+	}
+
+	// Keeps the capacity, lists are re-recorded every frame
+	void Reset();
+
+	inline const std::vector<Command>& GetCommands() const { return Commands; }
+	inline size_t Size() const { return Commands.size(); }
+
+private:
+	Command& Push(Command::Type type);
+
+private:
+	std::vector<Command> Commands;
+};
\ No newline at end of file
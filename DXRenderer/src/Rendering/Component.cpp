@@ -1,4 +1,10 @@
 #include "Component.h"
+#include "DrawPacket.h"
+
+void Component::Record(DrawPacket& packet) const
+{
+	packet.AddDynamic(*this);
+}
 
 void ComponentGroup::Bind() const
 {
@@ -6,6 +12,23 @@ void ComponentGroup::Bind() const
 		component->Bind();
 }
 
+ResourceHandle ComponentGroup::GetHandle() const
+{
+	ResourceHandle handle = InvalidResourceHandle;
+	for (const auto& component : Components)
+	{
+		if (const ResourceHandle componentHandle = component->GetHandle(); componentHandle != InvalidResourceHandle)
+			handle = CombineResourceHandles(handle, componentHandle);
+	}
+	return handle;
+}
+
+void ComponentGroup::Record(DrawPacket& packet) const
+{
+	for (const auto& component : Components)
+		component->Record(packet);
+}
+
 void ComponentGroup::Add(UniquePtr<Component> component)
 {
 	Components.emplace_back(std::move(component));
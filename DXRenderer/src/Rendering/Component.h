@@ -1,18 +1,28 @@
 #pragma once
 
 #include "Core\Core.h"
+#include "ResourceHandle.h"
+
+struct DrawPacket;
 
 class Component
 {
 public:
 	virtual void Bind() const {};
 	virtual ~Component() = default;
+
+	// Identity of the bound data for draw sorting, components without one return InvalidResourceHandle
+	virtual ResourceHandle GetHandle() const { return InvalidResourceHandle; }
+	// Bakes the binding into a draw packet, by default it is rebound on every draw
+	virtual void Record(DrawPacket& packet) const;
 };
 
 class ComponentGroup : public Component
 {
 public:
 	void Bind() const override;
+	ResourceHandle GetHandle() const override;
+	void Record(DrawPacket& packet) const override;
 
 	void Add(UniquePtr<Component> component);
 	void Add(ComponentGroup componentGroup);
@@ -0,0 +1,78 @@
+#include "ConstantRing.h"
+#include "CurrentGraphicsContext.h"
+#include "Core/Exception.h"
+
+#include <cstring>
+
+ConstantRing::ConstantRing(uint32_t capacity, uint32_t framesInFlight)
+	:Allocator(capacity), Fences(framesInFlight)
+{
+	D3D11_BUFFER_DESC desc{};
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	desc.ByteWidth = capacity;
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateBuffer(&desc, nullptr, &BufferID));
+
+	D3D11_QUERY_DESC queryDesc{};
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	for (auto& fence : Fences)
+		GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateQuery(&queryDesc, &fence));
+}
+
+bool ConstantRing::Upload(const void* data, uint32_t size, Allocation& allocation)
+{
+	const uint32_t alignedSize = (size + Alignment - 1) & ~(Alignment - 1);
+	const uint32_t offset = Allocator.Allocate(alignedSize, Alignment);
+	if (offset == RingAllocator::InvalidOffset)
+		return false;
+
+	// Ranges handed out earlier may still be read by the GPU, only the very first map may discard
+	const D3D11_MAP mapType = IsFirstMap ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+	IsFirstMap = false;
+
+	D3D11_MAPPED_SUBRESOURCE subResource;
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Context()->Map(BufferID.Get(), 0, mapType, 0, &subResource));
+	std::memcpy(static_cast<char*>(subResource.pData) + offset, data, size);
+	CurrentGraphicsContext::Context()->Unmap(BufferID.Get(), 0);
+
+	allocation.Buffer = BufferID.Get();
+	allocation.FirstConstant = offset / 16;
+	allocation.ConstantCount = alignedSize / 16;
+	return true;
+}
+
+void ConstantRing::NextFrame()
+{
+	const auto& context = CurrentGraphicsContext::Context();
+
+	context->End(Fences[Frame % Fences.size()].Get());
+	Allocator.FinishFrame(Frame);
+	Frame++;
+
+	// Retire whatever finished, block only when every fence is still in flight
+	while (CompletedFrame < Frame)
+	{
+		const bool mustWait = Frame - CompletedFrame >= Fences.size();
+		auto* fence = Fences[CompletedFrame % Fences.size()].Get();
+
+		HRESULT result = context->GetData(fence, nullptr, 0, mustWait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		while (result == S_FALSE && mustWait)
+			result = context->GetData(fence, nullptr, 0, 0);
+
+		if (result != S_OK)
+			break;
+
+		Allocator.Retire(CompletedFrame);
+		CompletedFrame++;
+	}
+}
+
+bool ConstantRing::IsSupported(ID3D11Device* device)
+{
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	if (FAILED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+		return false;
+
+	return options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Core/Core.h"
+#include "RingAllocator.h"
+
+#include <d3d11_1.h>
+#include <vector>
+#include <wrl.h>
+
+// Single dynamic constant buffer shared by all uniforms. Every upload takes a fresh 256 byte
+// aligned range that is bound with *SetConstantBuffers1, frames are fenced with event queries
+// so a range is only reused once the GPU finished the frame that read it.
+class ConstantRing
+{
+public:
+	struct Allocation
+	{
+		ID3D11Buffer* Buffer = nullptr;
+		// In 16 byte shader constants, as *SetConstantBuffers1 expects
+		UINT FirstConstant = 0;
+		UINT ConstantCount = 0;
+	};
+
+	static constexpr uint32_t Alignment = 256;
+
+	ConstantRing(uint32_t capacity = 4u << 20, uint32_t framesInFlight = 3);
+
+	// Returns false when the ring is exhausted for this frame
+	bool Upload(const void* data, uint32_t size, Allocation& allocation);
+	void NextFrame();
+
+	inline uint64_t GetFrame() const { return Frame; }
+
+	// Needs the D3D 11.1 runtime with constant buffer offsetting and no-overwrite maps of constant buffers
+	static bool IsSupported(ID3D11Device* device);
+
+private:
+	RingAllocator Allocator;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> BufferID;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> Fences;
+	uint64_t Frame = 0;
+	uint64_t CompletedFrame = 0;
+	bool IsFirstMap = true;
+};
@@ -0,0 +1,141 @@
+#include "Culling.h"
+#include "Meshlets.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define CULLING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Culling
+{
+	void BoxList::Resize(size_t count)
+	{
+		for (auto* stream : { &CenterX, &CenterY, &CenterZ, &ExtentX, &ExtentY, &ExtentZ })
+			stream->resize(count);
+	}
+
+	void BoxList::Set(size_t index, const Box& box)
+	{
+		CenterX[index] = box.Center.x;
+		CenterY[index] = box.Center.y;
+		CenterZ[index] = box.Center.z;
+		ExtentX[index] = box.Extents.x;
+		ExtentY[index] = box.Extents.y;
+		ExtentZ[index] = box.Extents.z;
+	}
+
+	Frustum ExtractFrustum(const DirectX::XMMATRIX& viewProjection)
+	{
+		DirectX::XMFLOAT4X4 clip;
+		DirectX::XMStoreFloat4x4(&clip, viewProjection);
+
+		Meshlets::CullParameters parameters;
+		Meshlets::ExtractFrustumPlanes(clip.m, parameters);
+
+		Frustum frustum;
+		std::memcpy(frustum.Planes, parameters.Planes, sizeof(frustum.Planes));
+		return frustum;
+	}
+
+	Box TransformBox(const Box& local, const DirectX::XMMATRIX& transform)
+	{
+		using namespace DirectX;
+
+		const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&local.Center), transform);
+		const XMVECTOR extents = XMVectorAbs(transform.r[0]) * local.Extents.x +
+			XMVectorAbs(transform.r[1]) * local.Extents.y +
+			XMVectorAbs(transform.r[2]) * local.Extents.z;
+
+		Box world;
+		XMStoreFloat3(&world.Center, center);
+		XMStoreFloat3(&world.Extents, extents);
+		return world;
+	}
+
+	bool IsVisible(const Box& box, const Frustum& frustum)
+	{
+		for (const float* plane : frustum.Planes)
+		{
+			const float distance = plane[0] * box.Center.x + plane[1] * box.Center.y + plane[2] * box.Center.z + plane[3];
+			const float radius = std::fabs(plane[0]) * box.Extents.x + std::fabs(plane[1]) * box.Extents.y +
+				std::fabs(plane[2]) * box.Extents.z;
+			if (distance + radius < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	bool IntersectsSphere(const Box& box, const DirectX::XMFLOAT3& center, float radius)
+	{
+		const float dx = std::fmax(std::fabs(center.x - box.Center.x) - box.Extents.x, 0.0f);
+		const float dy = std::fmax(std::fabs(center.y - box.Center.y) - box.Extents.y, 0.0f);
+		const float dz = std::fmax(std::fabs(center.z - box.Center.z) - box.Extents.z, 0.0f);
+		return dx * dx + dy * dy + dz * dz <= radius * radius;
+	}
+
+	size_t CullBoxes(const BoxList& boxes, const Frustum& frustum, uint8_t* visible)
+	{
+		const size_t count = boxes.Size();
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+#ifdef CULLING_SSE2
+		// Four boxes per iteration, every plane splatted across the lanes
+		__m128 planes[6][4], absPlanes[6][3];
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		for (int p = 0; p < 6; p++)
+		{
+			for (int c = 0; c < 4; c++)
+				planes[p][c] = _mm_set1_ps(frustum.Planes[p][c]);
+			for (int c = 0; c < 3; c++)
+				absPlanes[p][c] = _mm_andnot_ps(signMask, planes[p][c]);
+		}
+
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(&boxes.CenterX[i]);
+			const __m128 y = _mm_loadu_ps(&boxes.CenterY[i]);
+			const __m128 z = _mm_loadu_ps(&boxes.CenterZ[i]);
+			const __m128 ex = _mm_loadu_ps(&boxes.ExtentX[i]);
+			const __m128 ey = _mm_loadu_ps(&boxes.ExtentY[i]);
+			const __m128 ez = _mm_loadu_ps(&boxes.ExtentZ[i]);
+
+			__m128 outside = zero;
+			for (int p = 0; p < 6; p++)
+			{
+				__m128 distance = _mm_add_ps(_mm_mul_ps(planes[p][0], x), planes[p][3]);
+				distance = _mm_add_ps(distance, _mm_mul_ps(planes[p][1], y));
+				distance = _mm_add_ps(distance, _mm_mul_ps(planes[p][2], z));
+
+				__m128 radius = _mm_mul_ps(absPlanes[p][0], ex);
+				radius = _mm_add_ps(radius, _mm_mul_ps(absPlanes[p][1], ey));
+				radius = _mm_add_ps(radius, _mm_mul_ps(absPlanes[p][2], ez));
+
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+			}
+
+			const int mask = ~_mm_movemask_ps(outside);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				visible[i + lane] = (mask >> lane) & 1;
+				visibleCount += visible[i + lane];
+			}
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			Box box;
+			box.Center = { boxes.CenterX[i], boxes.CenterY[i], boxes.CenterZ[i] };
+			box.Extents = { boxes.ExtentX[i], boxes.ExtentY[i], boxes.ExtentZ[i] };
+			visible[i] = IsVisible(box, frustum);
+			visibleCount += visible[i];
+		}
+
+		return visibleCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Batched visibility tests of world space bounds against the camera frustum
+namespace Culling
+{
+	struct Box
+	{
+		DirectX::XMFLOAT3 Center{};
+		DirectX::XMFLOAT3 Extents{};
+	};
+
+	// Structure of arrays, so consecutive boxes fill SIMD lanes
+	struct BoxList
+	{
+		std::vector<float> CenterX, CenterY, CenterZ;
+		std::vector<float> ExtentX, ExtentY, ExtentZ;
+
+		void Resize(size_t count);
+		void Set(size_t index, const Box& box);
+		size_t Size() const { return CenterX.size(); }
+	};
+
+	struct Frustum
+	{
+		// Planes as (a, b, c, d) with inside where a*x + b*y + c*z + d >= 0
+		float Planes[6][4]{};
+	};
+
+	// Frustum of a row-vector (v * M) view projection with D3D depth range
+	Frustum ExtractFrustum(const DirectX::XMMATRIX& viewProjection);
+
+	// Box enclosing local after the affine transform
+	Box TransformBox(const Box& local, const DirectX::XMMATRIX& transform);
+
+	bool IsVisible(const Box& box, const Frustum& frustum);
+	bool IntersectsSphere(const Box& box, const DirectX::XMFLOAT3& center, float radius);
+
+	// Writes 1 to visible[i] for boxes intersecting the frustum, 0 otherwise. Returns the number of visible boxes.
+	size_t CullBoxes(const BoxList& boxes, const Frustum& frustum, uint8_t* visible);
+}
\ No newline at end of file
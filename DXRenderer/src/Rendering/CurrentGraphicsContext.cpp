@@ -14,3 +14,15 @@ const Microsoft::WRL::ComPtr<ID3D11DeviceContext>& CurrentGraphicsContext::Conte
 	const auto& context = GraphicsInfo->GetContext();
 	return context;
 }
+
+
+const Microsoft::WRL::ComPtr<ID3D11DeviceContext1>& CurrentGraphicsContext::Context1()
+{
+	const auto& context = GraphicsInfo->GetContext1();
+	return context;
+}
+
+ConstantRing* CurrentGraphicsContext::Constants()
+{
+	return GraphicsInfo->GetConstants();
+}
\ No newline at end of file
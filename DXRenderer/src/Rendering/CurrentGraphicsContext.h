@@ -1,14 +1,19 @@
 #pragma once
 
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <wrl.h>
 
+class ConstantRing;
 class Graphics;
 
 struct CurrentGraphicsContext
 {
 	static const Microsoft::WRL::ComPtr<ID3D11Device>& Device();
 	static const Microsoft::WRL::ComPtr<ID3D11DeviceContext>& Context();
+	static const Microsoft::WRL::ComPtr<ID3D11DeviceContext1>& Context1();
+	// Null when the runtime cannot bind constant buffer ranges
+	static ConstantRing* Constants();
 
 	static Graphics* GraphicsInfo;
 };
@@ -1,4 +1,5 @@
 #include "DepthCube.h"
+#include "StateCache.h"
 
 CubeTextureDepth::CubeTextureDepth(uint32_t size, uint32_t slot)
 	:Slot(slot)
@@ -16,31 +17,38 @@ CubeTextureDepth::CubeTextureDepth(uint32_t size, uint32_t slot)
 	textureDesc.CPUAccessFlags = 0;
 	textureDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
 
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
-	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateTexture2D(&textureDesc, nullptr, &texture));
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateTexture2D(&textureDesc, nullptr, &Texture));
 
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
 	srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
 	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.MipLevels = 1;
-	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateShaderResourceView(texture.Get(), &srvDesc, &TextureView));
+	GRAPHICS_ASSERT(CurrentGraphicsContext::Device()->CreateShaderResourceView(Texture.Get(), &srvDesc, &TextureView));
 
 	for (uint32_t face = 0; face < 6; face++)
-		DepthBuffers.emplace_back(MakeShared<DepthStencilOutput>(texture, face));
+		DepthBuffers.emplace_back(MakeShared<DepthStencilOutput>(Texture, face));
 }
 
 void CubeTextureDepth::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShaderResources(Slot, 1, TextureView.GetAddressOf());
+	StateCache::PSSetShaderResource(Slot, TextureView.Get());
 }
 
 void CubeTextureDepth::Unbind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShaderResources(Slot, 1, nullptr);
+	StateCache::PSSetShaderResource(Slot, nullptr);
 }
 
 SharedPtr<DepthStencilOutput> CubeTextureDepth::operator[](size_t i)
 {
 	return DepthBuffers[i];
 }
+
+void CubeTextureDepth::CopyFace(const CubeTextureDepth& source, uint32_t face) const
+{
+	// Depth resources can only be copied whole, so no source box
+	const UINT subresource = D3D11CalcSubresource(0, face, 1);
+	CurrentGraphicsContext::Context()->CopySubresourceRegion(Texture.Get(), subresource, 0, 0, 0,
+															 source.Texture.Get(), subresource, nullptr);
+}
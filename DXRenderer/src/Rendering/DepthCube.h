@@ -14,8 +14,11 @@ public:
 	void Unbind() const override;
 	std::string GetID() const override { return "GlobalShadowMap"; }
 	SharedPtr<DepthStencilOutput> operator[](size_t i);
+	// Whole face copy, both cubes must have the same size
+	void CopyFace(const CubeTextureDepth& source, uint32_t face) const;
 
 protected:
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> Texture;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureView;
 	std::vector < SharedPtr<class DepthStencilOutput>> DepthBuffers;
 
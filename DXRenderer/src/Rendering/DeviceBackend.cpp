@@ -0,0 +1,60 @@
+#include "DeviceBackend.h"
+#include "CurrentGraphicsContext.h"
+#include "FrameStatistics.h"
+#include "StateCache.h"
+
+void D3D11Backend::BeginFrame()
+{
+	// ImGui and the previous frame leave the pipeline in an unknown state
+	StateCache::Invalidate();
+}
+
+void D3D11Backend::Submit(const CommandList& list)
+{
+	for (const Command& command : list.GetCommands())
+	{
+		switch (command.CommandType)
+		{
+		case Command::Type::SetVertexBuffer:
+			StateCache::SetVertexBuffer(0, static_cast<ID3D11Buffer*>(command.Resource), command.Values[0], 0);
+			StateCache::SetPrimitiveTopology(static_cast<D3D11_PRIMITIVE_TOPOLOGY>(command.Values[1]));
+			break;
+		case Command::Type::SetIndexBuffer:
+			StateCache::SetIndexBuffer(static_cast<ID3D11Buffer*>(command.Resource), static_cast<DXGI_FORMAT>(command.Values[0]), 0);
+			break;
+		case Command::Type::SetInputLayout:
+			StateCache::SetInputLayout(static_cast<ID3D11InputLayout*>(command.Resource));
+			break;
+		case Command::Type::SetVertexShader:
+			StateCache::VSSetShader(static_cast<ID3D11VertexShader*>(command.Resource));
+			break;
+		case Command::Type::SetPixelShader:
+			StateCache::PSSetShader(static_cast<ID3D11PixelShader*>(command.Resource));
+			break;
+		case Command::Type::VSSetConstantBuffer:
+			StateCache::VSSetConstantBuffer(command.Values[0], static_cast<ID3D11Buffer*>(command.Resource));
+			break;
+		case Command::Type::PSSetConstantBuffer:
+			StateCache::PSSetConstantBuffer(command.Values[0], static_cast<ID3D11Buffer*>(command.Resource));
+			break;
+		case Command::Type::PSSetShaderResource:
+			StateCache::PSSetShaderResource(command.Values[0], static_cast<ID3D11ShaderResourceView*>(command.Resource));
+			break;
+		case Command::Type::PSSetSampler:
+			StateCache::PSSetSampler(command.Values[0], static_cast<ID3D11SamplerState*>(command.Resource));
+			break;
+		case Command::Type::DrawIndexed:
+			CurrentGraphicsContext::Context()->DrawIndexed(command.Values[0], command.Values[1], 0);
+			FrameStatistics::Increment(FrameStatistics::DrawCalls);
+			break;
+		case Command::Type::DrawIndexedInstanced:
+			CurrentGraphicsContext::Context()->DrawIndexedInstanced(command.Values[0], command.Values[1], 0, 0, 0);
+			FrameStatistics::Increment(FrameStatistics::DrawCalls);
+			FrameStatistics::Increment(FrameStatistics::DrawsMerged, command.Values[1] - 1);
+			break;
+		case Command::Type::Callback:
+			command.Function(command.Object, command.Values[0]);
+			break;
+		}
+	}
+}
\ No newline at end of file
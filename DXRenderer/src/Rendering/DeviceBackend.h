@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CommandList.h"
+#include "StateTracker.h"
+
+#include <cstddef>
+
+// Plays back recorded command lists, always on the thread that owns the device
+class DeviceBackend
+{
+public:
+	virtual ~DeviceBackend() = default;
+
+	// Called once per frame before the first list
+	virtual void BeginFrame() {}
+	virtual void Submit(const CommandList& list) = 0;
+};
+
+// Replays lists on the immediate context through the StateCache
+class D3D11Backend : public DeviceBackend
+{
+public:
+	void BeginFrame() override;
+	void Submit(const CommandList& list) override;
+};
+
+// Counts what would have been sent to a device. Bindings go through a StateTracker the way D3D11Backend
+// sends them through the StateCache, so filtering is measured without a device. Callbacks touch the
+// device and are skipped.
+class NullBackend : public DeviceBackend
+{
+public:
+	void BeginFrame() override;
+	void Submit(const CommandList& list) override;
+
+	inline const StateTracker& GetStateTracker() const { return Tracker; }
+
+	inline size_t GetCommandCount() const { return Commands; }
+	inline size_t GetDrawCount() const { return Draws; }
+	inline size_t GetIndexCount() const { return Indices; }
+	inline size_t GetSkippedCallbackCount() const { return SkippedCallbacks; }
+
+private:
+	StateTracker Tracker;
+	size_t Commands = 0;
+	size_t Draws = 0;
+	size_t Indices = 0;
+	size_t SkippedCallbacks = 0;
+};
\ No newline at end of file
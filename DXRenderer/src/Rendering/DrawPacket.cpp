@@ -0,0 +1,186 @@
+#include "DrawPacket.h"
+
+#include <cstring>
+
+namespace
+{
+	template<typename T, uint32_t N>
+	bool SameBindings(const DrawPacket::SlotList<T, N>& a, const DrawPacket::SlotList<T, N>& b)
+	{
+		if (a.Count != b.Count)
+			return false;
+
+		for (uint32_t i = 0; i < a.Count; i++)
+			if (a.Bindings[i].Slot != b.Bindings[i].Slot || a.Bindings[i].Resource != b.Bindings[i].Resource)
+				return false;
+
+		return true;
+	}
+}
+
+void DrawPacket::SetVertexBuffer(ID3D11Buffer* buffer, uint32_t stride, D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	Flags |= HasVertexBuffer;
+	VertexBuffer = buffer;
+	VertexStride = stride;
+	Topology = topology;
+}
+
+void DrawPacket::SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, uint32_t indexCount)
+{
+	Flags |= HasIndexBuffer;
+	IndexBuffer = buffer;
+	IndexFormat = format;
+	IndexCount = indexCount;
+}
+
+void DrawPacket::SetInputLayout(ID3D11InputLayout* layout)
+{
+	Flags |= HasInputLayout;
+	InputLayout = layout;
+}
+
+void DrawPacket::SetVertexShader(ID3D11VertexShader* shader)
+{
+	Flags |= HasVertexShader;
+	VertexShader = shader;
+}
+
+void DrawPacket::SetPixelShader(ID3D11PixelShader* shader)
+{
+	Flags |= HasPixelShader;
+	PixelShader = shader;
+}
+
+void DrawPacket::Record(CommandList& list) const
+{
+	RecordState(list, false);
+
+	ASSERT(Flags & HasIndexBuffer);
+	if (!Ranges)
+	{
+		list.DrawIndexed(IndexCount, 0);
+		return;
+	}
+
+	for (const auto& range : *Ranges)
+		list.DrawIndexed(range.IndexCount, range.IndexOffset);
+}
+
+bool DrawPacket::CanInstanceWith(const DrawPacket& other) const
+{
+	if (!IsInstanceable() || !other.IsInstanceable() || Ranges || other.Ranges)
+		return false;
+
+	if (Flags != other.Flags || VertexBuffer != other.VertexBuffer || VertexStride != other.VertexStride ||
+		Topology != other.Topology || IndexBuffer != other.IndexBuffer || IndexFormat != other.IndexFormat ||
+		IndexCount != other.IndexCount || PixelShader != other.PixelShader ||
+		InstancedVertexShader != other.InstancedVertexShader || InstancedInputLayout != other.InstancedInputLayout ||
+		InstanceMatrixCount != other.InstanceMatrixCount || PerInstanceMask != other.PerInstanceMask)
+		return false;
+
+	if (!SameBindings(VSConstantBuffers, other.VSConstantBuffers) || !SameBindings(PSConstantBuffers, other.PSConstantBuffers) ||
+		!SameBindings(PSShaderResources, other.PSShaderResources) || !SameBindings(PSSamplers, other.PSSamplers))
+		return false;
+
+	if (DynamicCount != other.DynamicCount)
+		return false;
+
+	for (uint32_t i = 0; i < DynamicCount; i++)
+	{
+		if (Dynamic[i].Bind != other.Dynamic[i].Bind)
+			return false;
+
+		const bool sameData = Dynamic[i].Object == other.Dynamic[i].Object ||
+			(Dynamic[i].Handle != InvalidResourceHandle && Dynamic[i].Handle == other.Dynamic[i].Handle);
+		if (!(PerInstanceMask & (1u << i)) && !sameData)
+			return false;
+	}
+
+	return true;
+}
+
+void DrawPacket::RecordInstanced(CommandList& list, uint32_t instanceCount) const
+{
+	ASSERT(IsInstanceable() && !Ranges);
+	RecordState(list, true);
+	list.DrawIndexedInstanced(IndexCount, instanceCount);
+}
+
+void DrawPacket::WriteInstance(char* destination) const
+{
+	for (uint32_t i = 0; i < InstanceMatrixCount; i++)
+		std::memcpy(destination + i * 64, InstanceMatrices[i], 64);
+}
+
+void BuildDrawRuns(const std::vector<DrawPacket>& packets, const std::vector<uint32_t>& views, uint32_t maxInstances,
+				   std::vector<DrawRun>& runs, std::vector<char>& instanceData)
+{
+	ASSERT(packets.size() == views.size() && maxInstances > 0);
+	runs.clear();
+	instanceData.clear();
+
+	for (uint32_t first = 0; first < packets.size();)
+	{
+		if (views[first] == 0)
+		{
+			first++;
+			continue;
+		}
+
+		uint32_t count = 1;
+		while (count < maxInstances && first + count < packets.size() && views[first + count] == views[first] &&
+			   packets[first].CanInstanceWith(packets[first + count]))
+			count++;
+
+		DrawRun run{ first, count, 0, views[first] };
+		if (count > 1)
+		{
+			run.FirstInstance = static_cast<uint32_t>(instanceData.size() / DrawPacket::InstanceStride);
+			instanceData.resize(instanceData.size() + count * DrawPacket::InstanceStride);
+			for (uint32_t i = 0; i < count; i++)
+				packets[first + i].WriteInstance(instanceData.data() + (run.FirstInstance + i) * DrawPacket::InstanceStride);
+		}
+
+		runs.push_back(run);
+		first += count;
+	}
+}
+
+void DrawPacket::RecordState(CommandList& list, bool instanced) const
+{
+	if (Flags & HasVertexBuffer)
+		list.SetVertexBuffer(VertexBuffer, VertexStride, Topology);
+	if (Flags & HasIndexBuffer)
+		list.SetIndexBuffer(IndexBuffer, IndexFormat);
+	if (instanced)
+	{
+		list.SetInputLayout(InstancedInputLayout);
+		list.SetVertexShader(InstancedVertexShader);
+	}
+	else
+	{
+		if (Flags & HasInputLayout)
+			list.SetInputLayout(InputLayout);
+		if (Flags & HasVertexShader)
+			list.SetVertexShader(VertexShader);
+	}
+	if (Flags & HasPixelShader)
+		list.SetPixelShader(PixelShader);
+
+	for (uint32_t i = 0; i < VSConstantBuffers.Count; i++)
+		list.VSSetConstantBuffer(VSConstantBuffers.Bindings[i].Slot, VSConstantBuffers.Bindings[i].Resource);
+	for (uint32_t i = 0; i < PSConstantBuffers.Count; i++)
+		list.PSSetConstantBuffer(PSConstantBuffers.Bindings[i].Slot, PSConstantBuffers.Bindings[i].Resource);
+	for (uint32_t i = 0; i < PSShaderResources.Count; i++)
+		list.PSSetShaderResource(PSShaderResources.Bindings[i].Slot, PSShaderResources.Bindings[i].Resource);
+	for (uint32_t i = 0; i < PSSamplers.Count; i++)
+		list.PSSetSampler(PSSamplers.Bindings[i].Slot, PSSamplers.Bindings[i].Resource);
+
+	for (uint32_t i = 0; i < DynamicCount; i++)
+	{
+		if (instanced && (PerInstanceMask & (1u << i)))
+			continue;
+		list.Callback(Dynamic[i].Bind, Dynamic[i].Object);
+	}
+}
\ No newline at end of file
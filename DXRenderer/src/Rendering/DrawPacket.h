@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Core\Core.h"
+#include "CommandList.h"
+#include "Meshlets.h"
+#include "ResourceHandle.h"
+
+#include <array>
+#include <cstdint>
+#include <d3d11.h>
+#include <type_traits>
+#include <vector>
+
+// Flat record of everything a Task binds, baked once when the owning Step is linked.
+// Immutable bindings are stored as raw handles and recorded as commands, bindables whose data
+// changes every frame (uniforms, pipeline states) are kept as bind callbacks and run after the
+// baked state.
+struct DrawPacket
+{
+	static constexpr uint32_t MaxConstantBuffers = 4;
+	static constexpr uint32_t MaxShaderResources = 4;
+	static constexpr uint32_t MaxSamplers = 4;
+	static constexpr uint32_t MaxDynamicBinds = 12;
+	static constexpr uint32_t MaxInstanceMatrices = 2;
+	static constexpr uint32_t InstanceStride = MaxInstanceMatrices * 64;
+	// Longest instanced draw, longer runs of equal packets are split
+	static constexpr uint32_t MaxInstancesPerDraw = 1024;
+
+	enum Flag : uint32_t
+	{
+		HasVertexBuffer = 1 << 0,
+		HasIndexBuffer = 1 << 1,
+		HasInputLayout = 1 << 2,
+		HasVertexShader = 1 << 3,
+		HasPixelShader = 1 << 4,
+	};
+
+	template<typename T>
+	struct SlotBinding
+	{
+		uint32_t Slot;
+		T* Resource;
+	};
+
+	template<typename T, uint32_t N>
+	struct SlotList
+	{
+		void Set(uint32_t slot, T* resource);
+
+		std::array<SlotBinding<T>, N> Bindings{};
+		uint32_t Count = 0;
+	};
+
+	struct DynamicBind
+	{
+		CommandCallback Bind;
+		const void* Object;
+		// Identity of the bound data, equal handles bind equal data
+		ResourceHandle Handle;
+	};
+
+	void SetVertexBuffer(ID3D11Buffer* buffer, uint32_t stride, D3D11_PRIMITIVE_TOPOLOGY topology);
+	void SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, uint32_t indexCount);
+	void SetInputLayout(ID3D11InputLayout* layout);
+	void SetVertexShader(ID3D11VertexShader* shader);
+	void SetPixelShader(ID3D11PixelShader* shader);
+
+	// Anything with a const Bind(), called on every execution
+	template<typename T>
+	void AddDynamic(const T& bindable)
+	{
+		ASSERT(DynamicCount < MaxDynamicBinds);
+		Dynamic[DynamicCount++] = { [](const void* object, uint32_t) { static_cast<const T*>(object)->Bind(); }, &bindable,
+									bindable.GetHandle() };
+	}
+
+	void Record(CommandList& list) const;
+
+	inline bool IsInstanceable() const { return InstancedVertexShader != nullptr; }
+	// Whether both draws only differ by their per instance matrices
+	bool CanInstanceWith(const DrawPacket& other) const;
+	// Draws instanceCount objects, the instance stream has to be bound already
+	void RecordInstanced(CommandList& list, uint32_t instanceCount) const;
+	// Writes this object's per instance matrices, InstanceStride bytes
+	void WriteInstance(char* destination) const;
+
+	uint32_t Flags = 0;
+
+	ID3D11Buffer* VertexBuffer = nullptr;
+	uint32_t VertexStride = 0;
+	D3D11_PRIMITIVE_TOPOLOGY Topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+
+	ID3D11Buffer* IndexBuffer = nullptr;
+	DXGI_FORMAT IndexFormat = DXGI_FORMAT_UNKNOWN;
+	uint32_t IndexCount = 0;
+
+	ID3D11InputLayout* InputLayout = nullptr;
+	ID3D11VertexShader* VertexShader = nullptr;
+	ID3D11PixelShader* PixelShader = nullptr;
+
+	SlotList<ID3D11Buffer, MaxConstantBuffers> VSConstantBuffers{};
+	SlotList<ID3D11Buffer, MaxConstantBuffers> PSConstantBuffers{};
+	SlotList<ID3D11ShaderResourceView, MaxShaderResources> PSShaderResources{};
+	SlotList<ID3D11SamplerState, MaxSamplers> PSSamplers{};
+
+	std::array<DynamicBind, MaxDynamicBinds> Dynamic{};
+	uint32_t DynamicCount = 0;
+
+	// Visible parts of the index buffer, owned by the render object. Null draws all IndexCount indices.
+	const std::vector<Meshlets::DrawRange>* Ranges = nullptr;
+
+	// Instanced variant, set by steps that provide one. Dynamic binds in PerInstanceMask upload per object
+	// matrices, instanced draws skip them and read InstanceMatrices from the instance stream instead.
+	ID3D11VertexShader* InstancedVertexShader = nullptr;
+	ID3D11InputLayout* InstancedInputLayout = nullptr;
+	std::array<const void*, MaxInstanceMatrices> InstanceMatrices{};
+	uint32_t InstanceMatrixCount = 0;
+	uint32_t PerInstanceMask = 0;
+
+private:
+	void RecordState(CommandList& list, bool instanced) const;
+};
+
+static_assert(std::is_trivially_copyable_v<DrawPacket>);
+
+// Consecutive packets drawn with one call, instanced when Count > 1
+struct DrawRun
+{
+	uint32_t First;
+	uint32_t Count;
+	uint32_t FirstInstance;
+	uint32_t Views;
+};
+
+// Merges neighbouring packets that only differ by their per instance matrices and are drawn into the same
+// views, at most maxInstances per run. Packets without any view are dropped. The matrices of instanced runs
+// are written to instanceData, InstanceStride bytes per instance.
+void BuildDrawRuns(const std::vector<DrawPacket>& packets, const std::vector<uint32_t>& views, uint32_t maxInstances,
+				   std::vector<DrawRun>& runs, std::vector<char>& instanceData);
+
+template<typename T, uint32_t N>
+void DrawPacket::SlotList<T, N>::Set(uint32_t slot, T* resource)
+{
+	for (uint32_t i = 0; i < Count; i++)
+	{
+		if (Bindings[i].Slot == slot)
+		{
+			Bindings[i].Resource = resource;
+			return;
+		}
+	}
+
+	ASSERT(Count < N);
+	Bindings[Count++] = { slot, resource };
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "FrameStatistics.h"
+
+#include <imgui.h>
+
+FrameStatistics& FrameStatistics::Get()
+{
+	static FrameStatistics singleton;
+	return singleton;
+}
+
+void FrameStatistics::EndFrame()
+{
+	Get().EndFrameImpl();
+}
+
+void FrameStatistics::GUI()
+{
+	Get().GUIImpl();
+}
+
+void FrameStatistics::EndFrameImpl()
+{
+	Last = Current;
+	Current.fill(0);
+}
+
+void FrameStatistics::GUIImpl()
+{
+	if (ImGui::Begin("Frame Statistics"))
+	{
+		const size_t uploads = Last[UniformUploads];
+		const size_t skipped = Last[UniformUploadsSkipped];
+		const size_t binds = uploads + skipped;
+
+		ImGui::Text("Uniform binds %zu", binds);
+		ImGui::Text("Uniform uploads %zu, skipped %zu (%.1f%%)", uploads, skipped, binds ? 100.0f * skipped / binds : 0.0f);
+
+		const size_t issued = Last[StateCallsIssued];
+		const size_t filtered = Last[StateCallsFiltered];
+		const size_t calls = issued + filtered;
+
+		ImGui::Text("State calls issued %zu, filtered %zu (%.1f%%)", issued, filtered, calls ? 100.0f * filtered / calls : 0.0f);
+
+		ImGui::Text("Draw calls %zu, %zu saved by instancing", Last[DrawCalls], Last[DrawsMerged]);
+	}
+	ImGui::End();
+}
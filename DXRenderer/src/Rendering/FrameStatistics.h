@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+// Per frame renderer counters. Counting happens during the frame, the GUI shows the last completed frame.
+class FrameStatistics
+{
+public:
+	enum Counter : size_t
+	{
+		UniformUploads,
+		UniformUploadsSkipped,
+		StateCallsIssued,
+		StateCallsFiltered,
+		DrawCalls,
+		// Draw calls saved by merging objects into instanced draws
+		DrawsMerged,
+		CounterCount
+	};
+
+	static FrameStatistics& Get();
+
+	static void Increment(Counter counter, size_t amount = 1) { Get().Current[counter] += amount; }
+	static size_t GetLastFrame(Counter counter) { return Get().Last[counter]; }
+
+	static void EndFrame();
+	static void GUI();
+
+private:
+	FrameStatistics() = default;
+	~FrameStatistics() = default;
+
+	void EndFrameImpl();
+	void GUIImpl();
+
+private:
+	std::array<size_t, CounterCount> Current{};
+	std::array<size_t, CounterCount> Last{};
+};
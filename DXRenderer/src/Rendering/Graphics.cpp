@@ -64,6 +64,9 @@ Graphics::Graphics(HWND windowHandle, uint32_t width, uint32_t height)
 	viewport.TopLeftX = 0.0f;
 	viewport.TopLeftY = 0.0f;
 	Context->RSSetViewports(1u, &viewport);
+
+	if (SUCCEEDED(Context.As(&Context1)) && ConstantRing::IsSupported(Device.Get()))
+		Constants = MakeUnique<ConstantRing>();
 }
 
 void Graphics::Tick(float delta)
@@ -89,6 +92,9 @@ void Graphics::Tick(float delta)
 			GRAPHICS_EXCEPTION(result);
 		}
 	}
+
+	if (Constants)
+		Constants->NextFrame();
 	ClearColor();
 }
 
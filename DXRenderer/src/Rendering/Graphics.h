@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Camera.h"
+#include "ConstantRing.h"
 #include "Core/Core.h"
 #include "Core/Exception.h"
 #include "RenderTarget.h"
@@ -22,6 +23,8 @@ public:
 	
 	const Microsoft::WRL::ComPtr<ID3D11DeviceContext>& GetContext() const;
 	const Microsoft::WRL::ComPtr<ID3D11Device>& GetDevice() const;
+	const Microsoft::WRL::ComPtr<ID3D11DeviceContext1>& GetContext1() const { return Context1; }
+	inline ConstantRing* GetConstants() { return Constants.get(); }
 
 	void SetCamera(Camera& camera);
 	inline uint32_t GetWidth() const { return Width; }
@@ -39,7 +42,9 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11Device>        Device;
 	Microsoft::WRL::ComPtr<IDXGISwapChain>      SwapChain;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> Context;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> Context1;
 	SharedPtr<RenderTarget> RTarget;
+	UniquePtr<ConstantRing> Constants;
 
 	#ifndef NDEBUG
 	DXGIInfoManager InfoManager;
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ResourceHandle.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Open addressing map keyed by ResourceHandle with linear probing. Handles are already well
+// mixed hashes, so the low bits index the table directly. Entries are never erased.
+template<typename T>
+class HandleMap
+{
+public:
+	T* Find(ResourceHandle handle)
+	{
+		if (Keys.empty())
+			return nullptr;
+
+		for (size_t i = handle & Mask;; i = (i + 1) & Mask)
+		{
+			if (Keys[i] == handle)
+				return &Values[i];
+			if (Keys[i] == InvalidResourceHandle)
+				return nullptr;
+		}
+	}
+
+	// Returns the stored value and whether it was inserted by this call
+	std::pair<T&, bool> Insert(ResourceHandle handle, T value)
+	{
+		if ((Count + 1) * 2 > Keys.size())
+			Grow();
+
+		size_t i = handle & Mask;
+		for (; Keys[i] != InvalidResourceHandle; i = (i + 1) & Mask)
+		{
+			if (Keys[i] == handle)
+				return { Values[i], false };
+		}
+
+		Keys[i] = handle;
+		Values[i] = std::move(value);
+		Count++;
+		return { Values[i], true };
+	}
+
+	inline size_t Size() const { return Count; }
+
+private:
+	void Grow()
+	{
+		std::vector<ResourceHandle> keys(std::max<size_t>(Keys.size() * 2, 64), InvalidResourceHandle);
+		std::vector<T> values(keys.size());
+		Mask = keys.size() - 1;
+
+		for (size_t j = 0; j < Keys.size(); j++)
+		{
+			if (Keys[j] == InvalidResourceHandle)
+				continue;
+
+			size_t i = Keys[j] & Mask;
+			while (keys[i] != InvalidResourceHandle)
+				i = (i + 1) & Mask;
+
+			keys[i] = Keys[j];
+			values[i] = std::move(Values[j]);
+		}
+
+		Keys = std::move(keys);
+		Values = std::move(values);
+	}
+
+private:
+	std::vector<ResourceHandle> Keys;
+	std::vector<T> Values;
+	size_t Mask = 0;
+	size_t Count = 0;
+};
@@ -0,0 +1,104 @@
+#include "Interleave.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define INTERLEAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr size_t BlockSize = 256;
+
+	using CopyKernel = void(*)(char* destination, uint32_t stride, const char* source, uint32_t sourceStride, uint32_t size, size_t count);
+
+	void CopyScalar(char* destination, uint32_t stride, const char* source, uint32_t sourceStride, uint32_t size, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			std::memcpy(destination + i * stride, source + i * sourceStride, size);
+	}
+
+	void Copy4(char* destination, uint32_t stride, const char* source, uint32_t sourceStride, uint32_t, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			std::memcpy(destination + i * stride, source + i * sourceStride, 4);
+	}
+
+#ifdef INTERLEAVE_SSE2
+	void Copy8(char* destination, uint32_t stride, const char* source, uint32_t sourceStride, uint32_t, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			__m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i * sourceStride));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i * stride), value);
+		}
+	}
+
+	void Copy12(char* destination, uint32_t stride, const char* source, uint32_t sourceStride, uint32_t, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const char* src = source + i * sourceStride;
+			char* dst = destination + i * stride;
+			__m128i xy = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), xy);
+			std::memcpy(dst + 8, src + 8, 4);
+		}
+	}
+
+	void Copy16(char* destination, uint32_t stride, const char* source, uint32_t sourceStride, uint32_t, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * sourceStride));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * stride), value);
+		}
+	}
+#endif
+
+	CopyKernel SelectKernel(uint32_t size)
+	{
+		if (size == 4)
+			return Copy4;
+
+#ifdef INTERLEAVE_SSE2
+		switch (size)
+		{
+		case 8: return Copy8;
+		case 12: return Copy12;
+		case 16: return Copy16;
+		default: break;
+		}
+#endif
+		return CopyScalar;
+	}
+}
+
+void InterleaveStreams(char* destination, uint32_t stride,
+					   const VertexStream* streams, const VertexStreamTarget* targets, size_t streamCount,
+					   size_t count)
+{
+	constexpr size_t MaxStreams = 16;
+	CopyKernel kernels[MaxStreams];
+	for (size_t s = 0; s < streamCount && s < MaxStreams; s++)
+		kernels[s] = SelectKernel(targets[s].Size);
+
+	for (size_t first = 0; first < count; first += BlockSize)
+	{
+		size_t blockCount = count - first < BlockSize ? count - first : BlockSize;
+		char* block = destination + first * stride;
+
+		for (size_t s = 0; s < streamCount; s++)
+		{
+			const auto& stream = streams[s];
+			const auto& target = targets[s];
+			if (!stream.Data)
+				continue;
+
+			const char* source = static_cast<const char*>(stream.Data) + first * stream.SourceStride;
+			CopyKernel kernel = s < MaxStreams ? kernels[s] : SelectKernel(target.Size);
+			kernel(block + target.Offset, stride, source, stream.SourceStride, target.Size, blockCount);
+		}
+	}
+}
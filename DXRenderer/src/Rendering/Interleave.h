@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Source attribute stream in structure-of-arrays form (e.g. aiMesh::mVertices).
+// SourceStride is the distance between consecutive elements in the source, which can be
+// larger than the destination element (aiVector3D texture coordinates feeding a float2).
+struct VertexStream
+{
+	const void* Data = nullptr;
+	uint32_t SourceStride = 0;
+};
+
+// Destination of a stream inside an interleaved vertex.
+struct VertexStreamTarget
+{
+	uint32_t Offset = 0;
+	uint32_t Size = 0;
+};
+
+// Writes count vertices of the given stride into destination, copying streams[i] to targets[i].
+// Work is done in blocks so the destination block stays cache resident while every stream
+// is walked sequentially, and the copy kernel for each stream is selected once per call.
+void InterleaveStreams(char* destination, uint32_t stride,
+					   const VertexStream* streams, const VertexStreamTarget* targets, size_t streamCount,
+					   size_t count);
@@ -0,0 +1,20 @@
+#include "Attenuation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Attenuation
+{
+	float GetRange(float intensity, float constant, float linear, float quad, float cutoff)
+	{
+		// Solves intensity / (constant + linear * d + quad * d^2) = cutoff
+		const float c = constant - intensity / cutoff;
+		if (quad > 0.0f)
+			return (-linear + std::sqrt(linear * linear - 4.0f * quad * c)) / (2.0f * quad);
+		if (linear > 0.0f)
+			return std::max(-c / linear, 0.0f);
+
+		return std::numeric_limits<float>::infinity();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+// Point light falloff, intensity / (constant + linear * d + quad * d^2)
+namespace Attenuation
+{
+	// Distance at which the attenuated intensity falls below cutoff, nothing further away is lit
+	float GetRange(float intensity, float constant, float linear, float quad, float cutoff = 1.0f / 256.0f);
+}
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "LightClusters.h"
+#include "Core/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define CLUSTERS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	uint32_t ClampTile(float ndc, uint32_t count)
+	{
+		const float tile = std::floor((ndc * 0.5f + 0.5f) * count);
+		return static_cast<uint32_t>(std::clamp(tile, 0.0f, static_cast<float>(count - 1)));
+	}
+}
+
+bool LightClusters::Parameters::operator==(const Parameters& other) const
+{
+	return TilesX == other.TilesX && TilesY == other.TilesY && Slices == other.Slices &&
+		NearZ == other.NearZ && FarZ == other.FarZ && ScaleX == other.ScaleX && ScaleY == other.ScaleY;
+}
+
+void LightClusters::LightList::Resize(size_t count)
+{
+	for (auto* stream : { &X, &Y, &Z, &Radius })
+		stream->resize(count);
+}
+
+void LightClusters::LightList::Set(size_t index, float x, float y, float z, float radius)
+{
+	X[index] = x;
+	Y[index] = y;
+	Z[index] = z;
+	Radius[index] = radius;
+}
+
+float LightClusters::GetSliceScale() const
+{
+	return Grid.Slices / std::log(Grid.FarZ / Grid.NearZ);
+}
+
+float LightClusters::GetSliceBias() const
+{
+	return -GetSliceScale() * std::log(Grid.NearZ);
+}
+
+void LightClusters::Build(const Parameters& parameters, const LightList& lights)
+{
+	if (!HasBounds || !(parameters == Grid))
+	{
+		Grid = parameters;
+		BuildBounds();
+		HasBounds = true;
+	}
+
+	// Conservative tile and slice ranges of every sphere, refined by the box tests
+	const float sliceScale = GetSliceScale();
+	const float sliceBias = GetSliceBias();
+	Extents.resize(lights.Size());
+	ThreadPool::ParallelFor(lights.Size(), 256, [this, &lights, sliceScale, sliceBias](size_t, size_t begin, size_t end)
+							{
+								for (size_t i = begin; i < end; i++)
+								{
+									const float x = lights.X[i], y = lights.Y[i], z = lights.Z[i], radius = lights.Radius[i];
+									const float zMin = std::max(z - radius, Grid.NearZ);
+									const float zMax = std::min(z + radius, Grid.FarZ);
+
+									LightExtent& extent = Extents[i];
+									extent.Slice[0] = 1;
+									extent.Slice[1] = 0;
+									if (zMin > zMax)
+										continue;
+
+									// x / z over the box around the sphere is extreme at its corners
+									const float ndcX[4] = { (x - radius) / zMin, (x - radius) / zMax, (x + radius) / zMin, (x + radius) / zMax };
+									const float ndcY[4] = { (y - radius) / zMin, (y - radius) / zMax, (y + radius) / zMin, (y + radius) / zMax };
+									const float minX = *std::min_element(ndcX, ndcX + 4) * Grid.ScaleX;
+									const float maxX = *std::max_element(ndcX, ndcX + 4) * Grid.ScaleX;
+									const float minY = *std::min_element(ndcY, ndcY + 4) * Grid.ScaleY;
+									const float maxY = *std::max_element(ndcY, ndcY + 4) * Grid.ScaleY;
+									if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+										continue;
+
+									extent.TileX[0] = ClampTile(minX, Grid.TilesX);
+									extent.TileX[1] = ClampTile(maxX, Grid.TilesX);
+									extent.TileY[0] = ClampTile(minY, Grid.TilesY);
+									extent.TileY[1] = ClampTile(maxY, Grid.TilesY);
+									extent.Slice[0] = std::min(static_cast<uint32_t>(std::max(std::log(zMin) * sliceScale + sliceBias, 0.0f)), Grid.Slices - 1);
+									extent.Slice[1] = std::min(static_cast<uint32_t>(std::max(std::log(zMax) * sliceScale + sliceBias, 0.0f)), Grid.Slices - 1);
+								}
+							});
+
+	SliceResults.resize(Grid.Slices);
+	ThreadPool::ParallelFor(Grid.Slices, 1, [this, &lights](size_t, size_t begin, size_t end)
+							{
+								for (size_t slice = begin; slice < end; slice++)
+									BuildSlice(static_cast<uint32_t>(slice), lights);
+							});
+
+	// Slices are concatenated in order, so every cluster range is contiguous
+	const size_t tiles = static_cast<size_t>(Grid.TilesX) * Grid.TilesY;
+	Ranges.resize(GetClusterCount() * 2);
+	MaxLightsPerCluster = 0;
+	std::vector<uint32_t> sliceOffsets(Grid.Slices);
+	uint32_t offset = 0;
+	for (uint32_t slice = 0; slice < Grid.Slices; slice++)
+	{
+		const SliceLights& result = SliceResults[slice];
+		for (size_t tile = 0; tile < tiles; tile++)
+		{
+			const size_t cluster = slice * tiles + tile;
+			Ranges[cluster * 2] = offset + result.Offsets[tile];
+			Ranges[cluster * 2 + 1] = result.Counts[tile];
+			MaxLightsPerCluster = std::max<size_t>(MaxLightsPerCluster, result.Counts[tile]);
+		}
+		sliceOffsets[slice] = offset;
+		offset += static_cast<uint32_t>(result.Indices.size());
+	}
+
+	Indices.resize(offset);
+	ThreadPool::ParallelFor(Grid.Slices, 1, [this, &sliceOffsets](size_t, size_t begin, size_t end)
+							{
+								for (size_t slice = begin; slice < end; slice++)
+									std::copy(SliceResults[slice].Indices.begin(), SliceResults[slice].Indices.end(),
+											  Indices.begin() + sliceOffsets[slice]);
+							});
+}
+
+void LightClusters::BuildBounds()
+{
+	const size_t count = GetClusterCount();
+	for (auto* stream : { &MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ })
+		stream->resize(count);
+
+	// A cluster spans its tile in NDC between two slice depths, the widest extent is at either depth
+	for (uint32_t slice = 0; slice < Grid.Slices; slice++)
+	{
+		const float zMin = Grid.NearZ * std::pow(Grid.FarZ / Grid.NearZ, static_cast<float>(slice) / Grid.Slices);
+		const float zMax = Grid.NearZ * std::pow(Grid.FarZ / Grid.NearZ, static_cast<float>(slice + 1) / Grid.Slices);
+		for (uint32_t y = 0; y < Grid.TilesY; y++)
+		{
+			const float ndcY[2] = { 2.0f * y / Grid.TilesY - 1.0f, 2.0f * (y + 1) / Grid.TilesY - 1.0f };
+			for (uint32_t x = 0; x < Grid.TilesX; x++)
+			{
+				const float ndcX[2] = { 2.0f * x / Grid.TilesX - 1.0f, 2.0f * (x + 1) / Grid.TilesX - 1.0f };
+				const size_t cluster = (static_cast<size_t>(slice) * Grid.TilesY + y) * Grid.TilesX + x;
+
+				MinX[cluster] = std::min(ndcX[0] * zMin, ndcX[0] * zMax) / Grid.ScaleX;
+				MaxX[cluster] = std::max(ndcX[1] * zMin, ndcX[1] * zMax) / Grid.ScaleX;
+				MinY[cluster] = std::min(ndcY[0] * zMin, ndcY[0] * zMax) / Grid.ScaleY;
+				MaxY[cluster] = std::max(ndcY[1] * zMin, ndcY[1] * zMax) / Grid.ScaleY;
+				MinZ[cluster] = zMin;
+				MaxZ[cluster] = zMax;
+			}
+		}
+	}
+}
+
+void LightClusters::BuildSlice(uint32_t slice, const LightList& lights)
+{
+	const uint32_t tiles = Grid.TilesX * Grid.TilesY;
+	SliceLights& result = SliceResults[slice];
+	result.Counts.assign(tiles, 0);
+	result.Tiles.clear();
+	result.Lights.clear();
+
+	auto add = [&result](uint32_t tile, uint32_t light)
+	{
+		result.Tiles.push_back(tile);
+		result.Lights.push_back(light);
+		result.Counts[tile]++;
+	};
+
+	for (uint32_t i = 0; i < lights.Size(); i++)
+	{
+		const LightExtent& extent = Extents[i];
+		if (slice < extent.Slice[0] || slice > extent.Slice[1])
+			continue;
+
+		const float x = lights.X[i], y = lights.Y[i], z = lights.Z[i];
+		const float radiusSq = lights.Radius[i] * lights.Radius[i];
+
+		for (uint32_t tileY = extent.TileY[0]; tileY <= extent.TileY[1]; tileY++)
+		{
+			const size_t row = (static_cast<size_t>(slice) * Grid.TilesY + tileY) * Grid.TilesX;
+			uint32_t tileX = extent.TileX[0];
+
+#ifdef CLUSTERS_SSE2
+			// Four clusters of the row per test, lanes past the extent are still exact sphere box tests
+			const __m128 centerX = _mm_set1_ps(x), centerY = _mm_set1_ps(y), centerZ = _mm_set1_ps(z);
+			const __m128 radius = _mm_set1_ps(radiusSq);
+			const __m128 zero = _mm_setzero_ps();
+			for (tileX &= ~3u; tileX + 4 <= Grid.TilesX && tileX <= extent.TileX[1]; tileX += 4)
+			{
+				const size_t cluster = row + tileX;
+				const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&MinX[cluster]), centerX),
+														_mm_sub_ps(centerX, _mm_loadu_ps(&MaxX[cluster]))), zero);
+				const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&MinY[cluster]), centerY),
+														_mm_sub_ps(centerY, _mm_loadu_ps(&MaxY[cluster]))), zero);
+				const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&MinZ[cluster]), centerZ),
+														_mm_sub_ps(centerZ, _mm_loadu_ps(&MaxZ[cluster]))), zero);
+				const __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+				const int mask = _mm_movemask_ps(_mm_cmple_ps(distanceSq, radius));
+				for (uint32_t lane = 0; lane < 4; lane++)
+				{
+					if (mask & (1 << lane))
+						add(tileY * Grid.TilesX + tileX + lane, i);
+				}
+			}
+#endif
+
+			for (; tileX <= extent.TileX[1]; tileX++)
+			{
+				const size_t cluster = row + tileX;
+				const float dx = std::max({ MinX[cluster] - x, x - MaxX[cluster], 0.0f });
+				const float dy = std::max({ MinY[cluster] - y, y - MaxY[cluster], 0.0f });
+				const float dz = std::max({ MinZ[cluster] - z, z - MaxZ[cluster], 0.0f });
+				if (dx * dx + dy * dy + dz * dz <= radiusSq)
+					add(tileY * Grid.TilesX + tileX, i);
+			}
+		}
+	}
+
+	// Counting sort by tile, stable so every tile keeps its lights in increasing order
+	result.Offsets.resize(tiles);
+	uint32_t offset = 0;
+	for (uint32_t tile = 0; tile < tiles; tile++)
+	{
+		result.Offsets[tile] = offset;
+		offset += result.Counts[tile];
+		result.Counts[tile] = 0;
+	}
+
+	result.Indices.resize(result.Lights.size());
+	for (size_t j = 0; j < result.Lights.size(); j++)
+	{
+		const uint32_t tile = result.Tiles[j];
+		result.Indices[result.Offsets[tile] + result.Counts[tile]++] = result.Lights[j];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Assigns view space light spheres to a grid over the view frustum, screen tiles by exponential depth slices.
+// Clusters are numbered x fastest, then y from the bottom of the screen, then slice.
+class LightClusters
+{
+public:
+	struct Parameters
+	{
+		uint32_t TilesX = 16;
+		uint32_t TilesY = 8;
+		uint32_t Slices = 24;
+		float NearZ = 0.5f;
+		float FarZ = 200.0f;
+		// Projection[0][0] and Projection[1][1] of the camera
+		float ScaleX = 1.0f;
+		float ScaleY = 1.0f;
+
+		bool operator==(const Parameters& other) const;
+	};
+
+	// Structure of arrays, so consecutive lights fill SIMD lanes
+	struct LightList
+	{
+		std::vector<float> X, Y, Z, Radius;
+
+		void Resize(size_t count);
+		void Set(size_t index, float x, float y, float z, float radius);
+		size_t Size() const { return X.size(); }
+	};
+
+	// Slices are built in parallel, each cluster lists its lights in increasing order
+	void Build(const Parameters& parameters, const LightList& lights);
+
+	const Parameters& GetParameters() const { return Grid; }
+	size_t GetClusterCount() const { return static_cast<size_t>(Grid.TilesX) * Grid.TilesY * Grid.Slices; }
+	// Offset into GetIndices() and light count of every cluster
+	const std::vector<uint32_t>& GetRanges() const { return Ranges; }
+	const std::vector<uint32_t>& GetIndices() const { return Indices; }
+	size_t GetMaxLightsPerCluster() const { return MaxLightsPerCluster; }
+
+	// Slice of a view space depth, the shaders do the same with the two factors
+	float GetSliceScale() const;
+	float GetSliceBias() const;
+
+private:
+	void BuildBounds();
+	void BuildSlice(uint32_t slice, const LightList& lights);
+
+	struct LightExtent
+	{
+		uint32_t TileX[2], TileY[2], Slice[2];
+	};
+
+	struct SliceLights
+	{
+		// Per tile counts, then offsets into Indices
+		std::vector<uint32_t> Counts;
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Tiles;
+		std::vector<uint32_t> Lights;
+		std::vector<uint32_t> Indices;
+	};
+
+private:
+	Parameters Grid;
+	bool HasBounds = false;
+
+	// View space bounds of every cluster
+	std::vector<float> MinX, MinY, MinZ;
+	std::vector<float> MaxX, MaxY, MaxZ;
+
+	std::vector<LightExtent> Extents;
+	std::vector<SliceLights> SliceResults;
+	std::vector<uint32_t> Ranges;
+	std::vector<uint32_t> Indices;
+	size_t MaxLightsPerCluster = 0;
+};
\ No newline at end of file
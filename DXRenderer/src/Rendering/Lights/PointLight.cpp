@@ -1,4 +1,5 @@
 #include "PointLight.h"
+#include "Attenuation.h"
 
 #include "Rendering\Graphics.h"
 #include "Rendering/Actors/CameraViewer.h"
@@ -41,6 +42,16 @@ void PointLight::LinkTechniques()
 	Mesh.LinkTechniques();
 }
 
+float PointLight::GetRange(float cutoff) const
+{
+	return Attenuation::GetRange(Intensity, AttenuationConstant, AttenuationLinear, AttenuationQuad, cutoff);
+}
+
+DirectX::XMVECTOR PointLight::GetWorldPosition() const
+{
+	return DirectX::XMVectorSet(-Position.x, -Position.y, Position.z, 1.0f);
+}
+
 void PointLight::Tick(float delta)
 {
 	Mesh.Transform.Translation = Position;
@@ -15,6 +15,11 @@ public:
 	void GUI();
 	void Tick(float delta);
 
+	// Distance at which the attenuated intensity falls below cutoff, nothing further away is lit
+	float GetRange(float cutoff = 1.0f / 256.0f) const;
+	// Where the shadow pass and the shaders place the light, Position has x and y mirrored
+	DirectX::XMVECTOR GetWorldPosition() const;
+
 public:
 	struct LightProperties
 	{
@@ -0,0 +1,108 @@
+#include "PointLightSet.h"
+#include "PointLight.h"
+#include "Attenuation.h"
+
+#include "Core/Timer.h"
+#include "Rendering\Graphics.h"
+
+#include <imgui.h>
+#include <random>
+
+PointLightSet::PointLightSet()
+	:PropertiesBuffer(std::string(typeid(this).name()) + "clusters", Properties, 3u),
+	LightBuffer(std::string(typeid(this).name()) + "lights", sizeof(ShaderLight), 4),
+	RangeBuffer(std::string(typeid(this).name()) + "ranges", sizeof(uint32_t) * 2, 5),
+	IndexBuffer(std::string(typeid(this).name()) + "indices", sizeof(uint32_t), 6)
+{
+}
+
+void PointLightSet::Scatter(size_t count, const Culling::Box& volume, uint32_t seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> color(0.2f, 1.0f);
+
+	Lights.resize(count);
+	for (Light& light : Lights)
+	{
+		light = Light();
+		light.Position = { volume.Center.x + unit(generator) * volume.Extents.x,
+						   volume.Center.y + unit(generator) * volume.Extents.y,
+						   volume.Center.z + unit(generator) * volume.Extents.z };
+		light.Diffuse = { color(generator), color(generator), color(generator) };
+	}
+
+	Volume = volume;
+	RequestedCount = static_cast<int>(count);
+}
+
+void PointLightSet::Bind()
+{
+	using namespace DirectX;
+
+	Timer timer;
+	const XMMATRIX view = CurrentGraphicsContext::GraphicsInfo->GetView();
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, CurrentGraphicsContext::GraphicsInfo->GetProjection());
+
+	// Left handed perspective, depth row is (far / (far - near), -near * far / (far - near))
+	Grid.NearZ = -projection._43 / projection._33;
+	Grid.FarZ = projection._43 / (1.0f - projection._33);
+	Grid.ScaleX = projection._11;
+	Grid.ScaleY = projection._22;
+
+	ViewLights.Resize(Lights.size());
+	ShaderLights.resize(Lights.size());
+	for (size_t i = 0; i < Lights.size(); i++)
+	{
+		const Light& light = Lights[i];
+		const float range = Attenuation::GetRange(light.Intensity, light.AttenuationConstant, light.AttenuationLinear,
+												  light.AttenuationQuad);
+
+		ShaderLight& shaderLight = ShaderLights[i];
+		XMStoreFloat3(&shaderLight.Position, XMVector3TransformCoord(XMLoadFloat3(&light.Position), view));
+		XMStoreFloat3(&shaderLight.Color, XMLoadFloat3(&light.Diffuse) * light.Intensity);
+		shaderLight.Range = range;
+		shaderLight.AttenuationConstant = light.AttenuationConstant;
+		shaderLight.AttenuationLinear = light.AttenuationLinear;
+		shaderLight.AttenuationQuad = light.AttenuationQuad;
+
+		ViewLights.Set(i, shaderLight.Position.x, shaderLight.Position.y, shaderLight.Position.z, range);
+	}
+
+	Clusters.Build(Grid, ViewLights);
+	BuildMilliseconds = timer.Get() * 1000.0f;
+
+	Properties.TilesX = Grid.TilesX;
+	Properties.TilesY = Grid.TilesY;
+	Properties.Slices = Grid.Slices;
+	Properties.SliceScale = Clusters.GetSliceScale();
+	Properties.SliceBias = Clusters.GetSliceBias();
+	Properties.ScaleX = Grid.ScaleX;
+	Properties.ScaleY = Grid.ScaleY;
+	Properties.LightCount = static_cast<uint32_t>(Lights.size());
+
+	LightBuffer.Upload(ShaderLights.data(), static_cast<uint32_t>(ShaderLights.size()));
+	RangeBuffer.Upload(Clusters.GetRanges().data(), static_cast<uint32_t>(Clusters.GetClusterCount()));
+	IndexBuffer.Upload(Clusters.GetIndices().data(), static_cast<uint32_t>(Clusters.GetIndices().size()));
+
+	PropertiesBuffer.Bind();
+	LightBuffer.Bind();
+	RangeBuffer.Bind();
+	IndexBuffer.Bind();
+}
+
+void PointLightSet::GUI()
+{
+	ImGui::Begin("Clustered Lights");
+
+	ImGui::SliderInt("Lights", &RequestedCount, 0, 8192);
+	if (static_cast<size_t>(RequestedCount) != Lights.size())
+		Scatter(RequestedCount, Volume);
+
+	ImGui::Text("%u x %u x %u clusters, %zu light references, at most %zu in a cluster", Grid.TilesX, Grid.TilesY,
+				Grid.Slices, Clusters.GetIndices().size(), Clusters.GetMaxLightsPerCluster());
+	ImGui::Text("Cluster build %.3f ms", BuildMilliseconds);
+
+	ImGui::End();
+}
\ No newline at end of file
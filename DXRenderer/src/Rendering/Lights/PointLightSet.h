@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Rendering\Buffer.h"
+#include "Rendering/Culling.h"
+#include "LightClusters.h"
+
+// Unshadowed point lights on top of the shadowed PointLight. They are assigned to clusters of the camera
+// frustum every frame and the Phong pixel shaders only loop over the lights of their fragment's cluster.
+class PointLightSet
+{
+public:
+	struct Light
+	{
+		DirectX::XMFLOAT3 Position{};
+		DirectX::XMFLOAT3 Diffuse{ 1.0f, 1.0f, 1.0f };
+		float Intensity = 1.0f;
+		float AttenuationConstant = 1.0f;
+		float AttenuationLinear = 0.7f;
+		float AttenuationQuad = 1.8f;
+	};
+
+	PointLightSet();
+
+	// Replaces the lights with count random ones inside the world space box
+	void Scatter(size_t count, const Culling::Box& volume, uint32_t seed = 1);
+	std::vector<Light>& GetLights() { return Lights; }
+
+	// Clusters the lights for the current camera, uploads them and binds them to the pixel shaders
+	void Bind();
+	void GUI();
+
+private:
+	// Matches ClusterLight of ClusteredLights.hlsli
+	struct ShaderLight
+	{
+		DirectX::XMFLOAT3 Position;
+		float Range;
+		DirectX::XMFLOAT3 Color;
+		float AttenuationConstant;
+		float AttenuationLinear;
+		float AttenuationQuad;
+		float Padding[2];
+	};
+
+	struct ClusterProperties
+	{
+		uint32_t TilesX = 0;
+		uint32_t TilesY = 0;
+		uint32_t Slices = 0;
+		float SliceScale = 0.0f;
+		float ScaleX = 0.0f;
+		float ScaleY = 0.0f;
+		float SliceBias = 0.0f;
+		uint32_t LightCount = 0;
+	};
+
+private:
+	std::vector<Light> Lights;
+	std::vector<ShaderLight> ShaderLights;
+	LightClusters::LightList ViewLights;
+	LightClusters::Parameters Grid;
+	LightClusters Clusters;
+
+	ClusterProperties Properties;
+	UniformPS<ClusterProperties> PropertiesBuffer;
+	StructuredBuffer LightBuffer;
+	StructuredBuffer RangeBuffer;
+	StructuredBuffer IndexBuffer;
+
+	Culling::Box Volume;
+	int RequestedCount = 0;
+	float BuildMilliseconds = 0.0f;
+};
\ No newline at end of file
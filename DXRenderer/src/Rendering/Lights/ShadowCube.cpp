@@ -0,0 +1,64 @@
+#include "ShadowCube.h"
+
+#include <algorithm>
+#include <numbers>
+
+namespace
+{
+	constexpr float HalfPi = std::numbers::pi_v<float> / 2.0f;
+
+	// Pitch, yaw and roll of the camera of each face, in the order of the cube's array slices
+	constexpr std::array<DirectX::XMFLOAT3, ShadowCube::FaceCount> FaceOrientations =
+	{ {
+		{ 0, HalfPi, 0 },
+		{ 0, -HalfPi, 0 },
+		{ -HalfPi, 0, 0 },
+		{ HalfPi, 0, 0 },
+		{ 0, 0, 0 },
+		{ 0, -2.0f * HalfPi, 0 },
+	} };
+}
+
+ShadowCube::ShadowCube()
+	:Projection(DirectX::XMMatrixPerspectiveFovLH(HalfPi, 1.0f, NearZ, FarZ))
+{
+	Place(DirectX::XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), 0.0f);
+}
+
+void ShadowCube::Place(DirectX::FXMVECTOR position, float range)
+{
+	using namespace DirectX;
+
+	XMStoreFloat3(&Position, position);
+	Range = std::min(range, FarZ);
+	for (uint32_t i = 0; i < FaceCount; i++)
+		Frustums[i] = Culling::ExtractFrustum(XMMatrixInverse(nullptr, GetFaceTransform(i)) * Projection);
+}
+
+bool ShadowCube::IsInRange(const Culling::Box& box) const
+{
+	return Culling::IntersectsSphere(box, Position, Range);
+}
+
+uint32_t ShadowCube::GetFaceMask(const Culling::Box& box) const
+{
+	if (!IsInRange(box))
+		return 0;
+
+	uint32_t faces = 0;
+	for (uint32_t i = 0; i < FaceCount; i++)
+	{
+		if (Culling::IsVisible(box, Frustums[i]))
+			faces |= 1u << i;
+	}
+	return faces;
+}
+
+DirectX::XMMATRIX ShadowCube::GetFaceTransform(uint32_t face) const
+{
+	using namespace DirectX;
+
+	const XMFLOAT3& rotation = FaceOrientations[face];
+	return XMMatrixRotationRollPitchYaw(-rotation.x, -rotation.y, rotation.z) *
+		XMMatrixTranslation(Position.x, Position.y, Position.z);
+}
\ No newline at end of file
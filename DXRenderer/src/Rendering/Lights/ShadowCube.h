@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Rendering/Culling.h"
+
+#include <array>
+#include <cstdint>
+#include <DirectXMath.h>
+
+// Faces of a point light's depth cube and the casters each one takes. Nothing here touches the device,
+// the shadow pass places the cube at the light before sorting its queue.
+class ShadowCube
+{
+public:
+	ShadowCube();
+
+	// Moves the faces to position, casters farther than range from it are in none of them.
+	// The range stops at the far plane, the depth of nothing beyond it is stored.
+	void Place(DirectX::FXMVECTOR position, float range);
+
+	bool IsInRange(const Culling::Box& box) const;
+	// Faces whose frustum the box overlaps, none outside the light range
+	uint32_t GetFaceMask(const Culling::Box& box) const;
+
+	// Camera of the face, at the light and looking along the face's axis
+	DirectX::XMMATRIX GetFaceTransform(uint32_t face) const;
+	const DirectX::XMMATRIX& GetProjection() const { return Projection; }
+	const DirectX::XMFLOAT3& GetPosition() const { return Position; }
+	float GetRange() const { return Range; }
+
+	static constexpr uint32_t FaceCount = 6;
+	static constexpr uint32_t AllFaces = 0b111111;
+	// Match zn and zf of ShadowOps.hlsli
+	static constexpr float NearZ = 0.5f;
+	static constexpr float FarZ = 100.0f;
+
+private:
+	DirectX::XMMATRIX Projection;
+	std::array<Culling::Frustum, FaceCount> Frustums;
+	DirectX::XMFLOAT3 Position{};
+	float Range = 0.0f;
+};
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "Material.h"
 
+#include <cstddef>
+#include <string>
+
 Material::Material(uint32_t slot)
 	:Properties(),
 	PropertiesUniform(UniformPS<MaterialProperties>(std::string(typeid(this).name()) + "properties", Properties, slot))
@@ -9,4 +12,12 @@ Material::Material(uint32_t slot)
 void Material::Bind() const
 {
 	PropertiesUniform.Bind();
+}
+
+ResourceHandle Material::GetHandle() const
+{
+	// Materials with equal properties bind equal data. The trailing padding of the uniform is left out.
+	constexpr size_t size = offsetof(MaterialProperties, NormalMapEnabled) + sizeof(MaterialProperties::NormalMapEnabled);
+	static_assert(size == sizeof(DirectX::XMFLOAT3) + 2 * sizeof(float) + sizeof(BOOL), "Material properties have no inner padding");
+	return CombineResourceHandles(PropertiesUniform.GetHandle(), HashResourceData(&Properties, size));
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ public:
 	Material(uint32_t slot = 0);
 
 	void Bind() const override;
+	ResourceHandle GetHandle() const override;
 
 public:
 
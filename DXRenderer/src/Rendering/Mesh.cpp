@@ -2,32 +2,109 @@
 #include "Utilities.h"
 
 #include "Actors/Model.h"
+#include "Rendering/Lights/PointLight.h"
 #include "Rendering/Material.h"
 #include "Rendering/State.h"
+#include "Rendering/VertexLayout.h"
+#include "RenderGraph/PassExtensions.h"
+#include "RenderGraph/RenderGraph.h"
 
-inline PrimitiveComponent::PrimitiveComponent()
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string_view>
+
+namespace
 {
-	DirectX::XMStoreFloat4x4(&Transform, DirectX::XMMatrixIdentity());
+	std::vector<uint32_t> GatherIndices(const aiMesh& mesh)
+	{
+		std::vector<uint32_t> indices;
+		indices.reserve(mesh.mNumFaces * 3);
+		for (unsigned int i = 0; i < mesh.mNumFaces; i++)
+		{
+			const auto& face = mesh.mFaces[i];
+			assert(face.mNumIndices == 3);
+			indices.push_back(face.mIndices[0]);
+			indices.push_back(face.mIndices[1]);
+			indices.push_back(face.mIndices[2]);
+		}
+		return indices;
+	}
+
+	using MeshOptimizer::VertexRemap;
+
+	using PositionNormal = StaticLayout<VertexAttribute::Position3, VertexAttribute::Normal>;
+	using PositionNormalTexCoords = StaticLayout<VertexAttribute::Position3, VertexAttribute::Normal, VertexAttribute::TexCoords>;
+	using PositionNormalTangentBitangentTexCoords = StaticLayout<VertexAttribute::Position3, VertexAttribute::Normal,
+		VertexAttribute::Tangent, VertexAttribute::Bitangent, VertexAttribute::TexCoords>;
+
+	struct PositionDequantization
+	{
+		DirectX::XMFLOAT4 Center{ 0.0f, 0.0f, 0.0f, 0.0f };
+		DirectX::XMFLOAT4 Extents{ 1.0f, 1.0f, 1.0f, 0.0f };
+	};
+
+	template<typename Layout>
+	UniquePtr<VertexBuffer> BuildVertexBuffer(const std::string& tag, const std::array<VertexStream, Layout::Count>& streams, size_t count,
+											  const VertexRemap& remap)
+	{
+		StaticVertexBufferBuilder<Layout> builder{ tag };
+		builder.Interleave(streams, count);
+		if (!remap.Table.empty())
+			builder.Remap(remap.Table, remap.VertexCount);
+		return builder.Release();
+	}
+
+	template<typename Position>
+	UniquePtr<VertexBuffer> BuildQuantizedVertexBuffer(const std::string& tag, const aiMesh& mesh, VertexStream position,
+													   bool hasTexCoords, bool hasTangents, const VertexRemap& remap)
+	{
+		using namespace VertexAttribute;
+		const size_t count = mesh.mNumVertices;
+		const auto* normalsIn = reinterpret_cast<const Quantization::Float3*>(mesh.mNormals);
+
+		std::vector<Quantization::Short2> normals(count);
+		Quantization::EncodeNormals(normals.data(), normalsIn, count);
+		const VertexStream normal{ normals.data(), sizeof(Quantization::Short2) };
+
+		if (!hasTexCoords)
+			return BuildVertexBuffer<StaticLayout<Position, NormalOct>>(tag, { position, normal }, count, remap);
+
+		std::vector<Quantization::Half2> texCoords(count);
+		Quantization::EncodeTexCoords(texCoords.data(), reinterpret_cast<const Quantization::Float3*>(mesh.mTextureCoords[0]), count);
+		const VertexStream texCoord{ texCoords.data(), sizeof(Quantization::Half2) };
+
+		if (!hasTangents)
+			return BuildVertexBuffer<StaticLayout<Position, NormalOct, TexCoordsHalf>>(tag, { position, normal, texCoord }, count, remap);
+
+		std::vector<Quantization::Short2> tangents(count);
+		Quantization::EncodeTangents(tangents.data(), reinterpret_cast<const Quantization::Float3*>(mesh.mTangents),
+									 reinterpret_cast<const Quantization::Float3*>(mesh.mBitangents), normalsIn, count);
+		const VertexStream tangent{ tangents.data(), sizeof(Quantization::Short2) };
+
+		return BuildVertexBuffer<StaticLayout<Position, NormalOct, TangentOct, TexCoordsHalf>>(tag, { position, normal, tangent, texCoord },
+																								 count, remap);
+	}
 }
 
-void PrimitiveComponent::SetTransform(DirectX::XMMATRIX transform)
+inline PrimitiveComponent::PrimitiveComponent(const TransformHierarchy& transforms, uint32_t node)
+	:Transforms(transforms), TransformIndex(node)
 {
-	DirectX::XMStoreFloat4x4(&Transform, transform);
+	ASSERT(node < transforms.Size());
 }
 
-inline DirectX::XMMATRIX PrimitiveComponent::GetTransform() const
+DirectX::XMMATRIX PrimitiveComponent::GetTransform() const
 {
-	return DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(&Transform));
+	return DirectX::XMLoadFloat4x4A(&GetWorld());
 }
 
-void PrimitiveComponent::Tick(float delta)
+float PrimitiveComponent::GetViewDepth() const
 {
-	DirectX::XMStoreFloat4x4(&ModelView,
-							 GetTransform() * CurrentGraphicsContext::GraphicsInfo->GetView());
+	return GetModelView()._43;
 }
 
-Mesh::Mesh(const aiMesh& mesh, const std::string& meshName)
-	:Name(meshName)
+Mesh::Mesh(const aiMesh& mesh, const std::string& meshName, const TransformHierarchy& transforms, uint32_t node)
+	:PrimitiveComponent(transforms, node), Name(meshName)
 {
 	using namespace DirectX;
 	Technique standard(Channels::Main);
@@ -38,36 +115,20 @@ Mesh::Mesh(const aiMesh& mesh, const std::string& meshName)
 	first.Add<VertexShader>(vertexShader);
 	first.Add<PixelShader>(pixelName);
 	
-	BufferLayout layout{
-	{ LayoutElement::ElementType::Position3 },
-	{ LayoutElement::ElementType::Normal }
-	};
-
-	VertexBufferBuilder builder{ Name + "VertexBufferModel", std::move(layout), vertexShader.GetBlob() };
-
-	for (unsigned int i = 0; i < mesh.mNumVertices; i++)
-	{
-		builder.EmplaceBack(*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mVertices[i]),
-							*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mNormals[i])
-		);
-	}
+	StaticVertexBufferBuilder<PositionNormal> builder{ Name + "VertexBufferModel" };
+	builder.Interleave({ VertexStream{ mesh.mVertices, sizeof(aiVector3D) }, VertexStream{ mesh.mNormals, sizeof(aiVector3D) } }, mesh.mNumVertices);
 
 	auto ptr = builder.Release();
-	first.Add<InputLayout>(Name, ptr->GetLayout(), vertexShader.GetBlob());
+	first.Add<InputLayout>(Name, GetInputDescriptors<PositionNormal>(), vertexShader.GetBlob());
 	Add(std::move(ptr));
 
-	std::vector<unsigned short> indices;
-	indices.reserve(mesh.mNumFaces * 3);
-	for (unsigned int i = 0; i < mesh.mNumFaces; i++)
-	{
-		const auto& face = mesh.mFaces[i];
-		assert(face.mNumIndices == 3);
-		indices.push_back(face.mIndices[0]);
-		indices.push_back(face.mIndices[1]);
-		indices.push_back(face.mIndices[2]);
-	}
+	AddIndexBuffer(GatherIndices(mesh), mesh.mNumVertices);
 
-	Add<IndexBuffer>(Name + "IndexBufferModel", indices);
+	const auto bounds = Quantization::ComputeBounds(reinterpret_cast<const Quantization::Float3*>(mesh.mVertices), mesh.mNumVertices);
+	const auto center = bounds.GetCenter();
+	const auto extents = bounds.GetExtents();
+	LocalBounds = { { center.X, center.Y, center.Z }, { extents.X, extents.Y, extents.Z } };
+	BoundsRadius = std::sqrt(extents.X * extents.X + extents.Y * extents.Y + extents.Z * extents.Z);
 
 	const DirectX::XMMATRIX& view = CurrentGraphicsContext::GraphicsInfo->GetView();
 	first.Add<UniformPS<XMMATRIX>>(Name + "View", view, 2);
@@ -75,7 +136,7 @@ Mesh::Mesh(const aiMesh& mesh, const std::string& meshName)
 	const DirectX::XMMATRIX& projection = CurrentGraphicsContext::GraphicsInfo->GetProjection();
 	first.Add<UniformVS<XMMATRIX>>(Name + "Proj", projection, 1);
 
-	auto& modelView = *reinterpret_cast<const XMMATRIX*>(&ModelView);
+	auto& modelView = *reinterpret_cast<const XMMATRIX*>(&GetModelView());
 	first.Add<UniformVS<XMMATRIX>>(Name + "Transform" + UIDTag(), modelView);
 
 	if (!HasSpecular)
@@ -91,8 +152,9 @@ Mesh::Mesh(const aiMesh& mesh, const std::string& meshName)
 	Add(std::move(standard));
 }
 
-Mesh::Mesh(const aiMesh& mesh, const std::string& meshName, const aiMaterial* const* materials, const std::string& path)
-	:Name(meshName)
+Mesh::Mesh(const aiMesh& mesh, const std::string& meshName, const TransformHierarchy& transforms, uint32_t node,
+		   const aiMaterial* const* materials, const std::string& path, const ImportSettings& settings)
+	:PrimitiveComponent(transforms, node), Name(meshName), IsQuantized(settings.QuantizeAttributes)
 {
 	ASSERT(materials);
 	using namespace DirectX;
@@ -136,84 +198,97 @@ Mesh::Mesh(const aiMesh& mesh, const std::string& meshName, const aiMaterial* co
 	auto [vertexName, pixelName] = ResolveShaders();
 	VertexShader vertexShader(vertexName);
 	SharedPtr<VertexBuffer> vertexBuffer;
+	const std::string tag = Name + "VertexBufferModel";
 
-	if (HasDiffuse && HasNormals)
-	{
-		BufferLayout layout{
-		{ LayoutElement::ElementType::Position3 },
-		{ LayoutElement::ElementType::Normal },
-		{ LayoutElement::ElementType::Tangent},
-		{ LayoutElement::ElementType::Bitangent},
-		{ LayoutElement::ElementType::TexCoords}
-		};
+	auto indices = GatherIndices(mesh);
+	VertexRemap remap;
+	if (settings.OptimizeMeshes)
+		remap = Optimize(mesh, indices);
 
-		VertexBufferBuilder builder{ Name + "VertexBufferModel", std::move(layout), vertexShader.GetBlob() };
+	const size_t vertexCount = remap.Table.empty() ? mesh.mNumVertices : remap.VertexCount;
+	const aiVector3D* positions = mesh.mVertices;
 
-		for (unsigned int i = 0; i < mesh.mNumVertices; i++)
-		{
-			builder.EmplaceBack(*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mVertices[i]),
-								*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mNormals[i]),
-								*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mTangents[i]),
-								*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mBitangents[i]),
-								*reinterpret_cast<DirectX::XMFLOAT2*>(&mesh.mTextureCoords[0][i])
-			);
-		}
-		vertexBuffer = builder.Release();
-		Add(vertexBuffer);
-	}
-	else if (HasDiffuse)
+	std::vector<aiVector3D> remappedPositions;
+	if (!remap.Table.empty())
 	{
-		BufferLayout layout{
-		{ LayoutElement::ElementType::Position3 },
-		{ LayoutElement::ElementType::Normal },
-		{ LayoutElement::ElementType::TexCoords}
-		};
+		remappedPositions.resize(vertexCount);
+		MeshOptimizer::RemapVertexBuffer(remappedPositions.data(), mesh.mVertices, mesh.mNumVertices, sizeof(aiVector3D), remap.Table.data());
+		positions = remappedPositions.data();
+	}
 
-		VertexBufferBuilder builder{ Name + "VertexBufferModel", std::move(layout), vertexShader.GetBlob() };
+	const auto bounds = Quantization::ComputeBounds(reinterpret_cast<const Quantization::Float3*>(positions), vertexCount);
+	const auto center = bounds.GetCenter();
+	const auto extents = bounds.GetExtents();
+	LocalBounds = { { center.X, center.Y, center.Z }, { extents.X, extents.Y, extents.Z } };
+	BoundsRadius = std::sqrt(extents.X * extents.X + extents.Y * extents.Y + extents.Z * extents.Z);
 
-		for (unsigned int i = 0; i < mesh.mNumVertices; i++)
-		{
-			builder.EmplaceBack(*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mVertices[i]),
-								*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mNormals[i]),
-								*reinterpret_cast<DirectX::XMFLOAT2*>(&mesh.mTextureCoords[0][i])
-			);
-		}
+	if (settings.BuildMeshlets)
+		Clusters = Meshlets::Build(indices.data(), indices.size(), &positions->x, sizeof(aiVector3D), vertexCount);
 
-		vertexBuffer = builder.Release();
-		Add(vertexBuffer);
-	}
-	else
-	{
-		BufferLayout layout{
-		{ LayoutElement::ElementType::Position3 },
-		{ LayoutElement::ElementType::Normal }
-		};
+	// Alpha tested surfaces have holes, they are never occluders
+	if (settings.BuildOccluders && !HasAlphaDiffuse)
+		Occluder = Occlusion::BuildOccluder(indices.data(), indices.size(), &positions->x, sizeof(aiVector3D), vertexCount,
+											settings.OccluderMaxTriangles, settings.LodMaxError * BoundsRadius);
+
+	// Coarser levels are appended behind the full index list, so cluster ranges stay valid
+	if (settings.LodLevels > 1)
+		BuildLevelsOfDetail(indices, positions, vertexCount, settings);
 
-		VertexBufferBuilder builder{ Name + "VertexBufferModel", std::move(layout), vertexShader.GetBlob() };
+	if (IsQuantized)
+	{
+		PositionDequantization dequantization;
+		// Encoded before the remap, the vertex buffer builder remaps the encoded stream with the others
+		const auto* sourcePositions = reinterpret_cast<const Quantization::Float3*>(mesh.mVertices);
 
-		for (unsigned int i = 0; i < mesh.mNumVertices; i++)
+		if (settings.QuantizePositions)
 		{
-			builder.EmplaceBack(*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mVertices[i]),
-								*reinterpret_cast<DirectX::XMFLOAT3*>(&mesh.mNormals[i])
-			);
+			const auto quantizationBounds = Quantization::ComputeBounds(sourcePositions, mesh.mNumVertices);
+			const auto quantizationCenter = quantizationBounds.GetCenter();
+			const auto quantizationExtents = quantizationBounds.GetExtents();
+			dequantization.Center = { quantizationCenter.X, quantizationCenter.Y, quantizationCenter.Z, 0.0f };
+			dequantization.Extents = { quantizationExtents.X, quantizationExtents.Y, quantizationExtents.Z, 0.0f };
+
+			std::vector<Quantization::Short4> quantized(mesh.mNumVertices);
+			Quantization::EncodePositions(quantized.data(), sourcePositions, mesh.mNumVertices, quantizationBounds);
+			vertexBuffer = BuildQuantizedVertexBuffer<VertexAttribute::PositionQuantized>(tag, mesh,
+				VertexStream{ quantized.data(), sizeof(Quantization::Short4) }, HasDiffuse, HasDiffuse && HasNormals, remap);
+		}
+		else
+		{
+			vertexBuffer = BuildQuantizedVertexBuffer<VertexAttribute::Position3>(tag, mesh,
+				VertexStream{ mesh.mVertices, sizeof(aiVector3D) }, HasDiffuse, HasDiffuse && HasNormals, remap);
 		}
 
-		vertexBuffer = builder.Release();
 		Add(vertexBuffer);
+		Add<VS<PositionDequantization>>(Name + "Dequantization", dequantization, 5);
 	}
-
-	std::vector<unsigned short> indices;
-	indices.reserve(mesh.mNumFaces * 3);
-	for (unsigned int i = 0; i < mesh.mNumFaces; i++)
+	else if (HasDiffuse && HasNormals)
 	{
-		const auto& face = mesh.mFaces[i];
-		assert(face.mNumIndices == 3);
-		indices.push_back(face.mIndices[0]);
-		indices.push_back(face.mIndices[1]);
-		indices.push_back(face.mIndices[2]);
+		vertexBuffer = BuildVertexBuffer<PositionNormalTangentBitangentTexCoords>(tag, { VertexStream{ mesh.mVertices, sizeof(aiVector3D) },
+																						 VertexStream{ mesh.mNormals, sizeof(aiVector3D) },
+																						 VertexStream{ mesh.mTangents, sizeof(aiVector3D) },
+																						 VertexStream{ mesh.mBitangents, sizeof(aiVector3D) },
+																						 VertexStream{ mesh.mTextureCoords[0], sizeof(aiVector3D) } },
+																				  mesh.mNumVertices, remap);
+		Add(vertexBuffer);
+	}
+	else if (HasDiffuse)
+	{
+		vertexBuffer = BuildVertexBuffer<PositionNormalTexCoords>(tag, { VertexStream{ mesh.mVertices, sizeof(aiVector3D) },
+																		 VertexStream{ mesh.mNormals, sizeof(aiVector3D) },
+																		 VertexStream{ mesh.mTextureCoords[0], sizeof(aiVector3D) } },
+																  mesh.mNumVertices, remap);
+		Add(vertexBuffer);
+	}
+	else
+	{
+		vertexBuffer = BuildVertexBuffer<PositionNormal>(tag, { VertexStream{ mesh.mVertices, sizeof(aiVector3D) },
+																VertexStream{ mesh.mNormals, sizeof(aiVector3D) } },
+														 mesh.mNumVertices, remap);
+		Add(vertexBuffer);
 	}
 
-	Add<IndexBuffer>(Name + "IndexBufferModel", indices);
+	AddIndexBuffer(indices, vertexCount);
 
 	Technique standard(Channels::Main);
 	{
@@ -226,11 +301,14 @@ Mesh::Mesh(const aiMesh& mesh, const std::string& meshName, const aiMaterial* co
 		const DirectX::XMMATRIX& view = CurrentGraphicsContext::GraphicsInfo->GetView();
 		first.Add<UniformPS<XMMATRIX>>(Name + "View", view, 2);
 
-		auto& model = *reinterpret_cast<const XMMATRIX*>(&Transform);
-		first.Add<UniformVS<XMMATRIX>>(Name + "Model" + UIDTag(), model);
+		auto& model = *reinterpret_cast<const XMMATRIX*>(&GetWorld());
+		first.AddPerInstance<UniformVS<XMMATRIX>>(Name + "Model" + UIDTag(), model);
+
+		auto& modelView = *reinterpret_cast<const XMMATRIX*>(&GetModelView());
+		first.AddPerInstance<UniformVS<XMMATRIX>>(Name + "Transform" + UIDTag(), modelView, 1);
 
-		auto& modelView = *reinterpret_cast<const XMMATRIX*>(&ModelView);
-		first.Add<UniformVS<XMMATRIX>>(Name + "Transform" + UIDTag(), modelView, 1);
+		if (std::string_view(vertexName) == "Phong")
+			first.SetInstancing("PhongInstanced", Name + "Instanced", vertexBuffer->GetLayout());
 
 		const DirectX::XMMATRIX& projection = CurrentGraphicsContext::GraphicsInfo->GetProjection();
 		first.Add<UniformVS<XMMATRIX>>(Name + "Proj", projection, 2);
@@ -243,6 +321,7 @@ Mesh::Mesh(const aiMesh& mesh, const std::string& meshName, const aiMaterial* co
 		}
 
 		first.Add<RasterizerState>(HasAlphaDiffuse);
+		first.SetTranslucent(HasAlphaDiffuse);
 
 		for (auto& t : textures)
 		{
@@ -257,11 +336,15 @@ Mesh::Mesh(const aiMesh& mesh, const std::string& meshName, const aiMaterial* co
 	Technique shadowMap(Channels::Shadow);
 	{
 		Step draw("shadowMap");
-		VertexShader vs("ShadowMapUpdate");
+		VertexShader vs(IsQuantized ? "ShadowMapUpdateQuantized" : "ShadowMapUpdate");
+		draw.Add<VertexShader>(vs);
 		draw.Add<InputLayout>(Name, vertexBuffer->GetLayout(), vs.GetBlob());
 
-		auto& transform = *reinterpret_cast<const XMMATRIX*>(&Transform);
-		draw.Add<UniformVS<XMMATRIX>>(Name + "Model" + UIDTag(), transform);
+		auto& transform = *reinterpret_cast<const XMMATRIX*>(&GetWorld());
+		draw.AddPerInstance<UniformVS<XMMATRIX>>(Name + "Model" + UIDTag(), transform);
+
+		if (!IsQuantized)
+			draw.SetInstancing("ShadowMapUpdateInstanced", Name + "ShadowInstanced", vertexBuffer->GetLayout());
 		shadowMap.PushBack(std::move(draw));
 	}
 
@@ -278,21 +361,289 @@ inline void Mesh::Bind() const
 
 void Mesh::Submit(size_t channelsIn)
 {
+	if (DrawsRanges())
+	{
+		for (size_t channel : { Channels::Main, Channels::Shadow })
+		{
+			if (!(channelsIn & channel))
+				continue;
+
+			GetCurrentLevel(channel) = SelectLevelOfDetail(channel);
+			if (UpdateVisibleRanges(channel) == 0)
+				channelsIn &= ~channel;
+		}
+
+		if (channelsIn == 0)
+			return;
+	}
+
 	for (auto& t : Techniques)
 		t->Submit(*this, channelsIn);
 }
 
+void Mesh::UpdateWorldBounds()
+{
+	WorldBounds = Culling::TransformBox(LocalBounds, GetTransform());
+}
+
+float Mesh::GetViewDepth() const
+{
+	using namespace DirectX;
+	const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&LocalBounds.Center), XMLoadFloat4x4A(&GetModelView()));
+	return XMVectorGetZ(center);
+}
+
+const std::vector<Meshlets::DrawRange>* Mesh::GetDrawRanges(size_t channels) const
+{
+	return DrawsRanges() ? &GetVisibleRanges(channels) : nullptr;
+}
+
+size_t Mesh::SelectLevelOfDetail(size_t channel) const
+{
+	using namespace DirectX;
+
+	if (LevelsOfDetail.size() <= 1)
+		return 0;
+
+	const XMMATRIX model = GetTransform();
+	const float scale = std::max({ XMVectorGetX(XMVector3Length(model.r[0])),
+								   XMVectorGetX(XMVector3Length(model.r[1])),
+								   XMVectorGetX(XMVector3Length(model.r[2])) });
+
+	XMVECTOR eye;
+	float pixelsPerUnit;
+	if (channel == Channels::Main)
+	{
+		eye = XMMatrixInverse(nullptr, CurrentGraphicsContext::GraphicsInfo->GetView()).r[3];
+
+		XMFLOAT4X4 projection;
+		XMStoreFloat4x4(&projection, CurrentGraphicsContext::GraphicsInfo->GetProjection());
+		pixelsPerUnit = 0.5f * CurrentGraphicsContext::GraphicsInfo->GetHeight() * projection._22 * scale;
+	}
+	else
+	{
+		const PointLight* light = RenderGraph::GetLightSource();
+		if (!light)
+			return 0;
+
+		// Cube faces have a 90 degree field of view
+		eye = light->GetWorldPosition();
+		pixelsPerUnit = 0.5f * ShadowMappingPass::DepthDim * scale;
+	}
+
+	const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&LocalBounds.Center), model);
+	const float distance = XMVectorGetX(XMVector3Length(center - eye)) - BoundsRadius * scale;
+
+	return Simplifier::SelectLevel(LevelsOfDetail.data(), LevelsOfDetail.size(), distance, pixelsPerUnit, LodThresholdPixels);
+}
+
+size_t Mesh::UpdateVisibleRanges(size_t channel)
+{
+	using namespace DirectX;
+
+	auto& ranges = GetVisibleRanges(channel);
+	ranges.clear();
+
+	// Clusters only cover the full resolution level
+	const size_t currentLevel = GetCurrentLevel(channel);
+	if (currentLevel > 0 || Clusters.Empty())
+	{
+		const auto& level = LevelsOfDetail[currentLevel];
+		ranges.push_back({ level.IndexOffset, level.IndexCount });
+		return 1;
+	}
+
+	// Culling runs in model space, so the clusters never need to be transformed
+	const XMMATRIX model = GetTransform();
+	const XMMATRIX inverseModel = XMMatrixInverse(nullptr, model);
+
+	// Alpha tested meshes are drawn two sided in the main pass, the shadow rasterizer culls back faces of every mesh
+	Meshlets::CullParameters parameters;
+	parameters.CullBackfacing = channel == Channels::Shadow || !HasAlphaDiffuse;
+
+	XMVECTOR viewer;
+	if (channel == Channels::Main)
+	{
+		XMFLOAT4X4 clip;
+		XMStoreFloat4x4(&clip, model * CurrentGraphicsContext::GraphicsInfo->GetViewProjection());
+		Meshlets::ExtractFrustumPlanes(clip.m, parameters);
+
+		viewer = XMMatrixInverse(nullptr, CurrentGraphicsContext::GraphicsInfo->GetView()).r[3];
+	}
+	else
+	{
+		// The shadow map covers every direction around the light, only backfacing clusters can go
+		const PointLight* light = RenderGraph::GetLightSource();
+		if (!light)
+		{
+			// Coarser levels follow the full one in the index buffer, only the full level is drawn
+			ranges.push_back(LevelsOfDetail.empty() ? Meshlets::DrawRange{ 0, GetIndexBuffer()->GetCount() } :
+							 Meshlets::DrawRange{ LevelsOfDetail[0].IndexOffset, LevelsOfDetail[0].IndexCount });
+			return 1;
+		}
+
+		viewer = light->GetWorldPosition();
+	}
+
+	XMFLOAT3 local;
+	XMStoreFloat3(&local, XMVector3TransformCoord(viewer, inverseModel));
+	parameters.Viewer[0] = local.x;
+	parameters.Viewer[1] = local.y;
+	parameters.Viewer[2] = local.z;
+
+	return Meshlets::Cull(Clusters, parameters, ranges);
+}
+
+std::vector<UniquePtr<aiMesh>> Mesh::Split(const aiMesh& mesh, uint32_t maxVertices)
+{
+	constexpr uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+
+	std::vector<UniquePtr<aiMesh>> chunks;
+	std::vector<uint32_t> remap(mesh.mNumVertices, unassigned);
+	std::vector<uint32_t> chunkVertices;
+	std::vector<uint32_t> chunkFaces;
+
+	const auto gather = [&chunkVertices](const aiVector3D* source) -> aiVector3D*
+	{
+		if (!source)
+			return nullptr;
+
+		auto* destination = new aiVector3D[chunkVertices.size()];
+		for (size_t i = 0; i < chunkVertices.size(); i++)
+			destination[i] = source[chunkVertices[i]];
+		return destination;
+	};
+
+	const auto flush = [&]()
+	{
+		auto chunk = MakeUnique<aiMesh>();
+		chunk->mName = aiString(std::string(mesh.mName.C_Str()) + "#" + std::to_string(chunks.size()));
+		chunk->mMaterialIndex = mesh.mMaterialIndex;
+		chunk->mPrimitiveTypes = mesh.mPrimitiveTypes;
+		chunk->mNumVertices = static_cast<unsigned int>(chunkVertices.size());
+		chunk->mVertices = gather(mesh.mVertices);
+		chunk->mNormals = gather(mesh.mNormals);
+		chunk->mTangents = gather(mesh.mTangents);
+		chunk->mBitangents = gather(mesh.mBitangents);
+		chunk->mTextureCoords[0] = gather(mesh.mTextureCoords[0]);
+		chunk->mNumUVComponents[0] = mesh.mNumUVComponents[0];
+
+		chunk->mNumFaces = static_cast<unsigned int>(chunkFaces.size());
+		chunk->mFaces = new aiFace[chunkFaces.size()];
+		for (size_t i = 0; i < chunkFaces.size(); i++)
+		{
+			const auto& source = mesh.mFaces[chunkFaces[i]];
+			auto& face = chunk->mFaces[i];
+			face.mNumIndices = source.mNumIndices;
+			face.mIndices = new unsigned int[source.mNumIndices];
+			for (unsigned int j = 0; j < source.mNumIndices; j++)
+				face.mIndices[j] = remap[source.mIndices[j]];
+		}
+
+		for (auto vertex : chunkVertices)
+			remap[vertex] = unassigned;
+
+		chunkVertices.clear();
+		chunkFaces.clear();
+		chunks.emplace_back(std::move(chunk));
+	};
+
+	for (unsigned int i = 0; i < mesh.mNumFaces; i++)
+	{
+		const auto& face = mesh.mFaces[i];
+
+		uint32_t newVertices = 0;
+		for (unsigned int j = 0; j < face.mNumIndices; j++)
+			newVertices += remap[face.mIndices[j]] == unassigned;
+
+		if (chunkVertices.size() + newVertices > maxVertices)
+			flush();
+
+		for (unsigned int j = 0; j < face.mNumIndices; j++)
+		{
+			auto& local = remap[face.mIndices[j]];
+			if (local == unassigned)
+			{
+				local = static_cast<uint32_t>(chunkVertices.size());
+				chunkVertices.push_back(face.mIndices[j]);
+			}
+		}
+		chunkFaces.push_back(i);
+	}
+
+	if (!chunkFaces.empty())
+		flush();
+
+	return chunks;
+}
+
+void Mesh::AddIndexBuffer(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	if (vertexCount <= MaxShortIndexVertices)
+		Add<IndexBuffer>(Name + "IndexBufferModel", std::vector<uint16_t>(indices.begin(), indices.end()));
+	else
+		Add<IndexBuffer>(Name + "IndexBufferModel", indices);
+}
+
+void Mesh::BuildLevelsOfDetail(std::vector<uint32_t>& indices, const aiVector3D* positions, size_t vertexCount, const ImportSettings& settings)
+{
+	const size_t fullCount = indices.size();
+	LevelsOfDetail.push_back({ 0, static_cast<uint32_t>(fullCount), 0.0f });
+	LodThresholdPixels = settings.LodThresholdPixels;
+
+	// Every level is simplified from the full mesh, so its error is measured against the original surface
+	std::vector<uint32_t> level(fullCount);
+	std::vector<uint32_t> ordered(fullCount);
+	float ratio = 1.0f;
+	for (uint32_t i = 1; i < settings.LodLevels; i++)
+	{
+		ratio *= settings.LodReduction;
+		const size_t target = static_cast<size_t>(fullCount * ratio) / 3 * 3;
+		const size_t previousCount = LevelsOfDetail.back().IndexCount;
+
+		float error = 0.0f;
+		const size_t count = Simplifier::Simplify(level.data(), indices.data(), fullCount, &positions->x, sizeof(aiVector3D), vertexCount,
+												  target, settings.LodMaxError * BoundsRadius, &error);
+
+		// Stop once the error budget is spent and levels stop shrinking
+		if (count == 0 || count > previousCount * 9 / 10)
+			break;
+
+		MeshOptimizer::OptimizeVertexCache(ordered.data(), level.data(), count, vertexCount);
+
+		LevelsOfDetail.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(count),
+								   std::max(error, LevelsOfDetail.back().Error) });
+		indices.insert(indices.end(), ordered.begin(), ordered.begin() + count);
+	}
+}
+
+MeshOptimizer::VertexRemap Mesh::Optimize(const aiMesh& mesh, std::vector<uint32_t>& indices)
+{
+	const size_t vertexCount = mesh.mNumVertices;
+	VertexCacheBefore = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+	std::vector<uint32_t> cacheOrder(indices.size());
+	MeshOptimizer::OptimizeVertexCache(cacheOrder.data(), indices.data(), indices.size(), vertexCount);
+	MeshOptimizer::OptimizeOverdraw(indices.data(), cacheOrder.data(), cacheOrder.size(),
+									&mesh.mVertices[0].x, sizeof(aiVector3D), vertexCount);
+
+	auto remap = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+
+	VertexCacheAfter = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), remap.VertexCount);
+	return remap;
+}
+
 std::pair<const char*, const char*> Mesh::ResolveShaders() const
 {
 	const char* vertexName, * pixelName;
 
 	// Vertex Shader resolution
 	if (HasDiffuse && HasNormals)
-		vertexName = "PhongNormalLoadTexture";
+		vertexName = IsQuantized ? "PhongNormalLoadTextureQuantized" : "PhongNormalLoadTexture";
 	else if (HasDiffuse && !HasNormals)
-		vertexName = "PhongLoadTexture";
+		vertexName = IsQuantized ? "PhongLoadTextureQuantized" : "PhongLoadTexture";
 	else
-		vertexName = "Phong";
+		vertexName = IsQuantized ? "PhongQuantized" : "Phong";
 
 	// Pixel Shader resolution
 	if (HasDiffuse && HasNormals && HasSpecular)
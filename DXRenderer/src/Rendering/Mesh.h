@@ -3,7 +3,13 @@
 #include "Rendering/Buffer.h"
 #include "Rendering/Component.h"
 #include "Rendering/CurrentGraphicsContext.h"
+#include "Rendering/Culling.h"
+#include "Rendering/MeshOptimizer.h"
+#include "Rendering/Meshlets.h"
+#include "Rendering/Occlusion.h"
 #include "Rendering/Shader.h"
+#include "Rendering/Simplifier.h"
+#include "Rendering/TransformHierarchy.h"
 #include "Rendering/Utilities.h"
 #include "RenderGraph/RenderQueue.h"
 
@@ -15,18 +21,52 @@
 
 class Model;
 
+struct ImportSettings
+{
+	// Split meshes that do not fit 16-bit indices instead of switching them to 32-bit indices
+	bool SplitLargeMeshes = false;
+	// Octahedral normals and tangents, half-float texture coordinates
+	bool QuantizeAttributes = false;
+	// With QuantizeAttributes, also store positions as 16-bit offsets inside the mesh bounds
+	bool QuantizePositions = false;
+	// Reorder triangles for the post-transform cache and overdraw, vertices for fetch locality
+	bool OptimizeMeshes = true;
+	// Partition meshes into clusters that are frustum and backface culled on the CPU every frame
+	bool BuildMeshlets = true;
+
+	// Number of levels including the full mesh, each one aiming at LodReduction of the triangles of the previous
+	uint32_t LodLevels = 4;
+	float LodReduction = 0.5f;
+	// Largest simplification error relative to the mesh bounding radius
+	float LodMaxError = 0.05f;
+	// Projected error in pixels a level may have to be selected
+	float LodThresholdPixels = 1.0f;
+
+	// Simplified copy of opaque meshes rasterized on the CPU to occlusion cull the rest of the model
+	bool BuildOccluders = true;
+	uint32_t OccluderMaxTriangles = 256;
+
+	// Nodes of static models are not expected to move, the shadow pass caches them. Nodes moved from the GUI stop being static.
+	bool Static = true;
+};
+
 class PrimitiveComponent : public Component, public GPUObject
 {
 public:
-	PrimitiveComponent();
+	PrimitiveComponent(const TransformHierarchy& transforms, uint32_t node);
 
-	void SetTransform(DirectX::XMMATRIX transform);
 	DirectX::XMMATRIX GetTransform() const;
-	virtual void Tick(float delta) override;
+	const DirectX::XMFLOAT4X4* GetWorldMatrix() const override { return &GetWorld(); }
+	virtual float GetViewDepth() const override;
+	bool IsStatic() const override { return Transforms.IsStatic(TransformIndex); }
 
 protected:
-	DirectX::XMFLOAT4X4 Transform;
-	DirectX::XMFLOAT4X4 ModelView;
+	// Matrices of the owning node, updated by the model before it submits
+	const DirectX::XMFLOAT4X4A& GetWorld() const { return Transforms.GetWorld(TransformIndex); }
+	const DirectX::XMFLOAT4X4A& GetModelView() const { return Transforms.GetModelView(TransformIndex); }
+
+	const TransformHierarchy& Transforms;
+	uint32_t TransformIndex;
 
 private:
 	bool IsRootComponent = false;
@@ -35,14 +75,42 @@ private:
 class Mesh : public PrimitiveComponent
 {
 public:
-	Mesh(const aiMesh& mesh, const std::string& meshName);
-	Mesh(const aiMesh& mesh, const std::string& meshName, const aiMaterial* const* materials, const std::string& path);
+	Mesh(const aiMesh& mesh, const std::string& meshName, const TransformHierarchy& transforms, uint32_t node);
+	Mesh(const aiMesh& mesh, const std::string& meshName, const TransformHierarchy& transforms, uint32_t node,
+		 const aiMaterial* const* materials, const std::string& path, const ImportSettings& settings = {});
 
 	void Bind() const override;
 	void Submit(size_t channelsIn);
+	const std::vector<Meshlets::DrawRange>* GetDrawRanges(size_t channels) const override;
+	float GetViewDepth() const override;
+
+	// Follows the world matrix of the owning node
+	void UpdateWorldBounds();
+	const Culling::Box* GetWorldBounds() const override { return &WorldBounds; }
+
+	// Partitions mesh into chunks of at most maxVertices vertices each, faces kept in order
+	static std::vector<UniquePtr<aiMesh>> Split(const aiMesh& mesh, uint32_t maxVertices);
+
+	static constexpr uint32_t MaxShortIndexVertices = 65535;
+
+	const MeshOptimizer::Statistics& GetVertexCacheBefore() const { return VertexCacheBefore; }
+	const MeshOptimizer::Statistics& GetVertexCacheAfter() const { return VertexCacheAfter; }
+	const std::vector<Simplifier::LevelOfDetail>& GetLevelsOfDetail() const { return LevelsOfDetail; }
+	const Occlusion::Occluder& GetOccluder() const { return Occluder; }
 
 private:
+	void AddIndexBuffer(const std::vector<uint32_t>& indices, size_t vertexCount);
+	MeshOptimizer::VertexRemap Optimize(const aiMesh& mesh, std::vector<uint32_t>& indices);
 	std::pair<const char*, const char*> ResolveShaders() const;
+	void BuildLevelsOfDetail(std::vector<uint32_t>& indices, const aiVector3D* positions, size_t vertexCount, const ImportSettings& settings);
+	// The shadow map picks its level from the light, camera movement leaves cached shadow faces alone
+	size_t SelectLevelOfDetail(size_t channel) const;
+	size_t UpdateVisibleRanges(size_t channel);
+	inline bool DrawsRanges() const { return !Clusters.Empty() || LevelsOfDetail.size() > 1; }
+
+	std::vector<Meshlets::DrawRange>& GetVisibleRanges(size_t channel) { return VisibleRanges[channel == Channels::Shadow]; }
+	const std::vector<Meshlets::DrawRange>& GetVisibleRanges(size_t channel) const { return VisibleRanges[channel == Channels::Shadow]; }
+	size_t& GetCurrentLevel(size_t channel) { return CurrentLevels[channel == Channels::Shadow]; }
 
 private:
 	std::string Name;
@@ -52,6 +120,20 @@ private:
 	bool HasAlphaDiffuse = false;
 	bool HasNormals = false;
 	bool HasSpecular = false;
+	bool IsQuantized = false;
 
 	float Shininess = 2.0f;
+
+	MeshOptimizer::Statistics VertexCacheBefore;
+	MeshOptimizer::Statistics VertexCacheAfter;
+
+	Meshlets::ClusterTable Clusters;
+	std::vector<Simplifier::LevelOfDetail> LevelsOfDetail;
+	Occlusion::Occluder Occluder;
+	Culling::Box LocalBounds;
+	Culling::Box WorldBounds;
+	float BoundsRadius = 0.0f;
+	float LodThresholdPixels = 1.0f;
+	std::array<size_t, 2> CurrentLevels{};
+	std::array<std::vector<Meshlets::DrawRange>, 2> VisibleRanges;
 };
\ No newline at end of file
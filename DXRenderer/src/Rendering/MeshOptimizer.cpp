@@ -0,0 +1,329 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace MeshOptimizer
+{
+	namespace
+	{
+		constexpr uint32_t Unused = ~0u;
+
+		// Forsyth scoring parameters
+		constexpr int MaxCacheSize = 32;
+		constexpr float CacheDecayPower = 1.5f;
+		constexpr float LastTriangleScore = 0.75f;
+		constexpr float ValenceBoostScale = 2.0f;
+		constexpr float ValenceBoostPower = 0.5f;
+
+		float VertexScore(int cachePosition, uint32_t remainingTriangles)
+		{
+			if (remainingTriangles == 0)
+				return -1.0f;
+
+			float score = 0.0f;
+			if (cachePosition >= 0)
+			{
+				if (cachePosition < 3)
+					score = LastTriangleScore;
+				else
+				{
+					const float scaler = 1.0f / (MaxCacheSize - 3);
+					score = std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+				}
+			}
+
+			return score + ValenceBoostScale * std::pow(float(remainingTriangles), -ValenceBoostPower);
+		}
+
+		class FifoCache
+		{
+		public:
+			FifoCache(size_t vertexCount, uint32_t size)
+				:Timestamps(vertexCount, 0), Size(size)
+			{}
+
+			// Returns true on a miss
+			bool Access(uint32_t vertex)
+			{
+				if (Timestamps[vertex] && Time - Timestamps[vertex] < Size)
+					return false;
+
+				Timestamps[vertex] = ++Time;
+				return true;
+			}
+
+		private:
+			std::vector<uint32_t> Timestamps;
+			uint32_t Size;
+			uint32_t Time = 0;
+		};
+	}
+
+	Statistics& Statistics::operator+=(const Statistics& other)
+	{
+		Triangles += other.Triangles;
+		Vertices += other.Vertices;
+		Transforms += other.Transforms;
+		return *this;
+	}
+
+	Statistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+	{
+		Statistics stats;
+		stats.Triangles = indexCount / 3;
+
+		std::vector<bool> used(vertexCount, false);
+		FifoCache cache(vertexCount, cacheSize);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			stats.Transforms += cache.Access(indices[i]);
+			if (!used[indices[i]])
+			{
+				used[indices[i]] = true;
+				stats.Vertices++;
+			}
+		}
+
+		return stats;
+	}
+
+	void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+	{
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+			return;
+
+		// Vertex to triangle adjacency
+		std::vector<uint32_t> valence(vertexCount, 0);
+		for (size_t i = 0; i < indexCount; i++)
+			valence[indices[i]]++;
+
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+			offsets[v + 1] = offsets[v] + valence[v];
+
+		std::vector<uint32_t> adjacency(indexCount);
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indexCount; i++)
+				adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::vector<uint32_t> remaining = valence;
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			vertexScores[v] = VertexScore(-1, remaining[v]);
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+		for (size_t t = 0; t < triangleCount; t++)
+			triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> nextCache;
+		cache.reserve(MaxCacheSize + 3);
+		nextCache.reserve(MaxCacheSize + 3);
+
+		size_t fallbackCursor = 0;
+		uint32_t best = static_cast<uint32_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+		for (size_t output = 0; output < triangleCount; output++)
+		{
+			if (best == Unused)
+			{
+				// Cache holds no useful vertices, take the next triangle not emitted yet
+				while (emitted[fallbackCursor])
+					fallbackCursor++;
+				best = static_cast<uint32_t>(fallbackCursor);
+			}
+
+			const uint32_t* triangle = indices + best * 3;
+			std::copy(triangle, triangle + 3, destination + output * 3);
+			emitted[best] = true;
+
+			for (int k = 0; k < 3; k++)
+			{
+				const uint32_t v = triangle[k];
+				auto* begin = adjacency.data() + offsets[v];
+				auto* end = begin + remaining[v];
+				std::iter_swap(std::find(begin, end, best), end - 1);
+				remaining[v]--;
+			}
+
+			// Move the triangle's vertices to the front of the LRU cache
+			nextCache.assign(triangle, triangle + 3);
+			for (auto v : cache)
+			{
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+					nextCache.push_back(v);
+			}
+			for (size_t i = MaxCacheSize; i < nextCache.size(); i++)
+				cachePosition[nextCache[i]] = -1;
+			if (nextCache.size() > MaxCacheSize)
+				nextCache.resize(MaxCacheSize);
+			std::swap(cache, nextCache);
+
+			// Rescore cached vertices and their remaining triangles
+			for (size_t i = 0; i < cache.size(); i++)
+			{
+				const uint32_t v = cache[i];
+				cachePosition[v] = static_cast<int>(i);
+				const float score = VertexScore(cachePosition[v], remaining[v]);
+				const float delta = score - vertexScores[v];
+				vertexScores[v] = score;
+
+				for (uint32_t j = 0; j < remaining[v]; j++)
+					triangleScores[adjacency[offsets[v] + j]] += delta;
+			}
+
+			best = Unused;
+			float bestScore = -1.0f;
+			for (auto v : cache)
+			{
+				for (uint32_t j = 0; j < remaining[v]; j++)
+				{
+					const uint32_t t = adjacency[offsets[v] + j];
+					if (triangleScores[t] > bestScore)
+					{
+						bestScore = triangleScores[t];
+						best = t;
+					}
+				}
+			}
+		}
+	}
+
+	void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+						  const float* positions, size_t positionStride, size_t vertexCount, float threshold)
+	{
+		const size_t triangleCount = indexCount / 3;
+		std::copy(indices, indices + indexCount, destination);
+		if (triangleCount < 2)
+			return;
+
+		const auto position = [positions, positionStride](uint32_t v)
+		{
+			return reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + v * positionStride);
+		};
+
+		// Cluster boundaries where the cache restarts (a triangle missing on all vertices)
+		std::vector<uint32_t> clusters;
+		{
+			FifoCache cache(vertexCount, 16);
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				int misses = 0;
+				for (int k = 0; k < 3; k++)
+					misses += cache.Access(indices[t * 3 + k]);
+
+				if (misses == 3)
+					clusters.push_back(static_cast<uint32_t>(t));
+			}
+		}
+		if (clusters.size() < 2)
+			return;
+		clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+		float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			const float* p = position(indices[i]);
+			for (int k = 0; k < 3; k++)
+				meshCentroid[k] += p[k];
+		}
+		for (float& c : meshCentroid)
+			c /= float(indexCount);
+
+		// Outward facing clusters far from the center occlude the rest of the mesh
+		const size_t clusterCount = clusters.size() - 1;
+		std::vector<float> sortKeys(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			float centroid[3] = { 0.0f, 0.0f, 0.0f };
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+			float area = 0.0f;
+
+			for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++)
+			{
+				const float* p0 = position(indices[t * 3]);
+				const float* p1 = position(indices[t * 3 + 1]);
+				const float* p2 = position(indices[t * 3 + 2]);
+
+				const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				const float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+				for (int k = 0; k < 3; k++)
+				{
+					centroid[k] += (p0[k] + p1[k] + p2[k]) * (triangleArea / 3.0f);
+					normal[k] += n[k];
+				}
+				area += triangleArea;
+			}
+
+			const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (area == 0.0f || normalLength == 0.0f)
+			{
+				sortKeys[c] = 0.0f;
+				continue;
+			}
+
+			float key = 0.0f;
+			for (int k = 0; k < 3; k++)
+				key += (centroid[k] / area - meshCentroid[k]) * (normal[k] / normalLength);
+			sortKeys[c] = key;
+		}
+
+		std::vector<uint32_t> order(clusterCount);
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		size_t offset = 0;
+		for (auto c : order)
+		{
+			const size_t count = (clusters[c + 1] - clusters[c]) * 3;
+			std::copy(indices + clusters[c] * 3, indices + clusters[c] * 3 + count, destination + offset);
+			offset += count;
+		}
+
+		const float before = AnalyzeVertexCache(indices, indexCount, vertexCount).GetACMR();
+		const float after = AnalyzeVertexCache(destination, indexCount, vertexCount).GetACMR();
+		if (after > before * threshold)
+			std::copy(indices, indices + indexCount, destination);
+	}
+
+	VertexRemap OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount)
+	{
+		VertexRemap remap;
+		remap.Table.assign(vertexCount, Unused);
+
+		uint32_t next = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			auto& target = remap.Table[indices[i]];
+			if (target == Unused)
+				target = next++;
+			indices[i] = target;
+		}
+
+		remap.VertexCount = next;
+		return remap;
+	}
+
+	void RemapVertexBuffer(void* destination, const void* source, size_t vertexCount, size_t stride, const uint32_t* remap)
+	{
+		auto* dst = static_cast<char*>(destination);
+		const auto* src = static_cast<const char*>(source);
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			if (remap[i] != Unused)
+				std::memcpy(dst + remap[i] * stride, src + i * stride, stride);
+		}
+	}
+}
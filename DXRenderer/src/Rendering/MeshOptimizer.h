@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Index and vertex reordering for imported meshes. All functions work on 32-bit triangle lists
+// and leave narrowing to the caller.
+namespace MeshOptimizer
+{
+	struct Statistics
+	{
+		size_t Triangles = 0;
+		size_t Vertices = 0;
+		size_t Transforms = 0;
+
+		// Average cache miss ratio: vertex shader invocations per triangle
+		float GetACMR() const { return Triangles ? float(Transforms) / float(Triangles) : 0.0f; }
+		// Average transform to vertex ratio: 1.0 means every vertex is shaded exactly once
+		float GetATVR() const { return Vertices ? float(Transforms) / float(Vertices) : 0.0f; }
+
+		Statistics& operator+=(const Statistics& other);
+	};
+
+	// Simulates a FIFO post-transform cache of the given size
+	Statistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+	// Forsyth's linear-speed vertex cache optimization. destination may not alias indices.
+	void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	// Splits the cache optimized order into clusters at cache restarts and draws outward facing
+	// clusters first. Falls back to the input order if ACMR grows by more than threshold.
+	void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+						  const float* positions, size_t positionStride, size_t vertexCount, float threshold = 1.05f);
+
+	struct VertexRemap
+	{
+		// New position of every source vertex, ~0u for vertices never referenced
+		std::vector<uint32_t> Table;
+		size_t VertexCount = 0;
+	};
+
+	// Orders vertices by first use and rewrites indices in place
+	VertexRemap OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	// destination[remap[i]] = source[i] for every referenced vertex of the given stride
+	void RemapVertexBuffer(void* destination, const void* source, size_t vertexCount, size_t stride, const uint32_t* remap);
+}
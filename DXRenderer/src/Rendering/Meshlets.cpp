@@ -0,0 +1,209 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Meshlets
+{
+	namespace
+	{
+		void AppendCluster(ClusterTable& table, const uint32_t* indices, size_t first, size_t count,
+						   const float* positions, size_t positionStride)
+		{
+			const auto position = [positions, positionStride](uint32_t v)
+			{
+				return reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + v * positionStride);
+			};
+
+			float min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+			float max[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+			for (size_t i = first; i < first + count; i++)
+			{
+				const float* p = position(indices[i]);
+				for (int k = 0; k < 3; k++)
+				{
+					min[k] = std::min(min[k], p[k]);
+					max[k] = std::max(max[k], p[k]);
+				}
+			}
+
+			const float center[3] = { (min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f };
+			float radiusSq = 0.0f;
+			for (size_t i = first; i < first + count; i++)
+			{
+				const float* p = position(indices[i]);
+				const float d[3] = { p[0] - center[0], p[1] - center[1], p[2] - center[2] };
+				radiusSq = std::max(radiusSq, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+			}
+
+			// Cone axis is the average of the triangle normals, cutoff from the widest deviation
+			std::vector<float> normals;
+			normals.reserve(count);
+			float axis[3] = { 0.0f, 0.0f, 0.0f };
+			for (size_t i = first; i < first + count; i += 3)
+			{
+				const float* p0 = position(indices[i]);
+				const float* p1 = position(indices[i + 1]);
+				const float* p2 = position(indices[i + 2]);
+
+				const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				if (length == 0.0f)
+					continue;
+
+				for (int k = 0; k < 3; k++)
+				{
+					n[k] /= length;
+					axis[k] += n[k];
+					normals.push_back(n[k]);
+				}
+			}
+
+			float cutoff = 1.0f;
+			const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+			if (axisLength > 0.0f && !normals.empty())
+			{
+				for (float& a : axis)
+					a /= axisLength;
+
+				float minDot = 1.0f;
+				for (size_t i = 0; i < normals.size(); i += 3)
+					minDot = std::min(minDot, normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]);
+
+				// Cones wider than a hemisphere can never be rejected
+				if (minDot > 0.0f)
+					cutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+
+			table.IndexOffset.push_back(static_cast<uint32_t>(first));
+			table.IndexCount.push_back(static_cast<uint32_t>(count));
+			table.CenterX.push_back(center[0]);
+			table.CenterY.push_back(center[1]);
+			table.CenterZ.push_back(center[2]);
+			table.Radius.push_back(std::sqrt(radiusSq));
+			table.MinX.push_back(min[0]);
+			table.MinY.push_back(min[1]);
+			table.MinZ.push_back(min[2]);
+			table.MaxX.push_back(max[0]);
+			table.MaxY.push_back(max[1]);
+			table.MaxZ.push_back(max[2]);
+			table.ConeAxisX.push_back(axis[0]);
+			table.ConeAxisY.push_back(axis[1]);
+			table.ConeAxisZ.push_back(axis[2]);
+			table.ConeCutoff.push_back(cutoff);
+		}
+	}
+
+	ClusterTable Build(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount,
+					   uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		ClusterTable table;
+
+		std::vector<uint32_t> marker(vertexCount, ~0u);
+		uint32_t clusterId = 0;
+		uint32_t vertices = 0;
+		size_t first = 0;
+
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			uint32_t newVertices = 0;
+			for (int k = 0; k < 3; k++)
+				newVertices += marker[indices[i + k]] != clusterId;
+
+			const size_t triangles = (i - first) / 3;
+			if (vertices + newVertices > maxVertices || triangles + 1 > maxTriangles)
+			{
+				AppendCluster(table, indices, first, i - first, positions, positionStride);
+				first = i;
+				vertices = 0;
+				clusterId++;
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				if (marker[indices[i + k]] != clusterId)
+				{
+					marker[indices[i + k]] = clusterId;
+					vertices++;
+				}
+			}
+		}
+
+		if (first < indexCount)
+			AppendCluster(table, indices, first, indexCount - first, positions, positionStride);
+
+		return table;
+	}
+
+	size_t Cull(const ClusterTable& clusters, const CullParameters& parameters, std::vector<DrawRange>& ranges)
+	{
+		size_t visible = 0;
+		for (size_t i = 0; i < clusters.Size(); i++)
+		{
+			const float x = clusters.CenterX[i];
+			const float y = clusters.CenterY[i];
+			const float z = clusters.CenterZ[i];
+			const float radius = clusters.Radius[i];
+
+			bool inside = true;
+			for (uint32_t p = 0; p < parameters.PlaneCount && inside; p++)
+			{
+				const float* plane = parameters.Planes[p];
+				inside = plane[0] * x + plane[1] * y + plane[2] * z + plane[3] >= -radius;
+			}
+			if (!inside)
+				continue;
+
+			if (parameters.CullBackfacing)
+			{
+				const float d[3] = { x - parameters.Viewer[0], y - parameters.Viewer[1], z - parameters.Viewer[2] };
+				const float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+				const float dot = d[0] * clusters.ConeAxisX[i] + d[1] * clusters.ConeAxisY[i] + d[2] * clusters.ConeAxisZ[i];
+				if (dot >= clusters.ConeCutoff[i] * distance + radius)
+					continue;
+			}
+
+			visible++;
+			const uint32_t offset = clusters.IndexOffset[i];
+			const uint32_t count = clusters.IndexCount[i];
+			if (!ranges.empty() && ranges.back().IndexOffset + ranges.back().IndexCount == offset)
+				ranges.back().IndexCount += count;
+			else
+				ranges.push_back({ offset, count });
+		}
+
+		return visible;
+	}
+
+	void ExtractFrustumPlanes(const float m[4][4], CullParameters& parameters)
+	{
+		const auto column = [&m](int c, int r) { return m[r][c]; };
+		const auto set = [&](int index, int sign, int c)
+		{
+			for (int r = 0; r < 4; r++)
+				parameters.Planes[index][r] = column(3, r) + sign * column(c, r);
+		};
+
+		set(0, 1, 0);   // left
+		set(1, -1, 0);  // right
+		set(2, 1, 1);   // bottom
+		set(3, -1, 1);  // top
+		set(4, -1, 2);  // far
+		for (int r = 0; r < 4; r++)
+			parameters.Planes[5][r] = column(2, r); // near, depth in [0, w]
+
+		for (auto& plane : parameters.Planes)
+		{
+			const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			if (length > 0.0f)
+			{
+				for (float& component : plane)
+					component /= length;
+			}
+		}
+		parameters.PlaneCount = 6;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Partitioning of a triangle list into small clusters that can be culled individually.
+// Clusters are contiguous ranges of the index buffer, so a visible set is drawn with
+// plain DrawIndexed calls.
+namespace Meshlets
+{
+	inline constexpr uint32_t MaxVertices = 64;
+	inline constexpr uint32_t MaxTriangles = 124;
+
+	struct DrawRange
+	{
+		uint32_t IndexOffset;
+		uint32_t IndexCount;
+	};
+
+	// Structure of arrays side table, one entry per cluster
+	struct ClusterTable
+	{
+		std::vector<uint32_t> IndexOffset;
+		std::vector<uint32_t> IndexCount;
+
+		// Bounding sphere
+		std::vector<float> CenterX, CenterY, CenterZ, Radius;
+		// Axis aligned box
+		std::vector<float> MinX, MinY, MinZ;
+		std::vector<float> MaxX, MaxY, MaxZ;
+		// Normal cone; a cluster is back facing when dot(center - viewer, axis) >= cutoff * |center - viewer| + radius
+		std::vector<float> ConeAxisX, ConeAxisY, ConeAxisZ, ConeCutoff;
+
+		size_t Size() const { return IndexOffset.size(); }
+		bool Empty() const { return IndexOffset.empty(); }
+	};
+
+	struct CullParameters
+	{
+		// Planes as (a, b, c, d) with inside where a*x + b*y + c*z + d >= 0
+		float Planes[6][4]{};
+		uint32_t PlaneCount = 0;
+
+		float Viewer[3]{};
+		bool CullBackfacing = false;
+	};
+
+	// Splits the index buffer in order, so a cache optimized order yields spatially coherent clusters
+	ClusterTable Build(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount,
+					   uint32_t maxVertices = MaxVertices, uint32_t maxTriangles = MaxTriangles);
+
+	// Appends the visible clusters to ranges, merging neighbours into a single range.
+	// Returns the number of visible clusters.
+	size_t Cull(const ClusterTable& clusters, const CullParameters& parameters, std::vector<DrawRange>& ranges);
+
+	// Extracts frustum planes from a row-vector (v * M) clip transform with D3D depth range
+	void ExtractFrustumPlanes(const float matrix[4][4], CullParameters& parameters);
+}
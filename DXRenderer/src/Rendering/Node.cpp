@@ -4,44 +4,34 @@
 #include "Rendering/Material.h"
 #include "Rendering/State.h"
 
+#include <algorithm>
+
+namespace
+{
+	size_t CountNodes(const aiNode& node)
+	{
+		size_t count = 1;
+		for (size_t i = 0; i < node.mNumChildren; i++)
+			count += CountNodes(*node.mChildren[i]);
+		return count;
+	}
+}
 
 class NodeInternal : public NodeBase
 {
 public:
 	NodeInternal(Model& actor, const std::string& name = "Unknown")
 		:NodeBase(actor, name)
-	{
-		DirectX::XMStoreFloat4x4(&Transform, DirectX::XMMatrixIdentity());
-		DirectX::XMStoreFloat4x4(&RelativeTransform, DirectX::XMMatrixIdentity());
-	}
-
-	void SetTransform(DirectX::XMMATRIX transform) override
-	{
-		DirectX::XMStoreFloat4x4(&Transform, transform);
-	}
-
-	DirectX::XMMATRIX GetTransform() const override
-	{
-		return DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(&Transform));
-	}
+	{}
 
 	virtual void SetRelativeTransform(DirectX::XMMATRIX transform)
 	{
-		DirectX::XMStoreFloat4x4(&RelativeTransform, transform);
+		Owner.Transforms.SetLocal(TransformIndex, transform);
 	}
 
 	DirectX::XMMATRIX GetRelativeTransform() const
 	{
-		return DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(&RelativeTransform));
-	}
-
-	void Submit(size_t channelsIn)
-	{
-		for (auto* mesh : Meshes)
-			mesh->Submit(channelsIn);
-
-		for (auto& child : Children)
-			child->Submit(channelsIn);
+		return Owner.Transforms.GetLocal(TransformIndex);
 	}
 
 	void SetupChild(UniquePtr<NodeInternal> child)
@@ -53,7 +43,9 @@ public:
 
 	void GUITransform() override
 	{
-		glm::mat transform = *reinterpret_cast<const glm::mat4x4*>(&RelativeTransform);
+		DirectX::XMFLOAT4X4 relativeTransform;
+		DirectX::XMStoreFloat4x4(&relativeTransform, GetRelativeTransform());
+		glm::mat transform = *reinterpret_cast<const glm::mat4x4*>(&relativeTransform);
 
 		glm::vec3 translate(transform[3]);
 		translate.x *= -1;
@@ -75,26 +67,26 @@ public:
 
 		ImGui::NextColumn();
 		ImGui::Text("Orientation (Relative)");
-		ImGui::SliderAngle("Roll", &roll, -180.0f, 180.0f);
-		ImGui::SliderAngle("Pitch", &pitch, -180.0f, 180.0f);
-		ImGui::SliderAngle("Yaw", &yaw, -180.0f, 180.0f);
+		bool moved = ImGui::SliderAngle("Roll", &roll, -180.0f, 180.0f);
+		moved |= ImGui::SliderAngle("Pitch", &pitch, -180.0f, 180.0f);
+		moved |= ImGui::SliderAngle("Yaw", &yaw, -180.0f, 180.0f);
 
 		ImGui::Text("Position (Relative)");
-		ImGui::SliderFloat("X", &x, -20.0f, 20.0f);
-		ImGui::SliderFloat("Y", &y, -20.0f, 20.0f);
-		ImGui::SliderFloat("Z", &z, -20.0f, 20.0f);
+		moved |= ImGui::SliderFloat("X", &x, -20.0f, 20.0f);
+		moved |= ImGui::SliderFloat("Y", &y, -20.0f, 20.0f);
+		moved |= ImGui::SliderFloat("Z", &z, -20.0f, 20.0f);
 
 		DirectX::XMMATRIX newTransform =
 			DirectX::XMMatrixRotationRollPitchYaw(-pitch, -yaw, roll) * DirectX::XMMatrixTranslation(-x, -y, z);
 		SetRelativeTransform(newTransform);
+
+		if (moved)
+			Owner.Transforms.SetStatic(TransformIndex, false);
 	}
 
 private:
 	const NodeBase* Parent = nullptr;
 
-	DirectX::XMFLOAT4X4 Transform;
-	DirectX::XMFLOAT4X4 RelativeTransform;
-
 	friend class Node;
 };
 
@@ -103,25 +95,6 @@ Node::Node(Model& actor, const std::string& name)
 	:NodeBase(actor, name)
 {}
 
-inline void Node::SetTransform(DirectX::XMMATRIX transform)
-{
-	const_cast<DirectX::XMMATRIX&>(Owner.Transform.GetMatrix()) = transform;
-}
-
-inline DirectX::XMMATRIX Node::GetTransform() const
-{
-	return Owner.GetTransform();
-}
-
-void Node::Submit(size_t channelsIn)
-{
-	for (auto* mesh : Meshes)
-		mesh->Submit(channelsIn);
-
-	for (auto& child : Children)
-		child->Submit(channelsIn);
-}
-
 void Node::ShowTree()
 {
 	int trackedIndex = 0;
@@ -149,19 +122,14 @@ UniquePtr<Node> Node::Build(Model& actor, const std::string& filename)
 	auto& node = *scene->mRootNode;
 	UniquePtr<Node> customNode = MakeUnique<Node>(actor, node.mName.C_Str());
 
-	std::vector<Mesh*> meshes;
-
-	for (size_t i = 0; i < node.mNumMeshes; i++)
-	{
-		const auto index = node.mMeshes[i];
-		const auto& mesh = *scene->mMeshes[index];
-		materials ? meshes.emplace_back(new Mesh(mesh, mesh.mName.C_Str(), materials, customNode->Owner.GetPath())) :
-			meshes.emplace_back(new Mesh(mesh, mesh.mName.C_Str()));
-	}
+	// Meshes reference the matrices of their node, so the arrays are sized before any of them is built
+	actor.Transforms.Reset(CountNodes(node));
+	customNode->TransformIndex = actor.Transforms.Add(TransformHierarchy::NoParent, DirectX::XMMatrixIdentity(),
+													  actor.GetImportSettings().Static);
 
-	customNode->Meshes = std::move(meshes);
+	customNode->Meshes = BuildMeshes(*scene, node, materials, customNode->Owner, customNode->TransformIndex);
 	for (size_t i = 0; i < node.mNumChildren; i++)
-		customNode->SetupChild(BuildImpl(*scene, *node.mChildren[i], materials, customNode->Owner));
+		customNode->SetupChild(BuildImpl(*scene, *node.mChildren[i], materials, customNode->Owner, customNode->TransformIndex));
 
 	return std::move(customNode);
 }
@@ -185,14 +153,17 @@ inline void Node::GUITransform()
 
 	ImGui::NextColumn();
 	ImGui::Text("Orientation");
-	ImGui::SliderAngle("Roll", &roll, -180.0f, 180.0f);
-	ImGui::SliderAngle("Pitch", &pitch, -180.0f, 180.0f);
-	ImGui::SliderAngle("Yaw", &yaw, -180.0f, 180.0f);
+	bool moved = ImGui::SliderAngle("Roll", &roll, -180.0f, 180.0f);
+	moved |= ImGui::SliderAngle("Pitch", &pitch, -180.0f, 180.0f);
+	moved |= ImGui::SliderAngle("Yaw", &yaw, -180.0f, 180.0f);
 
 	ImGui::Text("Position");
-	ImGui::SliderFloat("X", &x, -20.0f, 20.0f);
-	ImGui::SliderFloat("Y", &y, -20.0f, 20.0f);
-	ImGui::SliderFloat("Z", &z, -20.0f, 20.0f);
+	moved |= ImGui::SliderFloat("X", &x, -20.0f, 20.0f);
+	moved |= ImGui::SliderFloat("Y", &y, -20.0f, 20.0f);
+	moved |= ImGui::SliderFloat("Z", &z, -20.0f, 20.0f);
+
+	if (moved)
+		Owner.Transforms.SetStatic(TransformIndex, false);
 
 	Owner.X = x;
 	Owner.Y = y;
@@ -207,55 +178,83 @@ inline void Node::GUITransform()
 	Owner.Yaw = yaw;
 }
 
-inline UniquePtr<NodeInternal> Node::BuildImpl(const aiScene& scene, const aiNode& node, const aiMaterial* const* materials, Model& owner)
+inline UniquePtr<NodeInternal> Node::BuildImpl(const aiScene& scene, const aiNode& node, const aiMaterial* const* materials, Model& owner,
+												 uint32_t parent)
 {
+	// Added before the children, so the hierarchy ends up in depth first order with parents first
 	const auto relativeTransform = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(&node.mTransformation));
+	UniquePtr<NodeInternal> customNode = MakeUnique<NodeInternal>(owner, node.mName.C_Str());
+	customNode->TransformIndex = owner.Transforms.Add(parent, relativeTransform, owner.GetImportSettings().Static);
+	customNode->Meshes = BuildMeshes(scene, node, materials, owner, customNode->TransformIndex);
+
+	for (size_t i = 0; i < node.mNumChildren; i++)
+		customNode->SetupChild(BuildImpl(scene, *node.mChildren[i], materials, owner, customNode->TransformIndex));
+
+	return std::move(customNode);
+}
+
+std::vector<Mesh*> Node::BuildMeshes(const aiScene& scene, const aiNode& node, const aiMaterial* const* materials, Model& owner,
+									 uint32_t transformIndex)
+{
 	std::vector<Mesh*> meshes;
 
+	const auto emplace = [&](const aiMesh& mesh)
+	{
+		materials ? meshes.emplace_back(new Mesh(mesh, mesh.mName.C_Str(), owner.Transforms, transformIndex, materials, owner.GetPath(),
+												 owner.GetImportSettings())) :
+			meshes.emplace_back(new Mesh(mesh, mesh.mName.C_Str(), owner.Transforms, transformIndex));
+		owner.VertexCacheBefore += meshes.back()->GetVertexCacheBefore();
+		owner.VertexCacheAfter += meshes.back()->GetVertexCacheAfter();
+
+		// Meshes that ran out of levels keep contributing their coarsest one
+		const auto& levels = meshes.back()->GetLevelsOfDetail();
+		if (!levels.empty())
+		{
+			owner.LevelStatistics.resize(owner.GetImportSettings().LodLevels);
+			for (size_t i = 0; i < owner.LevelStatistics.size(); i++)
+			{
+				const auto& level = levels[std::min(i, levels.size() - 1)];
+				owner.LevelStatistics[i] += { level.IndexCount / 3, level.Error };
+			}
+		}
+	};
+
 	for (size_t i = 0; i < node.mNumMeshes; i++)
 	{
 		const auto index = node.mMeshes[i];
 		const auto& mesh = *scene.mMeshes[index];
-		materials ? meshes.emplace_back(new Mesh(mesh, mesh.mName.C_Str(), materials, owner.GetPath())) :
-			meshes.emplace_back(new Mesh(mesh, mesh.mName.C_Str()));
-	}
 
-	UniquePtr<NodeInternal> customNode = MakeUnique<NodeInternal>(owner, node.mName.C_Str());
-	customNode->SetRelativeTransform(relativeTransform);
-	customNode->Meshes = std::move(meshes);
-
-	for (size_t i = 0; i < node.mNumChildren; i++)
-		customNode->SetupChild(BuildImpl(scene, *node.mChildren[i], materials, owner));
+		if (owner.GetImportSettings().SplitLargeMeshes && mesh.mNumVertices > Mesh::MaxShortIndexVertices)
+		{
+			for (const auto& chunk : Mesh::Split(mesh, Mesh::MaxShortIndexVertices))
+				emplace(*chunk);
+		}
+		else
+			emplace(mesh);
+	}
 
-	return std::move(customNode);
+	return meshes;
 }
 
 NodeBase::NodeBase(Model& owner, const std::string& name)
 	:Name(name), Owner(owner), Children{}, Meshes{}
 {}
 
-void NodeBase::Tick(float delta)
+void NodeBase::LinkTechniques()
 {
 	for (auto* mesh : Meshes)
-	{
-		mesh->SetTransform(GetTransform());
-		mesh->Tick(delta);
-	}
+		mesh->LinkTechniques();
 
 	for (auto& child : Children)
-	{
-		child->SetTransform(GetTransform() * child->GetRelativeTransform());
-		child->Tick(delta);
-	}
+		child->LinkTechniques();
 }
 
-void NodeBase::LinkTechniques()
+void NodeBase::CollectMeshes(std::vector<Mesh*>& meshes) const
 {
-	for (auto* mesh : Meshes)
-		mesh->LinkTechniques();
+	meshes.insert(meshes.end(), Meshes.begin(), Meshes.end());
 
-	for (auto& child : Children)
-		child->LinkTechniques();
+	for (const auto& child : Children)
+		child->CollectMeshes(meshes);
 }
 
 inline void NodeBase::ShowTree(int& trackedIndex, std::optional<int>& selectedIndex, NodeBase*& selectedNode) const
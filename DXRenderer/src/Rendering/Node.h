@@ -17,13 +17,10 @@ public:
 	NodeBase(Model& owner, const std::string& name);
 	virtual ~NodeBase() = default;
 
-	virtual void SetTransform(DirectX::XMMATRIX transform) = 0;
-
-	virtual DirectX::XMMATRIX GetTransform() const = 0;
-
 	virtual void GUITransform() = 0;
-	void Tick(float delta);
 	void LinkTechniques();
+	// Meshes of the subtree, in the order a depth first walk visits them
+	void CollectMeshes(std::vector<Mesh*>& meshes) const;
 
 protected:
 	void ShowTree(int& trackedIndex, std::optional<int>& selectedIndex, NodeBase*& selectedNode) const;
@@ -34,6 +31,8 @@ protected:
 
 	std::string Name;
 	Model& Owner;
+	// Matrices of the node in the owner's TransformHierarchy
+	uint32_t TransformIndex = 0;
 };
 
 class Node : public NodeBase
@@ -42,13 +41,8 @@ public:
 
 	Node(Model& actor, const std::string& name = "Unknown");
 
-	void SetTransform(DirectX::XMMATRIX transform) override;
-
-	DirectX::XMMATRIX GetTransform() const override;
 	//void SetupAttachment(Node* parent);
 
-	void Submit(size_t channelsIn);
-
 	void ShowTree();
 
 	static UniquePtr<Node> Build(Model& actor, const std::string& filename);
@@ -58,7 +52,9 @@ private:
 	void GUITransform() override;
 
 	static UniquePtr<class NodeInternal> BuildImpl(const aiScene& scene, const aiNode& node, const aiMaterial* const* materials,
-												   Model& owner);
+												   Model& owner, uint32_t parent);
+	static std::vector<Mesh*> BuildMeshes(const aiScene& scene, const aiNode& node, const aiMaterial* const* materials,
+										  Model& owner, uint32_t transformIndex);
 
 private:
 	std::optional<int> SelectedIndex;
@@ -0,0 +1,56 @@
+#include "DeviceBackend.h"
+
+void NullBackend::BeginFrame()
+{
+	Tracker.Invalidate();
+}
+
+void NullBackend::Submit(const CommandList& list)
+{
+	for (const Command& command : list.GetCommands())
+	{
+		Commands++;
+		switch (command.CommandType)
+		{
+		case Command::Type::SetVertexBuffer:
+			Tracker.SetVertexBuffer(0, command.Resource, command.Values[0], 0);
+			Tracker.SetTopology(command.Values[1]);
+			break;
+		case Command::Type::SetIndexBuffer:
+			Tracker.SetIndexBuffer(command.Resource, command.Values[0], 0);
+			break;
+		case Command::Type::SetInputLayout:
+			Tracker.SetInputLayout(command.Resource);
+			break;
+		case Command::Type::SetVertexShader:
+			Tracker.SetShader(StateTracker::VertexStage, command.Resource);
+			break;
+		case Command::Type::SetPixelShader:
+			Tracker.SetShader(StateTracker::PixelStage, command.Resource);
+			break;
+		case Command::Type::VSSetConstantBuffer:
+			Tracker.SetConstantBuffer(StateTracker::VertexStage, command.Values[0], command.Resource);
+			break;
+		case Command::Type::PSSetConstantBuffer:
+			Tracker.SetConstantBuffer(StateTracker::PixelStage, command.Values[0], command.Resource);
+			break;
+		case Command::Type::PSSetShaderResource:
+			Tracker.SetShaderResource(StateTracker::PixelStage, command.Values[0], command.Resource);
+			break;
+		case Command::Type::PSSetSampler:
+			Tracker.SetSampler(StateTracker::PixelStage, command.Values[0], command.Resource);
+			break;
+		case Command::Type::DrawIndexed:
+			Draws++;
+			Indices += command.Values[0];
+			break;
+		case Command::Type::DrawIndexedInstanced:
+			Draws++;
+			Indices += static_cast<size_t>(command.Values[0]) * command.Values[1];
+			break;
+		case Command::Type::Callback:
+			SkippedCallbacks++;
+			break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "Occlusion.h"
+#include "Simplifier.h"
+#include "Core/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Occlusion
+{
+	namespace
+	{
+		// Screen x, y, depth and clip w of every vertex of the occluder being set up
+		thread_local std::vector<float> Projected;
+
+		const float* GetPosition(const float* positions, size_t stride, size_t vertex)
+		{
+			return reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + vertex * stride);
+		}
+
+		// Clip space of a row-vector, false when the point is in front of the near plane
+		bool Project(const float position[3], const float matrix[4][4], float& x, float& y, float& z)
+		{
+			float clip[4];
+			for (int j = 0; j < 4; j++)
+				clip[j] = position[0] * matrix[0][j] + position[1] * matrix[1][j] + position[2] * matrix[2][j] + matrix[3][j];
+
+			if (clip[2] < 0.0f || clip[3] <= 0.0f)
+				return false;
+
+			const float invW = 1.0f / clip[3];
+			x = (clip[0] * invW * 0.5f + 0.5f) * DepthBuffer::Width;
+			y = (0.5f - clip[1] * invW * 0.5f) * DepthBuffer::Height;
+			z = clip[2] * invW;
+			return true;
+		}
+	}
+
+	Occluder BuildOccluder(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+						   size_t vertexCount, size_t maxTriangles, float maxError)
+	{
+		// Weld vertices sharing a position, the simplifier keeps attribute seams which an occluder does not need
+		std::vector<uint32_t> order(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			order[i] = i;
+
+		std::sort(order.begin(), order.end(), [positions, positionStride](uint32_t a, uint32_t b)
+				  {
+					  return std::memcmp(GetPosition(positions, positionStride, a),
+										 GetPosition(positions, positionStride, b), sizeof(float) * 3) < 0;
+				  });
+
+		std::vector<uint32_t> welded(vertexCount);
+		std::vector<float> weldedPositions;
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const float* position = GetPosition(positions, positionStride, order[i]);
+			if (i == 0 || std::memcmp(position, GetPosition(positions, positionStride, order[i - 1]), sizeof(float) * 3) != 0)
+				weldedPositions.insert(weldedPositions.end(), position, position + 3);
+			welded[order[i]] = static_cast<uint32_t>(weldedPositions.size() / 3 - 1);
+		}
+
+		std::vector<uint32_t> source;
+		source.reserve(indexCount);
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const uint32_t a = welded[indices[i]], b = welded[indices[i + 1]], c = welded[indices[i + 2]];
+			if (a != b && b != c && c != a)
+				source.insert(source.end(), { a, b, c });
+		}
+
+		const size_t targetIndexCount = maxTriangles * 3;
+		std::vector<uint32_t> simplified(source.size());
+		size_t count = source.size();
+		if (count > targetIndexCount)
+			count = Simplifier::Simplify(simplified.data(), source.data(), source.size(), weldedPositions.data(), sizeof(float) * 3,
+										 weldedPositions.size() / 3, targetIndexCount, maxError);
+		else
+			simplified = source;
+
+		Occluder occluder;
+		if (count == 0 || count > targetIndexCount)
+			return occluder;
+
+		std::vector<uint32_t> remap(weldedPositions.size() / 3, ~0u);
+		occluder.Indices.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t& vertex = remap[simplified[i]];
+			if (vertex == ~0u)
+			{
+				vertex = static_cast<uint32_t>(occluder.Positions.size() / 3);
+				const float* position = &weldedPositions[simplified[i] * 3];
+				occluder.Positions.insert(occluder.Positions.end(), position, position + 3);
+			}
+			occluder.Indices.push_back(vertex);
+		}
+
+		return occluder;
+	}
+
+	DepthBuffer::DepthBuffer()
+	{
+		uint32_t width = Width, height = Height;
+		Levels.emplace_back(width * height, 1.0f);
+		while (width > 1 || height > 1)
+		{
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+			Levels.emplace_back(width * height, 1.0f);
+		}
+	}
+
+	void DepthBuffer::Render(const OccluderInstance* occluders, size_t count)
+	{
+		constexpr size_t Grain = 8;
+		const size_t chunkCount = std::max<size_t>(ThreadPool::GetChunkCount(count, Grain), 1);
+		if (Bins.size() < chunkCount * TileCount)
+			Bins.resize(chunkCount * TileCount);
+		for (size_t i = 0; i < chunkCount * TileCount; i++)
+			Bins[i].clear();
+
+		std::vector<size_t> triangles(chunkCount, 0);
+		ThreadPool::ParallelFor(count, Grain, [this, occluders, &triangles](size_t chunk, size_t begin, size_t end)
+								{
+									for (size_t i = begin; i < end; i++)
+										SetupOccluder(occluders[i], &Bins[chunk * TileCount], triangles[chunk]);
+								});
+
+		ThreadPool::ParallelFor(TileCount, 1, [this, chunkCount](size_t, size_t begin, size_t end)
+								{
+									for (size_t tile = begin; tile < end; tile++)
+										RasterizeTile(static_cast<uint32_t>(tile), chunkCount);
+								});
+
+		TriangleCount = 0;
+		for (size_t chunkTriangles : triangles)
+			TriangleCount += chunkTriangles;
+
+		BuildPyramid();
+	}
+
+	bool DepthBuffer::IsOccluded(const float center[3], const float extents[3], const float viewProjection[4][4]) const
+	{
+		float minX = std::numeric_limits<float>::max(), minY = minX, minZ = minX;
+		float maxX = -minX, maxY = -minX;
+		for (int corner = 0; corner < 8; corner++)
+		{
+			const float position[3] = {
+				center[0] + (corner & 1 ? extents[0] : -extents[0]),
+				center[1] + (corner & 2 ? extents[1] : -extents[1]),
+				center[2] + (corner & 4 ? extents[2] : -extents[2]),
+			};
+
+			float x, y, z;
+			if (!Project(position, viewProjection, x, y, z))
+				return false;
+
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+			minZ = std::min(minZ, z);
+		}
+
+		if (maxX < 0.0f || maxY < 0.0f || minX >= Width || minY >= Height)
+			return false;
+
+		const int x0 = std::max(static_cast<int>(minX), 0);
+		const int y0 = std::max(static_cast<int>(minY), 0);
+		const int x1 = std::min(static_cast<int>(maxX), static_cast<int>(Width) - 1);
+		const int y1 = std::min(static_cast<int>(maxY), static_cast<int>(Height) - 1);
+
+		// Coarsest level needed so the rectangle spans at most 2x2 texels
+		size_t level = 0;
+		while (level + 1 < Levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+			level++;
+
+		const int levelWidth = std::max(static_cast<int>(Width >> level), 1);
+		const int levelHeight = std::max(static_cast<int>(Height >> level), 1);
+		const std::vector<float>& depth = Levels[level];
+		for (int y = std::min(y0 >> level, levelHeight - 1); y <= std::min(y1 >> level, levelHeight - 1); y++)
+		{
+			for (int x = std::min(x0 >> level, levelWidth - 1); x <= std::min(x1 >> level, levelWidth - 1); x++)
+			{
+				if (depth[y * levelWidth + x] >= minZ)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	void DepthBuffer::SetupOccluder(const OccluderInstance& occluder, std::vector<Triangle>* bins, size_t& triangles)
+	{
+		const Occluder& geometry = *occluder.Geometry;
+		const size_t vertexCount = geometry.Positions.size() / 3;
+		Projected.resize(vertexCount * 4);
+
+#ifdef OCCLUSION_SSE2
+		const __m128 rows[4] = {
+			_mm_loadu_ps(occluder.ModelViewProjection[0]), _mm_loadu_ps(occluder.ModelViewProjection[1]),
+			_mm_loadu_ps(occluder.ModelViewProjection[2]), _mm_loadu_ps(occluder.ModelViewProjection[3]),
+		};
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const float* position = &geometry.Positions[i * 3];
+			__m128 clip = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(position[0]), rows[0]), rows[3]);
+			clip = _mm_add_ps(clip, _mm_mul_ps(_mm_set1_ps(position[1]), rows[1]));
+			clip = _mm_add_ps(clip, _mm_mul_ps(_mm_set1_ps(position[2]), rows[2]));
+
+			float* projected = &Projected[i * 4];
+			_mm_storeu_ps(projected, clip);
+			if (projected[2] < 0.0f || projected[3] <= 0.0f)
+			{
+				projected[3] = 0.0f;
+				continue;
+			}
+
+			const float invW = 1.0f / projected[3];
+			projected[0] = (projected[0] * invW * 0.5f + 0.5f) * Width;
+			projected[1] = (0.5f - projected[1] * invW * 0.5f) * Height;
+			projected[2] *= invW;
+		}
+#else
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			float* projected = &Projected[i * 4];
+			projected[3] = Project(&geometry.Positions[i * 3], occluder.ModelViewProjection,
+								   projected[0], projected[1], projected[2]) ? 1.0f : 0.0f;
+		}
+#endif
+
+		for (size_t i = 0; i + 2 < geometry.Indices.size(); i += 3)
+		{
+			const float* a = &Projected[geometry.Indices[i] * 4];
+			const float* b = &Projected[geometry.Indices[i + 1] * 4];
+			const float* c = &Projected[geometry.Indices[i + 2] * 4];
+
+			// Triangles reaching past the near plane are dropped rather than clipped, which only loses occlusion
+			if (a[3] <= 0.0f || b[3] <= 0.0f || c[3] <= 0.0f)
+				continue;
+
+			const float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+			if (area == 0.0f)
+				continue;
+			if (area < 0.0f)
+				std::swap(b, c);
+
+			// Pixels whose center is inside the bounds
+			const float minX = std::min({ a[0], b[0], c[0] }), maxX = std::max({ a[0], b[0], c[0] });
+			const float minY = std::min({ a[1], b[1], c[1] }), maxY = std::max({ a[1], b[1], c[1] });
+			const int x0 = static_cast<int>(std::max(std::ceil(minX - 0.5f), 0.0f));
+			const int y0 = static_cast<int>(std::max(std::ceil(minY - 0.5f), 0.0f));
+			const int x1 = static_cast<int>(std::min(std::floor(maxX - 0.5f), Width - 1.0f));
+			const int y1 = static_cast<int>(std::min(std::floor(maxY - 0.5f), Height - 1.0f));
+			if (x0 > x1 || y0 > y1)
+				continue;
+
+			const Triangle triangle{ { a[0], b[0], c[0] }, { a[1], b[1], c[1] }, { a[2], b[2], c[2] } };
+			for (int tileY = y0 / TileSize; tileY <= y1 / static_cast<int>(TileSize); tileY++)
+				for (int tileX = x0 / TileSize; tileX <= x1 / static_cast<int>(TileSize); tileX++)
+					bins[tileY * TilesX + tileX].push_back(triangle);
+			triangles++;
+		}
+	}
+
+	void DepthBuffer::RasterizeTile(uint32_t tile, size_t chunkCount)
+	{
+		const uint32_t tileX = tile % TilesX, tileY = tile / TilesX;
+		std::vector<float>& depth = Levels[0];
+		for (uint32_t y = tileY * TileSize; y < (tileY + 1) * TileSize; y++)
+			std::fill_n(&depth[y * Width + tileX * TileSize], TileSize, 1.0f);
+
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+			for (const Triangle& triangle : Bins[chunk * TileCount + tile])
+				RasterizeTriangle(triangle, tileX, tileY);
+	}
+
+	void DepthBuffer::RasterizeTriangle(const Triangle& triangle, uint32_t tileX, uint32_t tileY)
+	{
+		const float* X = triangle.X;
+		const float* Y = triangle.Y;
+		const float* Z = triangle.Z;
+
+		const int x0 = std::max(static_cast<int>(std::ceil(std::min({ X[0], X[1], X[2] }) - 0.5f)), static_cast<int>(tileX * TileSize)) & ~3;
+		const int y0 = std::max(static_cast<int>(std::ceil(std::min({ Y[0], Y[1], Y[2] }) - 0.5f)), static_cast<int>(tileY * TileSize));
+		const int x1 = std::min(static_cast<int>(std::floor(std::max({ X[0], X[1], X[2] }) - 0.5f)), static_cast<int>((tileX + 1) * TileSize) - 1);
+		const int y1 = std::min(static_cast<int>(std::floor(std::max({ Y[0], Y[1], Y[2] }) - 0.5f)), static_cast<int>((tileY + 1) * TileSize) - 1);
+		if (x0 > x1 || y0 > y1)
+			return;
+
+		// Edge i runs from vertex i to vertex i + 1 and is A * x + B * y + C, non negative inside
+		float A[3], B[3], C[3];
+		for (int i = 0; i < 3; i++)
+		{
+			const int j = (i + 1) % 3;
+			A[i] = Y[i] - Y[j];
+			B[i] = X[j] - X[i];
+			C[i] = -(A[i] * X[i] + B[i] * Y[i]);
+		}
+
+		// Edge i is zero on the opposite vertex, so depth is the edges weighted by the vertex they face
+		const float invArea = 1.0f / (A[0] * X[2] + B[0] * Y[2] + C[0]);
+		const float zx = (A[1] * Z[0] + A[2] * Z[1] + A[0] * Z[2]) * invArea;
+		const float zy = (B[1] * Z[0] + B[2] * Z[1] + B[0] * Z[2]) * invArea;
+		const float zc = (C[1] * Z[0] + C[2] * Z[1] + C[0] * Z[2]) * invArea;
+
+		std::vector<float>& depth = Levels[0];
+
+#ifdef OCCLUSION_SSE2
+		// Four pixels per step. x0 is aligned down and the tile width is a multiple of four, so the lanes
+		// never leave the tile; lanes outside the bounds fail the edge tests.
+		const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 a0 = _mm_set1_ps(A[0]), a1 = _mm_set1_ps(A[1]), a2 = _mm_set1_ps(A[2]);
+		const __m128 depthX = _mm_set1_ps(zx);
+		for (int y = y0; y <= y1; y++)
+		{
+			const float py = y + 0.5f;
+			const __m128 row0 = _mm_set1_ps(B[0] * py + C[0]);
+			const __m128 row1 = _mm_set1_ps(B[1] * py + C[1]);
+			const __m128 row2 = _mm_set1_ps(B[2] * py + C[2]);
+			const __m128 rowDepth = _mm_set1_ps(zy * py + zc);
+
+			float* pixels = &depth[y * Width];
+			for (int x = x0; x <= x1; x += 4)
+			{
+				const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+				__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), row0), zero);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), row1), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), row2), zero));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				const __m128 old = _mm_loadu_ps(pixels + x);
+				const __m128 nearest = _mm_min_ps(old, _mm_add_ps(_mm_mul_ps(depthX, px), rowDepth));
+				_mm_storeu_ps(pixels + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+		}
+#else
+		for (int y = y0; y <= y1; y++)
+		{
+			const float py = y + 0.5f;
+			float* pixels = &depth[y * Width];
+			for (int x = x0; x <= x1; x++)
+			{
+				const float px = x + 0.5f;
+				if (A[0] * px + B[0] * py + C[0] < 0.0f || A[1] * px + B[1] * py + C[1] < 0.0f ||
+					A[2] * px + B[2] * py + C[2] < 0.0f)
+					continue;
+				pixels[x] = std::min(pixels[x], zx * px + zy * py + zc);
+			}
+		}
+#endif
+	}
+
+	void DepthBuffer::BuildPyramid()
+	{
+		uint32_t width = Width, height = Height;
+		for (size_t level = 1; level < Levels.size(); level++)
+		{
+			const std::vector<float>& source = Levels[level - 1];
+			std::vector<float>& destination = Levels[level];
+			const uint32_t levelWidth = std::max(width / 2, 1u);
+			const uint32_t levelHeight = std::max(height / 2, 1u);
+
+			for (uint32_t y = 0; y < levelHeight; y++)
+			{
+				const uint32_t top = std::min(y * 2, height - 1) * width;
+				const uint32_t bottom = std::min(y * 2 + 1, height - 1) * width;
+				for (uint32_t x = 0; x < levelWidth; x++)
+				{
+					const uint32_t left = std::min(x * 2, width - 1);
+					const uint32_t right = std::min(x * 2 + 1, width - 1);
+					destination[y * levelWidth + x] = std::max(std::max(source[top + left], source[top + right]),
+															   std::max(source[bottom + left], source[bottom + right]));
+				}
+			}
+
+			width = levelWidth;
+			height = levelHeight;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Software occlusion culling. A budget of simplified occluders is rasterized on the CPU into a small
+// depth buffer, and object bounds are tested against a max depth pyramid built over it.
+// Matrices are row-vector (v * M) with D3D depth range, depth is nearest at 0.
+namespace Occlusion
+{
+	// Simplified copy of a mesh in model space
+	struct Occluder
+	{
+		std::vector<float> Positions; // x, y, z
+		std::vector<uint32_t> Indices;
+
+		size_t GetTriangleCount() const { return Indices.size() / 3; }
+		bool Empty() const { return Indices.empty(); }
+	};
+
+	// Simplifies the mesh to at most maxTriangles within maxError, empty when it cannot get there.
+	// positionStride is in bytes.
+	Occluder BuildOccluder(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+						   size_t vertexCount, size_t maxTriangles, float maxError);
+
+	struct OccluderInstance
+	{
+		const Occluder* Geometry;
+		float ModelViewProjection[4][4];
+	};
+
+	class DepthBuffer
+	{
+	public:
+		static constexpr uint32_t Width = 256;
+		static constexpr uint32_t Height = 128;
+		static constexpr uint32_t TileSize = 32;
+		static constexpr uint32_t TilesX = Width / TileSize;
+		static constexpr uint32_t TilesY = Height / TileSize;
+		static constexpr uint32_t TileCount = TilesX * TilesY;
+
+		DepthBuffer();
+
+		// Clears the buffer, rasterizes the occluders and rebuilds the pyramid. Triangles are set up and
+		// binned to tiles by chunks of occluders, then tiles are rasterized in parallel.
+		void Render(const OccluderInstance* occluders, size_t count);
+
+		// True when the world space box lies behind the occluders. Boxes crossing the near plane are visible.
+		bool IsOccluded(const float center[3], const float extents[3], const float viewProjection[4][4]) const;
+
+		size_t GetTriangleCount() const { return TriangleCount; }
+		const float* GetDepth() const { return Levels[0].data(); }
+
+	private:
+		// Screen space triangle, counter clockwise in pixels with y down
+		struct Triangle
+		{
+			float X[3], Y[3], Z[3];
+		};
+
+		void SetupOccluder(const OccluderInstance& occluder, std::vector<Triangle>* bins, size_t& triangles);
+		void RasterizeTile(uint32_t tile, size_t chunkCount);
+		// Covers the pixels of the tile whose center lies inside the triangle
+		void RasterizeTriangle(const Triangle& triangle, uint32_t tileX, uint32_t tileY);
+		void BuildPyramid();
+
+	private:
+		// Level 0 is the full resolution depth, every next level keeps the farthest depth of 2x2 texels
+		std::vector<std::vector<float>> Levels;
+		// Chunk major, TileCount bins per chunk
+		std::vector<std::vector<Triangle>> Bins;
+		size_t TriangleCount = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "Quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Quantization
+{
+	namespace
+	{
+		constexpr float TangentSignBias = 1.0f / 32767.0f;
+
+		float SignNotZero(float value)
+		{
+			return value >= 0.0f ? 1.0f : -1.0f;
+		}
+
+		void ToOctahedral(const Float3& direction, float& u, float& v)
+		{
+			const float length = std::abs(direction.X) + std::abs(direction.Y) + std::abs(direction.Z);
+			if (length == 0.0f)
+			{
+				u = v = 0.0f;
+				return;
+			}
+
+			u = direction.X / length;
+			v = direction.Y / length;
+
+			if (direction.Z < 0.0f)
+			{
+				const float x = u;
+				u = (1.0f - std::abs(v)) * SignNotZero(x);
+				v = (1.0f - std::abs(x)) * SignNotZero(v);
+			}
+		}
+
+		Float3 FromOctahedral(float u, float v)
+		{
+			Float3 direction{ u, v, 1.0f - std::abs(u) - std::abs(v) };
+			if (direction.Z < 0.0f)
+			{
+				direction.X = (1.0f - std::abs(v)) * SignNotZero(u);
+				direction.Y = (1.0f - std::abs(u)) * SignNotZero(v);
+			}
+
+			const float length = std::sqrt(direction.X * direction.X + direction.Y * direction.Y + direction.Z * direction.Z);
+			return { direction.X / length, direction.Y / length, direction.Z / length };
+		}
+
+		Float3 Cross(const Float3& a, const Float3& b)
+		{
+			return { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+		}
+
+		float Dot(const Float3& a, const Float3& b)
+		{
+			return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+		}
+	}
+
+	Float3 Bounds::GetCenter() const
+	{
+		return { (Min.X + Max.X) * 0.5f, (Min.Y + Max.Y) * 0.5f, (Min.Z + Max.Z) * 0.5f };
+	}
+
+	Float3 Bounds::GetExtents() const
+	{
+		return { (Max.X - Min.X) * 0.5f, (Max.Y - Min.Y) * 0.5f, (Max.Z - Min.Z) * 0.5f };
+	}
+
+	int16_t FloatToSnorm16(float value)
+	{
+		value = std::clamp(value, -1.0f, 1.0f);
+		return static_cast<int16_t>(std::lround(value * 32767.0f));
+	}
+
+	float Snorm16ToFloat(int16_t value)
+	{
+		return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+	}
+
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		const uint32_t sign = (bits >> 16) & 0x8000u;
+		const uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+		// NaN and infinity
+		if (magnitude >= 0x7F800000u)
+			return static_cast<uint16_t>(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+
+		// Overflow to infinity
+		if (magnitude >= 0x477FF000u)
+			return static_cast<uint16_t>(sign | 0x7C00u);
+
+		// Subnormal halves, rounded to nearest even
+		if (magnitude < 0x38800000u)
+		{
+			if (magnitude < 0x33000000u)
+				return static_cast<uint16_t>(sign);
+
+			const uint32_t exponent = magnitude >> 23;
+			const uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+			const uint32_t shift = 126 - exponent;
+			uint32_t half = mantissa >> shift;
+			const uint32_t remainder = mantissa & ((1u << shift) - 1);
+			const uint32_t midpoint = 1u << (shift - 1);
+			if (remainder > midpoint || (remainder == midpoint && (half & 1u)))
+				half++;
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		// Normal halves, rounded to nearest even
+		uint32_t half = magnitude - 0x38000000u;
+		half += 0xFFFu + ((half >> 13) & 1u);
+		return static_cast<uint16_t>(sign | (half >> 13));
+	}
+
+	float HalfToFloat(uint16_t value)
+	{
+		const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+		uint32_t exponent = (value >> 10) & 0x1Fu;
+		uint32_t mantissa = value & 0x3FFu;
+
+		uint32_t bits;
+		if (exponent == 0x1Fu)
+			bits = sign | 0x7F800000u | (mantissa << 13);
+		else if (exponent != 0)
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		else if (mantissa == 0)
+			bits = sign;
+		else
+		{
+			exponent = 113;
+			while (!(mantissa & 0x400u))
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+		}
+
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	Short2 EncodeOctahedral(const Float3& direction)
+	{
+		float u, v;
+		ToOctahedral(direction, u, v);
+		return { FloatToSnorm16(u), FloatToSnorm16(v) };
+	}
+
+	Float3 DecodeOctahedral(Short2 encoded)
+	{
+		return FromOctahedral(Snorm16ToFloat(encoded.X), Snorm16ToFloat(encoded.Y));
+	}
+
+	Short2 EncodeTangent(const Float3& tangent, float bitangentSign)
+	{
+		float u, v;
+		ToOctahedral(tangent, u, v);
+
+		// Remap v from [-1, 1] to [bias, 1] so its sign is free to carry the bitangent sign
+		const float magnitude = TangentSignBias + (v * 0.5f + 0.5f) * (1.0f - TangentSignBias);
+		return { FloatToSnorm16(u), FloatToSnorm16(SignNotZero(bitangentSign) * magnitude) };
+	}
+
+	Float3 DecodeTangent(Short2 encoded, float& bitangentSign)
+	{
+		const float y = Snorm16ToFloat(encoded.Y);
+		bitangentSign = SignNotZero(y);
+
+		const float magnitude = std::max(std::abs(y), TangentSignBias);
+		const float v = (magnitude - TangentSignBias) / (1.0f - TangentSignBias) * 2.0f - 1.0f;
+		return FromOctahedral(Snorm16ToFloat(encoded.X), v);
+	}
+
+	Bounds ComputeBounds(const Float3* positions, size_t count)
+	{
+		if (count == 0)
+			return {};
+
+		Bounds bounds{ positions[0], positions[0] };
+		for (size_t i = 1; i < count; i++)
+		{
+			const auto& p = positions[i];
+			bounds.Min = { std::min(bounds.Min.X, p.X), std::min(bounds.Min.Y, p.Y), std::min(bounds.Min.Z, p.Z) };
+			bounds.Max = { std::max(bounds.Max.X, p.X), std::max(bounds.Max.Y, p.Y), std::max(bounds.Max.Z, p.Z) };
+		}
+		return bounds;
+	}
+
+	Short4 QuantizePosition(const Float3& position, const Bounds& bounds)
+	{
+		const Float3 center = bounds.GetCenter();
+		const Float3 extents = bounds.GetExtents();
+
+		const auto quantize = [](float value, float center, float extent)
+		{
+			return FloatToSnorm16(extent > 0.0f ? (value - center) / extent : 0.0f);
+		};
+
+		return { quantize(position.X, center.X, extents.X),
+				 quantize(position.Y, center.Y, extents.Y),
+				 quantize(position.Z, center.Z, extents.Z),
+				 std::numeric_limits<int16_t>::max() };
+	}
+
+	Float3 DequantizePosition(Short4 encoded, const Bounds& bounds)
+	{
+		const Float3 center = bounds.GetCenter();
+		const Float3 extents = bounds.GetExtents();
+
+		return { center.X + Snorm16ToFloat(encoded.X) * extents.X,
+				 center.Y + Snorm16ToFloat(encoded.Y) * extents.Y,
+				 center.Z + Snorm16ToFloat(encoded.Z) * extents.Z };
+	}
+
+	void EncodePositions(Short4* destination, const Float3* positions, size_t count, const Bounds& bounds)
+	{
+		for (size_t i = 0; i < count; i++)
+			destination[i] = QuantizePosition(positions[i], bounds);
+	}
+
+	void EncodeNormals(Short2* destination, const Float3* normals, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			destination[i] = EncodeOctahedral(normals[i]);
+	}
+
+	void EncodeTangents(Short2* destination, const Float3* tangents, const Float3* bitangents, const Float3* normals, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const float sign = Dot(Cross(normals[i], tangents[i]), bitangents[i]);
+			destination[i] = EncodeTangent(tangents[i], sign);
+		}
+	}
+
+	void EncodeTexCoords(Half2* destination, const Float3* texCoords, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			destination[i] = { FloatToHalf(texCoords[i].X), FloatToHalf(texCoords[i].Y) };
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Packed vertex attribute encodings. Memory layouts match the DXGI formats they are bound as:
+// Short2/Short4 -> R16G16(B16A16)_SNORM, Half2 -> R16G16_FLOAT.
+namespace Quantization
+{
+	struct Short2
+	{
+		int16_t X, Y;
+	};
+
+	struct Short4
+	{
+		int16_t X, Y, Z, W;
+	};
+
+	struct Half2
+	{
+		uint16_t X, Y;
+	};
+
+	struct Float3
+	{
+		float X, Y, Z;
+	};
+
+	struct Bounds
+	{
+		Float3 Min{ 0.0f, 0.0f, 0.0f };
+		Float3 Max{ 0.0f, 0.0f, 0.0f };
+
+		Float3 GetCenter() const;
+		Float3 GetExtents() const;
+	};
+
+	int16_t FloatToSnorm16(float value);
+	float Snorm16ToFloat(int16_t value);
+
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+
+	// Octahedral mapping of a unit vector onto the [-1, 1]^2 square
+	Short2 EncodeOctahedral(const Float3& direction);
+	Float3 DecodeOctahedral(Short2 encoded);
+
+	// Same as EncodeOctahedral, with the bitangent sign folded into the sign of Y.
+	// Y keeps 15 bits of precision.
+	Short2 EncodeTangent(const Float3& tangent, float bitangentSign);
+	Float3 DecodeTangent(Short2 encoded, float& bitangentSign);
+
+	Bounds ComputeBounds(const Float3* positions, size_t count);
+
+	// Positions are mapped to [-1, 1] inside bounds, W carries 1.0
+	Short4 QuantizePosition(const Float3& position, const Bounds& bounds);
+	Float3 DequantizePosition(Short4 encoded, const Bounds& bounds);
+
+	void EncodePositions(Short4* destination, const Float3* positions, size_t count, const Bounds& bounds);
+	void EncodeNormals(Short2* destination, const Float3* normals, size_t count);
+	void EncodeTangents(Short2* destination, const Float3* tangents, const Float3* bitangents, const Float3* normals, size_t count);
+	void EncodeTexCoords(Half2* destination, const Float3* texCoords, size_t count);
+}
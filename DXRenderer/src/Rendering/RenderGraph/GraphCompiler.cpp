@@ -0,0 +1,182 @@
+#include "GraphCompiler.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+namespace
+{
+	std::string ResourceKey(const std::string& passName, const std::string& resourceName)
+	{
+		return passName + "." + resourceName;
+	}
+}
+
+uint32_t GraphCompiler::AddPass(const std::string& name)
+{
+	const uint32_t index = static_cast<uint32_t>(PassNames.size());
+	if (!PassLookup.emplace(name, index).second)
+		throw std::invalid_argument("Pass " + name + " added twice");
+
+	PassNames.push_back(name);
+	return index;
+}
+
+uint32_t GraphCompiler::AddResource(uint32_t producer, const std::string& name, uint32_t source)
+{
+	if (source != External && source >= Producers.size())
+		throw std::out_of_range("Resource " + name + " forwarded from an unknown resource");
+
+	if (producer != External && producer >= PassNames.size())
+		throw std::out_of_range("Resource " + name + " produced by an unknown pass");
+
+	const std::string& passName = producer == External ? "$" : PassNames[producer];
+	const uint32_t handle = static_cast<uint32_t>(Producers.size());
+	if (!ResourceLookup.emplace(ResourceKey(passName, name), handle).second)
+		throw std::invalid_argument("Resource " + ResourceKey(passName, name) + " added twice");
+
+	Producers.push_back(producer);
+	Sources.push_back(source);
+	return handle;
+}
+
+uint32_t GraphCompiler::AddRead(uint32_t consumer, const std::string& passName, const std::string& resourceName)
+{
+	if (consumer >= PassNames.size())
+		throw std::out_of_range("Read from an unknown pass");
+
+	const uint32_t resource = FindResource(passName, resourceName);
+	Reads.push_back({ consumer, resource });
+	return resource;
+}
+
+void GraphCompiler::AddSink(const std::string& passName, const std::string& resourceName)
+{
+	Sinks.push_back(FindResource(passName, resourceName));
+}
+
+uint32_t GraphCompiler::FindPass(const std::string& name) const
+{
+	const auto it = PassLookup.find(name);
+	if (it == PassLookup.end())
+		throw std::runtime_error("Pass " + name + " not found");
+
+	return it->second;
+}
+
+uint32_t GraphCompiler::FindResource(const std::string& passName, const std::string& resourceName) const
+{
+	const auto it = ResourceLookup.find(ResourceKey(passName, resourceName));
+	if (it == ResourceLookup.end())
+		throw std::runtime_error("Resource " + ResourceKey(passName, resourceName) + " not found");
+
+	return it->second;
+}
+
+GraphCompiler::Plan GraphCompiler::Compile() const
+{
+	const size_t passCount = PassNames.size();
+
+	Plan plan;
+	plan.Reads.resize(passCount);
+
+	std::vector<std::vector<uint32_t>> dependencies(passCount);
+	std::vector<std::vector<uint32_t>> dependents(passCount);
+	for (const Read& read : Reads)
+	{
+		plan.Reads[read.Consumer].push_back(read.Resource);
+
+		const uint32_t producer = Producers[read.Resource];
+		if (producer == External)
+			continue;
+		if (producer == read.Consumer)
+			throw std::runtime_error("Pass " + PassNames[producer] + " reads its own output");
+
+		dependencies[read.Consumer].push_back(producer);
+		dependents[producer].push_back(read.Consumer);
+	}
+
+	// Walk back from the sinks, anything not reached never affects the frame
+	std::vector<bool> live(passCount, false);
+	std::vector<uint32_t> stack;
+	for (uint32_t sink : Sinks)
+		if (Producers[sink] != External)
+			stack.push_back(Producers[sink]);
+
+	while (!stack.empty())
+	{
+		const uint32_t pass = stack.back();
+		stack.pop_back();
+		if (live[pass])
+			continue;
+
+		live[pass] = true;
+		for (uint32_t dependency : dependencies[pass])
+			stack.push_back(dependency);
+	}
+
+	// Kahn's algorithm, ties broken by insertion order so an already ordered graph keeps its order
+	std::vector<uint32_t> pending(passCount, 0);
+	for (uint32_t pass = 0; pass < passCount; pass++)
+	{
+		if (!live[pass])
+		{
+			plan.Culled.push_back(pass);
+			continue;
+		}
+
+		pending[pass] = static_cast<uint32_t>(dependencies[pass].size());
+	}
+
+	std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+	for (uint32_t pass = 0; pass < passCount; pass++)
+		if (live[pass] && pending[pass] == 0)
+			ready.push(pass);
+
+	while (!ready.empty())
+	{
+		const uint32_t pass = ready.top();
+		ready.pop();
+		plan.Schedule.push_back(pass);
+
+		for (uint32_t dependent : dependents[pass])
+			if (live[dependent] && --pending[dependent] == 0)
+				ready.push(dependent);
+	}
+
+	if (plan.Schedule.size() + plan.Culled.size() != passCount)
+		throw std::runtime_error("Render graph contains a cycle");
+
+	std::vector<uint32_t> position(passCount, External);
+	for (uint32_t i = 0; i < plan.Schedule.size(); i++)
+		position[plan.Schedule[i]] = i;
+
+	// Sources are always added before the resources forwarding them
+	const size_t resourceCount = Producers.size();
+	plan.Roots.resize(resourceCount);
+	for (uint32_t resource = 0; resource < resourceCount; resource++)
+		plan.Roots[resource] = Sources[resource] == External ? resource : plan.Roots[Sources[resource]];
+
+	plan.Lifetimes.resize(resourceCount);
+	const auto extend = [&plan](uint32_t resource, uint32_t at)
+	{
+		if (at == External)
+			return;
+
+		auto& lifetime = plan.Lifetimes[plan.Roots[resource]];
+		lifetime.First = std::min(lifetime.First, at);
+		lifetime.Last = std::max(lifetime.Last, at);
+	};
+
+	for (uint32_t resource = 0; resource < resourceCount; resource++)
+		if (Producers[resource] != External)
+			extend(resource, position[Producers[resource]]);
+	for (const Read& read : Reads)
+		extend(read.Resource, position[read.Consumer]);
+	for (uint32_t sink : Sinks)
+		if (!plan.Schedule.empty())
+			extend(sink, static_cast<uint32_t>(plan.Schedule.size() - 1));
+
+	return plan;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Turns the pass/resource wiring of a render graph into an execution schedule. Names are resolved
+// to integer handles once while the description is built, Compile only works on indices, so the
+// compiler runs on any pass type, including stand-ins without a device.
+class GraphCompiler
+{
+public:
+	static constexpr uint32_t External = ~0u;
+
+	// Schedule positions of the first write and the last read, inclusive
+	struct Lifetime
+	{
+		uint32_t First = External;
+		uint32_t Last = 0;
+	};
+
+	struct Plan
+	{
+		// Pass indices in execution order, producers before consumers
+		std::vector<uint32_t> Schedule;
+		// Passes that do not contribute to any sink, in insertion order
+		std::vector<uint32_t> Culled;
+		// Resource handle read by each input, per pass in input registration order
+		std::vector<std::vector<uint32_t>> Reads;
+		// Per resource, the resource it was forwarded from, itself when it is written first here
+		std::vector<uint32_t> Roots;
+		// Per root resource, covering every pass forwarding it, sinks up to the last pass. First is
+		// External for resources no scheduled pass writes or reads.
+		std::vector<Lifetime> Lifetimes;
+	};
+
+	uint32_t AddPass(const std::string& name);
+	// Resource written by a pass, or by nothing when producer is External (global outputs).
+	// A pass that modifies a resource it read and hands it on names the read handle as source.
+	uint32_t AddResource(uint32_t producer, const std::string& name, uint32_t source = External);
+	// Consumer reads resource of passName, passName "$" stands for the globals. Returns the resource handle.
+	uint32_t AddRead(uint32_t consumer, const std::string& passName, const std::string& resourceName);
+	// Resource that must be produced every frame, e.g. the back buffer
+	void AddSink(const std::string& passName, const std::string& resourceName);
+
+	uint32_t FindPass(const std::string& name) const;
+	uint32_t FindResource(const std::string& passName, const std::string& resourceName) const;
+	inline size_t GetPassCount() const { return PassNames.size(); }
+
+	// Throws std::runtime_error on dangling references and cycles
+	Plan Compile() const;
+
+private:
+	struct Read
+	{
+		uint32_t Consumer;
+		uint32_t Resource;
+	};
+
+	std::vector<std::string> PassNames;
+	std::unordered_map<std::string, uint32_t> PassLookup;
+	std::vector<uint32_t> Producers;
+	std::vector<uint32_t> Sources;
+	std::unordered_map<std::string, uint32_t> ResourceLookup;
+	std::vector<Read> Reads;
+	std::vector<uint32_t> Sinks;
+};
\ No newline at end of file
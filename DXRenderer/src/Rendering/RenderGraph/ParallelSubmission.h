@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Core/ThreadPool.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Items pushed into several queues from ThreadPool chunks. Each chunk gathers its own lists, which are
+// handed on in chunk order once all chunks are done, so the queues end up as if the submission was serial.
+// A submission started inside a chunk of another one hands its lists to that chunk. Nothing here touches
+// the device, RenderGraph::ParallelSubmit runs it with Task items.
+template<typename T>
+class ParallelSubmission
+{
+public:
+	ParallelSubmission(size_t queues)
+		:Queues(queues)
+	{}
+
+	// Calls submit for [0, count), then append(queue, items) with the lists of every chunk that are not
+	// taken by an enclosing submission
+	template<typename Append>
+	void Run(size_t count, size_t grain, const std::function<void(size_t)>& submit, Append&& append)
+	{
+		Buckets.assign(ThreadPool::GetChunkCount(count, grain) * Queues, {});
+
+		ThreadPool::ParallelFor(count, grain, [this, &submit](size_t chunk, size_t begin, size_t end)
+								{
+									ScopedTarget scope({ this, chunk });
+									for (size_t i = begin; i < end; i++)
+										submit(i);
+								});
+
+		for (size_t bucket = 0; bucket < Buckets.size(); bucket++)
+		{
+			const size_t queue = bucket % Queues;
+			if (auto* target = GetTarget(queue))
+				target->insert(target->end(), Buckets[bucket].begin(), Buckets[bucket].end());
+			else
+				append(queue, Buckets[bucket]);
+		}
+	}
+
+	// List of the chunk running on this thread for a queue, null when not inside a submission
+	static std::vector<T>* GetTarget(size_t queue)
+	{
+		if (!Current.Submission)
+			return nullptr;
+
+		return &Current.Submission->Buckets[Current.Chunk * Current.Submission->Queues + queue];
+	}
+
+private:
+	struct Target
+	{
+		ParallelSubmission* Submission = nullptr;
+		size_t Chunk = 0;
+	};
+
+	// Restores the enclosing submission's chunk, also when submit throws
+	struct ScopedTarget
+	{
+		ScopedTarget(Target target)
+			:Outer(Current)
+		{
+			Current = target;
+		}
+
+		~ScopedTarget() { Current = Outer; }
+
+		Target Outer;
+	};
+
+private:
+	static inline thread_local Target Current{};
+
+	size_t Queues;
+	std::vector<std::vector<T>> Buckets;
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Pass.h"
 
+#include "Rendering/CommandList.h"
+#include "Rendering/DepthCube.h"
 #include "Rendering/RenderTarget.h"
 
 #include <stdexcept>
@@ -78,6 +80,23 @@ void Pass::Register(UniquePtr<PassOutputBase> output)
 	Outputs.emplace_back(std::move(output));
 }
 
+void Pass::Register(UniquePtr<PassTransientBase> transient)
+{
+	auto it = std::find_if(Transients.begin(), Transients.end(),
+						   [&transient](const UniquePtr<PassTransientBase>& in)
+						   {
+							   return in->GetName() == transient->GetName();
+						   });
+
+	if (it != Transients.end()) throw std::invalid_argument("Registered transient in conflict with existing registered transient");
+	Transients.emplace_back(std::move(transient));
+}
+
+void Pass::Record(CommandList& list) const
+{
+	list.Call<&Pass::Execute>(*this);
+}
+
 inline void Pass::Bind() const
 {
 	if (RTarget)
@@ -123,3 +142,18 @@ void Pass::Register(UniquePtr<PassInputBase> input)
 PassOutputBase::PassOutputBase(std::string&& name)
 	:Name(std::move(name))
 {}
+
+
+template<>
+SharedPtr<RenderTargetInput> CreateTransient<RenderTargetInput>(const TransientDesc& desc)
+{
+	ASSERT(desc.ArraySize == 1 && desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM);
+	return MakeShared<RenderTargetInput>(desc.Width, desc.Height, desc.Slot);
+}
+
+template<>
+SharedPtr<CubeTextureDepth> CreateTransient<CubeTextureDepth>(const TransientDesc& desc)
+{
+	ASSERT(desc.Width == desc.Height && desc.ArraySize == 6 && desc.Format == DXGI_FORMAT_R32_TYPELESS);
+	return MakeShared<CubeTextureDepth>(desc.Width, desc.Slot);
+}
\ No newline at end of file
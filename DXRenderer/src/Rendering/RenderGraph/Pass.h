@@ -3,7 +3,12 @@
 #include "Core/Core.h"
 #include "Rendering/Utilities.h"
 #include "Rendering/RenderTarget.h"
+#include "TransientPlanner.h"
 
+#include <typeindex>
+
+class CommandList;
+class CubeTextureDepth;
 class DepthStencil;
 class RenderTarget;
 class PassOutputBase;
@@ -137,16 +142,96 @@ void PassInput<T>::Bind(PassOutputBase& out)
 		throw std::bad_cast();
 }
 
+class PassTransientBase
+{
+public:
+	virtual ~PassTransientBase() = default;
+
+	const std::string& GetName() const noexcept { return Name; }
+	const TransientDesc& GetDesc() const noexcept { return Desc; }
+
+	// Transients of the same type and description can share one allocation
+	virtual std::type_index GetType() const = 0;
+	virtual void Allocate() = 0;
+
+	void Alias(const PassTransientBase& allocated)
+	{
+		ASSERT(GetType() == allocated.GetType() && Desc == allocated.Desc);
+		Resource = allocated.Resource;
+		Assign();
+	}
+
+protected:
+	PassTransientBase(std::string&& name, const TransientDesc& desc)
+		:Name(std::move(name)), Desc(desc)
+	{}
+
+	// Hands Resource to the pass
+	virtual void Assign() = 0;
+
+protected:
+	SharedPtr<void> Resource;
+
+private:
+	std::string Name;
+	TransientDesc Desc;
+};
+
+template<typename T>
+SharedPtr<T> CreateTransient(const TransientDesc& desc);
+
+template<>
+SharedPtr<RenderTargetInput> CreateTransient<RenderTargetInput>(const TransientDesc& desc);
+
+template<>
+SharedPtr<CubeTextureDepth> CreateTransient<CubeTextureDepth>(const TransientDesc& desc);
+
+// Resource a pass writes and hands on through the output of the same name. It is created by the
+// render graph once compiled, and may share memory with transients whose lifetimes do not overlap.
+template<typename T, ResourceType Target = T>
+class PassTransient : public PassTransientBase
+{
+public:
+	PassTransient(std::string&& name, SharedPtr<Target>& target, const TransientDesc& desc)
+		:PassTransientBase(std::move(name), desc), TargetRef(target)
+	{}
+
+	std::type_index GetType() const override { return typeid(T); }
+
+	void Allocate() override
+	{
+		Resource = CreateTransient<T>(GetDesc());
+		Assign();
+	}
+
+protected:
+	void Assign() override
+	{
+		TargetRef = std::static_pointer_cast<T>(Resource);
+	}
+
+private:
+	SharedPtr<Target>& TargetRef;
+};
+
 class Pass
 {
 public:
 	Pass(std::string&& name) noexcept;
 	virtual ~Pass() = default;
 
-	virtual void Execute() const = 0;
+	// Records the pass, possibly on a worker thread at the same time as other passes. Shared state
+	// may only be read, device work goes into the list. By default defers Execute to playback.
+	virtual void Record(CommandList& list) const;
+	// Device work run when the list is played back
+	virtual void Execute() const {}
 	virtual void Reset() {}
+	// Statistics shown in the render graph window
+	virtual void GUI() const {}
 	const std::string& GetName() const noexcept { return Name; }
 	const std::vector<UniquePtr<PassInputBase>>& GetInputs() const { return Inputs; }
+	const std::vector<UniquePtr<PassOutputBase>>& GetOutputs() const { return Outputs; }
+	const std::vector<UniquePtr<PassTransientBase>>& GetTransients() const { return Transients; }
 
 	PassOutputBase& GetOutput(const std::string& name) const;
 	PassInputBase& GetInput(const std::string& name) const;
@@ -157,6 +242,7 @@ public:
 protected:
 	void Register(UniquePtr<PassInputBase> input);
 	void Register(UniquePtr<PassOutputBase> output);
+	void Register(UniquePtr<PassTransientBase> transient);
 
 	template<typename T, typename... Args>
 	requires std::is_constructible_v<T, Args...>
@@ -169,11 +255,13 @@ protected:
 	virtual void Bind() const;
 
 protected:
-	SharedPtr<DepthStencil> DStencil;
+	// Passes drawing several views, such as the shadow cube faces, switch it while their list plays back
+	mutable SharedPtr<DepthStencil> DStencil;
 	SharedPtr<RenderTarget> RTarget;
 
 private:
 	std::vector<UniquePtr<PassInputBase>> Inputs;
 	std::vector<UniquePtr<PassOutputBase>> Outputs;
+	std::vector<UniquePtr<PassTransientBase>> Transients;
 	std::string Name;
 };
\ No newline at end of file
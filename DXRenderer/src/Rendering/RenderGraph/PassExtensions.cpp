@@ -1,13 +1,58 @@
 #include "PassExtensions.h"
+#include "RenderGraph.h"
 #include "Rendering/Actors/Primitives.h"
 #include "Rendering/Buffer.h"
+#include "Rendering/CommandList.h"
 #include "Rendering/Lights/PointLight.h"
 #include "Rendering/RenderTarget.h"
 #include "Rendering/Shader.h"
 #include "Rendering/State.h"
+#include "Rendering/StateCache.h"
 #include "Rendering/Texture.h"
 #include "Rendering/Viewport.h"
 
+#include <cstring>
+#include <imgui.h>
+
+namespace
+{
+	uint64_t Mix(uint64_t hash, uint64_t value)
+	{
+		hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	template<typename T>
+	uint64_t MixWords(uint64_t hash, const T& value)
+	{
+		uint32_t words[sizeof(T) / sizeof(uint32_t)];
+		std::memcpy(words, &value, sizeof(words));
+		for (uint32_t word : words)
+			hash = Mix(hash, word);
+		return hash;
+	}
+
+	// Identifies what a caster draws: the object, its placement and the parts of its mesh. Bounds stand in
+	// for the placement only without a world matrix, a rotation can leave them unchanged.
+	uint64_t HashCaster(const Task& task, const Culling::Box& bounds)
+	{
+		const GPUObject& caster = task.GetRenderObject();
+		uint64_t hash = Mix(reinterpret_cast<uintptr_t>(&caster), reinterpret_cast<uintptr_t>(&task.GetStep()));
+
+		if (const auto* world = caster.GetWorldMatrix())
+			hash = MixWords(hash, *world);
+		else
+			hash = MixWords(hash, bounds);
+
+		if (const auto* ranges = caster.GetDrawRanges(Channels::Shadow))
+		{
+			for (const auto& range : *ranges)
+				hash = Mix(hash, (static_cast<uint64_t>(range.IndexOffset) << 32) | range.IndexCount);
+		}
+		return hash;
+	}
+}
+
 ResourcesPass::ResourcesPass(std::string&& name)
 	:Pass(std::move(name))
 {}
@@ -64,36 +109,148 @@ FullScreenPass::FullScreenPass(std::string&& name)
 	Add<Sampler>(0, SamplerInitializer{ false, true });
 }
 
-void FullScreenPass::Execute() const
+void FullScreenPass::Record(CommandList& list) const
 {
-	Bind();
-	CurrentGraphicsContext::Context()->DrawIndexed(
-		Resources.GetIndexBuffer()->GetCount(), 0, 0);
+	list.Call<&FullScreenPass::Execute>(*this);
+	list.Call<&FullScreenPass::Bind>(*this);
+	list.DrawIndexed(Resources.GetIndexBuffer()->GetCount(), 0);
 }
 
 RenderQueuePass::RenderQueuePass(std::string&& name)
-	:ResourcesPass(std::move(name)), Tasks{}
+	:ResourcesPass(std::move(name)), Tasks{}, Instances(GetName() + "Instances", DrawPacket::InstanceStride)
 {}
 
 RenderQueuePass::RenderQueuePass(std::string&& name, GPUObjectBase&& resources)
-	:ResourcesPass(std::move(name), std::move(resources)), Tasks{}
+	:ResourcesPass(std::move(name), std::move(resources)), Tasks{}, Instances(GetName() + "Instances", DrawPacket::InstanceStride)
 {}
 
 void RenderQueuePass::PushBack(Task task)
 {
+	const Step& step = task.GetStep();
+	const GPUObject& renderObject = task.GetRenderObject();
+
+	SortKeyInput input;
+	input.Layer = step.GetLayer();
+	input.Translucent = step.IsTranslucent();
+	input.Program = CombineResourceHandles(step.GetProgramHandle(), renderObject.GetProgramHandle());
+	input.Material = CombineResourceHandles(step.GetMaterialHandle(), renderObject.GetMaterialHandle());
+	input.Depth = renderObject.GetViewDepth();
+	task.SetSortKey(KeyLayout.Pack(input));
+
+	// Inside a parallel submission the pass is shared, tasks go to the calling chunk instead
+	if (auto* target = RenderGraph::GetSubmitTarget(QueueIndex))
+	{
+		target->push_back(task);
+		return;
+	}
+
 	Tasks.push_back(task);
+	IsSorted = false;
+}
+
+void RenderQueuePass::Append(const std::vector<Task>& tasks)
+{
+	if (tasks.empty())
+		return;
+
+	Tasks.insert(Tasks.end(), tasks.begin(), tasks.end());
+	IsSorted = false;
 }
 
-void RenderQueuePass::Execute() const
+void RenderQueuePass::Record(CommandList& list) const
 {
-	Bind();
-	for (auto& task : Tasks)
-		task.Execute();
+	list.Call<&RenderQueuePass::Execute>(*this);
+	RecordQueue(list);
 }
 
 void RenderQueuePass::Reset()
 {
 	Tasks.clear();
+	IsSorted = false;
+}
+
+void RenderQueuePass::SortQueue() const
+{
+	if (!IsSorted)
+		Sort();
+}
+
+void RenderQueuePass::RecordQueue(CommandList& list, uint32_t views) const
+{
+	SortQueue();
+
+	list.Call<&RenderQueuePass::Bind>(*this);
+	if (InstancesPending)
+	{
+		// Uploaded once for every recording of the frame
+		list.Call<&RenderQueuePass::UploadInstances>(*this);
+		InstancesPending = false;
+	}
+
+	constexpr uint32_t ownProgram = DrawPacket::HasVertexShader | DrawPacket::HasInputLayout;
+	bool instancedProgram = false;
+	for (const DrawRun& run : Runs)
+	{
+		if ((run.Views & views) == 0)
+			continue;
+
+		const DrawPacket& packet = Packets[run.First];
+		if (run.Count > 1)
+		{
+			list.Call<&RenderQueuePass::BindInstances>(*this, run.FirstInstance);
+			packet.RecordInstanced(list, run.Count);
+			instancedProgram = true;
+			continue;
+		}
+
+		// Draws relying on the shader and layout of the pass need them back after an instanced draw
+		if (instancedProgram && (packet.Flags & ownProgram) != ownProgram)
+		{
+			list.Call<&RenderQueuePass::Bind>(*this);
+			instancedProgram = false;
+		}
+		packet.Record(list);
+	}
+}
+
+void RenderQueuePass::Sort() const
+{
+	Order.resize(Tasks.size());
+	Keys.resize(Tasks.size());
+	for (uint32_t i = 0; i < Tasks.size(); i++)
+	{
+		Order[i] = i;
+		Keys[i] = Tasks[i].GetSortKey();
+	}
+
+	if (KeyLayout.Enabled)
+		RadixSort(Keys, Order, ScratchKeys, ScratchOrder);
+
+	Packets.resize(Tasks.size());
+	Views.resize(Tasks.size());
+	for (uint32_t i = 0; i < Tasks.size(); i++)
+	{
+		const Task& task = Tasks[Order[i]];
+		Packets[i] = task.GetStep().GetPacket();
+		Views[i] = GetViewMask(task);
+	}
+
+	// Neighbours that only differ by their per instance matrices merge into one instanced draw,
+	// as long as they are drawn into the same views
+	BuildDrawRuns(Packets, Views, DrawPacket::MaxInstancesPerDraw, Runs, InstanceData);
+
+	InstancesPending = !InstanceData.empty();
+	IsSorted = true;
+}
+
+void RenderQueuePass::UploadInstances() const
+{
+	Instances.Upload(InstanceData.data(), static_cast<uint32_t>(InstanceData.size() / DrawPacket::InstanceStride));
+}
+
+void RenderQueuePass::BindInstances(uint32_t firstInstance) const
+{
+	Instances.BindFrom(firstInstance);
 }
 
 PhongPass::PhongPass(std::string&& name)
@@ -112,7 +269,6 @@ PhongPass::PhongPass(std::string&& name)
 void PhongPass::Execute() const
 {
 	ShadowMap->Bind();
-	RenderQueuePass::Execute();
 }
 
 OutlineDrawPass::OutlineDrawPass(std::string&& name)
@@ -143,7 +299,8 @@ OutlineMaskPass::OutlineMaskPass(std::string&& name)
 BlurOutlineDrawPass::BlurOutlineDrawPass(std::string&& name, uint32_t width, uint32_t height)
 	:RenderQueuePass(std::move(name))
 {
-	RTarget = MakeUnique<RenderTargetInput>(width / 2, height / 2);
+	Register<PassTransient<RenderTargetInput, RenderTarget>>("scratchOut", RTarget,
+															 TransientDesc{ width / 2, height / 2, 1, DXGI_FORMAT_B8G8R8A8_UNORM });
 	Add<VertexShader>("colorInput");
 	Add<PixelShader>("colorInput");
 	Add<StencilState<DepthStencilMode::Mask>>();
@@ -154,7 +311,6 @@ BlurOutlineDrawPass::BlurOutlineDrawPass(std::string&& name, uint32_t width, uin
 void BlurOutlineDrawPass::Execute() const
 {
 	RTarget->Clear();
-	RenderQueuePass::Execute();
 }
 
 HorizontalBlurPass::HorizontalBlurPass(std::string&& name, uint32_t width, uint32_t height)
@@ -168,7 +324,8 @@ HorizontalBlurPass::HorizontalBlurPass(std::string&& name, uint32_t width, uint3
 	Register<PassInput<UniformPS<BOOL>>>("direction", HorizontalFlag);
 	Register<PassInput<RenderTarget>>("scratchIn", BlurScratchIn);
 
-	RTarget = MakeShared<RenderTargetInput>(width / 2, height / 2);
+	Register<PassTransient<RenderTargetInput, RenderTarget>>("scratchOut", RTarget,
+															 TransientDesc{ width / 2, height / 2, 1, DXGI_FORMAT_B8G8R8A8_UNORM });
 	Register<PassOutput<RenderTarget, true>>("scratchOut", RTarget);
 }
 
@@ -179,7 +336,6 @@ void HorizontalBlurPass::Execute() const
 	ConvKernel->Bind();
 	BlurScratchIn->Bind();
 	BlendState("$FullScreenFilter", true).Bind();
-	FullScreenPass::Execute();
 }
 
 VerticalBlurPass::VerticalBlurPass(std::string&& name)
@@ -205,13 +361,13 @@ void VerticalBlurPass::Execute() const
 	ConvKernel->Bind();
 	BlurScratchIn->Bind();
 	BlendState("$FullScreenFilter", true).Bind();
-	FullScreenPass::Execute();
 }
 
 ShadowMappingPass::ShadowMappingPass(std::string&& name, const PointLight* pointLight)
 	:RenderQueuePass(std::move(name)), LightSource(pointLight)
 {
-	DepthCube = MakeShared<CubeTextureDepth>(DepthDim, 3);
+	Register<PassTransient<CubeTextureDepth>>("map", DepthCube,
+											  TransientDesc{ DepthDim, DepthDim, 6, DXGI_FORMAT_R32_TYPELESS, 4, 3 });
 	Add<VertexShader>("ShadowMapUpdate");
 	Add<NullPixelShader>();
 	Add<StencilState<DepthStencilMode::Off>>();
@@ -219,56 +375,167 @@ ShadowMappingPass::ShadowMappingPass(std::string&& name, const PointLight* point
 	Add<Viewport>(DepthDim, DepthDim);
 	Add<ShadowRasterizerState>();
 
+	// All six faces share one order and camera depth means nothing to the light, group by program only
+	SortKeyLayout layout;
+	layout.Opaque = { { SortKeyLayout::Field::Program, 55 } };
+	layout.Translucent = layout.Opaque;
+	SetSortKeyLayout(std::move(layout));
+
 	ViewUniform = MakeUnique< UniformVS<DirectX::XMMATRIX>>("$shadowView", View, 3);
 	ViewProjectionUniform = MakeUnique< UniformVS<DirectX::XMMATRIX>>("$shadowViewProj", ViewProjection, 4);
 
 	Register<PassOutput<CubeTextureDepth>>("map", DepthCube);
 
-	Projection = DirectX::XMMatrixPerspectiveFovLH(pi / 2.0f, 1.0f, 0.5f, 100.0f);
-
-	CameraOrientation[0] = DirectX::XMFLOAT3{ 0, pi / 2.0f, 0 };
-	CameraOrientation[1] = DirectX::XMFLOAT3{ 0, -pi / 2.0f, 0 };
-	CameraOrientation[2] = DirectX::XMFLOAT3{ -pi / 2.0f, 0, 0 };
-	CameraOrientation[3] = DirectX::XMFLOAT3{ pi / 2.0f, 0, 0 };
-	CameraOrientation[4] = DirectX::XMFLOAT3{ 0, 0, 0 };
-	CameraOrientation[5] = DirectX::XMFLOAT3{ 0, -pi, 0 };
+	StaticCache = MakeShared<CubeTextureDepth>(DepthDim, 3);
+}
 
+void ShadowMappingPass::Validate()
+{
+	// The cube is a transient, it only exists once the render graph is compiled
 	SetDepthBuffer(DepthCube->operator[](0));
+	RenderQueuePass::Validate();
 }
 
-void ShadowMappingPass::Execute() const
+void ShadowMappingPass::Record(CommandList& list) const
 {
-	using namespace DirectX;
+	// The light does not move during recording, so the faces are known before the queue is sorted
+	Faces.Place(LightSource->GetWorldPosition(), LightSource->GetRange());
+
+	FaceCasters.fill(0);
+	CastersOutOfRange = 0;
+	FaceSignatures.fill(0);
+	SortQueue();
+
+	// Any change of the light invalidates every face, otherwise only faces whose static casters changed
+	const DirectX::XMFLOAT3& lightPosition = Faces.GetPosition();
+	if (lightPosition.x != CachedLightPosition.x || lightPosition.y != CachedLightPosition.y ||
+		lightPosition.z != CachedLightPosition.z || Faces.GetRange() != CachedLightRange)
+		DirtyFaces = ShadowCube::AllFaces;
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		if (FaceSignatures[i] != CachedSignatures[i])
+			DirtyFaces |= 1u << i;
+	}
+	CachedSignatures = FaceSignatures;
+	CachedLightPosition = lightPosition;
+	CachedLightRange = Faces.GetRange();
 
-	ID3D11ShaderResourceView* const pNullTex = nullptr;
-	CurrentGraphicsContext::Context()->PSSetShaderResources(3, 1, &pNullTex); // shadow map texture
+	const uint32_t dirty = DirtyFaces;
+	DirtyFaces = 0;
+	RedrawnFaces = 0;
 
-	auto position = LightSource->Position;
-	for (size_t i = 0; i < 6; i++)
+	list.Call<&ShadowMappingPass::Execute>(*this);
+	for (uint32_t i = 0; i < 6; i++)
 	{
-		auto depthStencil = (*DepthCube)[i];
-		depthStencil->Clear();
-		SetDepthBuffer(std::move(depthStencil));
-
-		auto Rotation = CameraOrientation[i];
-		DirectX::XMMATRIX transform = XMMatrixRotationRollPitchYaw(-Rotation.x, -Rotation.y, Rotation.z) *
-			XMMatrixTranslation(-position.x, -position.y, position.z);
-		View = XMMatrixInverse(nullptr, transform);
-		ViewProjection = View * Projection;
-
-		ViewUniform->Bind();
-		ViewProjectionUniform->Bind();
-		RenderQueuePass::Execute();
+		if (dirty & (1u << i))
+		{
+			list.Call<&ShadowMappingPass::BeginStaticFace>(*this, i);
+			RecordQueue(list, 1u << i);
+			RedrawnFaces++;
+		}
+
+		list.Call<&ShadowMappingPass::BeginFace>(*this, i);
+		RecordQueue(list, 1u << (6 + i));
 	}
+	list.Call<&ShadowMappingPass::EndFaces>(*this);
+}
+
+void ShadowMappingPass::InvalidateFaces(uint32_t faces)
+{
+	DirtyFaces |= faces & ShadowCube::AllFaces;
+}
+
+uint32_t ShadowMappingPass::GetViewMask(const Task& task) const
+{
+	const GPUObject& caster = task.GetRenderObject();
+	const Culling::Box* bounds = caster.GetWorldBounds();
+	if (!bounds)
+	{
+		for (size_t& casters : FaceCasters)
+			casters++;
+		return ShadowCube::AllFaces << 6;
+	}
+
+	// A static caster leaving a face changes the signature of that face as well
+	if (!Faces.IsInRange(*bounds))
+	{
+		CastersOutOfRange++;
+		return 0;
+	}
+
+	const uint32_t faces = Faces.GetFaceMask(*bounds);
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		if (faces & (1u << i))
+			FaceCasters[i]++;
+	}
+
+	if (!caster.IsStatic())
+		return faces << 6;
+
+	// Order independent, tasks of one face may come in any order
+	const uint64_t signature = HashCaster(task, *bounds);
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		if (faces & (1u << i))
+			FaceSignatures[i] += signature;
+	}
+	return faces;
+}
+
+void ShadowMappingPass::GUI() const
+{
+	ImGui::Separator();
+	ImGui::Text("Shadow casters per face %zu %zu %zu %zu %zu %zu", FaceCasters[0], FaceCasters[1], FaceCasters[2],
+				FaceCasters[3], FaceCasters[4], FaceCasters[5]);
+	ImGui::Text("Shadow casters out of light range (%.1f) %zu", Faces.GetRange(), CastersOutOfRange);
+	ImGui::Text("Static shadow faces redrawn %u of 6", RedrawnFaces);
+}
+
+void ShadowMappingPass::Execute() const
+{
+	StateCache::PSSetShaderResource(3, nullptr); // shadow map texture
+}
+
+void ShadowMappingPass::BeginFace(uint32_t face) const
+{
+	// Dynamic casters are drawn over the cached static depth
+	DepthCube->CopyFace(*StaticCache, face);
+	SetDepthBuffer((*DepthCube)[face]);
+	SetFaceView(face);
+}
+
+void ShadowMappingPass::BeginStaticFace(uint32_t face) const
+{
+	auto depthStencil = (*StaticCache)[face];
+	depthStencil->Clear();
+	SetDepthBuffer(std::move(depthStencil));
+	SetFaceView(face);
+}
+
+void ShadowMappingPass::SetFaceView(uint32_t face) const
+{
+	using namespace DirectX;
+
+	View = XMMatrixInverse(nullptr, Faces.GetFaceTransform(face));
+	ViewProjection = View * Faces.GetProjection();
+
+	ViewUniform->Bind();
+	ViewProjectionUniform->Bind();
+}
+
+void ShadowMappingPass::EndFaces() const
+{
+	using namespace DirectX;
 
-	View =XMMatrixTranslation(-position.x, -position.y, position.z);
-	View = XMMatrixInverse(nullptr, View);
-	ViewProjection = View * Projection;
+	View = XMMatrixInverse(nullptr, XMMatrixTranslationFromVector(LightSource->GetWorldPosition()));
+	ViewProjection = View * Faces.GetProjection();
 
 	ViewUniform->Bind();
 	ViewProjectionUniform->Bind();
 
 	CurrentGraphicsContext::Context()->OMSetRenderTargets(0, nullptr, nullptr);
+	StateCache::InvalidateShaderResources();
 }
 
 void ShadowMappingPass::SetLightSource(const PointLight* pointLight)
@@ -278,7 +545,7 @@ void ShadowMappingPass::SetLightSource(const PointLight* pointLight)
 
 void ShadowMappingPass::SetDepthBuffer(SharedPtr<DepthStencil> depthStencil) const
 {
-	const_cast<ShadowMappingPass*>(this)->DStencil = depthStencil;
+	DStencil = std::move(depthStencil);
 }
 
 SkyboxPass::SkyboxPass(std::string&& name)
@@ -310,8 +577,8 @@ SkyboxPass::SkyboxPass(std::string&& name)
 	Register<PassOutput<DepthStencil>>("depthStencil", DStencil);
 }
 
-void SkyboxPass::Execute() const
+void SkyboxPass::Record(CommandList& list) const
 {
-	Bind();
-	CurrentGraphicsContext::Context()->DrawIndexed(Count, 0, 0);
+	list.Call<&SkyboxPass::Bind>(*this);
+	list.DrawIndexed(Count, 0);
 }
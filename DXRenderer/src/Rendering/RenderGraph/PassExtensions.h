@@ -3,8 +3,10 @@
 #include "Pass.h"
 #include "Rendering/Utilities.h"
 #include "RenderQueue.h"
+#include "SortKey.h"
 #include "Rendering/Texture.h"
 #include "Rendering/DepthCube.h"
+#include "Rendering/Lights/ShadowCube.h"
 
 class ResourcesPass : public Pass
 {
@@ -39,7 +41,8 @@ class FullScreenPass : public ResourcesPass
 public:
 	FullScreenPass(std::string&& name);
 
-	void Execute() const;
+	// Execute of the filter, then the quad
+	void Record(CommandList& list) const override;
 private:
 	bool Initialized = false;
 };
@@ -51,11 +54,52 @@ public:
 	RenderQueuePass(std::string&& name, GPUObjectBase&& resources);
 
 	void PushBack(Task task);
-	void Execute() const;
+	// Appends tasks gathered by RenderGraph::ParallelSubmit
+	void Append(const std::vector<Task>& tasks);
+	// Execute of the derived pass, then the queued draws
+	void Record(CommandList& list) const override;
 	void Reset();
 
+	inline void SetQueueIndex(size_t index) { QueueIndex = index; }
+	inline size_t GetQueueIndex() const { return QueueIndex; }
+
+protected:
+	static constexpr uint32_t AllViews = ~0u;
+
+	inline void SetSortKeyLayout(SortKeyLayout layout) { KeyLayout = std::move(layout); }
+	// Sorts the queue for the frame, the first RecordQueue does it otherwise
+	void SortQueue() const;
+	// Records the queued draws whose view mask shares a bit with views
+	void RecordQueue(CommandList& list, uint32_t views = AllViews) const;
+	// Views of a pass recording its queue several times that the task is drawn into, evaluated once per sort.
+	// Tasks without any view are dropped.
+	virtual uint32_t GetViewMask(const Task& task) const { return AllViews; }
+
+private:
+	void Sort() const;
+	void UploadInstances() const;
+	void BindInstances(uint32_t firstInstance) const;
+
 protected:
 	std::vector<Task> Tasks;
+
+private:
+	SortKeyLayout KeyLayout = SortKeyLayout::StateFirst();
+	size_t QueueIndex = 0;
+
+	// Draw packets in execution order, sorted once per frame even if recorded several times
+	mutable std::vector<DrawPacket> Packets;
+	mutable std::vector<uint32_t> Views;
+	mutable std::vector<uint32_t> Order;
+	mutable std::vector<uint64_t> Keys;
+	mutable std::vector<uint64_t> ScratchKeys;
+	mutable std::vector<uint32_t> ScratchOrder;
+	mutable bool IsSorted = false;
+
+	mutable std::vector<DrawRun> Runs;
+	mutable std::vector<char> InstanceData;
+	mutable bool InstancesPending = false;
+	mutable InstanceBuffer Instances;
 };
 
 class PhongPass : public RenderQueuePass
@@ -118,27 +162,58 @@ class ShadowMappingPass : public RenderQueuePass
 {
 public:
 	ShadowMappingPass(std::string&& name, const PointLight* pointLight = nullptr);
+	// The queue is recorded once per cube face
+	void Record(CommandList& list) const override;
 	void Execute() const override;
 
 	void SetLightSource(const PointLight* pointLight);
 	void SetDepthBuffer(SharedPtr<DepthStencil> depthStencil) const;
+	void Validate() override;
+	void GUI() const override;
+
+	// Static casters of the faces are drawn into the cache again next frame
+	void InvalidateFaces(uint32_t faces);
+
+	// Texels along the side of a cube face
+	static constexpr uint32_t DepthDim = 1080;
+
+protected:
+	// Cube faces whose frustum the caster overlaps, none outside the light range.
+	// Static casters use the low six bits, dynamic ones the next six.
+	uint32_t GetViewMask(const Task& task) const override;
+
+private:
+	void BeginStaticFace(uint32_t face) const;
+	void BeginFace(uint32_t face) const;
+	void EndFaces() const;
+	void SetFaceView(uint32_t face) const;
 
 private:
 	SharedPtr<ShadowRasterizerState> ShadowRasterizer;
 	const PointLight* LightSource;
 	SharedPtr<CubeTextureDepth> DepthCube;
 
-	mutable DirectX::XMMATRIX Projection;
 	mutable DirectX::XMMATRIX View;
 	mutable DirectX::XMMATRIX ViewProjection;
 
 	UniquePtr<UniformVS<DirectX::XMMATRIX>>	 ViewUniform;
 	UniquePtr<UniformVS<DirectX::XMMATRIX>>	 ViewProjectionUniform;
 
-	std::array<DirectX::XMFLOAT3, 6> CameraUp;
-	std::array<DirectX::XMFLOAT3, 6> CameraOrientation;
-
-	static constexpr uint32_t DepthDim = 1080;
+	// Placed at the light before the queue is sorted for the frame
+	mutable ShadowCube Faces;
+
+	mutable std::array<size_t, 6> FaceCasters{};
+	mutable size_t CastersOutOfRange = 0;
+
+	// Depth of the static casters alone. A face is redrawn when the light moves or the static casters
+	// it holds change, and copied under the dynamic casters every frame.
+	SharedPtr<CubeTextureDepth> StaticCache;
+	mutable std::array<uint64_t, 6> FaceSignatures{};
+	mutable std::array<uint64_t, 6> CachedSignatures{};
+	mutable DirectX::XMFLOAT3 CachedLightPosition{};
+	mutable float CachedLightRange = 0.0f;
+	mutable uint32_t DirtyFaces = ShadowCube::AllFaces;
+	mutable uint32_t RedrawnFaces = 0;
 };
 
 class SkyboxPass : public ResourcesPass
@@ -146,7 +221,7 @@ class SkyboxPass : public ResourcesPass
 public:
 	SkyboxPass(std::string&& name);
 
-	void Execute() const override;
+	void Record(CommandList& list) const override;
 
 private:
 	uint32_t Count;
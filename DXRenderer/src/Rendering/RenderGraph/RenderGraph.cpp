@@ -1,10 +1,15 @@
 #include "RenderGraph.h"
 
+#include "GraphCompiler.h"
+#include "ParallelSubmission.h"
 #include "Pass.h"
 #include "PassExtensions.h"
 #include "Rendering/CurrentGraphicsContext.h"
 #include "Rendering/Graphics.h"
 #include "Rendering/RenderTarget.h"
+#include "Core/ThreadPool.h"
+
+#include <imgui.h>
 
 RenderGraph& RenderGraph::Get()
 {
@@ -22,6 +27,11 @@ void RenderGraph::Execute()
 	RenderGraph::Get().ExecuteImpl();
 }
 
+void RenderGraph::SetBackend(UniquePtr<DeviceBackend> backend)
+{
+	RenderGraph::Get().SetBackendImpl(std::move(backend));
+}
+
 void RenderGraph::Reset()
 {
 	RenderGraph::Get().ResetImpl();
@@ -47,6 +57,21 @@ void RenderGraph::Validate()
 	RenderGraph::Get().ValidateImpl();
 }
 
+void RenderGraph::GUI()
+{
+	RenderGraph::Get().GUIImpl();
+}
+
+void RenderGraph::ParallelSubmit(size_t count, size_t grain, const std::function<void(size_t)>& submit)
+{
+	RenderGraph::Get().ParallelSubmitImpl(count, grain, submit);
+}
+
+std::vector<Task>* RenderGraph::GetSubmitTarget(size_t queueIndex)
+{
+	return ParallelSubmission<Task>::GetTarget(queueIndex);
+}
+
 RenderQueuePass& RenderGraph::GetRenderQueue(const std::string& passName)
 {
 	return RenderGraph::Get().GetRenderQueueImpl(passName);
@@ -57,6 +82,11 @@ void RenderGraph::SetUpLightSource(const PointLight* pointLight)
 	RenderGraph::Get().SetUpLightSourceImpl(pointLight);
 }
 
+const PointLight* RenderGraph::GetLightSource()
+{
+	return RenderGraph::Get().LightSource;
+}
+
 void RenderGraph::AddGlobalInputs(UniquePtr<PassInputBase> in)
 {
 	RenderGraph::Get().AddGlobalInputsImpl(std::move(in));
@@ -71,7 +101,8 @@ RenderGraph::RenderGraph()
 	:BackBuffer(CurrentGraphicsContext::GraphicsInfo->GetTarget()),
 	DepthBuffer(MakeShared<DepthStencilOutput>(CurrentGraphicsContext::GraphicsInfo->GetWidth(),
 											   CurrentGraphicsContext::GraphicsInfo->GetHeight())),
-	ShadowRasterizer(MakeShared<ShadowRasterizerState>())
+	ShadowRasterizer(MakeShared<ShadowRasterizerState>()),
+	Backend(MakeUnique<D3D11Backend>())
 {
 	GlobalOutputs.emplace_back(MakeUnique<PassOutput<RenderTarget>>("backBuffer", BackBuffer));
 	GlobalOutputs.emplace_back(MakeUnique<PassOutput<DepthStencil>>("depthBuffer", DepthBuffer));
@@ -136,9 +167,34 @@ void RenderGraph::SetInputTargetImpl(const std::string& name, const std::string&
 void RenderGraph::ExecuteImpl()
 {
 	ASSERT(IsValidated);
+	Timer timer;
+
+	CommandLists.resize(Schedule.size());
+	ThreadPool::ParallelFor(Schedule.size(), 1, [this](size_t, size_t begin, size_t end)
+							{
+								for (size_t i = begin; i < end; i++)
+								{
+									CommandLists[i].Reset();
+									Schedule[i]->Record(CommandLists[i]);
+								}
+							});
+	RecordTime = timer.GetAndReset();
+
+	CommandCount = 0;
+	Backend->BeginFrame();
+	for (const CommandList& list : CommandLists)
+	{
+		Backend->Submit(list);
+		CommandCount += list.Size();
+	}
 
-	for (const auto& pass : Passes)
-		pass->Execute();
+	PlaybackTime = timer.Get();
+}
+
+void RenderGraph::SetBackendImpl(UniquePtr<DeviceBackend> backend)
+{
+	ASSERT(backend);
+	Backend = std::move(backend);
 }
 
 void RenderGraph::ResetImpl()
@@ -160,7 +216,7 @@ void RenderGraph::AddImpl(UniquePtr<Pass> pass)
 
 	if (it != Passes.end()) throw std::invalid_argument("Pass name already exists");
 
-	LinkInputsImpl(*pass);
+	// Inputs are linked once the graph is compiled and its transients exist
 	Passes.emplace_back(std::move(pass));
 }
 
@@ -223,13 +279,156 @@ void RenderGraph::LinkGlobalInputsImpl()
 void RenderGraph::ValidateImpl()
 {
 	ASSERT(!IsValidated);
+	CompileImpl();
+
+	RenderQueues.clear();
+	for (const auto& pass : Passes)
+	{
+		if (auto* queue = dynamic_cast<RenderQueuePass*>(pass.get()))
+		{
+			queue->SetQueueIndex(RenderQueues.size());
+			RenderQueues.push_back(queue);
+		}
+	}
+
 	for (const auto& pass : Passes)
-		pass->Validate();
+		LinkInputsImpl(*pass);
+
+	// Culled passes never run and their transients are not allocated
+	for (const auto& pass : Passes)
+		if (std::find(CulledPasses.begin(), CulledPasses.end(), pass.get()) == CulledPasses.end())
+			pass->Validate();
 
 	LinkGlobalInputsImpl();
 	IsValidated = true;
 }
 
+void RenderGraph::CompileImpl()
+{
+	ASSERT(!IsValidated);
+	Timer timer;
+
+	GraphCompiler compiler;
+	for (const auto& out : GlobalOutputs)
+		compiler.AddResource(GraphCompiler::External, out->GetName());
+
+	// Inputs only refer to passes added before, so reads resolve as the passes are described
+	for (uint32_t index = 0; index < Passes.size(); index++)
+	{
+		const Pass& pass = *Passes[index];
+		compiler.AddPass(pass.GetName());
+
+		std::vector<std::pair<const std::string*, uint32_t>> reads;
+		for (const auto& in : pass.GetInputs())
+			reads.emplace_back(&in->GetName(), compiler.AddRead(index, in->GetPassName(), in->GetOutputName()));
+
+		// An output named after an input hands on the resource that was read
+		for (const auto& out : pass.GetOutputs())
+		{
+			uint32_t source = GraphCompiler::External;
+			for (const auto& [name, resource] : reads)
+				if (*name == out->GetName())
+					source = resource;
+
+			compiler.AddResource(index, out->GetName(), source);
+		}
+	}
+
+	for (const auto& in : GlobalInputs)
+		compiler.AddSink(in->GetPassName(), in->GetOutputName());
+
+	const GraphCompiler::Plan plan = compiler.Compile();
+
+	Schedule.clear();
+	for (uint32_t index : plan.Schedule)
+		Schedule.push_back(Passes[index].get());
+
+	CulledPasses.clear();
+	for (uint32_t index : plan.Culled)
+		CulledPasses.push_back(Passes[index].get());
+
+	// Transients of scheduled passes, their lifetime is that of the output they are registered under
+	std::vector<PassTransientBase*> transients;
+	std::vector<TransientPlanner::Request> requests;
+	for (uint32_t index : plan.Schedule)
+	{
+		for (const auto& transient : Passes[index]->GetTransients())
+		{
+			const uint32_t resource = compiler.FindResource(Passes[index]->GetName(), transient->GetName());
+			const GraphCompiler::Lifetime& lifetime = plan.Lifetimes[plan.Roots[resource]];
+
+			const TransientDesc& desc = transient->GetDesc();
+			const std::string key = std::string(transient->GetType().name()) + "#" + std::to_string(desc.Width) + "x" +
+				std::to_string(desc.Height) + "x" + std::to_string(desc.ArraySize) + "#" + std::to_string(desc.Format) +
+				"#" + std::to_string(desc.Slot);
+
+			transients.push_back(transient.get());
+			requests.push_back({ InternResourceID(key), desc.GetByteSize(), lifetime.First, lifetime.Last });
+		}
+	}
+
+	const TransientPlanner::Plan allocation = TransientPlanner::Build(requests);
+	std::vector<PassTransientBase*> allocated(allocation.PhysicalBytes.size(), nullptr);
+	for (size_t i = 0; i < transients.size(); i++)
+	{
+		PassTransientBase*& physical = allocated[allocation.Physical[i]];
+		if (physical)
+			transients[i]->Alias(*physical);
+		else
+		{
+			transients[i]->Allocate();
+			physical = transients[i];
+		}
+	}
+
+	TransientCount = transients.size();
+	TransientAllocations = allocated.size();
+	TransientRequestedBytes = allocation.RequestedBytes;
+	TransientAllocatedBytes = allocation.AllocatedBytes;
+
+	CompileTime = timer.Get();
+}
+
+void RenderGraph::GUIImpl()
+{
+	if (ImGui::Begin("Render Graph"))
+	{
+		ImGui::Text("Compiled in %.3f ms", CompileTime * 1000.0f);
+		ImGui::Text("Record %.3f ms, playback %.3f ms", RecordTime * 1000.0f, PlaybackTime * 1000.0f);
+		ImGui::Text("Commands %zu", CommandCount);
+		ImGui::Text("Submission threads %zu", ThreadPool::GetConcurrency());
+		ImGui::Text("Transients %zu in %zu allocations", TransientCount, TransientAllocations);
+		ImGui::Text("Transient memory %.2f MB, %.2f MB without aliasing",
+					TransientAllocatedBytes / (1024.0f * 1024.0f), TransientRequestedBytes / (1024.0f * 1024.0f));
+
+		ImGui::Separator();
+		ImGui::Text("Schedule");
+		for (const Pass* pass : Schedule)
+			ImGui::BulletText("%s", pass->GetName().c_str());
+
+		for (const Pass* pass : Schedule)
+			pass->GUI();
+
+		if (!CulledPasses.empty())
+		{
+			ImGui::Text("Culled");
+			for (const Pass* pass : CulledPasses)
+				ImGui::BulletText("%s", pass->GetName().c_str());
+		}
+	}
+	ImGui::End();
+}
+
+void RenderGraph::ParallelSubmitImpl(size_t count, size_t grain, const std::function<void(size_t)>& submit)
+{
+	ASSERT(IsValidated);
+	ParallelSubmission<Task> submission(RenderQueues.size());
+	submission.Run(count, grain, submit, [this](size_t queue, const std::vector<Task>& tasks)
+				   {
+					   RenderQueues[queue]->Append(tasks);
+				   });
+}
+
 RenderQueuePass& RenderGraph::GetRenderQueueImpl(const std::string& passName)
 {
 	try
@@ -254,7 +453,10 @@ void RenderGraph::SetUpLightSourceImpl(const PointLight* pointLight)
 	ASSERT(it != Passes.end() && "Name not found!");
 
 	if (auto* outPtr = dynamic_cast<ShadowMappingPass*>((*it).get()))
+	{
 		outPtr->SetLightSource(pointLight);
+		LightSource = pointLight;
+	}
 	else
 		throw std::bad_cast();
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "Rendering/CommandList.h"
+#include "Rendering/DeviceBackend.h"
 #include "Rendering/Utilities.h"
+#include "Core/Timer.h"
 
 class Pass;
 class PassInputBase;
@@ -9,20 +12,31 @@ class RenderQueuePass;
 class DepthStencil;
 class RenderTarget;
 class ShadowRasterizerState;
+class Task;
 
 class RenderGraph
 {
 public:
 	static RenderGraph& Get();
 	static void SetInputTarget(const std::string& name, const std::string& target);
+	// Records the scheduled passes in parallel, then plays the lists back in schedule order
 	static void Execute();
+	// Where recorded lists are played back, the D3D11 immediate context by default
+	static void SetBackend(UniquePtr<DeviceBackend> backend);
 	static void Reset();
 	static void Add(UniquePtr<Pass> pass);
 	static void LinkInputs(Pass& pass);
 	static void LinkGlobalInputs();
 	static void Validate();
+	static void GUI();
+	// Calls submit for [0, count) on the thread pool. Tasks pushed meanwhile are gathered per chunk and
+	// merged in chunk order, the queues end up as if the submission was serial. Regions may nest.
+	static void ParallelSubmit(size_t count, size_t grain, const std::function<void(size_t)>& submit);
+	// Task list of the current parallel chunk for a queue, null when not inside ParallelSubmit
+	static std::vector<Task>* GetSubmitTarget(size_t queueIndex);
 	static RenderQueuePass& GetRenderQueue(const std::string& passName);
 	static void SetUpLightSource(const class PointLight* pointLight);
+	static const PointLight* GetLightSource();
 
 	static void AddGlobalInputs(UniquePtr<PassInputBase> in);
 	static void AddGlobalOutputs(UniquePtr<PassOutputBase> out);
@@ -33,11 +47,15 @@ private:
 
 	void SetInputTargetImpl(const std::string& name, const std::string& target);
 	void ExecuteImpl();
+	void SetBackendImpl(UniquePtr<DeviceBackend> backend);
 	void ResetImpl();
 	void AddImpl(UniquePtr<Pass> pass);
 	void LinkInputsImpl(Pass& pass);
 	void LinkGlobalInputsImpl();
 	void ValidateImpl();
+	void CompileImpl();
+	void GUIImpl();
+	void ParallelSubmitImpl(size_t count, size_t grain, const std::function<void(size_t)>& submit);
 	RenderQueuePass& GetRenderQueueImpl(const std::string& passName);
 	void SetUpLightSourceImpl(const PointLight* pointLight);
 
@@ -46,10 +64,29 @@ private:
 
 private:
 	std::vector<UniquePtr<Pass>> Passes;
+	// Indexed by RenderQueuePass::GetQueueIndex
+	std::vector<RenderQueuePass*> RenderQueues;
 	std::vector<UniquePtr<PassInputBase>> GlobalInputs;
 	std::vector<UniquePtr<PassOutputBase>> GlobalOutputs;
 	SharedPtr<DepthStencil> DepthBuffer;
 	SharedPtr<RenderTarget> BackBuffer;
 	SharedPtr<ShadowRasterizerState> ShadowRasterizer;
+	const PointLight* LightSource = nullptr;
 	bool IsValidated = false;
+
+	// Live passes in dependency order, filled by CompileImpl
+	std::vector<const Pass*> Schedule;
+	std::vector<const Pass*> CulledPasses;
+	// One list per scheduled pass
+	std::vector<CommandList> CommandLists;
+	UniquePtr<DeviceBackend> Backend;
+	float CompileTime = 0.0f;
+	float RecordTime = 0.0f;
+	float PlaybackTime = 0.0f;
+	size_t CommandCount = 0;
+
+	size_t TransientCount = 0;
+	size_t TransientAllocations = 0;
+	uint64_t TransientRequestedBytes = 0;
+	uint64_t TransientAllocatedBytes = 0;
 };
\ No newline at end of file
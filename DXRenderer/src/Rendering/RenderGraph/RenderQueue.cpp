@@ -16,23 +16,54 @@ void Step::Submit(const GPUObject& renderObject) const
 	TargetPass->PushBack(Task{ &renderObject, this });
 }
 
-void Step::Link()
+void Step::Link(const GPUObject& owner)
 {
 	ASSERT(TargetPass == nullptr);
 	TargetPass = &RenderGraph::GetRenderQueue(TargetPassName);
+
+	Packet = DrawPacket{};
+	owner.Record(Packet);
+	Resources.Record(Packet);
+	Packet.Ranges = owner.GetDrawRanges(Channels);
+
+	// Step resources are complete once linked, the handles never change afterwards
+	ProgramHandle = Resources.GetProgramHandle();
+	MaterialHandle = Resources.GetMaterialHandle();
+
+	if (InstancedShader)
+	{
+		DrawPacket variant{};
+		InstancedShader->Record(variant);
+		InstancedLayout->Record(variant);
+		Packet.InstancedVertexShader = variant.VertexShader;
+		Packet.InstancedInputLayout = variant.InputLayout;
+
+		for (const auto& instance : PerInstance)
+			Packet.InstanceMatrices[Packet.InstanceMatrixCount++] = instance.Data;
+
+		for (uint32_t i = 0; i < Packet.DynamicCount; i++)
+			for (const auto& instance : PerInstance)
+				if (Packet.Dynamic[i].Object == instance.Uniform)
+					Packet.PerInstanceMask |= 1u << i;
+
+		// Objects sharing geometry sort next to each other, so their draws can merge
+		if (const IndexBuffer* indices = owner.GetIndexBuffer())
+			MaterialHandle = CombineResourceHandles(MaterialHandle, indices->GetHandle());
+	}
+}
+
+void Step::SetInstancing(const std::string& vertexShader, const std::string& layoutTag, const BufferLayout& layout)
+{
+	ASSERT(!PerInstance.empty());
+	InstancedShader = Pool::Add(MakeShared<VertexShader>(vertexShader));
+	InstancedLayout = Pool::Add(MakeShared<InputLayout>(layoutTag, layout, static_cast<uint32_t>(PerInstance.size()),
+														InstancedShader->GetBlob()));
 }
 
 Task::Task(const GPUObject* renderObject, const Step* step)
 	:RenderObject(renderObject), TStep(step)
 {}
 
-void Task::Execute() const
-{
-	RenderObject->Bind();
-	TStep->Bind();
-	CurrentGraphicsContext::Context()->DrawIndexed(RenderObject->GetIndexBuffer()->GetCount(), 0, 0);
-}
-
 Technique::Technique(size_t channels)
 	:Channels(channels)
 {}
@@ -47,11 +78,12 @@ void Technique::Submit(const GPUObject& renderObject, size_t channelsIn)
 
 void Technique::PushBack(Step&& step)
 {
+	step.Channels = Channels;
 	Steps.emplace_back(std::move(step));
 }
 
-void Technique::Link()
+void Technique::Link(const GPUObject& owner)
 {
 	for (auto& step : Steps)
-		step.Link();
+		step.Link(owner);
 }
\ No newline at end of file
@@ -19,25 +19,77 @@ public:
 		Resources.Add<T>(std::forward<Args>(args)...);
 	}
 
+	// Per object matrix uniform, streamed per instance instead when the step is drawn instanced
+	template<typename T, typename... Args>
+	void AddPerInstance(Args&&... args)
+	{
+		auto uniform = MakeShared<T>(std::forward<Args>(args)...);
+		static_assert(sizeof(uniform->GetResourceRef()) == 64, "Instance data is made of 4x4 float matrices");
+		ASSERT(PerInstance.size() < DrawPacket::MaxInstanceMatrices);
+
+		PerInstance.push_back({ uniform.get(), &uniform->GetResourceRef() });
+		Resources.Add(std::move(uniform));
+	}
+
+	// Lets draws of several objects that only differ by their per instance uniforms merge into one
+	// instanced draw, using the given vertex shader on a layout extended by the instance stream
+	void SetInstancing(const std::string& vertexShader, const std::string& layoutTag, const BufferLayout& layout);
+
 	void Bind() const;
 	void Submit(const GPUObject& renderObject) const;
-	void Link();
+	void Link(const GPUObject& owner);
+
+	inline size_t GetChannels() const { return Channels; }
+	inline const DrawPacket& GetPacket() const { return Packet; }
+
+	// Draws of a lower layer run first within a pass
+	inline void SetLayer(uint8_t layer) { Layer = layer; }
+	inline void SetTranslucent(bool translucent) { Translucent = translucent; }
+	inline uint8_t GetLayer() const { return Layer; }
+	inline bool IsTranslucent() const { return Translucent; }
+	inline ResourceHandle GetProgramHandle() const { return ProgramHandle; }
+	inline ResourceHandle GetMaterialHandle() const { return MaterialHandle; }
 
 private:
+	friend class Technique;
+
 	std::string TargetPassName;
 	GPUObject Resources;
 	class RenderQueuePass* TargetPass{ nullptr };
+	size_t Channels = 0;
+	// Owner resources followed by the step's own, baked when linked
+	DrawPacket Packet;
+
+	uint8_t Layer = 0;
+	bool Translucent = false;
+	ResourceHandle ProgramHandle = InvalidResourceHandle;
+	ResourceHandle MaterialHandle = InvalidResourceHandle;
+
+	struct PerInstanceUniform
+	{
+		const BufferBase* Uniform;
+		const void* Data;
+	};
+	std::vector<PerInstanceUniform> PerInstance;
+	SharedPtr<Shader> InstancedShader;
+	SharedPtr<BufferBase> InstancedLayout;
 };
 
 class Task
 {
 public:
 	Task(const GPUObject* renderObject, const Step* step);
-	void Execute() const;
+
+	inline const GPUObject& GetRenderObject() const { return *RenderObject; }
+	inline const Step& GetStep() const { return *TStep; }
+
+	inline void SetSortKey(uint64_t key) { SortKey = key; }
+	inline uint64_t GetSortKey() const { return SortKey; }
 
 private:
 	const GPUObject* RenderObject;
 	const Step* TStep;
+	uint64_t SortKey = 0;
 };
 
 class Technique
@@ -51,7 +103,7 @@ public:
 
 	void PushBack(Step&& step);
 
-	void Link();
+	void Link(const GPUObject& owner);
 
 private:
 	bool IsActive = true;
@@ -0,0 +1,126 @@
+#include "SortKey.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+	constexpr uint32_t FieldBits = 55;
+
+	uint64_t Fold(uint64_t handle, uint32_t bits)
+	{
+		handle ^= handle >> 32;
+		handle ^= handle >> 16;
+		return bits >= 64 ? handle : handle & ((1ull << bits) - 1);
+	}
+
+	uint64_t QuantizeDepth(float depth, uint32_t bits)
+	{
+		// Positive floats order like their bit patterns, the top bits are a logarithmic quantization
+		depth = std::max(depth, 0.0f);
+		uint32_t pattern;
+		std::memcpy(&pattern, &depth, sizeof(pattern));
+		return (pattern << 1) >> (32 - bits);
+	}
+}
+
+uint64_t SortKeyLayout::Pack(const SortKeyInput& input) const
+{
+	if (!Enabled)
+		return 0;
+
+	uint64_t key = (uint64_t(input.Layer) << 56) | (uint64_t(input.Translucent) << FieldBits);
+
+	uint32_t shift = FieldBits;
+	for (const Entry& entry : input.Translucent ? Translucent : Opaque)
+	{
+		const uint32_t bits = std::min<uint32_t>(entry.Bits, shift);
+		if (bits == 0)
+			break;
+		shift -= bits;
+
+		uint64_t value = 0;
+		switch (entry.Type)
+		{
+		case Field::Program:
+			value = Fold(input.Program, bits);
+			break;
+		case Field::Material:
+			value = Fold(input.Material, bits);
+			break;
+		case Field::Depth:
+			value = QuantizeDepth(input.Depth, std::min<uint32_t>(bits, 31));
+			break;
+		case Field::DepthReversed:
+			value = ~QuantizeDepth(input.Depth, std::min<uint32_t>(bits, 31)) & ((1ull << std::min<uint32_t>(bits, 31)) - 1);
+			break;
+		}
+
+		key |= value << shift;
+	}
+
+	return key;
+}
+
+SortKeyLayout SortKeyLayout::StateFirst()
+{
+	SortKeyLayout layout;
+	layout.Opaque = { { Field::Program, 12 }, { Field::Material, 16 }, { Field::Depth, 27 } };
+	layout.Translucent = { { Field::DepthReversed, 31 }, { Field::Program, 12 }, { Field::Material, 12 } };
+	return layout;
+}
+
+SortKeyLayout SortKeyLayout::DepthFirst()
+{
+	SortKeyLayout layout;
+	layout.Opaque = { { Field::Depth, 31 }, { Field::Program, 24 } };
+	layout.Translucent = { { Field::DepthReversed, 31 }, { Field::Program, 24 } };
+	return layout;
+}
+
+SortKeyLayout SortKeyLayout::Unsorted()
+{
+	SortKeyLayout layout;
+	layout.Enabled = false;
+	return layout;
+}
+
+void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& order,
+			   std::vector<uint64_t>& scratchKeys, std::vector<uint32_t>& scratchOrder)
+{
+	const size_t count = keys.size();
+	if (count < 2)
+		return;
+
+	scratchKeys.resize(count);
+	scratchOrder.resize(count);
+
+	for (uint32_t shift = 0; shift < 64; shift += 8)
+	{
+		std::array<uint32_t, 256> histogram{};
+		for (uint64_t key : keys)
+			histogram[(key >> shift) & 0xFF]++;
+
+		if (histogram[(keys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		uint32_t sum = 0;
+		for (auto& bucket : histogram)
+		{
+			const uint32_t size = bucket;
+			bucket = sum;
+			sum += size;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint32_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+			scratchKeys[destination] = keys[i];
+			scratchOrder[destination] = order[i];
+		}
+
+		keys.swap(scratchKeys);
+		order.swap(scratchOrder);
+	}
+}
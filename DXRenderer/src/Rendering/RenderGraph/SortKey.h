@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct SortKeyInput
+{
+	uint8_t Layer = 0;
+	bool Translucent = false;
+	uint64_t Program = 0;
+	uint64_t Material = 0;
+	// View space depth, negative values clamp to zero
+	float Depth = 0.0f;
+};
+
+// Packs a draw into a 64-bit key: 8 bits of layer, 1 bit of translucency and 55 bits of
+// fields whose order and widths each RenderQueuePass chooses. Keys sort ascending.
+struct SortKeyLayout
+{
+	enum class Field : uint8_t
+	{
+		Program,
+		Material,
+		// Front to back
+		Depth,
+		// Back to front
+		DepthReversed
+	};
+
+	struct Entry
+	{
+		Field Type;
+		uint8_t Bits;
+	};
+
+	// Most significant first, at most 55 bits in total, depth fields at most 31 bits
+	std::vector<Entry> Opaque;
+	std::vector<Entry> Translucent;
+	bool Enabled = true;
+
+	uint64_t Pack(const SortKeyInput& input) const;
+
+	// Group by shader program and material, then front to back; translucent draws back to front
+	static SortKeyLayout StateFirst();
+	// Front to back only, for depth only passes
+	static SortKeyLayout DepthFirst();
+	// Keep submission order
+	static SortKeyLayout Unsorted();
+};
+
+// Stable LSD radix sort on 8-bit digits, skipping digits all keys share. order is permuted alongside keys.
+void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& order,
+			   std::vector<uint64_t>& scratchKeys, std::vector<uint32_t>& scratchOrder);
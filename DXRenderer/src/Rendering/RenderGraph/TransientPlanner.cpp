@@ -0,0 +1,53 @@
+#include "TransientPlanner.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace TransientPlanner
+{
+	Plan Build(const std::vector<Request>& requests)
+	{
+		Plan plan;
+		plan.Physical.resize(requests.size());
+
+		std::vector<uint32_t> order(requests.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&requests](uint32_t a, uint32_t b)
+						 {
+							 return requests[a].First < requests[b].First;
+						 });
+
+		// Interval partitioning per key, visiting requests by start keeps the allocation count minimal
+		std::vector<uint64_t> keys;
+		std::vector<uint32_t> releasedAfter;
+		for (uint32_t index : order)
+		{
+			const Request& request = requests[index];
+			plan.RequestedBytes += request.Bytes;
+
+			uint32_t best = ~0u;
+			for (uint32_t physical = 0; physical < keys.size(); physical++)
+			{
+				if (keys[physical] != request.Key || releasedAfter[physical] >= request.First)
+					continue;
+				if (best == ~0u || releasedAfter[physical] < releasedAfter[best])
+					best = physical;
+			}
+
+			if (best == ~0u)
+			{
+				best = static_cast<uint32_t>(keys.size());
+				keys.push_back(request.Key);
+				releasedAfter.push_back(request.Last);
+				plan.PhysicalBytes.push_back(request.Bytes);
+				plan.AllocatedBytes += request.Bytes;
+			}
+			else
+				releasedAfter[best] = request.Last;
+
+			plan.Physical[index] = best;
+		}
+
+		return plan;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Size and format of a render graph owned resource, Format holds a DXGI_FORMAT
+struct TransientDesc
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t ArraySize = 1;
+	uint32_t Format = 0;
+	uint32_t BytesPerTexel = 4;
+	// Shader resource slot the view is bound to
+	uint32_t Slot = 0;
+
+	inline uint64_t GetByteSize() const { return uint64_t(Width) * Height * ArraySize * BytesPerTexel; }
+	bool operator==(const TransientDesc&) const = default;
+};
+
+// Assigns transient resources to physical allocations. Requests with the same key are interchangeable
+// and share an allocation whenever their lifetimes, in compiled schedule positions, do not overlap.
+namespace TransientPlanner
+{
+	struct Request
+	{
+		uint64_t Key;
+		uint64_t Bytes;
+		// First and last schedule position using the resource, inclusive
+		uint32_t First;
+		uint32_t Last;
+	};
+
+	struct Plan
+	{
+		// Physical allocation of each request
+		std::vector<uint32_t> Physical;
+		std::vector<uint64_t> PhysicalBytes;
+		// Memory with one allocation per request, as without aliasing
+		uint64_t RequestedBytes = 0;
+		uint64_t AllocatedBytes = 0;
+	};
+
+	Plan Build(const std::vector<Request>& requests);
+}
\ No newline at end of file
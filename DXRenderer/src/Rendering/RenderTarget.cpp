@@ -1,5 +1,6 @@
 #include "RenderTarget.h"
 #include "CurrentGraphicsContext.h"
+#include "StateCache.h"
 
 namespace
 {
@@ -91,6 +92,7 @@ DepthStencil::DepthStencil(Microsoft::WRL::ComPtr<ID3D11Texture2D> texture, uint
 void DepthStencil::BindBuffer() const
 {
 	CurrentGraphicsContext::Context()->OMSetRenderTargets(0, nullptr, DepthStencilView.Get());
+	StateCache::InvalidateShaderResources();
 }
 
 void DepthStencil::BindBuffer(RenderTarget& renderTarget)
@@ -122,7 +124,7 @@ DepthStencilInput::DepthStencilInput(uint32_t width, uint32_t height, uint32_t s
 
 void DepthStencilInput::Bind()
 {
-	(CurrentGraphicsContext::Context()->PSSetShaderResources(Slot, 1, ShaderResourceView.GetAddressOf()));
+	StateCache::PSSetShaderResource(Slot, ShaderResourceView.Get());
 }
 
 DepthStencilOutput::DepthStencilOutput(uint32_t width, uint32_t height)
@@ -177,6 +179,7 @@ RenderTarget::RenderTarget(ID3D11Texture2D* texture)
 void RenderTarget::BindBuffer() const
 {
 	CurrentGraphicsContext::Context()->OMSetRenderTargets(1, RenderTargetView.GetAddressOf(), nullptr);
+	StateCache::InvalidateShaderResources();
 
 	D3D11_VIEWPORT viewport;
 	viewport.Width = (float)Width;
@@ -191,6 +194,7 @@ void RenderTarget::BindBuffer() const
 void RenderTarget::BindBuffer(DepthStencil& depthStencil) const
 {
 	CurrentGraphicsContext::Context()->OMSetRenderTargets(1, RenderTargetView.GetAddressOf(), depthStencil.DepthStencilView.Get());
+	StateCache::InvalidateShaderResources();
 
 	D3D11_VIEWPORT viewport;
 	viewport.Width = (float)Width;
@@ -228,7 +232,7 @@ RenderTargetInput::RenderTargetInput(uint32_t width, uint32_t height, uint32_t s
 
 void RenderTargetInput::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShaderResources(Slot, 1, TextureView.GetAddressOf());
+	StateCache::PSSetShaderResource(Slot, TextureView.Get());
 }
 
 RenderTargetOutput::RenderTargetOutput(ID3D11Texture2D* texture)
@@ -0,0 +1,33 @@
+#include "ResourceHandle.h"
+#include "Core/Core.h"
+
+#ifndef NDEBUG
+#include <string>
+#include <unordered_map>
+#endif
+
+ResourceHandle InternResourceID(std::string_view id)
+{
+	const ResourceHandle hash = HashResourceData(id.data(), id.size());
+
+#ifndef NDEBUG
+	static std::unordered_map<ResourceHandle, std::string> interned;
+	const auto [it, inserted] = interned.emplace(hash, id);
+	ASSERT(inserted || it->second == id);
+#endif
+
+	return hash;
+}
+
+ResourceHandle HashResourceData(const void* data, size_t size)
+{
+	ResourceHandle hash = 14695981039346656037ull;
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash == InvalidResourceHandle ? 1 : hash;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Stable 64-bit identity of a pooled resource, derived from its GetID() string
+using ResourceHandle = uint64_t;
+
+inline constexpr ResourceHandle InvalidResourceHandle = 0;
+
+// FNV-1a of the id, never InvalidResourceHandle. Debug builds check that no two ids collide.
+ResourceHandle InternResourceID(std::string_view id);
+
+// FNV-1a of raw bytes, never InvalidResourceHandle. For data that changes at runtime, such as
+// uniform contents, so collisions are not checked.
+ResourceHandle HashResourceData(const void* data, size_t size);
+
+// Order dependent combination, used for groups of resources
+inline ResourceHandle CombineResourceHandles(ResourceHandle seed, ResourceHandle handle)
+{
+	return (seed ^ handle) * 1099511628211ull + 0x9E3779B97F4A7C15ull;
+}
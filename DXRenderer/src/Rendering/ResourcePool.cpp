@@ -1,23 +1,23 @@
 #include "ResourcePool.h"
 
-void Pool::Add(SharedPtr<Shader> shader)
+SharedPtr<Shader> Pool::Add(SharedPtr<Shader> shader)
 {
-	Get().Shaders.Add(std::move(shader));
+	return Get().Shaders.Add(std::move(shader));
 }
 
-void Pool::Add(SharedPtr<BufferBase> buffer)
+SharedPtr<BufferBase> Pool::Add(SharedPtr<BufferBase> buffer)
 {
-	Get().Buffers.Add(std::move(buffer));
+	return Get().Buffers.Add(std::move(buffer));
 }
 
-SharedPtr<Shader> Pool::GetShader(const std::string& id)
+SharedPtr<Shader> Pool::GetShader(ResourceHandle handle)
 {
-	return Get().Shaders.Get(id);
+	return Get().Shaders.Get(handle);
 }
 
-SharedPtr<BufferBase> Pool::GetBuffer(const std::string& id)
+SharedPtr<BufferBase> Pool::GetBuffer(ResourceHandle handle)
 {
-	return Get().Buffers.Get(id);
+	return Get().Buffers.Get(handle);
 }
 
 Pool& Pool::Get()
@@ -7,10 +7,11 @@
 class Pool
 {
 public:
-	static void Add(SharedPtr<Shader> shader);
-	static void Add(SharedPtr<BufferBase> buffer);
-	static SharedPtr<Shader> GetShader(const std::string& id);
-	static SharedPtr<BufferBase> GetBuffer(const std::string& id);
+	// Return the pooled resource with the same handle, which is the argument itself if it was not pooled yet
+	static SharedPtr<Shader> Add(SharedPtr<Shader> shader);
+	static SharedPtr<BufferBase> Add(SharedPtr<BufferBase> buffer);
+	static SharedPtr<Shader> GetShader(ResourceHandle handle);
+	static SharedPtr<BufferBase> GetBuffer(ResourceHandle handle);
 private:
 	static Pool& Get();
 
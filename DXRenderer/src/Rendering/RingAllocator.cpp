@@ -0,0 +1,61 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(uint32_t capacity)
+	:Capacity(capacity)
+{}
+
+uint32_t RingAllocator::Allocate(uint32_t size, uint32_t alignment)
+{
+	if (size == 0 || size > Capacity)
+		return InvalidOffset;
+
+	if (Used == 0)
+		Tail = Head;
+
+	const uint64_t aligned = (uint64_t(Head) + alignment - 1) & ~uint64_t(alignment - 1);
+	uint32_t offset;
+
+	if (Head >= Tail)
+	{
+		// Free space is [Head, Capacity) followed by [0, Tail); Head == Tail with data in flight means full
+		if (Used > 0 && Head == Tail)
+			return InvalidOffset;
+
+		if (aligned + size <= Capacity)
+			offset = uint32_t(aligned);
+		else if (size <= Tail)
+			offset = 0;
+		else
+			return InvalidOffset;
+	}
+	else
+	{
+		if (aligned + size <= Tail)
+			offset = uint32_t(aligned);
+		else
+			return InvalidOffset;
+	}
+
+	const uint32_t consumed = offset >= Head ? offset + size - Head : Capacity - Head + size;
+	Used += consumed;
+	FrameUsed += consumed;
+	Head = offset + size;
+
+	return offset;
+}
+
+void RingAllocator::FinishFrame(uint64_t fence)
+{
+	Frames.push_back({ fence, Head, FrameUsed });
+	FrameUsed = 0;
+}
+
+void RingAllocator::Retire(uint64_t completedFence)
+{
+	while (!Frames.empty() && Frames.front().Fence <= completedFence)
+	{
+		Tail = Frames.front().Head;
+		Used -= Frames.front().Size;
+		Frames.pop_front();
+	}
+}
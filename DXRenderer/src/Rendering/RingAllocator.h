@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Bump allocator over a fixed range that is reused in frame sized batches. Allocations made
+// between two FinishFrame calls are released together once their fence is retired, so the
+// caller never overwrites memory the GPU may still read. Holds offsets only, no storage.
+class RingAllocator
+{
+public:
+	static constexpr uint32_t InvalidOffset = ~0u;
+
+	RingAllocator(uint32_t capacity);
+
+	// Returns InvalidOffset when the free space cannot hold size bytes at the alignment.
+	// alignment has to be a power of two.
+	uint32_t Allocate(uint32_t size, uint32_t alignment);
+
+	// Tags every allocation since the previous call with fence
+	void FinishFrame(uint64_t fence);
+	// Releases the allocations of all frames with a fence up to and including completedFence
+	void Retire(uint64_t completedFence);
+
+	inline uint32_t GetCapacity() const { return Capacity; }
+	inline uint32_t GetUsed() const { return Used; }
+	inline size_t GetPendingFrames() const { return Frames.size(); }
+
+private:
+	struct FrameMarker
+	{
+		uint64_t Fence;
+		uint32_t Head;
+		uint32_t Size;
+	};
+
+	std::deque<FrameMarker> Frames;
+	uint32_t Capacity;
+	uint32_t Head = 0;
+	uint32_t Tail = 0;
+	// Bytes between Tail and Head, alignment padding and the skipped end of the range included
+	uint32_t Used = 0;
+	uint32_t FrameUsed = 0;
+};
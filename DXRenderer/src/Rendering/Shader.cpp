@@ -1,7 +1,9 @@
 #include "Shader.h"
 
 #include "CurrentGraphicsContext.h"
+#include "DrawPacket.h"
 #include "Graphics.h"
+#include "StateCache.h"
 
 #include <algorithm>
 #include <source_location>
@@ -27,6 +29,11 @@ const Microsoft::WRL::ComPtr<ID3DBlob>& Shader::GetBlob() const
 		return Blob;
 }
 
+void Shader::Record(DrawPacket& packet) const
+{
+	packet.AddDynamic(*this);
+}
+
 std::wstring Shader::SetUpPath(const std::string& shaderName)
 {
 	return Path + std::wstring(shaderName.begin(), shaderName.end()) + GetTypeImpl() + L".cso";
@@ -42,12 +49,17 @@ VertexShader::VertexShader(const std::string& shaderName)
 
 void VertexShader::Bind() const
 {
-	CurrentGraphicsContext::Context()->VSSetShader(ShaderID.Get(), nullptr, 0);
+	StateCache::VSSetShader(ShaderID.Get());
 }
 
 void VertexShader::Unbind() const
 {
-	CurrentGraphicsContext::Context()->VSSetShader(nullptr, nullptr, 0);
+	StateCache::VSSetShader(nullptr);
+}
+
+void VertexShader::Record(DrawPacket& packet) const
+{
+	packet.SetVertexShader(ShaderID.Get());
 }
 
 const ShaderType& VertexShader::GetType() const
@@ -70,12 +82,17 @@ PixelShader::PixelShader(const std::string& shaderName)
 
 void PixelShader::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShader(ShaderID.Get(), nullptr, 0);
+	StateCache::PSSetShader(ShaderID.Get());
 }
 
 void PixelShader::Unbind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShader(nullptr, nullptr, 0);
+	StateCache::PSSetShader(nullptr);
+}
+
+void PixelShader::Record(DrawPacket& packet) const
+{
+	packet.SetPixelShader(ShaderID.Get());
 }
 
 const ShaderType& PixelShader::GetType() const
@@ -93,6 +110,17 @@ void ShaderGroup::Add(SharedPtr<Shader> shader)
 	Shaders[shader->GetType()] = shader;
 }
 
+ResourceHandle ShaderGroup::GetHandle() const
+{
+	ResourceHandle handle = InvalidResourceHandle;
+	for (const auto& shader : Shaders)
+	{
+		if (shader)
+			handle = CombineResourceHandles(handle, shader->GetHandle());
+	}
+	return handle;
+}
+
 void ShaderGroup::Bind() const
 {
 	for (auto& shader : Shaders)
@@ -105,26 +133,27 @@ void ShaderGroup::Unbind() const
 		shader->Unbind();
 }
 
+void ShaderGroup::Record(DrawPacket& packet) const
+{
+	for (auto& shader : Shaders)
+		if (shader) shader->Record(packet);
+}
+
 const Microsoft::WRL::ComPtr<ID3DBlob>& ShaderGroup::GetBlob(ShaderType type) const
 {
 	return Shaders[type]->GetBlob();
 }
 
-void ShaderPool::Add(SharedPtr<Shader> shader)
+SharedPtr<Shader> ShaderPool::Add(SharedPtr<Shader> shader)
 {
-	if (Get(shader->GetID()))
-		return;
-
-	Shaders[shader->GetID()] = std::move(shader);
+	const ResourceHandle handle = shader->GetHandle();
+	return Shaders.Insert(handle, std::move(shader)).first;
 }
 
-SharedPtr<Shader> ShaderPool::Get(const std::string& id)
+SharedPtr<Shader> ShaderPool::Get(ResourceHandle handle)
 {
-	auto it = Shaders.find(id);
-	if (it == Shaders.end())
-		return {};
-	else
-		return it->second;
+	auto* shader = Shaders.Find(handle);
+	return shader ? *shader : SharedPtr<Shader>{};
 }
 
 NullVertexShader::NullVertexShader()
@@ -133,7 +162,7 @@ NullVertexShader::NullVertexShader()
 
 void NullVertexShader::Bind() const
 {
-	CurrentGraphicsContext::Context()->VSSetShader(nullptr, nullptr, 0);
+	StateCache::VSSetShader(nullptr);
 }
 
 void NullVertexShader::Unbind() const
@@ -147,7 +176,7 @@ NullPixelShader::NullPixelShader()
 
 void NullPixelShader::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShader(nullptr, nullptr, 0);
+	StateCache::PSSetShader(nullptr);
 }
 
 void NullPixelShader::Unbind() const
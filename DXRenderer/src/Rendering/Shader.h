@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core\Core.h"
+#include "HandleMap.h"
 
 #include <array>
 #include <d3d11.h>
@@ -8,6 +9,8 @@
 #include <string>
 #include <wrl.h>
 
+struct DrawPacket;
+
 enum ShaderType
 {
 	VertexS = 0,
@@ -26,6 +29,16 @@ struct Shader
 	const Microsoft::WRL::ComPtr<ID3DBlob>& GetBlob() const;
 	virtual const ShaderType& GetType() const = 0;
 	virtual std::string GetID() const = 0;
+	// Bakes the binding into a draw packet, by default it is rebound on every draw
+	virtual void Record(DrawPacket& packet) const;
+
+	// Interned GetID(), built once per resource
+	inline ResourceHandle GetHandle() const
+	{
+		if (Handle == InvalidResourceHandle)
+			Handle = InternResourceID(GetID());
+		return Handle;
+	}
 
 protected:
 	std::wstring SetUpPath(const std::string& shaderName);
@@ -36,6 +49,7 @@ protected:
 	std::string Name;
 private:
 	static const std::wstring Path;
+	mutable ResourceHandle Handle = InvalidResourceHandle;
 };
 
 struct VertexShader : public Shader
@@ -44,6 +58,7 @@ struct VertexShader : public Shader
 
 	virtual void Bind() const override;
 	virtual void Unbind() const override;
+	virtual void Record(DrawPacket& packet) const override;
 	virtual const ShaderType& GetType() const override;
 	virtual std::string GetID() const override;
 protected:
@@ -73,6 +88,7 @@ struct PixelShader : public Shader
 
 	virtual void Bind() const override;
 	virtual void Unbind() const override;
+	virtual void Record(DrawPacket& packet) const override;
 	virtual const ShaderType& GetType() const override;
 	virtual std::string GetID() const override;
 
@@ -104,9 +120,12 @@ struct ShaderGroup
 
 	virtual void Bind() const;
 	virtual void Unbind() const;
+	void Record(DrawPacket& packet) const;
 
 	const Microsoft::WRL::ComPtr<ID3DBlob>& GetBlob(ShaderType type) const;
 	inline size_t Size() const { return Shaders.size(); }
+	// Combined handle of the bound stages
+	ResourceHandle GetHandle() const;
 
 private:
 	std::array<SharedPtr<Shader>, ShaderType::Size> Shaders;
@@ -114,10 +133,10 @@ private:
 
 class ShaderPool
 {
-	void Add(SharedPtr<Shader> shader);
-	SharedPtr<Shader> Get(const std::string& id);
+	SharedPtr<Shader> Add(SharedPtr<Shader> shader);
+	SharedPtr<Shader> Get(ResourceHandle handle);
 
-	std::unordered_map<std::string, SharedPtr<Shader>> Shaders;
+	HandleMap<SharedPtr<Shader>> Shaders;
 
 	friend class Pool;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "includes\LightVector.hlsli"
 #include "includes\ShaderOps.hlsli"
 #include "includes\ShadowOps.hlsli"
+#include "includes\ClusteredLights.hlsli"
 
 cbuffer constBuffer : register(b1)
 {
@@ -21,11 +22,12 @@ float4 main(float3 posCamera : Position, float3 normal : Normal, float4 shadowPo
     float3 diffuse = float3(0.0f, 0.0f, 0.0f);
     float3 specular = float3(0.0f, 0.0f, 0.0f);
     
+    float3 n = normalize(normal);
+    n.z *= -1;
+
     const float shadowIntensity = Shadow(shadowPos);
     if (shadowIntensity != 0.0f)
     {
-        float3 n = normalize(normal);
-        n.z *= -1;
         float3 lightWorld = (float3) mul(float4(-lightPos.xy, lightPos.z, 1.0f), view);
     
         LightVector light = LightVectorBuild(lightWorld, posCamera);
@@ -38,5 +40,7 @@ float4 main(float3 posCamera : Position, float3 normal : Normal, float4 shadowPo
         specular *= shadowIntensity;
     }
 
+    ClusteredLighting(posCamera, n, materialColor, specularIntensity, Shininess, diffuse, specular);
+
     return float4(saturate((diffuse + ambient + specular) * materialColor), 1.0f);
 }
@@ -2,6 +2,7 @@
 #include "includes\LightVector.hlsli"
 #include "includes\ShaderOps.hlsli"
 #include "includes\ShadowOps.hlsli"
+#include "includes\ClusteredLights.hlsli"
 
 cbuffer constBuffer : register(b1)
 {
@@ -24,10 +25,11 @@ float4 main(float3 posCamera : Position, float3 n : Normal, float2 texCoords : T
     float3 diffuse = float3(0.0f, 0.0f, 0.0f);
     float3 specular = float3(0.0f, 0.0f, 0.0f);
     
+    n = normalize(n);
+
     const float shadowIntensity = Shadow(shadowPos);
     if (shadowIntensity != 0.0f)
     {
-        n = normalize(n);
         float3 lightWorld = (float3) mul(float4(-lightPos.xy, lightPos.z, 1.0f), view);
     
         LightVector light = LightVectorBuild(lightWorld, posCamera);
@@ -39,6 +41,8 @@ float4 main(float3 posCamera : Position, float3 n : Normal, float2 texCoords : T
         diffuse *= shadowIntensity;
         specular *= shadowIntensity;
     }
+
+    ClusteredLighting(posCamera, n, materialColor, specularIntensity, Shininess, diffuse, specular);
     
     return float4(saturate((diffuse + ambient) * tex.Sample(samplerState, texCoords).rgb + specular), 1.0f);
 }
@@ -2,6 +2,7 @@
 #include "includes\LightVector.hlsli"
 #include "includes\ShaderOps.hlsli"
 #include "includes\ShadowOps.hlsli"
+#include "includes\ClusteredLights.hlsli"
 
 cbuffer constBuffer : register(b2)
 {
@@ -18,25 +19,27 @@ float4 main(float3 posCamera : Position, float3 n : Normal, float2 texCoords : T
     float3 diffuse = float3(0.0f, 0.0f, 0.0f);
     float3 specular = float3(0.0f, 0.0f, 0.0f);
     
+    n = normalize(n);
+
+    const float4 specSample = spec.Sample(samplerStateSpec, texCoords);
+    const float3 specColor = specSample.rgb;
+    const float specPower = pow(2.0f, specSample.a * 13.0f);
+
     const float shadowIntensity = Shadow(shadowPos);
     if (shadowIntensity != 0.0f)
     {
-        n = normalize(n);
         float3 lightWorld = (float3) mul(float4(-lightPos.xy, lightPos.z, 1.0f), view);
         LightVector light = LightVectorBuild(lightWorld, posCamera);
     
         float att = Attenuation(attConst, attLin, attQuad, light.Distance);
         diffuse = Diffuse(diffuseColor, diffuseIntensity, att, light.DirectionN, n);
-    
-        const float4 specSample = spec.Sample(samplerStateSpec, texCoords);
-        const float3 specColor = specSample.rgb;
-        const float specPower = pow(2.0f, specSample.a * 13.0f);
-    
         specular = Specular(specColor, 1.0f, n, light.Direction, posCamera, att, specPower);
         
         diffuse *= shadowIntensity;
         specular *= shadowIntensity;
     }
+
+    ClusteredLighting(posCamera, n, specColor, 1.0f, specPower, diffuse, specular);
     
     return float4(saturate(diffuse + ambient) * tex.Sample(samplerState, texCoords).rgb + specular, 1.0f);
 }
@@ -2,6 +2,7 @@
 #include "includes\LightVector.hlsli"
 #include "includes\ShaderOps.hlsli"
 #include "includes\ShadowOps.hlsli"
+#include "includes\ClusteredLights.hlsli"
 
 cbuffer constBuffer : register(b1)
 {
@@ -27,22 +28,22 @@ float4 main(float3 posCamera : Position, float3 n : Normal, float2 texCoords : T
     float3 diffuse = float3(0.0f, 0.0f, 0.0f);
     float3 specular = float3(0.0f, 0.0f, 0.0f);
     
+    if (NormalMapEnabled)
+    {
+        const float3 normalSample = normalMap.Sample(samplerStateNormal, texCoords).xyz;
+        n.x = normalSample.x * 2.0f - 1.0f;
+        n.y = -normalSample.y * 2.0f + 1.0f;
+        n.z = -normalSample.z * 2.0f + 1.0f;
+        n = mul(n, (float3x3) view);
+        n = normalize(n);
+
+    }
+    else
+        n = normalize(n);
+
     const float shadowIntensity = Shadow(shadowPos);
     if (shadowIntensity != 0.0f)
     {
-        if (NormalMapEnabled)
-        {
-            const float3 normalSample = normalMap.Sample(samplerStateNormal, texCoords).xyz;
-            n.x = normalSample.x * 2.0f - 1.0f;
-            n.y = -normalSample.y * 2.0f + 1.0f;
-            n.z = -normalSample.z * 2.0f + 1.0f;
-            n = mul(n, (float3x3) view);
-            n = normalize(n);
-
-        }
-        else
-            n = normalize(n);
-    
         float3 lightWorld = (float3) mul(float4(-lightPos.xy, lightPos.z, 1.0f), view);
         LightVector light = LightVectorBuild(lightWorld, posCamera);
     
@@ -55,5 +56,7 @@ float4 main(float3 posCamera : Position, float3 n : Normal, float2 texCoords : T
         specular *= shadowIntensity;
     }
 
+    ClusteredLighting(posCamera, n, materialColor, specularIntensity, Shininess, diffuse, specular);
+
     return float4(saturate((diffuse + ambient) * tex.Sample(samplerState, texCoords).rgb + specular), 1.0f);
 }
\ No newline at end of file
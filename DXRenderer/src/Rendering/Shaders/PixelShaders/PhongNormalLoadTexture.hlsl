@@ -2,6 +2,7 @@
 #include "includes\LightVector.hlsli"
 #include "includes\ShaderOps.hlsli"
 #include "includes\ShadowOps.hlsli"
+#include "includes\ClusteredLights.hlsli"
 
 cbuffer constBuffer : register(b1) // TO DO: FIX ALIGNMENT ISSUES
 {
@@ -27,11 +28,11 @@ float4 main(float3 posCamera : Position, float3 n : Normal, float3 t : Tangent,
     float3 diffuse = float3(0.0f, 0.0f, 0.0f);
     float3 specular = float3(0.0f, 0.0f, 0.0f);
     
+    n = normalPreprocessing(n, t, b, texCoords, normalMap, samplerStateNormal);
+
     const float shadowIntensity = Shadow(shadowPos);
     if (shadowIntensity != 0.0f)
     {
-        n = normalPreprocessing(n, t, b, texCoords, normalMap, samplerStateNormal);
-    
         float3 lightWorld = (float3) mul(float4(-lightPos.xy, lightPos.z, 1.0f), view);
         LightVector light = LightVectorBuild(lightWorld, posCamera);
 
@@ -42,5 +43,8 @@ float4 main(float3 posCamera : Position, float3 n : Normal, float3 t : Tangent,
         diffuse *= shadowIntensity;
     }
 
+    // Specular stays off here, as it is for the shadowed light
+    ClusteredLighting(posCamera, n, materialColor, 0.0f, Shininess, diffuse, specular);
+
     return float4(saturate((diffuse + ambient) * tex.Sample(samplerState, texCoords).rgb), 1.0f);
 }
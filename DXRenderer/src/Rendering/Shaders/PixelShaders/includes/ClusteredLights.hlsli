@@ -0,0 +1,62 @@
+struct ClusterLight
+{
+    float3 position;
+    float range;
+    float3 color;
+    float attConst;
+    float attLin;
+    float attQuad;
+    float2 padding;
+};
+
+StructuredBuffer<ClusterLight> clusterLights : register(t4);
+StructuredBuffer<uint2> clusterRanges : register(t5);
+StructuredBuffer<uint> clusterLightIndices : register(t6);
+
+cbuffer ClusterBuffer : register(b3)
+{
+    uint3 clusterCount;
+    float clusterSliceScale;
+    float2 clusterProjection;
+    float clusterSliceBias;
+    uint clusterLightCount;
+};
+
+// Offset and count of the lights of the cluster holding a camera space position
+uint2 ClusterRange(const in float3 posCamera)
+{
+    const float2 ndc = posCamera.xy * clusterProjection / posCamera.z;
+    const uint2 tile = (uint2) clamp(floor((ndc * 0.5f + 0.5f) * clusterCount.xy), 0.0f, (float2) clusterCount.xy - 1.0f);
+    const uint slice = (uint) clamp(floor(log(posCamera.z) * clusterSliceScale + clusterSliceBias), 0.0f, (float) clusterCount.z - 1.0f);
+    return clusterRanges[(slice * clusterCount.y + tile.y) * clusterCount.x + tile.x];
+}
+
+// Adds the unshadowed clustered lights, lights are in camera space
+void ClusteredLighting(
+    const in float3 posCamera,
+    const in float3 n,
+    const in float3 specularColor,
+    const in float specularIntensity,
+    const in float specularPower,
+    inout float3 diffuse,
+    inout float3 specular)
+{
+    if (clusterLightCount == 0)
+        return;
+
+    const uint2 range = ClusterRange(posCamera);
+    const float3 viewDir = normalize(posCamera);
+    for (uint i = 0; i < range.y; i++)
+    {
+        const ClusterLight light = clusterLights[clusterLightIndices[range.x + i]];
+        const LightVector vec = LightVectorBuild(light.position, posCamera);
+        if (vec.Distance > light.range)
+            continue;
+
+        const float att = 1.0f / (light.attConst + light.attLin * vec.Distance + light.attQuad * (vec.Distance * vec.Distance));
+        diffuse += light.color * att * max(0.0f, dot(vec.DirectionN, n));
+
+        const float3 r = normalize(n * dot(vec.Direction, n) * 2.0f - vec.Direction);
+        specular += att * light.color * specularColor * specularIntensity * pow(max(0.0f, dot(-r, viewDir)), specularPower);
+    }
+}
\ No newline at end of file
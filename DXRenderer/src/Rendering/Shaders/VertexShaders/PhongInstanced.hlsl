@@ -0,0 +1,33 @@
+#include "include/shadowOps.hlsli"
+
+cbuffer constBuffer : register(b2)
+{
+    row_major matrix projection;
+}
+
+struct Instance
+{
+    row_major float4x4 model : InstanceModel;
+    row_major float4x4 modelView : InstanceModelView;
+};
+
+struct Output
+{
+    float3 posWorld : Position;
+    float3 normal : Normal;
+    float4 shadowPos : ShadowPosition;
+    float4 pos : SV_Position;
+};
+
+Output main( float3 pos : Position, float3 n : Normal, Instance instance )
+{
+    Output output;
+    
+    output.posWorld = (float3) mul(float4(pos, 1.0f), instance.modelView);
+    output.normal = mul(n, (float3x3) instance.modelView);
+    output.pos = mul(float4(output.posWorld, 1.0f), projection);
+    
+    output.shadowPos = ShadowConversion(pos, instance.model);
+    
+    return output;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "include/shadowOps.hlsli"
+#include "include/quantization.hlsli"
+
+cbuffer constBuffer : register(b0)
+{
+    row_major matrix model;
+}
+
+cbuffer constBuffer : register(b1)
+{
+    row_major matrix modelView;
+}
+
+cbuffer constBuffer : register(b2)
+{
+    row_major matrix projection;
+}
+
+struct Output
+{
+    float3 posCamera : Position;
+    float3 normal : Normal;
+    float3 tangent : Tangent;
+    float3 bitangent : Bitangent;
+    float2 texCoords : TexCoords;
+    float4 shadowPos : ShadowPosition;
+    float4 pos : SV_Position;
+};
+
+Output main(float3 posQuantized : Position, float2 normalOct : Normal, float2 tangentOct : Tangent, float2 texCoords : TexCoords)
+{
+    Output output;
+    
+    const float3 pos = DecodePosition(posQuantized);
+    const float3 n = DecodeOctahedral(normalOct);
+    float bitangentSign;
+    const float3 t = DecodeTangent(tangentOct, bitangentSign);
+    const float3 b = cross(n, t) * bitangentSign;
+    
+    output.posCamera = (float3) mul(float4(pos, 1.0f), modelView);
+    output.normal = mul(n, (float3x3) modelView);
+    output.tangent = mul(t, (float3x3) modelView);
+    output.bitangent = mul(b, (float3x3) modelView);
+    output.texCoords = texCoords;
+    output.pos = mul(float4(output.posCamera, 1.0f), projection);
+    
+    output.shadowPos = ShadowConversion(pos, model);
+    
+    return output;
+}
\ No newline at end of file
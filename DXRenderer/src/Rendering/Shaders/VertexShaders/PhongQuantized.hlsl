@@ -0,0 +1,39 @@
+#include "include/shadowOps.hlsli"
+#include "include/quantization.hlsli"
+
+cbuffer constBuffer : register(b0)
+{
+    row_major matrix model;
+}
+
+cbuffer constBuffer : register(b1)
+{
+    row_major matrix modelView;
+}
+
+cbuffer constBuffer : register(b2)
+{
+    row_major matrix projection;
+}
+
+struct Output
+{
+    float3 posWorld : Position;
+    float3 normal : Normal;
+    float4 shadowPos : ShadowPosition;
+    float4 pos : SV_Position;
+};
+
+Output main(float3 posQuantized : Position, float2 normalOct : Normal)
+{
+    Output output;
+    
+    const float3 pos = DecodePosition(posQuantized);
+    output.posWorld = (float3) mul(float4(pos, 1.0f), modelView);
+    output.normal = mul(DecodeOctahedral(normalOct), (float3x3) modelView);
+    output.pos = mul(float4(output.posWorld, 1.0f), projection);
+    
+    output.shadowPos = ShadowConversion(pos, model);
+    
+    return output;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+cbuffer constBuffer : register(b4)
+{
+    row_major matrix shadowViewProj;
+}
+
+float4 main( float3 pos : Position, row_major float4x4 model : InstanceModel ) : SV_Position
+{
+    float4 posProj = mul(mul(float4(pos, 1.0f), model), shadowViewProj);
+    posProj.xy = -posProj.xy;
+    return posProj;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "include/quantization.hlsli"
+
+cbuffer constBuffer : register(b0)
+{
+    row_major matrix model;
+}
+
+cbuffer constBuffer : register(b4)
+{
+    row_major matrix shadowViewProj;
+}
+
+float4 main(float3 posQuantized : Position) : SV_Position
+{
+    float4 posProj = mul(mul(float4(DecodePosition(posQuantized), 1.0f), model), shadowViewProj);
+    posProj.xy = -posProj.xy;
+    return posProj;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+// Decoding of the packed vertex formats written by Quantization.cpp
+
+cbuffer constBuffer : register(b5)
+{
+    float3 positionCenter;
+    float3 positionExtents;
+}
+
+static const float tangentSignBias = 1.0f / 32767.0f;
+
+float3 DecodePosition(const in float3 pos)
+{
+    return positionCenter + pos * positionExtents;
+}
+
+float3 DecodeOctahedral(const in float2 e)
+{
+    float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    if (n.z < 0.0f)
+        n.xy = (1.0f - abs(n.yx)) * (n.xy >= 0.0f ? 1.0f : -1.0f);
+    return normalize(n);
+}
+
+float3 DecodeTangent(const in float2 e, out float bitangentSign)
+{
+    bitangentSign = e.y >= 0.0f ? 1.0f : -1.0f;
+    const float v = (max(abs(e.y), tangentSignBias) - tangentSignBias) / (1.0f - tangentSignBias) * 2.0f - 1.0f;
+    return DecodeOctahedral(float2(e.x, v));
+}
\ No newline at end of file
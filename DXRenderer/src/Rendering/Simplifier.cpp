@@ -0,0 +1,320 @@
+#include "Simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace Simplifier
+{
+	namespace
+	{
+		struct Vector3
+		{
+			float X, Y, Z;
+		};
+
+		// Symmetric 4x4 sum of plane equations, evaluates to the summed squared distance to the planes
+		struct Quadric
+		{
+			double A00 = 0, A11 = 0, A22 = 0, A01 = 0, A02 = 0, A12 = 0;
+			double B0 = 0, B1 = 0, B2 = 0;
+			double C = 0;
+
+			void AddPlane(double a, double b, double c, double d)
+			{
+				A00 += a * a; A11 += b * b; A22 += c * c;
+				A01 += a * b; A02 += a * c; A12 += b * c;
+				B0 += a * d; B1 += b * d; B2 += c * d;
+				C += d * d;
+			}
+
+			Quadric& operator+=(const Quadric& other)
+			{
+				A00 += other.A00; A11 += other.A11; A22 += other.A22;
+				A01 += other.A01; A02 += other.A02; A12 += other.A12;
+				B0 += other.B0; B1 += other.B1; B2 += other.B2;
+				C += other.C;
+				return *this;
+			}
+
+			double Evaluate(const Vector3& p) const
+			{
+				const double x = p.X, y = p.Y, z = p.Z;
+				const double result = A00 * x * x + A11 * y * y + A22 * z * z
+					+ 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z)
+					+ 2.0 * (B0 * x + B1 * y + B2 * z) + C;
+				return std::max(result, 0.0);
+			}
+		};
+
+		struct Collapse
+		{
+			uint32_t From;
+			uint32_t To;
+			double Cost;
+		};
+
+		struct PositionKey
+		{
+			uint32_t Bits[3];
+
+			bool operator==(const PositionKey& other) const
+			{
+				return Bits[0] == other.Bits[0] && Bits[1] == other.Bits[1] && Bits[2] == other.Bits[2];
+			}
+		};
+
+		struct PositionHash
+		{
+			size_t operator()(const PositionKey& key) const
+			{
+				return (key.Bits[0] * 73856093u) ^ (key.Bits[1] * 19349663u) ^ (key.Bits[2] * 83492791u);
+			}
+		};
+
+		Vector3 Cross(const Vector3& a, const Vector3& b)
+		{
+			return { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+		}
+
+		Vector3 Subtract(const Vector3& a, const Vector3& b)
+		{
+			return { a.X - b.X, a.Y - b.Y, a.Z - b.Z };
+		}
+
+		float Dot(const Vector3& a, const Vector3& b)
+		{
+			return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+		}
+
+		uint64_t EdgeKey(uint32_t a, uint32_t b)
+		{
+			return (uint64_t(a) << 32) | b;
+		}
+	}
+
+	LevelStatistics& LevelStatistics::operator+=(const LevelStatistics& other)
+	{
+		Triangles += other.Triangles;
+		Error = std::max(Error, other.Error);
+		return *this;
+	}
+
+	size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positionData, size_t positionStride,
+					size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError)
+	{
+		std::vector<Vector3> positions(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+			std::memcpy(&positions[i], reinterpret_cast<const char*>(positionData) + i * positionStride, sizeof(Vector3));
+
+		std::vector<uint32_t> result(indices, indices + indexCount);
+
+		// Vertices sharing a position are split by attributes; the first one stands for the group
+		std::vector<uint32_t> canonical(vertexCount);
+		{
+			std::unordered_map<PositionKey, uint32_t, PositionHash> firstAt;
+			firstAt.reserve(vertexCount);
+			for (uint32_t v = 0; v < vertexCount; v++)
+			{
+				PositionKey key;
+				std::memcpy(key.Bits, &positions[v], sizeof(key.Bits));
+				canonical[v] = firstAt.emplace(key, v).first->second;
+			}
+		}
+
+		std::vector<bool> locked(vertexCount, false);
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			if (canonical[v] != v)
+				locked[canonical[v]] = true;
+		}
+
+		// Edges without an opposite half-edge are borders, edges used twice in one direction are non-manifold
+		{
+			std::unordered_map<uint64_t, uint32_t> halfEdges;
+			halfEdges.reserve(indexCount);
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				const uint32_t a = canonical[indices[i]];
+				const uint32_t b = canonical[indices[i - i % 3 + (i + 1) % 3]];
+				halfEdges[EdgeKey(a, b)]++;
+			}
+
+			for (const auto& [key, count] : halfEdges)
+			{
+				const uint32_t a = uint32_t(key >> 32);
+				const uint32_t b = uint32_t(key);
+				const auto opposite = halfEdges.find(EdgeKey(b, a));
+				if (count > 1 || opposite == halfEdges.end() || opposite->second != 1)
+					locked[a] = locked[b] = true;
+			}
+		}
+
+		const auto isLocked = [&](uint32_t v) { return locked[canonical[v]]; };
+
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const Vector3& p0 = positions[indices[i]];
+			Vector3 normal = Cross(Subtract(positions[indices[i + 1]], p0), Subtract(positions[indices[i + 2]], p0));
+			const float length = std::sqrt(Dot(normal, normal));
+			if (length == 0.0f)
+				continue;
+
+			normal = { normal.X / length, normal.Y / length, normal.Z / length };
+			const double d = -Dot(normal, p0);
+			for (int k = 0; k < 3; k++)
+				quadrics[canonical[indices[i + k]]].AddPlane(normal.X, normal.Y, normal.Z, d);
+		}
+
+		const double errorLimit = double(targetError) * double(targetError);
+		double maxCost = 0.0;
+
+		std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+		std::vector<uint32_t> triangles;
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> dirty(vertexCount);
+
+		while (result.size() > targetIndexCount)
+		{
+			const size_t triangleCount = result.size() / 3;
+
+			std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+			for (uint32_t index : result)
+				triangleOffsets[index + 1]++;
+			for (size_t v = 0; v < vertexCount; v++)
+				triangleOffsets[v + 1] += triangleOffsets[v];
+
+			triangles.resize(result.size());
+			{
+				std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+				for (size_t i = 0; i < result.size(); i++)
+					triangles[fill[result[i]]++] = uint32_t(i / 3);
+			}
+
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i++)
+			{
+				const uint32_t from = result[i];
+				const uint32_t to = result[i - i % 3 + (i + 1) % 3];
+				if (isLocked(from))
+					continue;
+
+				Quadric quadric = quadrics[from];
+				quadric += quadrics[canonical[to]];
+				collapses.push_back({ from, to, quadric.Evaluate(positions[to]) });
+
+				if (!isLocked(to))
+				{
+					quadric = quadrics[to];
+					quadric += quadrics[from];
+					collapses.push_back({ to, from, quadric.Evaluate(positions[from]) });
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+					  {
+						  if (a.Cost != b.Cost)
+							  return a.Cost < b.Cost;
+						  return a.From != b.From ? a.From < b.From : a.To < b.To;
+					  });
+
+			for (uint32_t v = 0; v < vertexCount; v++)
+				remap[v] = v;
+			std::fill(dirty.begin(), dirty.end(), false);
+
+			size_t removedTriangles = 0;
+			size_t applied = 0;
+			const size_t targetTriangles = targetIndexCount / 3;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.Cost > errorLimit || triangleCount - removedTriangles <= targetTriangles)
+					break;
+
+				const uint32_t from = collapse.From;
+				const uint32_t to = collapse.To;
+				if (dirty[from] || dirty[to])
+					continue;
+
+				// Reject collapses that flip or degenerate a surviving triangle
+				bool valid = true;
+				size_t vanishing = 0;
+				for (uint32_t t = triangleOffsets[from]; t < triangleOffsets[from + 1] && valid; t++)
+				{
+					const uint32_t* triangle = &result[triangles[t] * 3];
+					if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+					{
+						vanishing++;
+						continue;
+					}
+
+					Vector3 before[3], after[3];
+					for (int k = 0; k < 3; k++)
+					{
+						before[k] = positions[triangle[k]];
+						after[k] = triangle[k] == from ? positions[to] : before[k];
+					}
+
+					const Vector3 normalBefore = Cross(Subtract(before[1], before[0]), Subtract(before[2], before[0]));
+					const Vector3 normalAfter = Cross(Subtract(after[1], after[0]), Subtract(after[2], after[0]));
+					valid = Dot(normalBefore, normalAfter) > 0.0f;
+				}
+
+				if (!valid)
+					continue;
+
+				for (uint32_t t = triangleOffsets[from]; t < triangleOffsets[from + 1]; t++)
+				{
+					const uint32_t* triangle = &result[triangles[t] * 3];
+					for (int k = 0; k < 3; k++)
+						dirty[triangle[k]] = true;
+				}
+
+				remap[from] = to;
+				quadrics[canonical[to]] += quadrics[from];
+				maxCost = std::max(maxCost, collapse.Cost);
+				removedTriangles += vanishing;
+				applied++;
+			}
+
+			if (applied == 0)
+				break;
+
+			size_t write = 0;
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				const uint32_t a = remap[result[i]];
+				const uint32_t b = remap[result[i + 1]];
+				const uint32_t c = remap[result[i + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+			result.resize(write);
+		}
+
+		std::copy(result.begin(), result.end(), destination);
+		if (resultError)
+			*resultError = float(std::sqrt(maxCost));
+
+		return result.size();
+	}
+
+	size_t SelectLevel(const LevelOfDetail* levels, size_t count, float distance, float pixelsPerUnit, float thresholdPixels)
+	{
+		const float scale = pixelsPerUnit / std::max(distance, 1e-4f);
+
+		size_t selected = 0;
+		for (size_t i = 1; i < count && levels[i].Error * scale <= thresholdPixels; i++)
+			selected = i;
+
+		return selected;
+	}
+}
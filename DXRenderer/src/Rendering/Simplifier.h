@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Quadric error metric simplification for building mesh LOD chains. Levels only drop triangles and
+// collapse vertices onto existing ones, so every level shares the vertex buffer of the full mesh.
+namespace Simplifier
+{
+	struct LevelOfDetail
+	{
+		uint32_t IndexOffset;
+		uint32_t IndexCount;
+		// Largest distance from the full resolution surface, in position units
+		float Error;
+	};
+
+	struct LevelStatistics
+	{
+		size_t Triangles = 0;
+		float Error = 0.0f;
+
+		LevelStatistics& operator+=(const LevelStatistics& other);
+	};
+
+	// Collapses edges by increasing quadric error until targetIndexCount is reached or the next collapse
+	// costs more than targetError. Vertices on open borders and on attribute seams (equal position,
+	// different vertex) are never moved, which keeps UV and normal discontinuities intact.
+	// destination needs room for indexCount indices; returns the number written.
+	size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+					size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+	// Coarsest level whose error, projected at distance, stays under thresholdPixels.
+	// pixelsPerUnit is the number of pixels one unit covers at distance one.
+	size_t SelectLevel(const LevelOfDetail* levels, size_t count, float distance, float pixelsPerUnit, float thresholdPixels);
+}
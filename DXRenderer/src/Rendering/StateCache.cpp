@@ -0,0 +1,99 @@
+#include "StateCache.h"
+#include "CurrentGraphicsContext.h"
+#include "FrameStatistics.h"
+
+StateCache& StateCache::Get()
+{
+	static StateCache singleton;
+	return singleton;
+}
+
+void StateCache::SetVertexBuffer(UINT slot, ID3D11Buffer* buffer, UINT stride, UINT offset)
+{
+	if (Get().Tracker.SetVertexBuffer(slot, buffer, stride, offset))
+		CurrentGraphicsContext::Context()->IASetVertexBuffers(slot, 1, &buffer, &stride, &offset);
+}
+
+void StateCache::SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset)
+{
+	if (Get().Tracker.SetIndexBuffer(buffer, format, offset))
+		CurrentGraphicsContext::Context()->IASetIndexBuffer(buffer, format, offset);
+}
+
+void StateCache::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	if (Get().Tracker.SetTopology(topology))
+		CurrentGraphicsContext::Context()->IASetPrimitiveTopology(topology);
+}
+
+void StateCache::SetInputLayout(ID3D11InputLayout* layout)
+{
+	if (Get().Tracker.SetInputLayout(layout))
+		CurrentGraphicsContext::Context()->IASetInputLayout(layout);
+}
+
+void StateCache::VSSetShader(ID3D11VertexShader* shader)
+{
+	if (Get().Tracker.SetShader(StateTracker::VertexStage, shader))
+		CurrentGraphicsContext::Context()->VSSetShader(shader, nullptr, 0);
+}
+
+void StateCache::PSSetShader(ID3D11PixelShader* shader)
+{
+	if (Get().Tracker.SetShader(StateTracker::PixelStage, shader))
+		CurrentGraphicsContext::Context()->PSSetShader(shader, nullptr, 0);
+}
+
+void StateCache::VSSetConstantBuffer(UINT slot, ID3D11Buffer* buffer)
+{
+	if (Get().Tracker.SetConstantBuffer(StateTracker::VertexStage, slot, buffer))
+		CurrentGraphicsContext::Context()->VSSetConstantBuffers(slot, 1, &buffer);
+}
+
+void StateCache::PSSetConstantBuffer(UINT slot, ID3D11Buffer* buffer)
+{
+	if (Get().Tracker.SetConstantBuffer(StateTracker::PixelStage, slot, buffer))
+		CurrentGraphicsContext::Context()->PSSetConstantBuffers(slot, 1, &buffer);
+}
+
+void StateCache::VSSetConstantBufferRange(UINT slot, ID3D11Buffer* buffer, UINT firstConstant, UINT constantCount)
+{
+	if (Get().Tracker.SetConstantBuffer(StateTracker::VertexStage, slot, buffer, firstConstant, constantCount))
+		CurrentGraphicsContext::Context1()->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+}
+
+void StateCache::PSSetConstantBufferRange(UINT slot, ID3D11Buffer* buffer, UINT firstConstant, UINT constantCount)
+{
+	if (Get().Tracker.SetConstantBuffer(StateTracker::PixelStage, slot, buffer, firstConstant, constantCount))
+		CurrentGraphicsContext::Context1()->PSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+}
+
+void StateCache::PSSetShaderResource(UINT slot, ID3D11ShaderResourceView* view)
+{
+	if (Get().Tracker.SetShaderResource(StateTracker::PixelStage, slot, view))
+		CurrentGraphicsContext::Context()->PSSetShaderResources(slot, 1, &view);
+}
+
+void StateCache::PSSetSampler(UINT slot, ID3D11SamplerState* sampler)
+{
+	if (Get().Tracker.SetSampler(StateTracker::PixelStage, slot, sampler))
+		CurrentGraphicsContext::Context()->PSSetSamplers(slot, 1, &sampler);
+}
+
+void StateCache::Invalidate()
+{
+	Get().Tracker.Invalidate();
+}
+
+void StateCache::InvalidateShaderResources()
+{
+	Get().Tracker.InvalidateShaderResources();
+}
+
+void StateCache::EndFrame()
+{
+	auto& tracker = Get().Tracker;
+	FrameStatistics::Increment(FrameStatistics::StateCallsIssued, tracker.GetIssued());
+	FrameStatistics::Increment(FrameStatistics::StateCallsFiltered, tracker.GetFiltered());
+	tracker.ResetCounters();
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "StateTracker.h"
+
+#include <d3d11.h>
+
+// Front of CurrentGraphicsContext::Context() for per draw bindings, calls that would rebind
+// what is already bound never reach the device
+class StateCache
+{
+public:
+	static void SetVertexBuffer(UINT slot, ID3D11Buffer* buffer, UINT stride, UINT offset);
+	static void SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset);
+	static void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology);
+	static void SetInputLayout(ID3D11InputLayout* layout);
+
+	static void VSSetShader(ID3D11VertexShader* shader);
+	static void PSSetShader(ID3D11PixelShader* shader);
+
+	static void VSSetConstantBuffer(UINT slot, ID3D11Buffer* buffer);
+	static void PSSetConstantBuffer(UINT slot, ID3D11Buffer* buffer);
+	static void VSSetConstantBufferRange(UINT slot, ID3D11Buffer* buffer, UINT firstConstant, UINT constantCount);
+	static void PSSetConstantBufferRange(UINT slot, ID3D11Buffer* buffer, UINT firstConstant, UINT constantCount);
+
+	static void PSSetShaderResource(UINT slot, ID3D11ShaderResourceView* view);
+	static void PSSetSampler(UINT slot, ID3D11SamplerState* sampler);
+
+	// For state changed behind the cache, e.g. by ImGui or by binding render targets
+	static void Invalidate();
+	static void InvalidateShaderResources();
+
+	// Moves the call counters into FrameStatistics
+	static void EndFrame();
+
+private:
+	static StateCache& Get();
+
+private:
+	StateTracker Tracker;
+};
\ No newline at end of file
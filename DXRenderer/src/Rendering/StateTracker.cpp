@@ -0,0 +1,75 @@
+#include "StateTracker.h"
+
+bool StateTracker::SetVertexBuffer(uint32_t slot, const void* buffer, uint32_t stride, uint32_t offset)
+{
+	if (slot >= VertexBufferSlots)
+		return Untracked();
+	return Update(VertexBuffers[slot], { buffer, stride, offset });
+}
+
+bool StateTracker::SetIndexBuffer(const void* buffer, uint32_t format, uint32_t offset)
+{
+	return Update(IndexBuffer, { buffer, format, offset });
+}
+
+bool StateTracker::SetTopology(uint32_t topology)
+{
+	return Update(Topology, topology);
+}
+
+bool StateTracker::SetInputLayout(const void* layout)
+{
+	return Update(InputLayout, layout);
+}
+
+bool StateTracker::SetShader(Stage stage, const void* shader)
+{
+	return Update(Shaders[stage], shader);
+}
+
+bool StateTracker::SetConstantBuffer(Stage stage, uint32_t slot, const void* buffer, uint32_t firstConstant, uint32_t constantCount)
+{
+	if (slot >= ConstantBufferSlots)
+		return Untracked();
+	return Update(ConstantBuffers[stage][slot], { buffer, firstConstant, constantCount });
+}
+
+bool StateTracker::SetShaderResource(Stage stage, uint32_t slot, const void* view)
+{
+	if (slot >= ShaderResourceSlots)
+		return Untracked();
+	return Update(ShaderResources[stage][slot], view);
+}
+
+bool StateTracker::SetSampler(Stage stage, uint32_t slot, const void* sampler)
+{
+	if (slot >= SamplerSlots)
+		return Untracked();
+	return Update(Samplers[stage][slot], sampler);
+}
+
+void StateTracker::Invalidate()
+{
+	VertexBuffers.fill(std::nullopt);
+	IndexBuffer.reset();
+	Topology.reset();
+	InputLayout.reset();
+	Shaders.fill(std::nullopt);
+	for (auto& stage : ConstantBuffers)
+		stage.fill(std::nullopt);
+	for (auto& stage : Samplers)
+		stage.fill(std::nullopt);
+	InvalidateShaderResources();
+}
+
+void StateTracker::InvalidateShaderResources()
+{
+	for (auto& stage : ShaderResources)
+		stage.fill(std::nullopt);
+}
+
+void StateTracker::ResetCounters()
+{
+	Issued = 0;
+	Filtered = 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Shadow copy of the bound pipeline state. Every setter reports whether the call has to reach the
+// device and counts issued versus filtered calls. Objects are opaque pointers and enums plain integers,
+// so the tracker works without a device. Slots past the tracked range are always issued.
+class StateTracker
+{
+public:
+	enum Stage : uint32_t
+	{
+		VertexStage = 0,
+		PixelStage,
+		StageCount
+	};
+
+	static constexpr uint32_t VertexBufferSlots = 16;
+	static constexpr uint32_t ConstantBufferSlots = 14;
+	static constexpr uint32_t ShaderResourceSlots = 32;
+	static constexpr uint32_t SamplerSlots = 16;
+
+	bool SetVertexBuffer(uint32_t slot, const void* buffer, uint32_t stride, uint32_t offset);
+	bool SetIndexBuffer(const void* buffer, uint32_t format, uint32_t offset);
+	bool SetTopology(uint32_t topology);
+	bool SetInputLayout(const void* layout);
+	bool SetShader(Stage stage, const void* shader);
+	// A constantCount of 0 binds the whole buffer
+	bool SetConstantBuffer(Stage stage, uint32_t slot, const void* buffer, uint32_t firstConstant = 0, uint32_t constantCount = 0);
+	bool SetShaderResource(Stage stage, uint32_t slot, const void* view);
+	bool SetSampler(Stage stage, uint32_t slot, const void* sampler);
+
+	// Forget everything, the next call of every kind is issued
+	void Invalidate();
+	// Binding outputs silently unbinds shader resource views of the same resources
+	void InvalidateShaderResources();
+
+	inline size_t GetIssued() const { return Issued; }
+	inline size_t GetFiltered() const { return Filtered; }
+	void ResetCounters();
+
+private:
+	struct VertexBufferBinding
+	{
+		const void* Buffer;
+		uint32_t Stride;
+		uint32_t Offset;
+		bool operator==(const VertexBufferBinding&) const = default;
+	};
+
+	struct IndexBufferBinding
+	{
+		const void* Buffer;
+		uint32_t Format;
+		uint32_t Offset;
+		bool operator==(const IndexBufferBinding&) const = default;
+	};
+
+	struct ConstantBufferBinding
+	{
+		const void* Buffer;
+		uint32_t FirstConstant;
+		uint32_t ConstantCount;
+		bool operator==(const ConstantBufferBinding&) const = default;
+	};
+
+	template<typename T>
+	bool Update(std::optional<T>& current, const T& next)
+	{
+		if (current == next)
+		{
+			Filtered++;
+			return false;
+		}
+
+		current = next;
+		Issued++;
+		return true;
+	}
+
+	bool Untracked()
+	{
+		Issued++;
+		return true;
+	}
+
+private:
+	std::array<std::optional<VertexBufferBinding>, VertexBufferSlots> VertexBuffers;
+	std::optional<IndexBufferBinding> IndexBuffer;
+	std::optional<uint32_t> Topology;
+	std::optional<const void*> InputLayout;
+	std::array<std::optional<const void*>, StageCount> Shaders;
+	std::array<std::array<std::optional<ConstantBufferBinding>, ConstantBufferSlots>, StageCount> ConstantBuffers;
+	std::array<std::array<std::optional<const void*>, ShaderResourceSlots>, StageCount> ShaderResources;
+	std::array<std::array<std::optional<const void*>, SamplerSlots>, StageCount> Samplers;
+
+	size_t Issued = 0;
+	size_t Filtered = 0;
+};
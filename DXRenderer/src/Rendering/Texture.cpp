@@ -1,6 +1,8 @@
 #include "Core\Exception.h"
 #include "Rendering\CurrentGraphicsContext.h"
+#include "DrawPacket.h"
 #include "RenderTarget.h"
+#include "StateCache.h"
 #include "Texture.h"
 
 #include <wrl.h>
@@ -25,7 +27,12 @@ Sampler::Sampler(uint32_t slot, SamplerInitializer init)
 
 inline void Sampler::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetSamplers(Slot, 1, SamplerID.GetAddressOf());
+	StateCache::PSSetSampler(Slot, SamplerID.Get());
+}
+
+void Sampler::Record(DrawPacket& packet) const
+{
+	packet.PSSamplers.Set(Slot, SamplerID.Get());
 }
 
 ShadowSampler::ShadowSampler(uint32_t slot)
@@ -44,11 +51,16 @@ ShadowSampler::ShadowSampler(uint32_t slot)
 
 void ShadowSampler::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetSamplers(Slot, 1, SamplerID.GetAddressOf());
+	StateCache::PSSetSampler(Slot, SamplerID.Get());
+}
+
+void ShadowSampler::Record(DrawPacket& packet) const
+{
+	packet.PSSamplers.Set(Slot, SamplerID.Get());
 }
 
 Texture::Texture(const std::string& filename, uint32_t slot)
-	:Slot(slot), TextureSampler{ slot, SamplerInitializer{ false, false } }
+	:Slot(slot), Handle(InternResourceID(filename + "#" + std::to_string(slot))), TextureSampler{ slot, SamplerInitializer{ false, false } }
 {
 	auto filepath = std::filesystem::current_path().parent_path().string() + "\\Content\\" + filename;
 	wchar_t wideName[512];
@@ -83,10 +95,16 @@ Texture::Texture(const std::string& filename, uint32_t slot)
 
 inline void Texture::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShaderResources(Slot, 1, TextureView.GetAddressOf());
+	StateCache::PSSetShaderResource(Slot, TextureView.Get());
 	TextureSampler.Bind();
 }
 
+void Texture::Record(DrawPacket& packet) const
+{
+	packet.PSShaderResources.Set(Slot, TextureView.Get());
+	TextureSampler.Record(packet);
+}
+
 CubeTexture::CubeTexture(uint32_t slot)
 	:Slot(slot), TextureSampler{}
 {
@@ -135,6 +153,12 @@ CubeTexture::CubeTexture(uint32_t slot)
 
 void CubeTexture::Bind() const
 {
-	CurrentGraphicsContext::Context()->PSSetShaderResources(Slot, 1, TextureView.GetAddressOf());
+	StateCache::PSSetShaderResource(Slot, TextureView.Get());
 	TextureSampler.Bind();
+}
+
+void CubeTexture::Record(DrawPacket& packet) const
+{
+	packet.PSShaderResources.Set(Slot, TextureView.Get());
+	TextureSampler.Record(packet);
 }
\ No newline at end of file
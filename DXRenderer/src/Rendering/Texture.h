@@ -20,6 +20,7 @@ public:
 	Sampler(uint32_t slot = 0, SamplerInitializer init = SamplerInitializer{});
 
 	void Bind() const override;
+	void Record(DrawPacket& packet) const override;
 private:
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> SamplerID;
 	uint32_t Slot;
@@ -31,6 +32,7 @@ public:
 	ShadowSampler(uint32_t slot = 0);
 
 	void Bind() const override;
+	void Record(DrawPacket& packet) const override;
 private:
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> SamplerID;
 	uint32_t Slot;
@@ -45,10 +47,13 @@ public:
 	inline uint32_t GetHeight() const { return (uint32_t)Image.GetMetadata().height; }
 
 	void Bind() const override;
+	void Record(DrawPacket& packet) const override;
+	inline ResourceHandle GetHandle() const override { return Handle; }
 	inline bool HasAlpha() const { return !Image.IsAlphaAllOpaque(); }
 
 private:
 	uint32_t Slot;
+	ResourceHandle Handle;
 	Sampler TextureSampler;
 	DirectX::ScratchImage Image;
 
@@ -61,6 +66,7 @@ class CubeTexture : public Component
 public:
 	CubeTexture(uint32_t slot = 0);
 	void Bind() const override;
+	void Record(DrawPacket& packet) const override;
 
 private:
 	uint32_t Slot;
@@ -0,0 +1,55 @@
+#include "TransformHierarchy.h"
+#include "Core/Core.h"
+
+void TransformHierarchy::Reset(size_t count)
+{
+	DirectX::XMFLOAT4X4A identity;
+	DirectX::XMStoreFloat4x4A(&identity, DirectX::XMMatrixIdentity());
+
+	Parents.assign(count, NoParent);
+	MarkedStatic.assign(count, 1);
+	Static.assign(count, 1);
+	Local.assign(count, identity);
+	World.assign(count, identity);
+	ModelView.assign(count, identity);
+	Count = 0;
+}
+
+uint32_t TransformHierarchy::Add(uint32_t parent, const DirectX::XMMATRIX& local, bool isStatic)
+{
+	ASSERT(Count < Parents.size());
+	ASSERT(parent == NoParent || parent < Count);
+
+	const uint32_t node = static_cast<uint32_t>(Count++);
+	Parents[node] = parent;
+	MarkedStatic[node] = isStatic;
+	Static[node] = isStatic && IsParentStatic(node);
+	SetLocal(node, local);
+	return node;
+}
+
+void TransformHierarchy::SetStatic(uint32_t node, bool isStatic)
+{
+	MarkedStatic[node] = isStatic;
+	Static[node] = isStatic && IsParentStatic(node);
+
+	// Descendants come after the node but need not follow it directly, so every later node takes its parent's
+	// state again. Parents come first, so the one read is already up to date.
+	for (size_t child = node + 1; child < Count; child++)
+		Static[child] = MarkedStatic[child] && IsParentStatic(static_cast<uint32_t>(child));
+}
+
+void TransformHierarchy::Update(const DirectX::XMMATRIX& root, const DirectX::XMMATRIX& view)
+{
+	using namespace DirectX;
+
+	// Parents come first, so the world matrix read for a parent is always the one of this update
+	for (size_t node = 0; node < Count; node++)
+	{
+		const uint32_t parent = Parents[node];
+		const XMMATRIX world = (parent == NoParent ? root : XMLoadFloat4x4A(&World[parent])) * XMLoadFloat4x4A(&Local[node]);
+
+		XMStoreFloat4x4A(&World[node], world);
+		XMStoreFloat4x4A(&ModelView[node], world * view);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Node transforms of a model flattened into arrays, parents stored before their children. World and
+// model view matrices are updated in one linear pass, meshes and their uniforms reference them by node index.
+class TransformHierarchy
+{
+public:
+	static constexpr uint32_t NoParent = ~0u;
+
+	// Sizes the arrays for count nodes, they never reallocate afterwards so the matrices can be referenced
+	void Reset(size_t count);
+	// Returns the index of the node, parent must already be added
+	uint32_t Add(uint32_t parent, const DirectX::XMMATRIX& local, bool isStatic = true);
+
+	// World of a node is the world of its parent times its local transform, root being that of top level nodes
+	void Update(const DirectX::XMMATRIX& root, const DirectX::XMMATRIX& view);
+
+	size_t Size() const { return Count; }
+	uint32_t GetParent(uint32_t node) const { return Parents[node]; }
+	DirectX::XMMATRIX GetLocal(uint32_t node) const { return DirectX::XMLoadFloat4x4A(&Local[node]); }
+	void SetLocal(uint32_t node, const DirectX::XMMATRIX& local) { DirectX::XMStoreFloat4x4A(&Local[node], local); }
+	const DirectX::XMFLOAT4X4A& GetWorld(uint32_t node) const { return World[node]; }
+	const DirectX::XMFLOAT4X4A& GetModelView(uint32_t node) const { return ModelView[node]; }
+
+	// Static nodes are not expected to move, passes may cache what they draw of them.
+	// A node is only static while its ancestors are as well.
+	void SetStatic(uint32_t node, bool isStatic);
+	bool IsStatic(uint32_t node) const { return Static[node]; }
+
+private:
+	bool IsParentStatic(uint32_t node) const { return Parents[node] == NoParent || Static[Parents[node]]; }
+
+private:
+	std::vector<uint32_t> Parents;
+	std::vector<uint8_t> MarkedStatic;
+	std::vector<uint8_t> Static;
+	std::vector<DirectX::XMFLOAT4X4A> Local;
+	std::vector<DirectX::XMFLOAT4X4A> World;
+	std::vector<DirectX::XMFLOAT4X4A> ModelView;
+	size_t Count = 0;
+};
\ No newline at end of file
@@ -42,18 +42,12 @@ GPUObjectBase::GPUObjectBase(GPUObjectBase&& other) noexcept
 
 void GPUObjectBase::Add(SharedPtr<Shader> shader)
 {
-	const auto id = shader->GetID();
-
-	Pool::Add(shader);
-	Shaders.Add(Pool::GetShader(id));
+	Shaders.Add(Pool::Add(std::move(shader)));
 }
 
 void GPUObjectBase::Add(SharedPtr<BufferBase> buffer)
 {
-	const auto id = buffer->GetID();
-
-	Pool::Add(buffer);
-	Buffers.Add(Pool::GetBuffer(id));
+	Buffers.Add(Pool::Add(std::move(buffer)));
 }
 
 void GPUObjectBase::Add(UniquePtr<Component> component)
@@ -75,6 +69,13 @@ const IndexBuffer* GPUObjectBase::GetIndexBuffer() const
 	return ptr;
 }
 
+void GPUObjectBase::Record(DrawPacket& packet) const
+{
+	Buffers.Record(packet);
+	Shaders.Record(packet);
+	Components.Record(packet);
+}
+
 GPUObject::GPUObject()
 {
 	UID++;
@@ -94,7 +95,7 @@ void GPUObject::Add(Technique&& technique)
 void GPUObject::LinkTechniques()
 {
 	for (auto& t : Techniques)
-		t->Link();
+		t->Link(*this);
 }
 
 Kernel InitKernel(uint32_t radius, float sigma)
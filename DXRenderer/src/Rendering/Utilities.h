@@ -3,6 +3,7 @@
 #include "Core\Core.h"
 #include "Rendering\Buffer.h"
 #include "Rendering\Component.h"
+#include "Rendering\Culling.h"
 #include "Rendering\ResourcePool.h"
 #include "Rendering\Shader.h"
 
@@ -116,11 +117,14 @@ namespace Primitives
 	struct VertexElement;
 }
 
-template<typename Vertex,typename = std::enable_if_t<std::is_base_of_v<Primitives::VertexElement, Vertex>>>
+template<typename Index>
+concept IsIndex = std::is_same_v<Index, uint16_t> || std::is_same_v<Index, uint32_t>;
+
+template<typename Vertex, IsIndex Index = uint16_t, typename = std::enable_if_t<std::is_base_of_v<Primitives::VertexElement, Vertex>>>
 struct IndexedVertices
 {
 	IndexedVertices() = default;
-	IndexedVertices(const std::vector<Vertex>& vertices, const std::vector<unsigned short> indices)
+	IndexedVertices(const std::vector<Vertex>& vertices, const std::vector<Index> indices)
 		: Vertices(std::move(vertices)), Indices(std::move(indices))
 	{
 	}
@@ -143,7 +147,7 @@ struct IndexedVertices
 
 public:
 	std::vector<Vertex> Vertices;
-	std::vector<unsigned short> Indices;
+	std::vector<Index> Indices;
 };
 
 class Technique;
@@ -164,6 +168,22 @@ public:
 	virtual void Tick(float delta) {}
 	void Bind() const;
 	const IndexBuffer* GetIndexBuffer() const;
+	// Appends buffers, shaders and components to a draw packet in binding order
+	void Record(DrawPacket& packet) const;
+	// Parts of the index buffer drawn for the given channels, null draws the whole buffer.
+	// The vector must outlive the object's draw packets.
+	virtual const std::vector<Meshlets::DrawRange>* GetDrawRanges(size_t channels) const { return nullptr; }
+
+	inline ResourceHandle GetProgramHandle() const { return Shaders.GetHandle(); }
+	inline ResourceHandle GetMaterialHandle() const { return Components.GetHandle(); }
+	// Depth of the object in view space, used to order draws
+	virtual float GetViewDepth() const { return 0.0f; }
+	// Null for objects without bounds, which are never culled
+	virtual const Culling::Box* GetWorldBounds() const { return nullptr; }
+	// Null for objects placed some other way, caches then only see their bounds
+	virtual const DirectX::XMFLOAT4X4* GetWorldMatrix() const { return nullptr; }
+	// Static objects rarely move, passes may cache what they draw of them
+	virtual bool IsStatic() const { return false; }
 
 	void Add(SharedPtr<Shader> shader);
 	void Add(SharedPtr<BufferBase> buffer);
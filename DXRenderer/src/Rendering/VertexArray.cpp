@@ -0,0 +1,166 @@
+#include "VertexArray.h"
+
+LayoutElement::LayoutElement(const std::string& name, DataType type)
+	:Name(name), Type(type), Size(CalcSize(type)), Offset(0)
+{
+}
+
+LayoutElement::LayoutElement(ElementType type)
+	:Name(ResolveNameFromType(type)), Type(ResolveDataType(type)), Size(CalcSize(type)), Offset(0)
+{}
+
+const char* LayoutElement::ResolveNameFromType(ElementType type)
+{
+	switch (type)
+	{
+	case ElementType::Position2:
+	case ElementType::Position3:
+	case ElementType::PositionQuantized: return "Position";
+	case ElementType::Color3:
+	case ElementType::Color4: return "Color";
+	case ElementType::Normal:
+	case ElementType::NormalOct: return "Normal";
+	case ElementType::Tangent:
+	case ElementType::TangentOct: return "Tangent";
+	case ElementType::Bitangent: return "Bitangent";
+	case ElementType::TexCoords:
+	case ElementType::TexCoordsHalf: return "TexCoords";
+	}
+}
+
+LayoutElement::DataType LayoutElement::ResolveDataType(ElementType type)
+{
+	switch (type)
+	{
+	case ElementType::Position2: return DataType::Float2;
+	case ElementType::Position3: return DataType::Float3;
+	case ElementType::Color3: return DataType::Float3;
+	case ElementType::Color4: return DataType::Float4;
+	case ElementType::Normal: return DataType::Float3;
+	case ElementType::Tangent: return DataType::Float3;
+	case ElementType::Bitangent: return DataType::Float3;
+	case ElementType::TexCoords: return DataType::Float2;
+	case ElementType::PositionQuantized: return DataType::Short4Norm;
+	case ElementType::NormalOct: return DataType::Short2Norm;
+	case ElementType::TangentOct: return DataType::Short2Norm;
+	case ElementType::TexCoordsHalf: return DataType::Half2;
+	}
+}
+
+uint32_t LayoutElement::CalcSize(DataType type)
+{
+	switch (type)
+	{
+	case DataType::UChar2:
+	case DataType::UChar2Norm: return sizeof(unsigned char) * 2;
+	case DataType::UChar4:
+	case DataType::UChar4Norm: return sizeof(unsigned char) * 4;
+	case DataType::Float: return sizeof(float);
+	case DataType::Float2: return sizeof(float) * 2;
+	case DataType::Float3: return sizeof(float) * 3;
+	case DataType::Float4: return sizeof(float) * 4;
+	case DataType::Int: return  sizeof(int);
+	case DataType::Int2: return sizeof(int) * 2;
+	case DataType::Int3: return sizeof(int) * 3;
+	case DataType::Int4: return sizeof(int) * 4;
+	case DataType::Short2Norm: return sizeof(short) * 2;
+	case DataType::Short4Norm: return sizeof(short) * 4;
+	case DataType::Half2: return sizeof(short) * 2;
+	}
+}
+
+uint32_t LayoutElement::CalcSize(ElementType type)
+{
+	switch (type)
+	{
+	case ElementType::Position2: return sizeof(float) * 2;
+	case ElementType::Position3: return sizeof(float) * 3;
+	case ElementType::Color3: return sizeof(float) * 3;
+	case ElementType::Color4: return sizeof(float) * 4;
+	case ElementType::Normal: return sizeof(float) * 3;
+	case ElementType::Tangent: return sizeof(float) * 3;
+	case ElementType::Bitangent: return sizeof(float) * 3;
+	case ElementType::TexCoords: return sizeof(float) * 2;
+	case ElementType::PositionQuantized: return sizeof(short) * 4;
+	case ElementType::NormalOct: return sizeof(short) * 2;
+	case ElementType::TangentOct: return sizeof(short) * 2;
+	case ElementType::TexCoordsHalf: return sizeof(short) * 2;
+	}
+}
+
+BufferLayout::BufferLayout(std::initializer_list<LayoutElement> elements)
+	: Elements(elements)
+{
+	uint32_t offset = 0;
+	for (auto& element : Elements)
+	{
+		element.Offset = offset;
+		offset += element.Size;
+		Stride += element.Size;
+	}
+}
+
+BufferLayout& BufferLayout::AddElement(LayoutElement element)
+{
+	uint32_t offset = Elements.empty() ? 0 : Elements.back().Offset + Elements.back().Size;
+	element.Offset = offset;
+	Stride = element.Offset + element.Size;
+	Elements.push_back(element);
+	return *this;
+}
+
+uint32_t BufferLayout::GetStride() const
+{
+	return Stride;
+}
+
+size_t BufferLayout::GetElementsSize() const
+{
+	return Elements.size();
+}
+
+const LayoutElement& BufferLayout::operator[](size_t i) const
+{
+	return Elements[i];
+}
+
+inline Vertex::Vertex(char* ptr, const BufferLayout& layout)
+	: Ptr(ptr), Layout(layout)
+{
+	ASSERT(ptr);
+}
+
+VertexArray::VertexArray(BufferLayout layout)
+	:Layout(std::move(layout))
+{}
+
+void VertexArray::Interleave(std::initializer_list<VertexStream> streams, size_t count)
+{
+	ASSERT(streams.size() <= Layout.GetElementsSize());
+
+	std::vector<VertexStreamTarget> targets;
+	targets.reserve(streams.size());
+	for (size_t i = 0; i < streams.size(); i++)
+		targets.push_back({ Layout[i].GetOffset(), Layout[i].GetSize() });
+
+	const uint32_t stride = Layout.GetStride();
+	const size_t offset = Vertices.size();
+	Vertices.resize(offset + count * stride);
+	InterleaveStreams(Vertices.data() + offset, stride, streams.begin(), targets.data(), streams.size(), count);
+}
+
+void VertexArray::Remap(const std::vector<uint32_t>& remap, size_t vertexCount)
+{
+	const uint32_t stride = Layout.GetStride();
+	ASSERT(remap.size() * stride == Vertices.size());
+
+	std::vector<char> remapped(vertexCount * stride);
+	MeshOptimizer::RemapVertexBuffer(remapped.data(), Vertices.data(), remap.size(), stride, remap.data());
+	Vertices = std::move(remapped);
+}
+
+Vertex VertexArray::Back()
+{
+	ASSERT(Vertices.size() != 0);
+	return Vertex{ Vertices.data() + Vertices.size() - Layout.GetStride(), Layout };
+}
\ No newline at end of file
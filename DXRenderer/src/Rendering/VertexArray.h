@@ -0,0 +1,363 @@
+#pragma once
+
+#include "Core/Core.h"
+#include "Rendering/Interleave.h"
+#include "Rendering/MeshOptimizer.h"
+#include "Rendering/Quantization.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <initializer_list>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Vertex layouts and the vertices written into them on the CPU. Nothing here touches the device,
+// the buffers in Buffer.h and VertexLayout.h upload the result.
+struct LayoutElement
+{
+	enum class DataType
+	{
+		UChar2, UChar4,
+		UChar2Norm, UChar4Norm,
+		Float, Float2, Float3, Float4,
+		Int, Int2, Int3, Int4,
+		Short2Norm, Short4Norm,
+		Half2
+	};
+
+	enum class ElementType
+	{
+		Position2, Position3,
+		Color3, Color4,
+		Normal, Tangent, Bitangent,
+		TexCoords,
+		PositionQuantized,
+		NormalOct, TangentOct,
+		TexCoordsHalf,
+	};
+
+public:
+	LayoutElement(const std::string& name, DataType type);
+	LayoutElement(ElementType type);
+
+	uint32_t GetSize() const { return Size; }
+	uint32_t GetOffset() const { return Offset; }
+	DataType GetType() const { return Type; }
+
+private:
+	static const char* ResolveNameFromType(ElementType type);
+	static DataType ResolveDataType(ElementType type);
+	static uint32_t CalcSize(DataType type);
+	static uint32_t CalcSize(ElementType type);
+
+private:
+	std::string Name;
+	DataType Type;
+	uint32_t Size;
+	uint32_t Offset;
+
+	friend struct BufferLayout;
+	friend class InputLayout;
+};
+
+struct BufferLayout
+{
+	BufferLayout() = default;
+	BufferLayout(std::initializer_list<LayoutElement> elements);
+
+	BufferLayout& AddElement(LayoutElement element);
+
+	uint32_t GetStride() const;
+	size_t GetElementsSize() const;
+
+	template<LayoutElement::ElementType Type>
+	const LayoutElement& ResolveType() const
+	{
+		for (auto& element : Elements)
+		{
+			// Elements keep their data type only, the semantic tells apart element types sharing one
+			if (element.Type == LayoutElement::ResolveDataType(Type) && element.Name == LayoutElement::ResolveNameFromType(Type))
+				return element;
+		}
+		ASSERT(false);
+		return Elements.front();
+	}
+
+	const LayoutElement& operator[](size_t i) const;
+private:
+
+	std::vector<LayoutElement> Elements;
+	uint32_t Stride = 0;
+
+	friend class InputLayout;
+};
+
+struct Vertex
+{
+public:
+	template<typename T>
+	void SetAttributeIndex(size_t i, T&& attr)
+	{
+		using namespace DirectX;
+		using namespace DirectX::PackedVector;
+		using DataType = LayoutElement::DataType;
+
+		const auto& element = Layout[i];
+		auto attributePtr = Ptr + element.GetOffset();
+
+		switch (element.GetType())
+		{
+			case DataType::UChar2Norm: SetAttribute<XMUBYTEN2>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::UChar4Norm: SetAttribute<XMUBYTEN4>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::UChar2: SetAttribute<XMUBYTE2>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::UChar4: SetAttribute<XMUBYTE4>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Float: SetAttribute<float>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Float2: SetAttribute<XMFLOAT2>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Float3: SetAttribute<XMFLOAT3>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Float4: SetAttribute<XMFLOAT4>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Int: SetAttribute<int>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Int2: SetAttribute<XMINT2>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Int3: SetAttribute<XMINT3>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Int4: SetAttribute<XMINT4>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Short2Norm: SetAttribute<XMSHORTN2>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Short4Norm: SetAttribute<XMSHORTN4>(attributePtr, std::forward<T>(attr)); break;
+			case DataType::Half2: SetAttribute<XMHALF2>(attributePtr, std::forward<T>(attr)); break;
+		}
+	}
+
+private:
+	Vertex(char* ptr, const BufferLayout& layout);
+
+	template<typename First, typename ...Rest>
+	void SetAttributeIndex(size_t i, First&& first, Rest&&... rest)
+	{
+		SetAttributeIndex(i, std::forward<First>(first));
+		SetAttributeIndex(i + 1, std::forward<Rest>(rest)...);
+	}
+
+	template<typename Dest, typename Src>
+	void SetAttribute(char* attributePtr, Src&& attr)
+	{
+		if constexpr (std::is_assignable<Dest&, Src>::value)
+			*reinterpret_cast<Dest*>(attributePtr) = attr;
+		else
+			ASSERT(false);
+	}
+private:
+	char* Ptr;
+	const BufferLayout& Layout;
+
+	friend class VertexArray;
+};
+
+// Vertices of a layout only known at runtime, every attribute goes through a switch on its type
+class VertexArray
+{
+public:
+	VertexArray(BufferLayout layout);
+
+	template<typename ...Attributes>
+	void EmplaceBack(Attributes&&... attributes)
+	{
+		Vertices.resize(Vertices.size() + Layout.GetStride());
+		Back().SetAttributeIndex(0, std::forward<Attributes>(attributes)...);
+	}
+
+	// Appends count vertices at once, streams[i] feeding the i-th element of the layout
+	void Interleave(std::initializer_list<VertexStream> streams, size_t count);
+
+	// Moves vertex i to remap[i], dropping vertices mapped to ~0u
+	void Remap(const std::vector<uint32_t>& remap, size_t vertexCount);
+
+	const BufferLayout& GetLayout() const { return Layout; }
+	const char* Data() const { return Vertices.data(); }
+	size_t GetByteSize() const { return Vertices.size(); }
+	size_t Size() const { return Vertices.size() / Layout.GetStride(); }
+
+private:
+	Vertex Back();
+
+private:
+	std::vector<char> Vertices{};
+	BufferLayout Layout;
+};
+
+// Compile-time counterpart of BufferLayout. Offsets and stride are resolved by the compiler,
+// so writing a vertex is a fixed sequence of stores.
+namespace VertexAttribute
+{
+	template<LayoutElement::ElementType Element, typename T, LayoutElement::DataType Data>
+	struct Tag
+	{
+		using Type = T;
+		static constexpr LayoutElement::ElementType ElementType = Element;
+		static constexpr LayoutElement::DataType DataType = Data;
+		static constexpr uint32_t Size = sizeof(T);
+	};
+
+	using Element = LayoutElement::ElementType;
+	using Data = LayoutElement::DataType;
+
+	struct Position2 : Tag<Element::Position2, DirectX::XMFLOAT2, Data::Float2>
+	{
+		static constexpr const char* Semantic = "Position";
+	};
+
+	struct Position3 : Tag<Element::Position3, DirectX::XMFLOAT3, Data::Float3>
+	{
+		static constexpr const char* Semantic = "Position";
+	};
+
+	struct Color3 : Tag<Element::Color3, DirectX::XMFLOAT3, Data::Float3>
+	{
+		static constexpr const char* Semantic = "Color";
+	};
+
+	struct Color4 : Tag<Element::Color4, DirectX::XMFLOAT4, Data::Float4>
+	{
+		static constexpr const char* Semantic = "Color";
+	};
+
+	struct Normal : Tag<Element::Normal, DirectX::XMFLOAT3, Data::Float3>
+	{
+		static constexpr const char* Semantic = "Normal";
+	};
+
+	struct Tangent : Tag<Element::Tangent, DirectX::XMFLOAT3, Data::Float3>
+	{
+		static constexpr const char* Semantic = "Tangent";
+	};
+
+	struct Bitangent : Tag<Element::Bitangent, DirectX::XMFLOAT3, Data::Float3>
+	{
+		static constexpr const char* Semantic = "Bitangent";
+	};
+
+	struct TexCoords : Tag<Element::TexCoords, DirectX::XMFLOAT2, Data::Float2>
+	{
+		static constexpr const char* Semantic = "TexCoords";
+	};
+
+	struct PositionQuantized : Tag<Element::PositionQuantized, Quantization::Short4, Data::Short4Norm>
+	{
+		static constexpr const char* Semantic = "Position";
+	};
+
+	struct NormalOct : Tag<Element::NormalOct, Quantization::Short2, Data::Short2Norm>
+	{
+		static constexpr const char* Semantic = "Normal";
+	};
+
+	struct TangentOct : Tag<Element::TangentOct, Quantization::Short2, Data::Short2Norm>
+	{
+		static constexpr const char* Semantic = "Tangent";
+	};
+
+	struct TexCoordsHalf : Tag<Element::TexCoordsHalf, Quantization::Half2, Data::Half2>
+	{
+		static constexpr const char* Semantic = "TexCoords";
+	};
+}
+
+template<typename... Elements>
+struct StaticLayout
+{
+	static constexpr size_t Count = sizeof...(Elements);
+	static constexpr uint32_t Stride = (Elements::Size + ... + 0u);
+
+	static constexpr std::array<uint32_t, Count> Offsets = []()
+	{
+		constexpr std::array<uint32_t, Count> sizes{ Elements::Size... };
+		std::array<uint32_t, Count> offsets{};
+		uint32_t offset = 0;
+		for (size_t i = 0; i < Count; i++)
+		{
+			offsets[i] = offset;
+			offset += sizes[i];
+		}
+		return offsets;
+	}();
+
+	template<size_t I>
+	using ElementAt = std::tuple_element_t<I, std::tuple<Elements...>>;
+
+	static BufferLayout GetBufferLayout()
+	{
+		return BufferLayout{ LayoutElement(Elements::ElementType)... };
+	}
+};
+
+template<typename Layout>
+class StaticVertexArray;
+
+template<typename... Elements>
+class StaticVertexArray<StaticLayout<Elements...>>
+{
+	using Layout = StaticLayout<Elements...>;
+
+public:
+	void Reserve(size_t count)
+	{
+		if (count * Layout::Stride > Vertices.size())
+			Vertices.resize(count * Layout::Stride);
+	}
+
+	void EmplaceBack(const typename Elements::Type&... attributes)
+	{
+		if ((Count + 1) * Layout::Stride > Vertices.size())
+			Reserve(std::max<size_t>(Count * 2, 64));
+
+		Write(Vertices.data() + Count * Layout::Stride, std::index_sequence_for<Elements...>{}, attributes...);
+		Count++;
+	}
+
+	// Appends count vertices at once, streams[i] feeding the i-th element of the layout
+	void Interleave(const std::array<VertexStream, sizeof...(Elements)>& streams, size_t count)
+	{
+		static constexpr std::array<VertexStreamTarget, sizeof...(Elements)> targets = []()
+		{
+			std::array<VertexStreamTarget, sizeof...(Elements)> result{};
+			constexpr std::array<uint32_t, sizeof...(Elements)> sizes{ Elements::Size... };
+			for (size_t i = 0; i < result.size(); i++)
+				result[i] = { Layout::Offsets[i], sizes[i] };
+			return result;
+		}();
+
+		Reserve(Count + count);
+		InterleaveStreams(Vertices.data() + Count * Layout::Stride, Layout::Stride,
+						  streams.data(), targets.data(), streams.size(), count);
+		Count += count;
+	}
+
+	// Moves vertex i to remap[i], dropping vertices mapped to ~0u
+	void Remap(const std::vector<uint32_t>& remap, size_t vertexCount)
+	{
+		ASSERT(remap.size() == Count);
+		std::vector<char> remapped(vertexCount * Layout::Stride);
+		MeshOptimizer::RemapVertexBuffer(remapped.data(), Vertices.data(), Count, Layout::Stride, remap.data());
+		Vertices = std::move(remapped);
+		Count = vertexCount;
+	}
+
+	const char* Data() const { return Vertices.data(); }
+	size_t GetByteSize() const { return Count * Layout::Stride; }
+	size_t Size() const { return Count; }
+
+private:
+	template<size_t... I>
+	static void Write(char* destination, std::index_sequence<I...>, const typename Elements::Type&... attributes)
+	{
+		(std::memcpy(destination + Layout::Offsets[I], &attributes, Elements::Size), ...);
+	}
+
+private:
+	// Grown ahead of Count, only the first Count vertices are written
+	std::vector<char> Vertices{};
+	size_t Count = 0;
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Rendering/Buffer.h"
+#include "Rendering/VertexArray.h"
+
+#include <array>
+#include <utility>
+
+template<typename Layout, size_t... I>
+constexpr std::array<D3D11_INPUT_ELEMENT_DESC, Layout::Count> GetInputDescriptors(std::index_sequence<I...>)
+{
+	return { D3D11_INPUT_ELEMENT_DESC{ Layout::template ElementAt<I>::Semantic, 0, GetDXGIFormat(Layout::template ElementAt<I>::DataType),
+									   0, Layout::Offsets[I], D3D11_INPUT_PER_VERTEX_DATA, 0 }... };
+}
+
+// Input layout descriptors of a StaticLayout, resolved by the compiler
+template<typename Layout>
+constexpr std::array<D3D11_INPUT_ELEMENT_DESC, Layout::Count> GetInputDescriptors()
+{
+	return GetInputDescriptors<Layout>(std::make_index_sequence<Layout::Count>{});
+}
+
+template<typename Layout>
+class StaticVertexBufferBuilder;
+
+template<typename... Elements>
+class StaticVertexBufferBuilder<StaticLayout<Elements...>>
+{
+	using Layout = StaticLayout<Elements...>;
+
+public:
+	StaticVertexBufferBuilder(const std::string& tag)
+		:Object(tag, Layout::GetBufferLayout())
+	{}
+
+	void Reserve(size_t count) { Vertices.Reserve(count); }
+
+	void EmplaceBack(const typename Elements::Type&... attributes) { Vertices.EmplaceBack(attributes...); }
+
+	// Appends count vertices at once, streams[i] feeding the i-th element of the layout
+	void Interleave(const std::array<VertexStream, sizeof...(Elements)>& streams, size_t count) { Vertices.Interleave(streams, count); }
+
+	// Moves vertex i to remap[i], dropping vertices mapped to ~0u
+	void Remap(const std::vector<uint32_t>& remap, size_t vertexCount) { Vertices.Remap(remap, vertexCount); }
+
+	size_t Size() const { return Vertices.Size(); }
+
+	UniquePtr<VertexBuffer> Release()
+	{
+		Object.Create(Vertices.Data(), static_cast<uint32_t>(Vertices.GetByteSize()));
+		return MakeUnique<VertexBuffer>(std::move(Object));
+	}
+
+private:
+	StaticVertexArray<Layout> Vertices;
+	VertexBuffer Object;
+};
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "Test.h"
+#include "CullingHelpers.h"
+#include "Rendering/BoundingVolumeHierarchy.h"
+
+#include <limits>
+#include <unordered_map>
+
+using namespace Culling;
+using CullingHelpers::GetPlaneMargin;
+using CullingHelpers::MakeViewProjection;
+using CullingHelpers::RandomBoxes;
+using CullingHelpers::ToBoxList;
+
+namespace
+{
+	using Bounds = BoundingVolumeHierarchy::Bounds;
+
+	// The tree and the boxes it should hold, keyed by item
+	struct Scene
+	{
+		BoundingVolumeHierarchy Tree;
+		std::unordered_map<uint32_t, Box> Boxes;
+		std::unordered_map<uint32_t, uint32_t> Proxies;
+	};
+
+	Scene BuildScene(const std::vector<Box>& boxes)
+	{
+		Scene scene;
+		std::vector<uint32_t> items(boxes.size()), proxies;
+		for (size_t i = 0; i < boxes.size(); i++)
+		{
+			items[i] = uint32_t(i) * 3 + 1;
+			scene.Boxes[items[i]] = boxes[i];
+		}
+
+		scene.Tree.Build(boxes.data(), items.data(), boxes.size(), proxies);
+		for (size_t i = 0; i < boxes.size(); i++)
+			scene.Proxies[items[i]] = proxies[i];
+		return scene;
+	}
+
+	float SphereDistance(const Box& box, const DirectX::XMFLOAT3& center)
+	{
+		const float dx = std::fmax(std::fabs(center.x - box.Center.x) - box.Extents.x, 0.0f);
+		const float dy = std::fmax(std::fabs(center.y - box.Center.y) - box.Extents.y, 0.0f);
+		const float dz = std::fmax(std::fabs(center.z - box.Center.z) - box.Extents.z, 0.0f);
+		return std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	float RayDistance(const Box& box, const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction)
+	{
+		const Bounds bounds = Bounds::FromBox(box);
+		const float start[3] = { origin.x, origin.y, origin.z };
+		const float step[3] = { direction.x, direction.y, direction.z };
+		float entry = 0.0f, exit = std::numeric_limits<float>::infinity();
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float t0 = (bounds.Min[axis] - start[axis]) / step[axis];
+			const float t1 = (bounds.Max[axis] - start[axis]) / step[axis];
+			entry = std::max(entry, std::min(t0, t1));
+			exit = std::min(exit, std::max(t0, t1));
+		}
+		return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+	}
+
+	// Every item passing the test is returned exactly once, and nothing else, up to boxes on the boundary
+	template<typename Passes, typename OnBoundary>
+	void CheckQuery(const Scene& scene, std::vector<uint32_t> items, Passes&& passes, OnBoundary&& onBoundary)
+	{
+		std::sort(items.begin(), items.end());
+		CHECK(std::adjacent_find(items.begin(), items.end()) == items.end());
+
+		size_t expected = 0, boundary = 0;
+		for (const auto& [item, box] : scene.Boxes)
+		{
+			const bool found = std::binary_search(items.begin(), items.end(), item);
+			if (found != passes(box))
+			{
+				CHECK(onBoundary(box));
+				boundary++;
+			}
+			expected += passes(box);
+		}
+		CHECK(items.size() + boundary >= expected && items.size() <= expected + boundary);
+		CHECK(boundary <= 2);
+		for (uint32_t item : items)
+			CHECK(scene.Boxes.count(item) == 1);
+	}
+
+	void CheckQueries(const Scene& scene, const Frustum& frustum, uint32_t seed)
+	{
+		std::vector<uint32_t> items;
+		scene.Tree.QueryFrustum(frustum, items);
+		CheckQuery(scene, items, [&](const Box& box) { return IsVisible(box, frustum); },
+				   [&](const Box& box) { return GetPlaneMargin(box, frustum) < 1e-3f; });
+
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> position(-150.0f, 150.0f), radius(1.0f, 40.0f), axis(-1.0f, 1.0f);
+		for (int i = 0; i < 20; i++)
+		{
+			const DirectX::XMFLOAT3 center = { position(generator), position(generator), position(generator) };
+			const float r = radius(generator);
+			items.clear();
+			scene.Tree.QuerySphere(center, r, items);
+			CheckQuery(scene, items, [&](const Box& box) { return IntersectsSphere(box, center, r); },
+					   [&](const Box& box) { return std::fabs(SphereDistance(box, center) - r) < 1e-3f; });
+		}
+
+		for (int i = 0; i < 50; i++)
+		{
+			const DirectX::XMFLOAT3 origin = { position(generator), position(generator), position(generator) };
+			const DirectX::XMFLOAT3 direction = { axis(generator), axis(generator), axis(generator) };
+			float nearest = 300.0f;
+			for (const auto& [item, box] : scene.Boxes)
+				nearest = std::min(nearest, RayDistance(box, origin, direction));
+
+			float distance = -1.0f;
+			const uint32_t hit = scene.Tree.RayCast(origin, direction, 300.0f, &distance);
+			if (nearest >= 300.0f)
+			{
+				CHECK_EQUAL(hit, BoundingVolumeHierarchy::Null);
+				continue;
+			}
+
+			// Ties between boxes may return either item, never a farther one
+			CHECK(hit != BoundingVolumeHierarchy::Null && scene.Boxes.count(hit) == 1);
+			CHECK_NEAR(distance, nearest, 1e-3f);
+			if (hit != BoundingVolumeHierarchy::Null && scene.Boxes.count(hit) == 1)
+				CHECK_NEAR(RayDistance(scene.Boxes.at(hit), origin, direction), nearest, 1e-3f);
+		}
+	}
+}
+
+TEST(BoundingVolumeHierarchyBuildMatchesBruteForce)
+{
+	const Frustum frustum = ExtractFrustum(MakeViewProjection(1.0f, 16.0f / 9.0f, 0.5f, 150.0f, { 3, -2, -40 }));
+	const Scene scene = BuildScene(RandomBoxes(5000, 21));
+	CHECK_EQUAL(scene.Tree.Size(), 5000u);
+	// A binned SAH build over uniform boxes stays close to balanced
+	CHECK(scene.Tree.GetHeight() < 32);
+	CheckQueries(scene, frustum, 22);
+
+	BoundingVolumeHierarchy empty;
+	std::vector<uint32_t> items;
+	empty.QueryFrustum(frustum, items);
+	empty.QuerySphere({ 0, 0, 0 }, 1000.0f, items);
+	CHECK(items.empty());
+	CHECK_EQUAL(empty.RayCast({ 0, 0, 0 }, { 0, 0, 1 }, 1000.0f), BoundingVolumeHierarchy::Null);
+}
+
+TEST(BoundingVolumeHierarchyRefitMatchesBruteForce)
+{
+	const Frustum frustum = ExtractFrustum(MakeViewProjection(1.2f, 1.0f, 0.5f, 200.0f, { 0, 0, -100 }));
+	Scene scene = BuildScene(RandomBoxes(2000, 31));
+	std::mt19937 generator(32);
+	std::uniform_real_distribution<float> jitter(-0.04f, 0.04f), jump(-30.0f, 30.0f);
+
+	// Movements inside the margin leave the tree alone
+	for (auto& [item, box] : scene.Boxes)
+	{
+		box.Center = { box.Center.x + jitter(generator), box.Center.y + jitter(generator), box.Center.z + jitter(generator) };
+		CHECK(!scene.Tree.Update(scene.Proxies[item], box));
+	}
+	CheckQueries(scene, frustum, 33);
+
+	uint32_t nextItem = 1u << 20;
+	const auto spawned = RandomBoxes(1000, 34);
+	for (int round = 0; round < 10; round++)
+	{
+		size_t refits = 0;
+		for (auto& [item, box] : scene.Boxes)
+		{
+			if (generator() % 4 != 0)
+				continue;
+			box.Center = { box.Center.x + jump(generator), box.Center.y + jump(generator), box.Center.z + jump(generator) };
+			refits += scene.Tree.Update(scene.Proxies[item], box);
+		}
+		CHECK(refits > 0);
+
+		// Remove a hundred items and insert as many new ones
+		std::vector<uint32_t> removed;
+		for (const auto& [item, box] : scene.Boxes)
+			if (removed.size() < 100 && generator() % 8 == 0)
+				removed.push_back(item);
+		for (uint32_t item : removed)
+		{
+			scene.Tree.Remove(scene.Proxies[item]);
+			scene.Boxes.erase(item);
+			scene.Proxies.erase(item);
+		}
+		for (size_t i = 0; i < removed.size(); i++)
+		{
+			const Box& box = spawned[nextItem % spawned.size()];
+			scene.Boxes[nextItem] = box;
+			scene.Proxies[nextItem] = scene.Tree.Insert(box, nextItem);
+			nextItem++;
+		}
+
+		CHECK_EQUAL(scene.Tree.Size(), scene.Boxes.size());
+		CheckQueries(scene, frustum, 35 + round);
+	}
+	// Rotations keep the refit tree from degenerating
+	CHECK(scene.Tree.GetHeight() < 48);
+}
+
+BENCHMARK(BoundingVolumeHierarchyThroughput)
+{
+	constexpr size_t count = 100000;
+	const Frustum frustum = ExtractFrustum(MakeViewProjection(1.0f, 16.0f / 9.0f, 0.5f, 150.0f, { 3, -2, -40 }));
+	std::vector<Box> boxes = RandomBoxes(count, 41);
+	std::vector<uint32_t> items(count), proxies;
+	for (size_t i = 0; i < count; i++)
+		items[i] = uint32_t(i);
+
+	BoundingVolumeHierarchy tree;
+	Test::Report("build 100k", Test::Measure([&]() { tree.Build(boxes.data(), items.data(), count, proxies); }));
+	std::printf("    height %u, area ratio %.1f\n", tree.GetHeight(), tree.GetAreaRatio());
+
+	// One in ten items moves far enough to refit every frame
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> jump(-5.0f, 5.0f);
+	Test::Report("update 10k moved items", Test::Measure([&]()
+	{
+		for (size_t i = 0; i < count; i += 10)
+		{
+			boxes[i].Center.x += jump(generator);
+			boxes[i].Center.z += jump(generator);
+			tree.Update(proxies[i], boxes[i]);
+		}
+	}));
+	std::printf("    height %u, area ratio %.1f\n", tree.GetHeight(), tree.GetAreaRatio());
+
+	std::vector<uint32_t> visible;
+	Test::Report("QueryFrustum", Test::Measure([&]()
+	{
+		visible.clear();
+		tree.QueryFrustum(frustum, visible);
+	}));
+
+	const BoxList list = ToBoxList(boxes);
+	std::vector<uint8_t> flags(count);
+	size_t visibleCount = 0;
+	Test::Report("CullBoxes brute force", Test::Measure([&]() { visibleCount = CullBoxes(list, frustum, flags.data()); }));
+
+	std::printf("    %zu of %zu visible\n", visible.size(), count);
+	CHECK(visible.size() + 4 >= visibleCount && visible.size() <= visibleCount + 4);
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "Test.h"
+#include "Core/ThreadPool.h"
+#include "Rendering/DeviceBackend.h"
+
+namespace
+{
+	void* Object(uintptr_t id)
+	{
+		return reinterpret_cast<void*>(id << 4);
+	}
+
+	struct Counter
+	{
+		mutable int Calls = 0;
+		mutable uint32_t LastArgument = 0;
+
+		void Bind() const { Calls++; }
+		void BindSlot(uint32_t slot) const { Calls++; LastArgument = slot; }
+	};
+
+	// Playback of callbacks, the part of D3D11Backend that needs no device
+	void RunCallbacks(const CommandList& list)
+	{
+		for (const Command& command : list.GetCommands())
+			if (command.CommandType == Command::Type::Callback)
+				command.Function(command.Object, command.Values[0]);
+	}
+
+	void RecordDraw(CommandList& list, uint32_t i)
+	{
+		list.SetVertexBuffer(Object(100 + i % 64), 32, 4);
+		list.SetIndexBuffer(Object(200 + i % 64), 42);
+		list.SetInputLayout(Object(1));
+		list.SetVertexShader(Object(2));
+		list.SetPixelShader(Object(3));
+		list.VSSetConstantBuffer(0, Object(4));
+		list.PSSetConstantBuffer(0, Object(300 + i % 8));
+		list.PSSetShaderResource(0, Object(400 + i % 8));
+		list.PSSetSampler(0, Object(5));
+		list.DrawIndexed(36, i);
+	}
+}
+
+TEST(CommandListRecordsArguments)
+{
+	CommandList list;
+	list.SetVertexBuffer(Object(1), 24, 4);
+	list.SetIndexBuffer(Object(2), 57);
+	list.PSSetShaderResource(3, Object(4));
+	list.DrawIndexed(36, 12);
+	list.DrawIndexedInstanced(6, 100);
+
+	const auto& commands = list.GetCommands();
+	CHECK_EQUAL(list.Size(), 5u);
+	CHECK(commands[0].CommandType == Command::Type::SetVertexBuffer);
+	CHECK(commands[0].Resource == Object(1));
+	CHECK_EQUAL(commands[0].Values[0], 24u);
+	CHECK_EQUAL(commands[0].Values[1], 4u);
+	CHECK(commands[1].CommandType == Command::Type::SetIndexBuffer);
+	CHECK_EQUAL(commands[1].Values[0], 57u);
+	CHECK(commands[2].Resource == Object(4));
+	CHECK_EQUAL(commands[2].Values[0], 3u);
+	CHECK_EQUAL(commands[3].Values[0], 36u);
+	CHECK_EQUAL(commands[3].Values[1], 12u);
+	CHECK(commands[4].CommandType == Command::Type::DrawIndexedInstanced);
+	CHECK_EQUAL(commands[4].Values[1], 100u);
+	// Unused fields are cleared
+	CHECK(commands[3].Resource == nullptr);
+	CHECK(commands[3].Function == nullptr);
+}
+
+TEST(CommandListDefersCallsToPlayback)
+{
+	Counter counter;
+	CommandList list;
+	list.Call<&Counter::Bind>(counter);
+	list.Call<&Counter::BindSlot>(counter, 7);
+	CHECK_EQUAL(counter.Calls, 0);
+
+	RunCallbacks(list);
+	CHECK_EQUAL(counter.Calls, 2);
+	CHECK_EQUAL(counter.LastArgument, 7u);
+
+	// Lists are re-recorded every frame without reallocating
+	const Command* storage = list.GetCommands().data();
+	list.Reset();
+	CHECK_EQUAL(list.Size(), 0u);
+	list.Call<&Counter::Bind>(counter);
+	CHECK(list.GetCommands().data() == storage);
+}
+
+TEST(CommandListNullBackendCounts)
+{
+	CommandList list;
+	for (uint32_t i = 0; i < 100; i++)
+		RecordDraw(list, i);
+	list.DrawIndexedInstanced(6, 50);
+	Counter counter;
+	list.Call<&Counter::Bind>(counter);
+
+	NullBackend backend;
+	backend.BeginFrame();
+	backend.Submit(list);
+	backend.Submit(list);
+
+	CHECK_EQUAL(backend.GetCommandCount(), 2 * list.Size());
+	CHECK_EQUAL(backend.GetDrawCount(), 2u * 101);
+	CHECK_EQUAL(backend.GetIndexCount(), 2u * (100 * 36 + 6 * 50));
+	CHECK_EQUAL(backend.GetSkippedCallbackCount(), 2u);
+	CHECK_EQUAL(counter.Calls, 0);
+}
+
+BENCHMARK(CommandListRecordAndReplay)
+{
+	// 100k draws of ten commands each, recorded into a list that keeps its capacity across frames
+	constexpr uint32_t draws = 100000;
+	CommandList list;
+	for (uint32_t i = 0; i < draws; i++)
+		RecordDraw(list, i);
+
+	Test::Report("record 100k draws", Test::Measure([&]()
+	{
+		list.Reset();
+		for (uint32_t i = 0; i < draws; i++)
+			RecordDraw(list, i);
+	}));
+
+	NullBackend backend;
+	Test::Report("NullBackend replay", Test::Measure([&]()
+	{
+		backend.BeginFrame();
+		backend.Submit(list);
+	}));
+
+	CHECK_EQUAL(list.Size(), draws * 10u);
+	const StateTracker& tracker = backend.GetStateTracker();
+	std::printf("    %zu of %zu binding calls filtered\n", tracker.GetFiltered(), tracker.GetIssued() + tracker.GetFiltered());
+}
+
+BENCHMARK(CommandListParallelRecording)
+{
+	// One list per pass as RenderGraph::Execute records them, 16 passes of 10k draws each
+	constexpr size_t passes = 16;
+	constexpr uint32_t draws = 10000;
+	std::vector<CommandList> lists(passes);
+	const auto record = [&lists](size_t pass)
+	{
+		lists[pass].Reset();
+		for (uint32_t i = 0; i < draws; i++)
+			RecordDraw(lists[pass], uint32_t(pass) * draws + i);
+	};
+
+	Test::Report("record 16 lists serially", Test::Measure([&]()
+	{
+		for (size_t pass = 0; pass < passes; pass++)
+			record(pass);
+	}));
+	Test::Report("record 16 lists with ParallelFor", Test::Measure([&]()
+	{
+		ThreadPool::ParallelFor(passes, 1, [&record](size_t, size_t begin, size_t end)
+								{
+									for (size_t pass = begin; pass < end; pass++)
+										record(pass);
+								});
+	}));
+
+	// Playback stays serial and in pass order
+	NullBackend backend;
+	backend.BeginFrame();
+	for (const CommandList& list : lists)
+		backend.Submit(list);
+	std::printf("    %zu threads\n", ThreadPool::GetConcurrency());
+	CHECK_EQUAL(backend.GetDrawCount(), passes * draws);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Rendering/Culling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace CullingHelpers
+{
+	// Row-vector (v * M) left handed perspective projection, camera at position looking down +z
+	inline DirectX::XMMATRIX MakeViewProjection(float fovY, float aspect, float nearZ, float farZ,
+												const DirectX::XMFLOAT3& position = { 0.0f, 0.0f, 0.0f })
+	{
+		const float yScale = 1.0f / std::tan(fovY * 0.5f);
+		const float range = farZ / (farZ - nearZ);
+		const DirectX::XMFLOAT4X4 matrix(
+			yScale / aspect, 0.0f, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f, 0.0f,
+			0.0f, 0.0f, range, 1.0f,
+			-position.x * yScale / aspect, -position.y * yScale, -position.z * range - nearZ * range, -position.z);
+		return DirectX::XMLoadFloat4x4(&matrix);
+	}
+
+	// Boxes scattered around the camera at the origin, most of them out of view
+	inline std::vector<Culling::Box> RandomBoxes(size_t count, uint32_t seed, float spread = 200.0f)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> position(-spread, spread);
+		std::uniform_real_distribution<float> size(0.1f, 5.0f);
+
+		std::vector<Culling::Box> boxes(count);
+		for (auto& box : boxes)
+		{
+			box.Center = { position(generator), position(generator), position(generator) };
+			box.Extents = { size(generator), size(generator), size(generator) };
+		}
+		return boxes;
+	}
+
+	// Smallest distance of the box's support point to a plane, where two evaluation orders may disagree
+	inline float GetPlaneMargin(const Culling::Box& box, const Culling::Frustum& frustum)
+	{
+		float margin = 1e30f;
+		for (const float* plane : frustum.Planes)
+		{
+			const float distance = plane[0] * box.Center.x + plane[1] * box.Center.y + plane[2] * box.Center.z + plane[3];
+			const float radius = std::fabs(plane[0]) * box.Extents.x + std::fabs(plane[1]) * box.Extents.y +
+				std::fabs(plane[2]) * box.Extents.z;
+			margin = std::min(margin, std::fabs(distance + radius));
+		}
+		return margin;
+	}
+
+	inline Culling::BoxList ToBoxList(const std::vector<Culling::Box>& boxes)
+	{
+		Culling::BoxList list;
+		list.Resize(boxes.size());
+		for (size_t i = 0; i < boxes.size(); i++)
+			list.Set(i, boxes[i]);
+		return list;
+	}
+}
\ No newline at end of file
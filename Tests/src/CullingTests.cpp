@@ -0,0 +1,91 @@
+#include "Test.h"
+#include "CullingHelpers.h"
+
+using namespace Culling;
+using CullingHelpers::GetPlaneMargin;
+using CullingHelpers::MakeViewProjection;
+using CullingHelpers::RandomBoxes;
+using CullingHelpers::ToBoxList;
+
+TEST(CullingFrustumPlanes)
+{
+	const Frustum frustum = ExtractFrustum(MakeViewProjection(1.5708f, 1.0f, 0.5f, 100.0f));
+
+	CHECK(IsVisible({ { 0, 0, 10 }, { 1, 1, 1 } }, frustum));
+	// Behind the camera, past the far plane, beside the 90 degree cone
+	CHECK(!IsVisible({ { 0, 0, -10 }, { 1, 1, 1 } }, frustum));
+	CHECK(!IsVisible({ { 0, 0, 150 }, { 1, 1, 1 } }, frustum));
+	CHECK(!IsVisible({ { 30, 0, 10 }, { 1, 1, 1 } }, frustum));
+	// Straddling a plane, or containing the whole frustum
+	CHECK(IsVisible({ { 11, 0, 10 }, { 2, 1, 1 } }, frustum));
+	CHECK(IsVisible({ { 0, 0, 0 }, { 1000, 1000, 1000 } }, frustum));
+
+	// The camera position moves the frustum with it
+	const Frustum moved = ExtractFrustum(MakeViewProjection(1.5708f, 1.0f, 0.5f, 100.0f, { 0, 0, -20 }));
+	CHECK(IsVisible({ { 0, 0, -10 }, { 1, 1, 1 } }, moved));
+}
+
+TEST(CullingTransformAndSphere)
+{
+	// Quarter turn about y and a translation
+	const DirectX::XMFLOAT4X4 matrix(0, 0, -1, 0, 0, 1, 0, 0, 1, 0, 0, 0, 5, 6, 7, 1);
+	const Box world = TransformBox({ { 1, 0, 0 }, { 1, 2, 3 } }, DirectX::XMLoadFloat4x4(&matrix));
+	CHECK_NEAR(world.Center.x, 5.0f, 1e-5f);
+	CHECK_NEAR(world.Center.y, 6.0f, 1e-5f);
+	CHECK_NEAR(world.Center.z, 6.0f, 1e-5f);
+	CHECK_NEAR(world.Extents.x, 3.0f, 1e-5f);
+	CHECK_NEAR(world.Extents.y, 2.0f, 1e-5f);
+	CHECK_NEAR(world.Extents.z, 1.0f, 1e-5f);
+
+	const Box box{ { 0, 0, 0 }, { 1, 1, 1 } };
+	CHECK(IntersectsSphere(box, { 2, 0, 0 }, 1.0f));
+	CHECK(!IntersectsSphere(box, { 2, 2, 0 }, 1.0f));
+	CHECK(IntersectsSphere(box, { 2, 2, 0 }, 1.5f));
+}
+
+TEST(CullingBatchMatchesScalar)
+{
+	const Frustum frustum = ExtractFrustum(MakeViewProjection(1.0f, 16.0f / 9.0f, 0.5f, 150.0f, { 3, -2, -40 }));
+	// Not a multiple of four, so the scalar tail runs too
+	const auto boxes = RandomBoxes(100003, 12);
+	const BoxList list = ToBoxList(boxes);
+
+	std::vector<uint8_t> visible(boxes.size(), 2);
+	const size_t visibleCount = CullBoxes(list, frustum, visible.data());
+
+	size_t counted = 0, boundary = 0;
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		counted += visible[i];
+		if (visible[i] != uint8_t(IsVisible(boxes[i], frustum)))
+		{
+			// Only boxes touching a plane within rounding may differ
+			CHECK(GetPlaneMargin(boxes[i], frustum) < 1e-3f);
+			boundary++;
+		}
+	}
+
+	CHECK_EQUAL(counted, visibleCount);
+	CHECK(visibleCount > 100 && visibleCount < boxes.size() / 2);
+	CHECK(boundary <= 2);
+}
+
+BENCHMARK(CullingThroughput)
+{
+	const Frustum frustum = ExtractFrustum(MakeViewProjection(1.0f, 16.0f / 9.0f, 0.5f, 150.0f, { 3, -2, -40 }));
+	const auto boxes = RandomBoxes(100000, 13);
+	const BoxList list = ToBoxList(boxes);
+	std::vector<uint8_t> visible(boxes.size()), scalar(boxes.size());
+
+	Test::Report("IsVisible per box", Test::Measure([&]()
+	{
+		for (size_t i = 0; i < boxes.size(); i++)
+			scalar[i] = IsVisible(boxes[i], frustum);
+	}));
+	Test::Report("CullBoxes", Test::Measure([&]() { CullBoxes(list, frustum, visible.data()); }));
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < boxes.size(); i++)
+		mismatches += visible[i] != scalar[i];
+	CHECK(mismatches <= 2);
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "Test.h"
+#include "Rendering/DrawPacket.h"
+
+#include <cstring>
+
+namespace
+{
+	template<typename T>
+	T* Object(uintptr_t id)
+	{
+		return reinterpret_cast<T*>(id << 4);
+	}
+
+	// Stands in for the per object matrix uniform and the material of a step
+	struct Uniform
+	{
+		ResourceHandle Handle = InvalidResourceHandle;
+
+		void Bind() const {}
+		ResourceHandle GetHandle() const { return Handle; }
+	};
+
+	struct Matrix
+	{
+		float Values[16];
+	};
+
+	// An instanceable draw of one mesh: world matrix first and streamed per instance, then the material
+	DrawPacket MakePacket(const Uniform& world, const Matrix& matrix, const Uniform& material, uintptr_t mesh = 1)
+	{
+		DrawPacket packet;
+		packet.SetVertexBuffer(Object<ID3D11Buffer>(100 + mesh), 32, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		packet.SetIndexBuffer(Object<ID3D11Buffer>(200 + mesh), DXGI_FORMAT_R32_UINT, 36);
+		packet.SetInputLayout(Object<ID3D11InputLayout>(1));
+		packet.SetVertexShader(Object<ID3D11VertexShader>(2));
+		packet.SetPixelShader(Object<ID3D11PixelShader>(3));
+		packet.PSShaderResources.Set(0, Object<ID3D11ShaderResourceView>(4));
+		packet.AddDynamic(world);
+		packet.AddDynamic(material);
+
+		packet.InstancedVertexShader = Object<ID3D11VertexShader>(5);
+		packet.InstancedInputLayout = Object<ID3D11InputLayout>(6);
+		packet.InstanceMatrices[0] = &matrix;
+		packet.InstanceMatrixCount = 1;
+		packet.PerInstanceMask = 1;
+		return packet;
+	}
+
+	Matrix MakeMatrix(float translation)
+	{
+		Matrix matrix{};
+		matrix.Values[0] = matrix.Values[5] = matrix.Values[10] = matrix.Values[15] = 1.0f;
+		matrix.Values[12] = translation;
+		return matrix;
+	}
+}
+
+TEST(DrawPacketInstancesOnlyAcrossWorldMatrices)
+{
+	const Uniform worldA, worldB, material{ 7 }, sameMaterial{ 7 }, otherMaterial{ 8 };
+	const Matrix a = MakeMatrix(1.0f), b = MakeMatrix(2.0f);
+	const DrawPacket packet = MakePacket(worldA, a, material);
+
+	// Equal material data bound through another object still merges
+	CHECK(packet.CanInstanceWith(MakePacket(worldB, b, material)));
+	CHECK(packet.CanInstanceWith(MakePacket(worldB, b, sameMaterial)));
+
+	CHECK(!packet.CanInstanceWith(MakePacket(worldB, b, otherMaterial)));
+	CHECK(!packet.CanInstanceWith(MakePacket(worldB, b, material, 2)));
+
+	DrawPacket texture = MakePacket(worldB, b, material);
+	texture.PSShaderResources.Set(0, Object<ID3D11ShaderResourceView>(9));
+	CHECK(!packet.CanInstanceWith(texture));
+
+	// Meshes drawing their visible ranges only are drawn one by one
+	const std::vector<Meshlets::DrawRange> ranges(1);
+	DrawPacket ranged = MakePacket(worldB, b, material);
+	ranged.Ranges = &ranges;
+	CHECK(!packet.CanInstanceWith(ranged));
+	CHECK(!ranged.CanInstanceWith(packet));
+
+	DrawPacket plain = MakePacket(worldB, b, material);
+	plain.InstancedVertexShader = nullptr;
+	CHECK(!packet.CanInstanceWith(plain));
+}
+
+TEST(DrawPacketRunsMergeEqualNeighbours)
+{
+	const Uniform material{ 7 }, otherMaterial{ 8 };
+	std::vector<Uniform> worlds(8);
+	std::vector<Matrix> matrices;
+	for (int i = 0; i < 8; i++)
+		matrices.push_back(MakeMatrix(float(i)));
+
+	// Three of one mesh, one of another material, two of another mesh, two in other views
+	const std::vector<DrawPacket> packets =
+	{
+		MakePacket(worlds[0], matrices[0], material), MakePacket(worlds[1], matrices[1], material),
+		MakePacket(worlds[2], matrices[2], material), MakePacket(worlds[3], matrices[3], otherMaterial),
+		MakePacket(worlds[4], matrices[4], material, 2), MakePacket(worlds[5], matrices[5], material, 2),
+		MakePacket(worlds[6], matrices[6], material, 2), MakePacket(worlds[7], matrices[7], material, 2)
+	};
+	const std::vector<uint32_t> views = { 1, 1, 1, 1, 1, 1, 2, 0 };
+
+	std::vector<DrawRun> runs;
+	std::vector<char> instanceData;
+	BuildDrawRuns(packets, views, DrawPacket::MaxInstancesPerDraw, runs, instanceData);
+
+	// The packet without views is dropped, the one in another view is drawn alone
+	CHECK_EQUAL(runs.size(), 4u);
+	CHECK(runs[0].First == 0 && runs[0].Count == 3 && runs[0].FirstInstance == 0 && runs[0].Views == 1);
+	CHECK(runs[1].First == 3 && runs[1].Count == 1);
+	CHECK(runs[2].First == 4 && runs[2].Count == 2 && runs[2].FirstInstance == 3);
+	CHECK(runs[3].First == 6 && runs[3].Count == 1 && runs[3].Views == 2);
+
+	CHECK_EQUAL(instanceData.size(), 5 * DrawPacket::InstanceStride);
+	CHECK(std::memcmp(instanceData.data() + 2 * DrawPacket::InstanceStride, &matrices[2], sizeof(Matrix)) == 0);
+	CHECK(std::memcmp(instanceData.data() + 4 * DrawPacket::InstanceStride, &matrices[5], sizeof(Matrix)) == 0);
+}
+
+TEST(DrawPacketRunsRespectInstanceCapacity)
+{
+	const Uniform material{ 7 };
+	constexpr uint32_t count = 10, capacity = 4;
+	std::vector<Uniform> worlds(count);
+	std::vector<Matrix> matrices;
+	std::vector<DrawPacket> packets;
+	for (uint32_t i = 0; i < count; i++)
+		matrices.push_back(MakeMatrix(float(i)));
+	for (uint32_t i = 0; i < count; i++)
+		packets.push_back(MakePacket(worlds[i], matrices[i], material));
+
+	std::vector<DrawRun> runs;
+	std::vector<char> instanceData;
+	BuildDrawRuns(packets, std::vector<uint32_t>(count, 1), capacity, runs, instanceData);
+
+	CHECK_EQUAL(runs.size(), 3u);
+	uint32_t next = 0;
+	for (const DrawRun& run : runs)
+	{
+		CHECK(run.Count <= capacity);
+		CHECK_EQUAL(run.First, next);
+		CHECK_EQUAL(run.FirstInstance, next);
+		next += run.Count;
+	}
+	CHECK_EQUAL(next, count);
+	CHECK_EQUAL(instanceData.size(), count * DrawPacket::InstanceStride);
+
+	// A single draw past the capacity is not instanced at all
+	BuildDrawRuns(packets, std::vector<uint32_t>(count, 1), 1, runs, instanceData);
+	CHECK_EQUAL(runs.size(), size_t(count));
+	CHECK(instanceData.empty());
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "Test.h"
+#include "Rendering/RenderGraph/GraphCompiler.h"
+
+#include <stdexcept>
+
+namespace
+{
+	using Schedule = std::vector<uint32_t>;
+}
+
+TEST(GraphCompilerOrderIsStable)
+{
+	// Already in dependency order, the schedule is the insertion order
+	GraphCompiler ordered;
+	const uint32_t shadow = ordered.AddPass("Shadow");
+	const uint32_t depth = ordered.AddPass("Depth");
+	const uint32_t lighting = ordered.AddPass("Lighting");
+	ordered.AddResource(shadow, "map");
+	ordered.AddResource(depth, "depth");
+	ordered.AddResource(lighting, "color");
+	ordered.AddRead(lighting, "Shadow", "map");
+	ordered.AddRead(lighting, "Depth", "depth");
+	ordered.AddSink("Lighting", "color");
+	CHECK(ordered.Compile().Schedule == (Schedule{ shadow, depth, lighting }));
+
+	// Consumers added first move behind their producers, independent producers keep their relative order
+	GraphCompiler reversed;
+	const uint32_t final = reversed.AddPass("Final");
+	const uint32_t shadowA = reversed.AddPass("ShadowA");
+	const uint32_t shadowB = reversed.AddPass("ShadowB");
+	const uint32_t gbuffer = reversed.AddPass("GBuffer");
+	reversed.AddResource(final, "color");
+	reversed.AddResource(shadowA, "map");
+	reversed.AddResource(shadowB, "map");
+	reversed.AddResource(gbuffer, "albedo");
+	reversed.AddRead(final, "GBuffer", "albedo");
+	reversed.AddRead(final, "ShadowB", "map");
+	reversed.AddRead(final, "ShadowA", "map");
+	reversed.AddSink("Final", "color");
+
+	const auto plan = reversed.Compile();
+	CHECK(plan.Schedule == (Schedule{ shadowA, shadowB, gbuffer, final }));
+	CHECK(plan.Culled.empty());
+	// Reads stay in registration order
+	CHECK(plan.Reads[final] == (Schedule{ reversed.FindResource("GBuffer", "albedo"), reversed.FindResource("ShadowB", "map"),
+										   reversed.FindResource("ShadowA", "map") }));
+}
+
+TEST(GraphCompilerCullsPassesNotReachingSinks)
+{
+	GraphCompiler compiler;
+	const uint32_t debug = compiler.AddPass("Debug");
+	const uint32_t scene = compiler.AddPass("Scene");
+	const uint32_t blurX = compiler.AddPass("BlurX");
+	const uint32_t blurY = compiler.AddPass("BlurY");
+	const uint32_t present = compiler.AddPass("Present");
+
+	const uint32_t backBuffer = compiler.AddResource(GraphCompiler::External, "backbuffer");
+	compiler.AddResource(debug, "overlay");
+	compiler.AddResource(scene, "color");
+	compiler.AddResource(blurX, "color");
+	compiler.AddResource(blurY, "color");
+
+	// The blur chain reads the scene but nothing reads its result
+	compiler.AddRead(blurX, "Scene", "color");
+	compiler.AddRead(blurY, "BlurX", "color");
+	compiler.AddRead(present, "Scene", "color");
+	compiler.AddRead(present, "$", "backbuffer");
+	compiler.AddResource(present, "backbuffer", backBuffer);
+	compiler.AddSink("Present", "backbuffer");
+
+	const auto plan = compiler.Compile();
+	CHECK(plan.Schedule == (Schedule{ scene, present }));
+	CHECK(plan.Culled == (Schedule{ debug, blurX, blurY }));
+
+	// Outputs of culled passes are never live
+	CHECK_EQUAL(plan.Lifetimes[compiler.FindResource("BlurY", "color")].First, GraphCompiler::External);
+
+	// Without sinks every pass is culled
+	GraphCompiler empty;
+	empty.AddResource(empty.AddPass("Orphan"), "color");
+	const auto emptyPlan = empty.Compile();
+	CHECK(emptyPlan.Schedule.empty());
+	CHECK_EQUAL(emptyPlan.Culled.size(), 1u);
+}
+
+TEST(GraphCompilerRejectsInvalidGraphs)
+{
+	GraphCompiler cycle;
+	const uint32_t a = cycle.AddPass("A");
+	const uint32_t b = cycle.AddPass("B");
+	cycle.AddResource(a, "out");
+	cycle.AddResource(b, "out");
+	cycle.AddRead(a, "B", "out");
+	cycle.AddRead(b, "A", "out");
+	cycle.AddSink("B", "out");
+	CHECK_THROWS(cycle.Compile());
+
+	GraphCompiler selfRead;
+	const uint32_t pass = selfRead.AddPass("Pass");
+	selfRead.AddResource(pass, "out");
+	selfRead.AddRead(pass, "Pass", "out");
+	selfRead.AddSink("Pass", "out");
+	CHECK_THROWS(selfRead.Compile());
+
+	// Cycles among culled passes are rejected as well
+	GraphCompiler deadCycle;
+	const uint32_t live = deadCycle.AddPass("Live");
+	const uint32_t c = deadCycle.AddPass("C");
+	const uint32_t d = deadCycle.AddPass("D");
+	deadCycle.AddResource(live, "out");
+	deadCycle.AddResource(c, "out");
+	deadCycle.AddResource(d, "out");
+	deadCycle.AddRead(c, "D", "out");
+	deadCycle.AddRead(d, "C", "out");
+	deadCycle.AddSink("Live", "out");
+	CHECK(deadCycle.Compile().Culled == (Schedule{ c, d }));
+
+	// Dangling and duplicate names fail while the description is built
+	GraphCompiler names;
+	const uint32_t only = names.AddPass("Only");
+	names.AddResource(only, "out");
+	CHECK_THROWS(names.AddPass("Only"));
+	CHECK_THROWS(names.AddResource(only, "out"));
+	CHECK_THROWS(names.AddResource(7, "other"));
+	CHECK_THROWS(names.AddRead(only, "Missing", "out"));
+	CHECK_THROWS(names.AddSink("Only", "missing"));
+	CHECK_THROWS(names.FindPass("Missing"));
+}
+
+TEST(GraphCompilerExtendsForwardedLifetimes)
+{
+	// GBuffer -> Lighting (modifies hdr in place) -> Bloom -> Tonemap, Shadow only feeds Lighting
+	GraphCompiler compiler;
+	const uint32_t shadow = compiler.AddPass("Shadow");
+	const uint32_t gbuffer = compiler.AddPass("GBuffer");
+	const uint32_t lighting = compiler.AddPass("Lighting");
+	const uint32_t bloom = compiler.AddPass("Bloom");
+	const uint32_t tonemap = compiler.AddPass("Tonemap");
+
+	const uint32_t shadowMap = compiler.AddResource(shadow, "map");
+	const uint32_t hdr = compiler.AddResource(gbuffer, "hdr");
+	compiler.AddRead(lighting, "GBuffer", "hdr");
+	compiler.AddRead(lighting, "Shadow", "map");
+	const uint32_t lit = compiler.AddResource(lighting, "hdr", hdr);
+	compiler.AddRead(bloom, "Lighting", "hdr");
+	const uint32_t bloomed = compiler.AddResource(bloom, "hdr", lit);
+	compiler.AddRead(tonemap, "Bloom", "hdr");
+	const uint32_t ldr = compiler.AddResource(tonemap, "ldr");
+	compiler.AddSink("Tonemap", "ldr");
+
+	const auto plan = compiler.Compile();
+	CHECK(plan.Schedule == (Schedule{ shadow, gbuffer, lighting, bloom, tonemap }));
+
+	CHECK_EQUAL(plan.Roots[hdr], hdr);
+	CHECK_EQUAL(plan.Roots[lit], hdr);
+	CHECK_EQUAL(plan.Roots[bloomed], hdr);
+	CHECK_EQUAL(plan.Roots[ldr], ldr);
+
+	// The root lives from the first write to the last read of any resource forwarding it
+	CHECK_EQUAL(plan.Lifetimes[hdr].First, 1u);
+	CHECK_EQUAL(plan.Lifetimes[hdr].Last, 4u);
+	CHECK_EQUAL(plan.Lifetimes[shadowMap].First, 0u);
+	CHECK_EQUAL(plan.Lifetimes[shadowMap].Last, 2u);
+	// Sinks live to the end of the frame
+	CHECK_EQUAL(plan.Lifetimes[ldr].First, 4u);
+	CHECK_EQUAL(plan.Lifetimes[ldr].Last, 4u);
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "Test.h"
+#include "Rendering/HandleMap.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+TEST(HandleMapInsertAndFind)
+{
+	HandleMap<int> map;
+	CHECK(map.Find(42) == nullptr);
+
+	auto [value, inserted] = map.Insert(42, 1);
+	CHECK(inserted);
+	CHECK_EQUAL(value, 1);
+
+	// A second insert keeps the first value
+	auto [existing, insertedAgain] = map.Insert(42, 2);
+	CHECK(!insertedAgain);
+	CHECK_EQUAL(existing, 1);
+	CHECK_EQUAL(map.Size(), 1u);
+
+	CHECK(map.Find(42) && *map.Find(42) == 1);
+	CHECK(map.Find(43) == nullptr);
+}
+
+TEST(HandleMapSurvivesGrowthAndCollisions)
+{
+	HandleMap<uint64_t> map;
+	std::vector<ResourceHandle> handles;
+	std::mt19937_64 generator(6);
+	for (int i = 0; i < 5000; i++)
+		handles.push_back(generator() | 1);
+	// Same low bits, so they all probe from one slot
+	for (uint64_t i = 1; i <= 200; i++)
+		handles.push_back((i << 40) | 7);
+
+	for (ResourceHandle handle : handles)
+		CHECK(map.Insert(handle, handle * 3).second);
+	CHECK_EQUAL(map.Size(), handles.size());
+
+	for (ResourceHandle handle : handles)
+	{
+		const uint64_t* value = map.Find(handle);
+		CHECK(value && *value == handle * 3);
+	}
+	CHECK(map.Find(8) == nullptr);
+}
+
+TEST(HandleMapInternedIDs)
+{
+	const ResourceHandle a = InternResourceID("class VertexBuffer#Sponza/Mesh0");
+	CHECK_EQUAL(a, InternResourceID(std::string("class VertexBuffer#") + "Sponza/Mesh0"));
+	CHECK(a != InternResourceID("class IndexBuffer#Sponza/Mesh0"));
+	CHECK(InternResourceID("") != InvalidResourceHandle);
+
+	// Raw bytes hash like the string of the same bytes
+	const float data[] = { 1.0f, 0.5f, 0.25f, 12.0f };
+	float other[] = { 1.0f, 0.5f, 0.25f, 12.0f };
+	CHECK_EQUAL(HashResourceData(data, sizeof(data)), HashResourceData(other, sizeof(other)));
+	other[3] = 16.0f;
+	CHECK(HashResourceData(data, sizeof(data)) != HashResourceData(other, sizeof(other)));
+	CHECK_EQUAL(HashResourceData("Sponza", 6), InternResourceID("Sponza"));
+	CHECK(HashResourceData(nullptr, 0) != InvalidResourceHandle);
+}
+
+BENCHMARK(HandleMapAddResources)
+{
+	// The pools used to key shared objects by typeid name and tag and look them up by string again
+	constexpr size_t count = 100000;
+	std::vector<std::string> tags;
+	for (size_t i = 0; i < count; i++)
+		tags.push_back("Content/Models/Sponza/sponza.obj#Mesh" + std::to_string(i));
+	const std::string typeName = "class VertexBuffer";
+
+	size_t found = 0;
+	Test::Report("unordered_map<std::string>", Test::Measure([&]()
+	{
+		std::unordered_map<std::string, std::shared_ptr<int>> pool;
+		for (const auto& tag : tags)
+		{
+			const std::string id = typeName + "#" + tag;
+			if (pool.find(id) == pool.end())
+				pool.emplace(id, std::make_shared<int>(0));
+			found += pool.find(typeName + "#" + tag) != pool.end();
+		}
+	}, 3));
+
+	std::vector<ResourceHandle> handles(count);
+	Test::Report("InternResourceID", Test::Measure([&]()
+	{
+		for (size_t i = 0; i < count; i++)
+			handles[i] = InternResourceID(typeName + "#" + tags[i]);
+	}, 3));
+
+	// Handles are computed once per resource, only the map work remains per Add
+	Test::Report("HandleMap", Test::Measure([&]()
+	{
+		HandleMap<std::shared_ptr<int>> pool;
+		for (ResourceHandle handle : handles)
+		{
+			auto [object, inserted] = pool.Insert(handle, nullptr);
+			if (inserted)
+				object = std::make_shared<int>(0);
+			found += pool.Find(handle) != nullptr;
+		}
+	}, 3));
+
+	CHECK_EQUAL(found, 6 * count);
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "Test.h"
+#include "Core/ThreadPool.h"
+#include "Rendering/Lights/LightClusters.h"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	LightClusters::Parameters MakeParameters()
+	{
+		LightClusters::Parameters parameters;
+		const float yScale = 1.0f / std::tan(0.5f * 1.0f);
+		parameters.ScaleX = yScale * 9.0f / 16.0f;
+		parameters.ScaleY = yScale;
+		return parameters;
+	}
+
+	// View space lights around the frustum, some behind the camera or past the far plane
+	LightClusters::LightList RandomLights(size_t count, uint32_t seed)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> x(-150.0f, 150.0f), y(-80.0f, 80.0f), z(-10.0f, 220.0f), radius(0.5f, 10.0f);
+		LightClusters::LightList lights;
+		lights.Resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const float depth = z(generator);
+			// Keep most of them near the view cone
+			const float spread = std::max(depth, 1.0f) / 150.0f;
+			lights.Set(i, x(generator) * spread, y(generator) * spread, depth, radius(generator));
+		}
+		return lights;
+	}
+
+	struct Cluster
+	{
+		uint32_t TileX, TileY, Slice;
+	};
+
+	double GetSliceDepth(const LightClusters::Parameters& parameters, double slice)
+	{
+		return parameters.NearZ * std::pow(double(parameters.FarZ) / parameters.NearZ, slice / parameters.Slices);
+	}
+
+	// View space point of the cluster at fractions of its tile and depth range
+	void GetClusterPoint(const LightClusters::Parameters& parameters, const Cluster& cluster, double u, double v, double w,
+						 double point[3])
+	{
+		const double ndcX = 2.0 * (cluster.TileX + u) / parameters.TilesX - 1.0;
+		const double ndcY = 2.0 * (cluster.TileY + v) / parameters.TilesY - 1.0;
+		point[2] = GetSliceDepth(parameters, cluster.Slice + w);
+		point[0] = ndcX * point[2] / parameters.ScaleX;
+		point[1] = ndcY * point[2] / parameters.ScaleY;
+	}
+
+	double GetDistanceSquared(const double point[3], const LightClusters::LightList& lights, size_t light)
+	{
+		const double dx = point[0] - lights.X[light], dy = point[1] - lights.Y[light], dz = point[2] - lights.Z[light];
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	struct Bounds
+	{
+		double Min[3] = { 1e30, 1e30, 1e30 };
+		double Max[3] = { -1e30, -1e30, -1e30 };
+	};
+
+	// View space box around the cluster's frustum cell
+	Bounds GetBounds(const LightClusters::Parameters& parameters, const Cluster& cluster)
+	{
+		Bounds bounds;
+		for (int corner = 0; corner < 8; corner++)
+		{
+			double point[3];
+			GetClusterPoint(parameters, cluster, corner & 1, (corner >> 1) & 1, (corner >> 2) & 1, point);
+			for (int axis = 0; axis < 3; axis++)
+			{
+				bounds.Min[axis] = std::min(bounds.Min[axis], point[axis]);
+				bounds.Max[axis] = std::max(bounds.Max[axis], point[axis]);
+			}
+		}
+		return bounds;
+	}
+
+	// Brute force against the box, an upper bound of any correct assignment
+	bool TouchesBounds(const Bounds& bounds, const LightClusters::LightList& lights, size_t light)
+	{
+		const double center[3] = { lights.X[light], lights.Y[light], lights.Z[light] };
+		double distanceSquared = 0.0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const double offset = std::max({ bounds.Min[axis] - center[axis], center[axis] - bounds.Max[axis], 0.0 });
+			distanceSquared += offset * offset;
+		}
+		const double radius = lights.Radius[light] * 1.0001 + 1e-4;
+		return distanceSquared <= radius * radius;
+	}
+
+	// Brute force over points inside the frustum cell, every light reaching one of them must be assigned
+	bool ReachesCell(const LightClusters::Parameters& parameters, const Cluster& cluster, const LightClusters::LightList& lights,
+					 size_t light)
+	{
+		constexpr int Samples = 5;
+		const double radius = lights.Radius[light] * 0.999;
+		for (int i = 0; i < Samples * Samples * Samples; i++)
+		{
+			double point[3];
+			GetClusterPoint(parameters, cluster, (i % Samples + 0.5) / Samples, (i / Samples % Samples + 0.5) / Samples,
+							(i / (Samples * Samples) + 0.5) / Samples, point);
+			if (GetDistanceSquared(point, lights, light) <= radius * radius)
+				return true;
+		}
+		return false;
+	}
+}
+
+TEST(LightClustersMatchBruteForce)
+{
+	const LightClusters::Parameters parameters = MakeParameters();
+	const LightClusters::LightList lights = RandomLights(400, 71);
+	LightClusters clusters;
+	clusters.Build(parameters, lights);
+
+	const auto& ranges = clusters.GetRanges();
+	const auto& indices = clusters.GetIndices();
+	CHECK_EQUAL(ranges.size(), clusters.GetClusterCount() * 2);
+
+	size_t required = 0, assigned = 0, maximum = 0;
+	uint32_t expectedOffset = 0;
+	for (uint32_t slice = 0; slice < parameters.Slices; slice++)
+		for (uint32_t tileY = 0; tileY < parameters.TilesY; tileY++)
+			for (uint32_t tileX = 0; tileX < parameters.TilesX; tileX++)
+			{
+				const size_t index = (static_cast<size_t>(slice) * parameters.TilesY + tileY) * parameters.TilesX + tileX;
+				const uint32_t offset = ranges[index * 2], count = ranges[index * 2 + 1];
+				// Ranges follow each other in cluster order
+				CHECK_EQUAL(offset, expectedOffset);
+				expectedOffset += count;
+				maximum = std::max<size_t>(maximum, count);
+				assigned += count;
+
+				const uint32_t* begin = indices.data() + offset;
+				const uint32_t* end = begin + count;
+				CHECK(std::adjacent_find(begin, end, std::greater_equal<uint32_t>()) == end);
+
+				const Cluster cluster{ tileX, tileY, slice };
+				const Bounds bounds = GetBounds(parameters, cluster);
+				for (const uint32_t* light = begin; light != end; light++)
+					CHECK(*light < lights.Size() && TouchesBounds(bounds, lights, *light));
+
+				for (size_t light = 0; light < lights.Size(); light++)
+				{
+					if (!TouchesBounds(bounds, lights, light) || !ReachesCell(parameters, cluster, lights, light))
+						continue;
+					required++;
+					CHECK(std::binary_search(begin, end, static_cast<uint32_t>(light)));
+				}
+			}
+
+	CHECK_EQUAL(expectedOffset, indices.size());
+	CHECK_EQUAL(clusters.GetMaxLightsPerCluster(), maximum);
+	CHECK(required > 1000);
+	CHECK(assigned >= required);
+}
+
+TEST(LightClustersSliceFactors)
+{
+	LightClusters clusters;
+	const LightClusters::Parameters parameters = MakeParameters();
+	clusters.Build(parameters, {});
+	CHECK(clusters.GetIndices().empty());
+	CHECK_EQUAL(clusters.GetMaxLightsPerCluster(), 0u);
+
+	// The shader's slice of a depth matches the depths the clusters were built from
+	for (uint32_t slice = 0; slice < parameters.Slices; slice++)
+	{
+		const double depth = GetSliceDepth(parameters, slice + 0.5);
+		const float shaderSlice = std::log(float(depth)) * clusters.GetSliceScale() + clusters.GetSliceBias();
+		CHECK_NEAR(shaderSlice, slice + 0.5f, 1e-3f);
+	}
+
+	// A single light at the center of one cluster lands there, and rebuilding with other parameters moves it
+	LightClusters::LightList lights;
+	lights.Resize(1);
+	double point[3];
+	GetClusterPoint(parameters, { 3, 5, 10 }, 0.5, 0.5, 0.5, point);
+	lights.Set(0, float(point[0]), float(point[1]), float(point[2]), 1e-3f);
+	clusters.Build(parameters, lights);
+	const size_t cluster = (10 * parameters.TilesY + 5) * parameters.TilesX + 3;
+	CHECK_EQUAL(clusters.GetRanges()[cluster * 2 + 1], 1u);
+	// Neighbours whose boxes overlap may list it too, other slices may not
+	const size_t tiles = size_t(parameters.TilesX) * parameters.TilesY;
+	for (size_t other = 0; other < clusters.GetClusterCount(); other++)
+		if (other / tiles != 10)
+			CHECK_EQUAL(clusters.GetRanges()[other * 2 + 1], 0u);
+
+	LightClusters::Parameters coarse = parameters;
+	coarse.Slices = 12;
+	clusters.Build(coarse, lights);
+	CHECK_EQUAL(clusters.GetClusterCount(), size_t(parameters.TilesX) * parameters.TilesY * 12);
+	CHECK_EQUAL(clusters.GetRanges()[((5 * coarse.TilesY + 5) * coarse.TilesX + 3) * 2 + 1], 1u);
+}
+
+BENCHMARK(LightClustersThroughput)
+{
+	const LightClusters::Parameters parameters = MakeParameters();
+	const LightClusters::LightList lights = RandomLights(4096, 72);
+	LightClusters clusters;
+	Test::Report("build 4096 lights", Test::Measure([&]() { clusters.Build(parameters, lights); }));
+	std::printf("    %zu assignments, at most %zu lights per cluster, %zu threads\n", clusters.GetIndices().size(),
+				clusters.GetMaxLightsPerCluster(), ThreadPool::GetConcurrency());
+
+	// Every light against every cluster box, what the extents and slices save
+	std::vector<Bounds> bounds;
+	for (uint32_t slice = 0; slice < parameters.Slices; slice++)
+		for (uint32_t tileY = 0; tileY < parameters.TilesY; tileY++)
+			for (uint32_t tileX = 0; tileX < parameters.TilesX; tileX++)
+				bounds.push_back(GetBounds(parameters, { tileX, tileY, slice }));
+
+	size_t bruteForce = 0;
+	Test::Report("brute force boxes", Test::Measure([&]()
+	{
+		bruteForce = 0;
+		for (const Bounds& cluster : bounds)
+			for (size_t light = 0; light < lights.Size(); light++)
+				bruteForce += TouchesBounds(cluster, lights, light);
+	}, 1));
+	CHECK(clusters.GetIndices().size() <= bruteForce);
+}
\ No newline at end of file
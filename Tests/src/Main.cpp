@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include <cstring>
+#include <exception>
+
+namespace
+{
+	bool CurrentFailed = false;
+}
+
+namespace Test
+{
+	std::vector<Case>& GetCases()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void Fail(const char* file, int line, const char* expression)
+	{
+		std::printf("    %s(%d): CHECK(%s) failed\n", file, line, expression);
+		CurrentFailed = true;
+	}
+}
+
+// Tests [--bench] [filter]: runs every test, and the benchmarks with --bench, whose name contains filter
+int main(int argc, char** argv)
+{
+	bool benchmarks = false;
+	const char* filter = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--bench") == 0)
+			benchmarks = true;
+		else
+			filter = argv[i];
+	}
+
+	size_t run = 0, failed = 0;
+	for (const Test::Case& testCase : Test::GetCases())
+	{
+		if ((testCase.IsBenchmark && !benchmarks) || (filter && !std::strstr(testCase.Name, filter)))
+			continue;
+
+		std::printf("%s\n", testCase.Name);
+		CurrentFailed = false;
+		try
+		{
+			testCase.Function();
+		}
+		catch (const std::exception& e)
+		{
+			std::printf("    unexpected exception: %s\n", e.what());
+			CurrentFailed = true;
+		}
+
+		run++;
+		if (CurrentFailed)
+			failed++;
+	}
+
+	std::printf("%zu of %zu cases passed\n", run - failed, run);
+	return failed ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "Test.h"
+#include "Rendering/MeshOptimizer.h"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace
+{
+	struct TestMesh
+	{
+		std::vector<float> Positions;
+		std::vector<uint32_t> Indices;
+
+		size_t GetVertexCount() const { return Positions.size() / 3; }
+	};
+
+	// UV sphere with its triangles in random order, the worst case for the post-transform cache
+	TestMesh MakeShuffledSphere(uint32_t rings, uint32_t segments, uint32_t seed)
+	{
+		TestMesh mesh;
+		for (uint32_t r = 0; r <= rings; r++)
+			for (uint32_t s = 0; s <= segments; s++)
+			{
+				const float theta = 3.14159265f * r / rings;
+				const float phi = 6.28318531f * s / segments;
+				mesh.Positions.insert(mesh.Positions.end(),
+									  { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+			}
+
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (uint32_t r = 0; r < rings; r++)
+			for (uint32_t s = 0; s < segments; s++)
+			{
+				const uint32_t a = r * (segments + 1) + s, b = a + segments + 1;
+				triangles.push_back({ a, b, a + 1 });
+				triangles.push_back({ a + 1, b, b + 1 });
+			}
+
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+		for (const auto& triangle : triangles)
+			mesh.Indices.insert(mesh.Indices.end(), triangle.begin(), triangle.end());
+		return mesh;
+	}
+
+	// Triangles rotated to start at their smallest index, so equal winding compares equal
+	std::vector<std::array<uint32_t, 3>> GetSortedTriangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			std::array<uint32_t, 3> triangle{ indices[i], indices[i + 1], indices[i + 2] };
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// Content/Model, looked up from the working directory and its parent as the renderer does
+	std::filesystem::path FindModel(const char* filename)
+	{
+		for (auto directory = std::filesystem::current_path(); ; directory = directory.parent_path())
+		{
+			const auto path = directory / "Content" / "Model" / filename;
+			if (std::filesystem::exists(path))
+				return path;
+			if (directory == directory.parent_path())
+				return {};
+		}
+	}
+
+	// Meshes of an OBJ file the way the importer hands them over: one per material, polygons
+	// triangulated as fans and identical position/texture/normal corners joined
+	std::vector<TestMesh> LoadObj(const std::filesystem::path& path)
+	{
+		std::ifstream file(path);
+		std::vector<float> positions;
+		std::vector<TestMesh> meshes(1);
+		std::map<std::array<int, 3>, uint32_t> corners;
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream stream(line);
+			std::string keyword;
+			stream >> keyword;
+			if (keyword == "v")
+			{
+				float x, y, z;
+				stream >> x >> y >> z;
+				positions.insert(positions.end(), { x, y, z });
+			}
+			else if (keyword == "usemtl" || keyword == "o" || keyword == "g")
+			{
+				if (!meshes.back().Indices.empty())
+					meshes.emplace_back();
+				corners.clear();
+			}
+			else if (keyword == "f")
+			{
+				TestMesh& mesh = meshes.back();
+				std::vector<uint32_t> polygon;
+				std::string corner;
+				while (stream >> corner)
+				{
+					std::array<int, 3> key{ 0, 0, 0 };
+					std::sscanf(corner.c_str(), "%d/%d/%d", &key[0], &key[1], &key[2]);
+					if (corner.find("//") != std::string::npos)
+						std::sscanf(corner.c_str(), "%d//%d", &key[0], &key[2]);
+
+					const auto [it, inserted] = corners.emplace(key, static_cast<uint32_t>(mesh.GetVertexCount()));
+					if (inserted)
+					{
+						const size_t position = (key[0] < 0 ? positions.size() / 3 + key[0] : key[0] - 1) * 3;
+						mesh.Positions.insert(mesh.Positions.end(), positions.begin() + position, positions.begin() + position + 3);
+					}
+					polygon.push_back(it->second);
+				}
+				for (size_t i = 2; i < polygon.size(); i++)
+					mesh.Indices.insert(mesh.Indices.end(), { polygon[0], polygon[i - 1], polygon[i] });
+			}
+		}
+
+		if (meshes.back().Indices.empty())
+			meshes.pop_back();
+		return meshes;
+	}
+}
+
+TEST(MeshOptimizerAnalyzeVertexCache)
+{
+	const uint32_t quad[] = { 0, 1, 2, 2, 1, 3 };
+	const auto statistics = MeshOptimizer::AnalyzeVertexCache(quad, 6, 4);
+	CHECK_EQUAL(statistics.Triangles, 2u);
+	CHECK_EQUAL(statistics.Transforms, 4u);
+	CHECK_NEAR(statistics.GetACMR(), 2.0f, 1e-6f);
+	CHECK_NEAR(statistics.GetATVR(), 1.0f, 1e-6f);
+
+	// A cache of 3 evicts vertex 0 before it is used again
+	const uint32_t fan[] = { 0, 1, 2, 0, 2, 3, 0, 3, 4 };
+	CHECK_EQUAL(MeshOptimizer::AnalyzeVertexCache(fan, 9, 5, 16).Transforms, 5u);
+	CHECK_EQUAL(MeshOptimizer::AnalyzeVertexCache(fan, 9, 5, 3).Transforms, 6u);
+}
+
+TEST(MeshOptimizerVertexCacheLowersACMR)
+{
+	const TestMesh mesh = MakeShuffledSphere(64, 128, 1);
+	const size_t vertexCount = mesh.GetVertexCount();
+
+	std::vector<uint32_t> optimized(mesh.Indices.size());
+	MeshOptimizer::OptimizeVertexCache(optimized.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+	CHECK(GetSortedTriangles(optimized) == GetSortedTriangles(mesh.Indices));
+
+	const auto before = MeshOptimizer::AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+	const auto after = MeshOptimizer::AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount);
+	std::printf("    ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.GetACMR(), after.GetACMR(), before.GetATVR(), after.GetATVR());
+
+	// Random order shades almost every corner, a regular grid approaches 0.5 vertices per triangle
+	CHECK(before.GetACMR() > 2.5f);
+	CHECK(after.GetACMR() < 0.8f);
+	CHECK(after.GetATVR() < 1.5f);
+}
+
+TEST(MeshOptimizerOverdrawKeepsCacheEfficiency)
+{
+	const TestMesh mesh = MakeShuffledSphere(48, 96, 2);
+	const size_t vertexCount = mesh.GetVertexCount();
+
+	std::vector<uint32_t> cacheOrder(mesh.Indices.size()), overdrawOrder(mesh.Indices.size());
+	MeshOptimizer::OptimizeVertexCache(cacheOrder.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+	MeshOptimizer::OptimizeOverdraw(overdrawOrder.data(), cacheOrder.data(), cacheOrder.size(),
+									mesh.Positions.data(), 3 * sizeof(float), vertexCount, 1.05f);
+	CHECK(GetSortedTriangles(overdrawOrder) == GetSortedTriangles(mesh.Indices));
+
+	const auto cache = MeshOptimizer::AnalyzeVertexCache(cacheOrder.data(), cacheOrder.size(), vertexCount);
+	const auto overdraw = MeshOptimizer::AnalyzeVertexCache(overdrawOrder.data(), overdrawOrder.size(), vertexCount);
+	CHECK(overdraw.GetACMR() <= cache.GetACMR() * 1.05f + 1e-6f);
+}
+
+TEST(MeshOptimizerVertexFetchOrdersByFirstUse)
+{
+	TestMesh mesh = MakeShuffledSphere(16, 32, 3);
+	const size_t vertexCount = mesh.GetVertexCount();
+	// One vertex nothing references
+	mesh.Positions.insert(mesh.Positions.end(), { 9.0f, 9.0f, 9.0f });
+
+	std::vector<uint32_t> indices = mesh.Indices;
+	const auto remap = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount + 1);
+	CHECK_EQUAL(remap.VertexCount, vertexCount);
+	CHECK_EQUAL(remap.Table[vertexCount], ~0u);
+
+	uint32_t next = 0;
+	for (uint32_t index : indices)
+	{
+		CHECK(index <= next);
+		if (index == next)
+			next++;
+	}
+
+	std::vector<float> positions(remap.VertexCount * 3);
+	MeshOptimizer::RemapVertexBuffer(positions.data(), mesh.Positions.data(), vertexCount + 1, 3 * sizeof(float), remap.Table.data());
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		CHECK_EQUAL(positions[indices[i] * 3], mesh.Positions[mesh.Indices[i] * 3]);
+		CHECK_EQUAL(positions[indices[i] * 3 + 2], mesh.Positions[mesh.Indices[i] * 3 + 2]);
+	}
+}
+
+BENCHMARK(MeshOptimizerThroughput)
+{
+	// About 500k triangles
+	const TestMesh mesh = MakeShuffledSphere(512, 512, 4);
+	const size_t vertexCount = mesh.GetVertexCount();
+	std::vector<uint32_t> cacheOrder(mesh.Indices.size()), overdrawOrder(mesh.Indices.size());
+
+	Test::Report("OptimizeVertexCache", Test::Measure([&]()
+	{
+		MeshOptimizer::OptimizeVertexCache(cacheOrder.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+	}, 3));
+	Test::Report("OptimizeOverdraw", Test::Measure([&]()
+	{
+		MeshOptimizer::OptimizeOverdraw(overdrawOrder.data(), cacheOrder.data(), cacheOrder.size(),
+										mesh.Positions.data(), 3 * sizeof(float), vertexCount);
+	}, 3));
+	Test::Report("OptimizeVertexFetch", Test::Measure([&]()
+	{
+		std::vector<uint32_t> indices = overdrawOrder;
+		MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+	}, 3));
+
+	const auto after = MeshOptimizer::AnalyzeVertexCache(overdrawOrder.data(), overdrawOrder.size(), vertexCount);
+	CHECK(after.GetACMR() < 0.8f);
+}
+
+BENCHMARK(MeshOptimizerContentModels)
+{
+	// The passes Mesh::Optimize runs on import, summed over the meshes of every model
+	for (const char* filename : { "Brickwall/brickwall.obj", "NanoSuit/nanosuit.obj", "Sponza/sponza.obj" })
+	{
+		const auto path = FindModel(filename);
+		if (path.empty())
+		{
+			std::printf("    %s not found, skipped\n", filename);
+			continue;
+		}
+
+		const std::vector<TestMesh> meshes = LoadObj(path);
+		MeshOptimizer::Statistics before, after;
+		const double milliseconds = Test::Measure([&]()
+		{
+			before = after = {};
+			for (const TestMesh& mesh : meshes)
+			{
+				const size_t vertexCount = mesh.GetVertexCount();
+				std::vector<uint32_t> cacheOrder(mesh.Indices.size()), indices(mesh.Indices.size());
+				MeshOptimizer::OptimizeVertexCache(cacheOrder.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+				MeshOptimizer::OptimizeOverdraw(indices.data(), cacheOrder.data(), cacheOrder.size(),
+												mesh.Positions.data(), 3 * sizeof(float), vertexCount);
+				const auto remap = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+
+				before += MeshOptimizer::AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+				after += MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), remap.VertexCount);
+			}
+		}, 3);
+
+		Test::Report(filename, milliseconds);
+		std::printf("    %zu meshes, %zu triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", meshes.size(), before.Triangles,
+					before.GetACMR(), after.GetACMR(), before.GetATVR(), after.GetATVR());
+		CHECK(after.Transforms <= before.Transforms);
+	}
+}
\ No newline at end of file
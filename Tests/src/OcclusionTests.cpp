@@ -0,0 +1,335 @@
+#include "Test.h"
+#include "Rendering/Occlusion.h"
+
+#include <algorithm>
+#include <random>
+
+using Occlusion::DepthBuffer;
+
+namespace
+{
+	constexpr float NearZ = 0.5f;
+	constexpr uint32_t Width = DepthBuffer::Width, Height = DepthBuffer::Height;
+
+	struct Matrix
+	{
+		float Rows[4][4] = {};
+	};
+
+	constexpr float FarZ = 500.0f;
+	constexpr double Range = FarZ / (FarZ - NearZ);
+
+	// Row-vector perspective at the origin looking down +z, with the aspect ratio of the depth buffer
+	Matrix MakeViewProjection(float fovY)
+	{
+		const float yScale = 1.0f / std::tan(fovY * 0.5f);
+		const float range = FarZ / (FarZ - NearZ);
+		Matrix matrix;
+		matrix.Rows[0][0] = yScale * Height / Width;
+		matrix.Rows[1][1] = yScale;
+		matrix.Rows[2][2] = range;
+		matrix.Rows[2][3] = 1.0f;
+		matrix.Rows[3][2] = -NearZ * range;
+		return matrix;
+	}
+
+	// Scale and translation applied before viewProjection
+	Matrix MakeModelViewProjection(const float center[3], const float extents[3], const Matrix& viewProjection)
+	{
+		Matrix matrix;
+		for (int j = 0; j < 4; j++)
+		{
+			for (int i = 0; i < 3; i++)
+				matrix.Rows[i][j] = extents[i] * viewProjection.Rows[i][j];
+			matrix.Rows[3][j] = center[0] * viewProjection.Rows[0][j] + center[1] * viewProjection.Rows[1][j] +
+				center[2] * viewProjection.Rows[2][j] + viewProjection.Rows[3][j];
+		}
+		return matrix;
+	}
+
+	// Screen x, y and depth, false in front of the near plane
+	bool Project(const float position[3], const Matrix& matrix, double screen[3])
+	{
+		double clip[4];
+		for (int j = 0; j < 4; j++)
+			clip[j] = double(position[0]) * matrix.Rows[0][j] + double(position[1]) * matrix.Rows[1][j] +
+				double(position[2]) * matrix.Rows[2][j] + matrix.Rows[3][j];
+		if (clip[2] < 0.0 || clip[3] <= 0.0)
+			return false;
+
+		screen[0] = (clip[0] / clip[3] * 0.5 + 0.5) * Width;
+		screen[1] = (0.5 - clip[1] / clip[3] * 0.5) * Height;
+		screen[2] = clip[2] / clip[3];
+		return true;
+	}
+
+	// View space distance of a depth buffer value
+	double GetDistance(double depth)
+	{
+		return NearZ * Range / (Range - depth);
+	}
+
+	// Unit cube with a vertex per face corner, as a mesh with flat normals would have
+	struct Cube
+	{
+		std::vector<float> Positions;
+		std::vector<uint32_t> Indices;
+
+		Cube()
+		{
+			for (int axis = 0; axis < 3; axis++)
+				for (float sign : { -1.0f, 1.0f })
+				{
+					const uint32_t first = static_cast<uint32_t>(Positions.size() / 3);
+					for (int corner = 0; corner < 4; corner++)
+					{
+						float position[3];
+						position[axis] = sign;
+						position[(axis + 1) % 3] = corner & 1 ? 1.0f : -1.0f;
+						position[(axis + 2) % 3] = corner & 2 ? 1.0f : -1.0f;
+						Positions.insert(Positions.end(), position, position + 3);
+					}
+					Indices.insert(Indices.end(), { first, first + 1, first + 2, first + 2, first + 1, first + 3 });
+				}
+		}
+	};
+
+	struct Placement
+	{
+		float Center[3];
+		float Extents[3];
+	};
+
+	std::vector<Placement> RandomPlacements(size_t count, uint32_t seed, float spreadX, float spreadY, float nearZ, float farZ,
+											float minSize, float maxSize)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> x(-spreadX, spreadX), y(-spreadY, spreadY), z(nearZ, farZ), size(minSize, maxSize);
+		std::vector<Placement> placements(count);
+		for (auto& placement : placements)
+			placement = { { x(generator), y(generator), z(generator) }, { size(generator), size(generator), size(generator) } };
+		return placements;
+	}
+
+	std::vector<Occlusion::OccluderInstance> Instantiate(const Occlusion::Occluder& occluder, const std::vector<Placement>& placements,
+														 const Matrix& viewProjection)
+	{
+		std::vector<Occlusion::OccluderInstance> instances(placements.size());
+		for (size_t i = 0; i < placements.size(); i++)
+		{
+			instances[i].Geometry = &occluder;
+			const Matrix matrix = MakeModelViewProjection(placements[i].Center, placements[i].Extents, viewProjection);
+			std::copy(&matrix.Rows[0][0], &matrix.Rows[0][0] + 16, &instances[i].ModelViewProjection[0][0]);
+		}
+		return instances;
+	}
+
+	// Nearest occluder depth at every pixel center, in double precision. Pixel centers on an edge count as covered,
+	// which can only bring the reference nearer.
+	std::vector<double> RenderReference(const std::vector<Occlusion::OccluderInstance>& instances)
+	{
+		std::vector<double> depth(Width * Height, 1.0);
+		for (const auto& instance : instances)
+		{
+			Matrix matrix;
+			std::copy(&instance.ModelViewProjection[0][0], &instance.ModelViewProjection[0][0] + 16, &matrix.Rows[0][0]);
+			const auto& geometry = *instance.Geometry;
+			for (size_t i = 0; i < geometry.Indices.size(); i += 3)
+			{
+				double v[3][3];
+				bool projected = true;
+				for (int k = 0; k < 3; k++)
+					projected &= Project(&geometry.Positions[geometry.Indices[i + k] * 3], matrix, v[k]);
+				const double area = (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]) - (v[1][1] - v[0][1]) * (v[2][0] - v[0][0]);
+				if (!projected || area == 0.0)
+					continue;
+
+				for (uint32_t y = 0; y < Height; y++)
+					for (uint32_t x = 0; x < Width; x++)
+					{
+						const double px = x + 0.5, py = y + 0.5;
+						double weights[3];
+						for (int k = 0; k < 3; k++)
+						{
+							const double* a = v[(k + 1) % 3];
+							const double* b = v[(k + 2) % 3];
+							weights[k] = ((b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0])) / area;
+						}
+						if (weights[0] < -1e-6 || weights[1] < -1e-6 || weights[2] < -1e-6)
+							continue;
+						const double z = weights[0] * v[0][2] + weights[1] * v[1][2] + weights[2] * v[2][2];
+						depth[y * Width + x] = std::min(depth[y * Width + x], z);
+					}
+			}
+		}
+		return depth;
+	}
+
+	Occlusion::Occluder MakeCubeOccluder()
+	{
+		const Cube cube;
+		return Occlusion::BuildOccluder(cube.Indices.data(), cube.Indices.size(), cube.Positions.data(), sizeof(float) * 3,
+										cube.Positions.size() / 3, 12, 0.0f);
+	}
+}
+
+TEST(OcclusionBuildOccluder)
+{
+	// Face corners sharing a position are welded
+	const Occlusion::Occluder cube = MakeCubeOccluder();
+	CHECK_EQUAL(cube.GetTriangleCount(), 12u);
+	CHECK_EQUAL(cube.Positions.size(), 8u * 3);
+	for (float coordinate : cube.Positions)
+		CHECK(coordinate == 1.0f || coordinate == -1.0f);
+
+	// A sphere simplifies to the budget, onto its own vertices
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+	constexpr uint32_t rings = 24, segments = 48;
+	for (uint32_t r = 0; r <= rings; r++)
+		for (uint32_t s = 0; s <= segments; s++)
+		{
+			// The seam column and the poles repeat positions exactly, so they weld into a closed surface
+			const float theta = 3.14159265f * r / rings, phi = 6.28318531f * (s % segments) / segments;
+			const float radius = r == 0 || r == rings ? 0.0f : std::sin(theta);
+			positions.insert(positions.end(), { radius * std::cos(phi), std::cos(theta), radius * std::sin(phi) });
+		}
+	for (uint32_t r = 0; r < rings; r++)
+		for (uint32_t s = 0; s < segments; s++)
+		{
+			const uint32_t a = r * (segments + 1) + s, b = a + segments + 1;
+			indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+		}
+
+	const size_t vertexCount = positions.size() / 3;
+	const auto sphere = Occlusion::BuildOccluder(indices.data(), indices.size(), positions.data(), sizeof(float) * 3, vertexCount,
+												 200, 1.0f);
+	CHECK(!sphere.Empty());
+	CHECK(sphere.GetTriangleCount() <= 200);
+	for (size_t i = 0; i < sphere.Positions.size(); i += 3)
+	{
+		bool found = false;
+		for (size_t j = 0; j < positions.size() && !found; j += 3)
+			found = std::equal(&positions[j], &positions[j] + 3, &sphere.Positions[i]);
+		CHECK(found);
+	}
+	for (uint32_t index : sphere.Indices)
+		CHECK(index < sphere.Positions.size() / 3);
+
+	// Out of reach within the error
+	CHECK(Occlusion::BuildOccluder(indices.data(), indices.size(), positions.data(), sizeof(float) * 3, vertexCount, 20, 1e-4f).Empty());
+}
+
+TEST(OcclusionFullScreenOccluder)
+{
+	const Matrix viewProjection = MakeViewProjection(1.5708f);
+	DepthBuffer buffer;
+	const float center[3] = { 0, 0, 0 }, extents[3] = { 1, 1, 1 };
+	// Nothing rendered yet, nothing is occluded
+	CHECK(!buffer.IsOccluded(center, extents, viewProjection.Rows));
+
+	// A wall at z = 10 reaching far past the screen edges
+	const Occlusion::Occluder cube = MakeCubeOccluder();
+	const std::vector<Placement> wall = { { { 0, 0, 11 }, { 100, 100, 1 } } };
+	const auto instances = Instantiate(cube, wall, viewProjection);
+	buffer.Render(instances.data(), instances.size());
+	CHECK(buffer.GetTriangleCount() > 0);
+
+	const float wallDepth = float(Range - NearZ * Range / 10.0);
+	for (uint32_t i = 0; i < Width * Height; i++)
+		CHECK_NEAR(buffer.GetDepth()[i], wallDepth, 1e-5f);
+
+	const auto isOccluded = [&](float x, float y, float z, float ex, float ey, float ez)
+	{
+		const float boxCenter[3] = { x, y, z }, boxExtents[3] = { ex, ey, ez };
+		return buffer.IsOccluded(boxCenter, boxExtents, viewProjection.Rows);
+	};
+	// Behind the wall, including boxes partly off screen and large ones
+	CHECK(isOccluded(0, 0, 20, 1, 1, 1));
+	CHECK(isOccluded(30, -12, 40, 2, 2, 2));
+	CHECK(isOccluded(0, 0, 100, 80, 50, 20));
+	// In front of or through the wall
+	CHECK(!isOccluded(0, 0, 5, 1, 1, 1));
+	CHECK(!isOccluded(0, 0, 10, 1, 1, 1.5f));
+	// Crossing the near plane, or behind the camera
+	CHECK(!isOccluded(0, 0, 15, 1, 1, 15));
+	CHECK(!isOccluded(0, 0, -20, 1, 1, 1));
+}
+
+TEST(OcclusionIsConservative)
+{
+	const Matrix viewProjection = MakeViewProjection(1.5708f);
+	const Occlusion::Occluder cube = MakeCubeOccluder();
+	const auto occluders = Instantiate(cube, RandomPlacements(60, 51, 40.0f, 20.0f, 15.0f, 60.0f, 1.0f, 6.0f), viewProjection);
+
+	DepthBuffer buffer;
+	buffer.Render(occluders.data(), occluders.size());
+	const std::vector<double> reference = RenderReference(occluders);
+
+	// Never nearer than the occluders at a pixel center. Depth is interpolated in float, which on faces seen
+	// almost edge on is off by a fraction of a percent of the distance.
+	constexpr double Tolerance = 1.01;
+	size_t covered = 0;
+	for (uint32_t i = 0; i < Width * Height; i++)
+	{
+		CHECK(GetDistance(buffer.GetDepth()[i]) * Tolerance >= GetDistance(reference[i]));
+		covered += reference[i] < 1.0;
+	}
+	CHECK(covered > Width * Height / 4);
+
+	// Every occluded box is behind the reference depth over all the pixels it touches
+	const auto boxes = RandomPlacements(20000, 52, 80.0f, 40.0f, 1.0f, 120.0f, 0.1f, 2.0f);
+	size_t occluded = 0;
+	for (const auto& box : boxes)
+	{
+		if (!buffer.IsOccluded(box.Center, box.Extents, viewProjection.Rows))
+			continue;
+		occluded++;
+
+		double minX = 1e30, minY = 1e30, minZ = 1e30, maxX = -1e30, maxY = -1e30;
+		for (int corner = 0; corner < 8; corner++)
+		{
+			const float position[3] = {
+				box.Center[0] + (corner & 1 ? box.Extents[0] : -box.Extents[0]),
+				box.Center[1] + (corner & 2 ? box.Extents[1] : -box.Extents[1]),
+				box.Center[2] + (corner & 4 ? box.Extents[2] : -box.Extents[2]),
+			};
+			double screen[3];
+			CHECK(Project(position, viewProjection, screen));
+			minX = std::min(minX, screen[0]);
+			maxX = std::max(maxX, screen[0]);
+			minY = std::min(minY, screen[1]);
+			maxY = std::max(maxY, screen[1]);
+			minZ = std::min(minZ, screen[2]);
+		}
+
+		const int x0 = std::max(int(minX), 0), x1 = std::min(int(maxX), int(Width) - 1);
+		const int y0 = std::max(int(minY), 0), y1 = std::min(int(maxY), int(Height) - 1);
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++)
+				CHECK(GetDistance(reference[y * Width + x]) < GetDistance(minZ) * Tolerance);
+	}
+	CHECK(occluded > boxes.size() / 20);
+}
+
+BENCHMARK(OcclusionThroughput)
+{
+	const Matrix viewProjection = MakeViewProjection(1.5708f);
+	const Occlusion::Occluder cube = MakeCubeOccluder();
+	const auto occluders = Instantiate(cube, RandomPlacements(500, 61, 60.0f, 30.0f, 15.0f, 100.0f, 1.0f, 6.0f), viewProjection);
+	const auto boxes = RandomPlacements(100000, 62, 120.0f, 60.0f, 1.0f, 200.0f, 0.1f, 2.0f);
+
+	DepthBuffer buffer;
+	Test::Report("render 500 occluders", Test::Measure([&]() { buffer.Render(occluders.data(), occluders.size()); }));
+
+	size_t occluded = 0;
+	Test::Report("test 100k boxes", Test::Measure([&]()
+	{
+		occluded = 0;
+		for (const auto& box : boxes)
+			occluded += buffer.IsOccluded(box.Center, box.Extents, viewProjection.Rows);
+	}));
+
+	std::printf("    %zu triangles, %zu of %zu boxes occluded\n", buffer.GetTriangleCount(), occluded, boxes.size());
+	CHECK(occluded > 0);
+}
\ No newline at end of file
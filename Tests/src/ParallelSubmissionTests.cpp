@@ -0,0 +1,228 @@
+#include "Test.h"
+#include "Core/ThreadPool.h"
+#include "Rendering/DeviceBackend.h"
+#include "Rendering/RenderGraph/ParallelSubmission.h"
+#include "Rendering/RenderGraph/SortKey.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	using Submission = ParallelSubmission<uint32_t>;
+
+	// Two queues, as the Phong and shadow passes of the scene
+	struct Queues
+	{
+		std::vector<uint32_t> Items[2];
+
+		void Append(size_t queue, const std::vector<uint32_t>& items)
+		{
+			Items[queue].insert(Items[queue].end(), items.begin(), items.end());
+		}
+	};
+
+	// Where RenderQueuePass::PushBack puts an item: the running chunk's list, or the queue itself
+	void Push(Queues& queues, size_t queue, uint32_t item)
+	{
+		if (auto* target = Submission::GetTarget(queue))
+			target->push_back(item);
+		else
+			queues.Items[queue].push_back(item);
+	}
+
+	size_t GetMeshCount(size_t actor)
+	{
+		return 50 + actor % 7 * 20;
+	}
+
+	// Every actor pushes itself, then its meshes through a nested submission, as Model::Submit does inside Application
+	void SubmitActor(Queues& queues, size_t actor)
+	{
+		Push(queues, 0, uint32_t(actor) << 16);
+		Submission meshes(2);
+		meshes.Run(GetMeshCount(actor), 8, [&queues, actor](size_t mesh)
+				   {
+					   Push(queues, 0, (uint32_t(actor) << 16) + uint32_t(mesh) + 1);
+					   if (mesh % 3 == 0)
+						   Push(queues, 1, uint32_t(mesh));
+				   }, [&queues](size_t queue, const std::vector<uint32_t>& items) { queues.Append(queue, items); });
+	}
+
+	struct SyntheticMesh
+	{
+		float Center[3];
+		float Radius;
+		uint32_t Program;
+		uint32_t Material;
+		uint32_t IndexCount;
+	};
+
+	std::vector<SyntheticMesh> MakeMeshes(size_t count)
+	{
+		std::vector<SyntheticMesh> meshes(count);
+		uint32_t hash = 1;
+		const auto next = [&hash]() { return hash = hash * 1664525u + 1013904223u; };
+		for (size_t i = 0; i < count; i++)
+		{
+			SyntheticMesh& mesh = meshes[i];
+			for (float& coordinate : mesh.Center)
+				coordinate = float(next() % 20000) * 0.01f - 100.0f;
+			mesh.Radius = 0.5f + float(next() % 100) * 0.01f;
+			mesh.Program = next() % 8;
+			mesh.Material = next() % 64;
+			mesh.IndexCount = 36 + next() % 3000;
+		}
+		return meshes;
+	}
+
+	// What a mesh does on submission: cull against the view, then pack the queue's sort key
+	bool MakeKey(const SyntheticMesh& mesh, const SortKeyLayout& layout, uint64_t& key)
+	{
+		const float planes[4][4] = { { 0.7f, 0.0f, 0.7f, 0.0f }, { -0.7f, 0.0f, 0.7f, 0.0f }, { 0.0f, 0.7f, 0.7f, 0.0f },
+									 { 0.0f, -0.7f, 0.7f, 0.0f } };
+		for (const auto& plane : planes)
+		{
+			const float distance = plane[0] * mesh.Center[0] + plane[1] * mesh.Center[1] + plane[2] * mesh.Center[2] + plane[3];
+			if (distance < -mesh.Radius)
+				return false;
+		}
+
+		SortKeyInput input;
+		input.Program = mesh.Program * 0x9E3779B97F4A7C15ull;
+		input.Material = mesh.Material * 0xC2B2AE3D27D4EB4Full;
+		input.Depth = std::sqrt(mesh.Center[0] * mesh.Center[0] + mesh.Center[1] * mesh.Center[1] + mesh.Center[2] * mesh.Center[2]);
+		key = layout.Pack(input);
+		return true;
+	}
+
+	struct Draw
+	{
+		uint64_t Key;
+		uint32_t Mesh;
+	};
+
+	// Sorts the queue and records it, as RenderQueuePass::Record does, then plays it back
+	void RecordAndPlay(const std::vector<Draw>& draws, const std::vector<SyntheticMesh>& meshes, CommandList& list, NullBackend& backend)
+	{
+		std::vector<uint64_t> keys(draws.size()), scratchKeys;
+		std::vector<uint32_t> order(draws.size()), scratchOrder;
+		for (uint32_t i = 0; i < draws.size(); i++)
+		{
+			keys[i] = draws[i].Key;
+			order[i] = i;
+		}
+		RadixSort(keys, order, scratchKeys, scratchOrder);
+
+		list.Reset();
+		for (uint32_t i : order)
+		{
+			const SyntheticMesh& mesh = meshes[draws[i].Mesh];
+			list.SetVertexShader(reinterpret_cast<void*>(uintptr_t(mesh.Program + 1) << 4));
+			list.PSSetShaderResource(0, reinterpret_cast<void*>(uintptr_t(mesh.Material + 1) << 8));
+			list.SetVertexBuffer(reinterpret_cast<void*>(uintptr_t(draws[i].Mesh + 1) << 12), 32, 4);
+			list.DrawIndexed(mesh.IndexCount, 0);
+		}
+
+		backend.BeginFrame();
+		backend.Submit(list);
+	}
+}
+
+TEST(ParallelSubmissionOutsideIsNull)
+{
+	CHECK(Submission::GetTarget(0) == nullptr);
+
+	Queues queues;
+	Submission submission(2);
+	submission.Run(0, 1, [](size_t) {}, [&queues](size_t queue, const std::vector<uint32_t>& items) { queues.Append(queue, items); });
+	CHECK(queues.Items[0].empty() && queues.Items[1].empty());
+
+	// A throwing submission leaves no chunk behind on the calling thread
+	CHECK_THROWS(submission.Run(64, 1, [](size_t i) { if (i == 0) throw std::runtime_error("submit failed"); },
+								[](size_t, const std::vector<uint32_t>&) {}));
+	CHECK(Submission::GetTarget(0) == nullptr);
+}
+
+TEST(ParallelSubmissionOrderMatchesSerial)
+{
+	constexpr size_t actors = 100;
+	Queues expected;
+	for (size_t actor = 0; actor < actors; actor++)
+		SubmitActor(expected, actor);
+
+	// The serial reference ran outside any submission, push by push
+	CHECK_EQUAL(expected.Items[0].size(), actors + [&]()
+	{
+		size_t meshes = 0;
+		for (size_t actor = 0; actor < actors; actor++)
+			meshes += GetMeshCount(actor);
+		return meshes;
+	}());
+
+	// Scheduling differs from run to run, the merged order must not
+	for (int run = 0; run < 20; run++)
+	{
+		Queues queues;
+		Submission submission(2);
+		submission.Run(actors, 1, [&queues](size_t actor) { SubmitActor(queues, actor); },
+					   [&queues](size_t queue, const std::vector<uint32_t>& items) { queues.Append(queue, items); });
+		CHECK(queues.Items[0] == expected.Items[0]);
+		CHECK(queues.Items[1] == expected.Items[1]);
+	}
+}
+
+BENCHMARK(ParallelSubmissionThroughput)
+{
+	// 100k meshes culled and keyed into a queue, then sorted, recorded and played back through a NullBackend
+	constexpr size_t count = 100000;
+	const std::vector<SyntheticMesh> meshes = MakeMeshes(count);
+	const SortKeyLayout layout = SortKeyLayout::StateFirst();
+	CommandList list;
+	NullBackend backend;
+
+	std::vector<Draw> serial;
+	const auto submitSerial = [&]()
+	{
+		serial.clear();
+		for (size_t i = 0; i < count; i++)
+		{
+			uint64_t key;
+			if (MakeKey(meshes[i], layout, key))
+				serial.push_back({ key, uint32_t(i) });
+		}
+	};
+
+	std::vector<Draw> parallel;
+	const auto submitParallel = [&]()
+	{
+		parallel.clear();
+		ParallelSubmission<Draw> submission(1);
+		submission.Run(count, 256, [&](size_t i)
+					   {
+						   uint64_t key;
+						   if (MakeKey(meshes[i], layout, key))
+							   ParallelSubmission<Draw>::GetTarget(0)->push_back({ key, uint32_t(i) });
+					   }, [&parallel](size_t, const std::vector<Draw>& draws) { parallel.insert(parallel.end(), draws.begin(), draws.end()); });
+	};
+
+	Test::Report("submit serial", Test::Measure(submitSerial));
+	Test::Report("submit parallel", Test::Measure(submitParallel));
+	Test::Report("submit and play back serial", Test::Measure([&]()
+	{
+		submitSerial();
+		RecordAndPlay(serial, meshes, list, backend);
+	}));
+	Test::Report("submit and play back parallel", Test::Measure([&]()
+	{
+		submitParallel();
+		RecordAndPlay(parallel, meshes, list, backend);
+	}));
+
+	std::printf("    %zu of %zu meshes drawn, %zu threads\n", serial.size(), count, ThreadPool::GetConcurrency());
+	CHECK_EQUAL(serial.size(), parallel.size());
+	bool same = serial.size() == parallel.size();
+	for (size_t i = 0; same && i < serial.size(); i++)
+		same = serial[i].Key == parallel[i].Key && serial[i].Mesh == parallel[i].Mesh;
+	CHECK(same);
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "Test.h"
+#include "Rendering/Quantization.h"
+
+#include <random>
+
+using namespace Quantization;
+
+namespace
+{
+	std::vector<Float3> RandomDirections(size_t count, uint32_t seed)
+	{
+		std::mt19937 generator(seed);
+		std::normal_distribution<float> distribution;
+		std::vector<Float3> directions(count);
+		for (auto& d : directions)
+		{
+			float length;
+			do
+			{
+				d = { distribution(generator), distribution(generator), distribution(generator) };
+				length = std::sqrt(d.X * d.X + d.Y * d.Y + d.Z * d.Z);
+			} while (length < 1e-3f);
+			d = { d.X / length, d.Y / length, d.Z / length };
+		}
+		return directions;
+	}
+
+	// In double, acos of a float dot product cannot resolve angles this small
+	double Angle(const Float3& a, const Float3& b)
+	{
+		const double x = double(a.Y) * b.Z - double(a.Z) * b.Y;
+		const double y = double(a.Z) * b.X - double(a.X) * b.Z;
+		const double z = double(a.X) * b.Y - double(a.Y) * b.X;
+		const double dot = double(a.X) * b.X + double(a.Y) * b.Y + double(a.Z) * b.Z;
+		return std::atan2(std::sqrt(x * x + y * y + z * z), dot);
+	}
+
+	// Radians, 2x16 bits measure about 6.4e-5 at worst and the 15 bit tangent Y about 9.7e-5
+	constexpr double MaxNormalError = 1e-4;
+	constexpr double MaxTangentError = 2e-4;
+}
+
+// Position, normal, tangent and texture coordinates in 20 bytes instead of 56 with bitangents
+static_assert(sizeof(Short4) + 2 * sizeof(Short2) + sizeof(Half2) == 20);
+
+TEST(QuantizationSnormRoundTrip)
+{
+	for (int value = -32767; value <= 32767; value++)
+		CHECK_EQUAL(FloatToSnorm16(Snorm16ToFloat(int16_t(value))), value);
+
+	CHECK_EQUAL(FloatToSnorm16(2.0f), 32767);
+	CHECK_EQUAL(FloatToSnorm16(-2.0f), -32767);
+	CHECK_EQUAL(Snorm16ToFloat(-32768), -1.0f);
+}
+
+TEST(QuantizationHalfRoundTrip)
+{
+	// Every half but NaNs converts to a float and back unchanged
+	for (uint32_t bits = 0; bits <= 0xFFFFu; bits++)
+	{
+		const float value = HalfToFloat(uint16_t(bits));
+		if (std::isnan(value))
+			CHECK(std::isnan(HalfToFloat(FloatToHalf(value))));
+		else
+			CHECK_EQUAL(FloatToHalf(value), bits);
+	}
+
+	// Texture coordinates in the usual range keep 11 significant bits
+	std::mt19937 generator(3);
+	std::uniform_real_distribution<float> distribution(-16.0f, 16.0f);
+	for (int i = 0; i < 100000; i++)
+	{
+		const float value = distribution(generator);
+		const float decoded = HalfToFloat(FloatToHalf(value));
+		CHECK(std::fabs(decoded - value) <= std::max(std::fabs(value) * (1.0f / 2048.0f), 1.0f / (1 << 24)));
+	}
+
+	CHECK_EQUAL(FloatToHalf(1e6f), 0x7C00u);
+	CHECK_EQUAL(FloatToHalf(-1e-10f), 0x8000u);
+}
+
+TEST(QuantizationOctahedralNormals)
+{
+	double maxError = 0.0;
+	for (const auto& normal : RandomDirections(200000, 1))
+		maxError = std::max(maxError, Angle(normal, DecodeOctahedral(EncodeOctahedral(normal))));
+	CHECK(maxError < MaxNormalError);
+
+	// Poles and octant seams
+	const Float3 axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	for (const auto& axis : axes)
+		CHECK(Angle(axis, DecodeOctahedral(EncodeOctahedral(axis))) < MaxNormalError);
+}
+
+TEST(QuantizationTangentsKeepBitangentSign)
+{
+	const auto tangents = RandomDirections(100000, 2);
+	double maxError = 0.0;
+	for (size_t i = 0; i < tangents.size(); i++)
+	{
+		const float sign = i & 1 ? -1.0f : 1.0f;
+		float decodedSign = 0.0f;
+		const Float3 decoded = DecodeTangent(EncodeTangent(tangents[i], sign), decodedSign);
+		CHECK_EQUAL(decodedSign, sign);
+		maxError = std::max(maxError, Angle(tangents[i], decoded));
+	}
+	CHECK(maxError < MaxTangentError);
+
+	// Sign from the handedness of the source frame
+	const Float3 normal{ 0, 0, 1 }, tangent{ 1, 0, 0 };
+	const Float3 bitangents[] = { { 0, 1, 0 }, { 0, -1, 0 } };
+	Short2 encoded[2];
+	EncodeTangents(encoded, &tangent, &bitangents[0], &normal, 1);
+	EncodeTangents(encoded + 1, &tangent, &bitangents[1], &normal, 1);
+
+	float sign;
+	DecodeTangent(encoded[0], sign);
+	CHECK_EQUAL(sign, 1.0f);
+	DecodeTangent(encoded[1], sign);
+	CHECK_EQUAL(sign, -1.0f);
+}
+
+TEST(QuantizationPositionsWithinHalfStep)
+{
+	std::mt19937 generator(4);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	std::vector<Float3> positions(50000);
+	for (auto& p : positions)
+		p = { 40.0f * distribution(generator) + 5.0f, 2.0f * distribution(generator), 300.0f * distribution(generator) };
+
+	const Bounds bounds = ComputeBounds(positions.data(), positions.size());
+	std::vector<Short4> encoded(positions.size());
+	EncodePositions(encoded.data(), positions.data(), positions.size(), bounds);
+
+	const Float3 extents = bounds.GetExtents();
+	const Float3 step{ extents.X / 32767.0f, extents.Y / 32767.0f, extents.Z / 32767.0f };
+	// Half a step, plus float rounding of the dequantization
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		const Float3 decoded = DequantizePosition(encoded[i], bounds);
+		CHECK(std::fabs(decoded.X - positions[i].X) <= step.X * 0.51f);
+		CHECK(std::fabs(decoded.Y - positions[i].Y) <= step.Y * 0.51f);
+		CHECK(std::fabs(decoded.Z - positions[i].Z) <= step.Z * 0.51f);
+		CHECK_EQUAL(encoded[i].W, 32767);
+	}
+
+	// Flat meshes collapse the empty axis to the center
+	const Float3 flat[] = { { 0, 1, 0 }, { 2, 1, 0 } };
+	const Bounds flatBounds = ComputeBounds(flat, 2);
+	CHECK_EQUAL(QuantizePosition(flat[1], flatBounds).Y, 0);
+	CHECK_EQUAL(DequantizePosition(QuantizePosition(flat[1], flatBounds), flatBounds).Y, 1.0f);
+}
+
+BENCHMARK(QuantizationEncodeThroughput)
+{
+	const size_t count = 1 << 20;
+	const auto normals = RandomDirections(count, 5);
+	const auto tangents = RandomDirections(count, 6);
+	const auto bitangents = RandomDirections(count, 7);
+
+	std::vector<Short4> positions(count);
+	std::vector<Short2> encodedNormals(count), encodedTangents(count);
+	std::vector<Half2> texCoords(count);
+	const Bounds bounds = ComputeBounds(tangents.data(), count);
+
+	Test::Report("EncodePositions", Test::Measure([&]() { EncodePositions(positions.data(), normals.data(), count, bounds); }));
+	Test::Report("EncodeNormals", Test::Measure([&]() { EncodeNormals(encodedNormals.data(), normals.data(), count); }));
+	Test::Report("EncodeTangents", Test::Measure([&]()
+	{
+		EncodeTangents(encodedTangents.data(), tangents.data(), bitangents.data(), normals.data(), count);
+	}));
+	Test::Report("EncodeTexCoords", Test::Measure([&]() { EncodeTexCoords(texCoords.data(), normals.data(), count); }));
+
+	std::vector<Float3> decoded(count);
+	Test::Report("DecodeOctahedral", Test::Measure([&]()
+	{
+		for (size_t i = 0; i < count; i++)
+			decoded[i] = DecodeOctahedral(encodedNormals[i]);
+	}));
+	CHECK(Angle(decoded[count / 2], normals[count / 2]) < MaxNormalError);
+}
\ No newline at end of file
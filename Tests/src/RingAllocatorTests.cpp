@@ -0,0 +1,127 @@
+#include "Test.h"
+#include "Rendering/RingAllocator.h"
+
+#include <deque>
+#include <random>
+
+TEST(RingAllocatorAlignment)
+{
+	RingAllocator ring(4096);
+	CHECK_EQUAL(ring.Allocate(3, 1), 0u);
+	CHECK_EQUAL(ring.Allocate(16, 256), 256u);
+	CHECK_EQUAL(ring.Allocate(4, 16), 272u);
+	// Padding counts as used until the frame retires
+	CHECK_EQUAL(ring.GetUsed(), 276u);
+
+	CHECK_EQUAL(ring.Allocate(0, 16), RingAllocator::InvalidOffset);
+	CHECK_EQUAL(ring.Allocate(4097, 16), RingAllocator::InvalidOffset);
+}
+
+TEST(RingAllocatorWrapsAround)
+{
+	RingAllocator ring(1024);
+	CHECK_EQUAL(ring.Allocate(600, 1), 0u);
+	ring.FinishFrame(1);
+	CHECK_EQUAL(ring.Allocate(300, 1), 600u);
+	ring.FinishFrame(2);
+
+	// Nothing retired, the end of the range cannot hold it and the start is in flight
+	CHECK_EQUAL(ring.Allocate(200, 1), RingAllocator::InvalidOffset);
+
+	ring.Retire(1);
+	CHECK_EQUAL(ring.Allocate(200, 1), 0u);
+	// The skipped tail [900, 1024) stays used until its frame retires
+	CHECK_EQUAL(ring.GetUsed(), 300u + 124u + 200u);
+
+	// Free space is [200, 600) now
+	CHECK_EQUAL(ring.Allocate(500, 1), RingAllocator::InvalidOffset);
+	CHECK_EQUAL(ring.Allocate(400, 1), 200u);
+	CHECK_EQUAL(ring.GetUsed(), 1024u);
+	CHECK_EQUAL(ring.Allocate(1, 1), RingAllocator::InvalidOffset);
+}
+
+TEST(RingAllocatorReusesRetiredFrames)
+{
+	RingAllocator ring(1024);
+	ring.Allocate(256, 16);
+	ring.FinishFrame(10);
+	ring.Allocate(256, 16);
+	ring.FinishFrame(11);
+	CHECK_EQUAL(ring.GetPendingFrames(), 2u);
+
+	ring.Retire(9);
+	CHECK_EQUAL(ring.GetPendingFrames(), 2u);
+	CHECK_EQUAL(ring.GetUsed(), 512u);
+
+	ring.Retire(10);
+	CHECK_EQUAL(ring.GetPendingFrames(), 1u);
+	CHECK_EQUAL(ring.GetUsed(), 256u);
+
+	// A later fence retires everything before it too
+	ring.FinishFrame(12);
+	ring.Retire(12);
+	CHECK_EQUAL(ring.GetPendingFrames(), 0u);
+	CHECK_EQUAL(ring.GetUsed(), 0u);
+
+	// Once idle the ring continues from the head instead of restarting at zero
+	CHECK_EQUAL(ring.Allocate(16, 16), 512u);
+}
+
+TEST(RingAllocatorNeverOverwritesFramesInFlight)
+{
+	// The GPU trails the CPU by up to three frames; live ranges of frames in flight must never overlap
+	constexpr uint32_t capacity = 1 << 16;
+	RingAllocator ring(capacity);
+	std::mt19937 generator(5);
+
+	struct Range
+	{
+		uint32_t Begin, End;
+	};
+	std::deque<std::vector<Range>> inFlight;
+	std::vector<uint8_t> owner(capacity, 0);
+	size_t allocated = 0, rejected = 0;
+
+	for (uint64_t frame = 1; frame <= 2000; frame++)
+	{
+		std::vector<Range> ranges;
+		const uint32_t requests = generator() % 64;
+		for (uint32_t r = 0; r < requests; r++)
+		{
+			const uint32_t size = 1 + generator() % 2048;
+			const uint32_t alignment = 1u << (generator() % 9);
+			const uint32_t offset = ring.Allocate(size, alignment);
+			if (offset == RingAllocator::InvalidOffset)
+			{
+				rejected++;
+				continue;
+			}
+
+			CHECK_EQUAL(offset % alignment, 0u);
+			CHECK(offset + size <= capacity);
+			for (uint32_t i = offset; i < offset + size; i++)
+			{
+				CHECK_EQUAL(owner[i], 0);
+				owner[i] = 1;
+			}
+			ranges.push_back({ offset, offset + size });
+			allocated++;
+		}
+
+		ring.FinishFrame(frame);
+		inFlight.push_back(std::move(ranges));
+
+		if (frame > 3)
+		{
+			ring.Retire(frame - 3);
+			for (const Range& range : inFlight.front())
+				std::fill(owner.begin() + range.Begin, owner.begin() + range.End, uint8_t(0));
+			inFlight.pop_front();
+		}
+		CHECK(ring.GetUsed() <= capacity);
+	}
+
+	// Both paths were exercised
+	CHECK(allocated > 10000);
+	CHECK(rejected > 0);
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "Test.h"
+#include "Rendering/Lights/Attenuation.h"
+#include "Rendering/Lights/ShadowCube.h"
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+	// PointLight::LightProperties defaults
+	constexpr float Intensity = 1.0f, Constant = 1.0f, Linear = 0.05f, Quad = 0.01f;
+
+	const DirectX::XMFLOAT3 LightPosition{ 3.0f, -2.0f, 5.0f };
+
+	ShadowCube MakeCube(float range)
+	{
+		ShadowCube cube;
+		cube.Place(DirectX::XMLoadFloat3(&LightPosition), range);
+		return cube;
+	}
+
+	// Direction the camera of the face looks along, one of the six signed axes
+	DirectX::XMFLOAT3 GetFaceAxis(const ShadowCube& cube, uint32_t face)
+	{
+		DirectX::XMFLOAT3 axis;
+		DirectX::XMStoreFloat3(&axis, cube.GetFaceTransform(face).r[2]);
+		return axis;
+	}
+
+	Culling::Box MakeBox(const DirectX::XMFLOAT3& direction, float distance, float extent)
+	{
+		return { { LightPosition.x + direction.x * distance, LightPosition.y + direction.y * distance,
+				   LightPosition.z + direction.z * distance }, { extent, extent, extent } };
+	}
+
+	// Face whose pyramid holds the offset from the light, the one along its largest coordinate
+	uint32_t GetPyramid(const ShadowCube& cube, float x, float y, float z)
+	{
+		const float offset[3] = { x, y, z };
+		int axis = 0;
+		for (int i = 1; i < 3; i++)
+		{
+			if (std::abs(offset[i]) > std::abs(offset[axis]))
+				axis = i;
+		}
+
+		for (uint32_t face = 0; face < ShadowCube::FaceCount; face++)
+		{
+			const DirectX::XMFLOAT3 faceAxis = GetFaceAxis(cube, face);
+			const float along[3] = { faceAxis.x, faceAxis.y, faceAxis.z };
+			if (along[axis] * offset[axis] > 0.5f * std::abs(offset[axis]))
+				return face;
+		}
+		return ShadowCube::FaceCount;
+	}
+}
+
+TEST(ShadowCubeFacesCoverTheAxes)
+{
+	const ShadowCube cube = MakeCube(50.0f);
+
+	// Each signed axis exactly once, every face camera sitting at the light
+	uint32_t axes = 0;
+	for (uint32_t face = 0; face < ShadowCube::FaceCount; face++)
+	{
+		const DirectX::XMFLOAT3 axis = GetFaceAxis(cube, face);
+		CHECK_NEAR(std::abs(axis.x) + std::abs(axis.y) + std::abs(axis.z), 1.0f, 1e-5f);
+		const int index = std::abs(axis.x) > 0.5f ? 0 : std::abs(axis.y) > 0.5f ? 1 : 2;
+		const float sign = index == 0 ? axis.x : index == 1 ? axis.y : axis.z;
+		axes |= 1u << (index * 2 + (sign > 0.0f));
+
+		DirectX::XMFLOAT3 position;
+		DirectX::XMStoreFloat3(&position, cube.GetFaceTransform(face).r[3]);
+		CHECK_NEAR(position.x, LightPosition.x, 1e-5f);
+		CHECK_NEAR(position.y, LightPosition.y, 1e-5f);
+		CHECK_NEAR(position.z, LightPosition.z, 1e-5f);
+
+		// A caster straight ahead of one face is in no other
+		CHECK_EQUAL(cube.GetFaceMask(MakeBox(axis, 10.0f, 0.5f)), 1u << face);
+	}
+	CHECK_EQUAL(axes, ShadowCube::AllFaces);
+
+	// Around the light, every face sees part of it
+	CHECK_EQUAL(cube.GetFaceMask({ LightPosition, { 2.0f, 2.0f, 2.0f } }), ShadowCube::AllFaces);
+}
+
+TEST(ShadowCubeBoxesAcrossFaceBoundaries)
+{
+	const ShadowCube cube = MakeCube(50.0f);
+
+	// On the edge between two neighbouring faces, or the corner of three
+	for (uint32_t a = 0; a < ShadowCube::FaceCount; a++)
+		for (uint32_t b = a + 1; b < ShadowCube::FaceCount; b++)
+		{
+			const DirectX::XMFLOAT3 axisA = GetFaceAxis(cube, a), axisB = GetFaceAxis(cube, b);
+			if (std::abs(axisA.x * axisB.x + axisA.y * axisB.y + axisA.z * axisB.z) > 0.5f)
+				continue;
+
+			const DirectX::XMFLOAT3 edge{ axisA.x + axisB.x, axisA.y + axisB.y, axisA.z + axisB.z };
+			CHECK_EQUAL(cube.GetFaceMask(MakeBox(edge, 8.0f, 0.5f)), (1u << a) | (1u << b));
+
+			for (uint32_t c = b + 1; c < ShadowCube::FaceCount; c++)
+			{
+				const DirectX::XMFLOAT3 axisC = GetFaceAxis(cube, c);
+				if (std::abs(axisA.x * axisC.x + axisA.y * axisC.y + axisA.z * axisC.z) > 0.5f ||
+					std::abs(axisB.x * axisC.x + axisB.y * axisC.y + axisB.z * axisC.z) > 0.5f)
+					continue;
+
+				const DirectX::XMFLOAT3 corner{ edge.x + axisC.x, edge.y + axisC.y, edge.z + axisC.z };
+				CHECK_EQUAL(cube.GetFaceMask(MakeBox(corner, 6.0f, 0.5f)), (1u << a) | (1u << b) | (1u << c));
+			}
+		}
+
+	// Random boxes take the faces of all their corners, and only that face when their corners share one
+	std::mt19937 generator(81);
+	std::uniform_real_distribution<float> offset(-30.0f, 30.0f), extent(0.05f, 3.0f);
+	size_t straddling = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		const DirectX::XMFLOAT3 center{ offset(generator), offset(generator), offset(generator) };
+		const DirectX::XMFLOAT3 extents{ extent(generator), extent(generator), extent(generator) };
+		if (std::max({ std::abs(center.x) - extents.x, std::abs(center.y) - extents.y, std::abs(center.z) - extents.z }) < 1.0f)
+			continue;
+
+		uint32_t corners = 0;
+		for (int corner = 0; corner < 8; corner++)
+		{
+			corners |= 1u << GetPyramid(cube, center.x + (corner & 1 ? extents.x : -extents.x),
+										center.y + (corner & 2 ? extents.y : -extents.y),
+										center.z + (corner & 4 ? extents.z : -extents.z));
+		}
+
+		const Culling::Box box{ { LightPosition.x + center.x, LightPosition.y + center.y, LightPosition.z + center.z }, extents };
+		const uint32_t faces = cube.GetFaceMask(box);
+		CHECK_EQUAL(faces & corners, corners);
+		if ((corners & (corners - 1)) == 0)
+			CHECK_EQUAL(faces, corners);
+		else
+			straddling++;
+	}
+	CHECK(straddling > 100);
+}
+
+TEST(ShadowCubeIgnoresCastersOutOfRange)
+{
+	// A dim light, its range well inside the far plane
+	const float range = Attenuation::GetRange(0.1f * Intensity, Constant, Linear, Quad);
+	CHECK(range > 20.0f && range < ShadowCube::FarZ - 10.0f);
+	const ShadowCube cube = MakeCube(range);
+	CHECK_EQUAL(cube.GetRange(), range);
+
+	for (uint32_t face = 0; face < ShadowCube::FaceCount; face++)
+	{
+		const DirectX::XMFLOAT3 axis = GetFaceAxis(cube, face);
+		// Just inside the range, and just beyond it
+		CHECK(cube.IsInRange(MakeBox(axis, range + 0.9f, 1.0f)));
+		CHECK_EQUAL(cube.GetFaceMask(MakeBox(axis, range + 0.9f, 1.0f)), 1u << face);
+		CHECK(!cube.IsInRange(MakeBox(axis, range + 1.1f, 1.0f)));
+		CHECK_EQUAL(cube.GetFaceMask(MakeBox(axis, range + 1.1f, 1.0f)), 0u);
+	}
+
+	// Off the axes the range is still a sphere, not the cube of the faces
+	const DirectX::XMFLOAT3 corner{ 1.0f, 1.0f, 1.0f };
+	CHECK_EQUAL(cube.GetFaceMask(MakeBox(corner, range / std::sqrt(3.0f) + 0.5f, 0.25f)), 0u);
+
+	// Moving the light moves the range with it
+	ShadowCube moved = MakeCube(range);
+	moved.Place(DirectX::XMVectorSet(LightPosition.x + range + 2.0f, LightPosition.y, LightPosition.z, 1.0f), range);
+	CHECK(moved.GetFaceMask(MakeBox({ 1.0f, 0.0f, 0.0f }, range + 1.1f, 1.0f)) != 0u);
+	CHECK_EQUAL(moved.GetFaceMask({ LightPosition, { 1.0f, 1.0f, 1.0f } }), 0u);
+
+	// The default light reaches past the far plane, where no depth is stored
+	const float far = Attenuation::GetRange(Intensity, Constant, Linear, Quad);
+	CHECK(far > ShadowCube::FarZ);
+	const ShadowCube bright = MakeCube(far);
+	CHECK_EQUAL(bright.GetRange(), ShadowCube::FarZ);
+	const DirectX::XMFLOAT3 axis = GetFaceAxis(bright, 0);
+	CHECK_EQUAL(bright.GetFaceMask(MakeBox(axis, ShadowCube::FarZ - 2.0f, 1.0f)), 1u);
+	CHECK(!bright.IsInRange(MakeBox(axis, ShadowCube::FarZ + 2.0f, 1.0f)));
+	CHECK_EQUAL(bright.GetFaceMask(MakeBox(axis, ShadowCube::FarZ + 2.0f, 1.0f)), 0u);
+}
+
+TEST(AttenuationRangeMatchesCutoff)
+{
+	const auto attenuate = [](float intensity, float constant, float linear, float quad, float distance)
+	{
+		return intensity / (constant + linear * distance + quad * distance * distance);
+	};
+
+	const float cutoff = 1.0f / 256.0f;
+	const float range = Attenuation::GetRange(Intensity, Constant, Linear, Quad);
+	CHECK(range > 0.0f);
+	CHECK_NEAR(attenuate(Intensity, Constant, Linear, Quad, range) / cutoff, 1.0f, 1e-3f);
+
+	// Brighter lights reach farther, a looser cutoff stops them earlier
+	CHECK(Attenuation::GetRange(4.0f, Constant, Linear, Quad) > range);
+	const float loose = Attenuation::GetRange(Intensity, Constant, Linear, Quad, 1.0f / 16.0f);
+	CHECK(loose < range);
+	CHECK_NEAR(attenuate(Intensity, Constant, Linear, Quad, loose) * 16.0f, 1.0f, 1e-3f);
+
+	// Without the quadratic term the linear one alone bounds the light, without both nothing does
+	const float linearOnly = Attenuation::GetRange(Intensity, Constant, Linear, 0.0f);
+	CHECK_NEAR(attenuate(Intensity, Constant, Linear, 0.0f, linearOnly) / cutoff, 1.0f, 1e-3f);
+	CHECK(std::isinf(Attenuation::GetRange(Intensity, Constant, 0.0f, 0.0f)));
+}
\ No newline at end of file
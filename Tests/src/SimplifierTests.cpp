@@ -0,0 +1,210 @@
+#include "Test.h"
+#include "Rendering/Simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	struct TestMesh
+	{
+		std::vector<float> Positions;
+		std::vector<uint32_t> Indices;
+		// Vertices on the open border of the grid and on both sides of its seam
+		std::vector<uint32_t> Locked;
+
+		size_t GetVertexCount() const { return Positions.size() / 3; }
+	};
+
+	// Gently rolling height field over [0, 1]^2. The middle column is split into two vertices per
+	// position, as a UV seam would split it.
+	TestMesh MakeTerrain(uint32_t size)
+	{
+		TestMesh mesh;
+		const uint32_t seam = size / 2;
+		std::vector<uint32_t> left((size + 1) * (size + 1)), right((size + 1) * (size + 1));
+
+		const auto addVertex = [&](uint32_t x, uint32_t z)
+		{
+			const float u = float(x) / size, v = float(z) / size;
+			mesh.Positions.insert(mesh.Positions.end(), { u, 0.05f * std::sin(u * 9.0f) * std::cos(v * 7.0f), v });
+			const uint32_t index = static_cast<uint32_t>(mesh.GetVertexCount() - 1);
+			if (x == 0 || z == 0 || x == size || z == size || x == seam)
+				mesh.Locked.push_back(index);
+			return index;
+		};
+
+		for (uint32_t z = 0; z <= size; z++)
+			for (uint32_t x = 0; x <= size; x++)
+			{
+				const uint32_t cell = z * (size + 1) + x;
+				left[cell] = right[cell] = addVertex(x, z);
+				if (x == seam)
+					right[cell] = addVertex(x, z);
+			}
+
+		for (uint32_t z = 0; z < size; z++)
+			for (uint32_t x = 0; x < size; x++)
+			{
+				const auto& side = x < seam ? left : right;
+				const uint32_t a = side[z * (size + 1) + x], b = side[z * (size + 1) + x + 1];
+				const uint32_t c = side[(z + 1) * (size + 1) + x], d = side[(z + 1) * (size + 1) + x + 1];
+				mesh.Indices.insert(mesh.Indices.end(), { a, c, b, b, c, d });
+			}
+		return mesh;
+	}
+
+	struct Level
+	{
+		std::vector<uint32_t> Indices;
+		float Error = 0.0f;
+	};
+
+	Level Simplify(const TestMesh& mesh, size_t targetIndexCount, float targetError)
+	{
+		Level level;
+		level.Indices.resize(mesh.Indices.size());
+		const size_t count = Simplifier::Simplify(level.Indices.data(), mesh.Indices.data(), mesh.Indices.size(), mesh.Positions.data(),
+												  3 * sizeof(float), mesh.GetVertexCount(), targetIndexCount, targetError, &level.Error);
+		level.Indices.resize(count);
+		return level;
+	}
+
+	// Height of the level's surface above (x, z), found by the triangle covering it in the xz plane
+	bool SampleHeight(const TestMesh& mesh, const Level& level, float x, float z, float& height)
+	{
+		const float* p = mesh.Positions.data();
+		for (size_t i = 0; i < level.Indices.size(); i += 3)
+		{
+			const float* a = p + level.Indices[i] * 3;
+			const float* b = p + level.Indices[i + 1] * 3;
+			const float* c = p + level.Indices[i + 2] * 3;
+			const float area = (b[0] - a[0]) * (c[2] - a[2]) - (c[0] - a[0]) * (b[2] - a[2]);
+			if (area == 0.0f)
+				continue;
+
+			const float wb = ((x - a[0]) * (c[2] - a[2]) - (c[0] - a[0]) * (z - a[2])) / area;
+			const float wc = ((b[0] - a[0]) * (z - a[2]) - (x - a[0]) * (b[2] - a[2])) / area;
+			const float wa = 1.0f - wb - wc;
+			if (wa < -1e-5f || wb < -1e-5f || wc < -1e-5f)
+				continue;
+
+			height = wa * a[1] + wb * b[1] + wc * c[1];
+			return true;
+		}
+		return false;
+	}
+}
+
+TEST(SimplifierIsDeterministic)
+{
+	const TestMesh mesh = MakeTerrain(32);
+	const Level first = Simplify(mesh, mesh.Indices.size() / 4, 0.05f);
+	const Level second = Simplify(mesh, mesh.Indices.size() / 4, 0.05f);
+	CHECK(first.Indices.size() < mesh.Indices.size());
+	CHECK(first.Indices == second.Indices);
+	CHECK_EQUAL(first.Error, second.Error);
+}
+
+TEST(SimplifierLevelsShrinkWithinTheirError)
+{
+	const TestMesh mesh = MakeTerrain(48);
+	const float targetError = 0.01f;
+
+	size_t previousCount = mesh.Indices.size();
+	float previousError = 0.0f;
+	for (size_t target = mesh.Indices.size() / 2; target >= 96; target /= 2)
+	{
+		const Level level = Simplify(mesh, target / 3 * 3, targetError);
+		CHECK_EQUAL(level.Indices.size() % 3, 0u);
+		CHECK(level.Indices.size() <= previousCount);
+		CHECK(level.Error <= targetError);
+		CHECK(level.Error >= previousError);
+
+		// The surface stays within a few times the quadric error of every source vertex
+		size_t sampled = 0;
+		for (size_t v = 0; v < mesh.GetVertexCount(); v++)
+		{
+			const float* position = &mesh.Positions[v * 3];
+			float height;
+			if (!SampleHeight(mesh, level, position[0], position[2], height))
+				continue;
+			sampled++;
+			CHECK(std::fabs(height - position[1]) <= 3.0f * targetError);
+		}
+		CHECK_EQUAL(sampled, mesh.GetVertexCount());
+
+		previousCount = level.Indices.size();
+		previousError = level.Error;
+	}
+	CHECK(previousCount < mesh.Indices.size() / 4);
+
+	// No budget for error keeps every collapse that costs something
+	const Level exact = Simplify(mesh, 0, 0.0f);
+	CHECK_EQUAL(exact.Error, 0.0f);
+	CHECK(exact.Indices.size() > mesh.Indices.size() / 2);
+}
+
+TEST(SimplifierKeepsBordersAndSeams)
+{
+	const TestMesh mesh = MakeTerrain(32);
+	const Level level = Simplify(mesh, 0, 1.0f);
+	CHECK(level.Indices.size() < mesh.Indices.size() / 4);
+
+	std::vector<bool> used(mesh.GetVertexCount(), false);
+	for (uint32_t index : level.Indices)
+		used[index] = true;
+	for (uint32_t locked : mesh.Locked)
+		CHECK(used[locked]);
+
+	// None folds over. Triangles spanning three vertices of one border edge stand upright, with no area seen from above.
+	for (size_t i = 0; i < level.Indices.size(); i += 3)
+	{
+		const float* a = &mesh.Positions[level.Indices[i] * 3];
+		const float* b = &mesh.Positions[level.Indices[i + 1] * 3];
+		const float* c = &mesh.Positions[level.Indices[i + 2] * 3];
+		const float normalY = (c[0] - a[0]) * (b[2] - a[2]) - (b[0] - a[0]) * (c[2] - a[2]);
+		CHECK(normalY >= 0.0f);
+	}
+}
+
+TEST(SimplifierSelectsCoarserLevelsFartherAway)
+{
+	const Simplifier::LevelOfDetail levels[] = { { 0, 3000, 0.0f }, { 3000, 1500, 0.01f }, { 4500, 700, 0.04f }, { 5200, 300, 0.2f } };
+	const float pixelsPerUnit = 1000.0f, thresholdPixels = 1.0f;
+
+	CHECK_EQUAL(Simplifier::SelectLevel(levels, 4, 1.0f, pixelsPerUnit, thresholdPixels), 0u);
+	CHECK_EQUAL(Simplifier::SelectLevel(levels, 4, 10.0f, pixelsPerUnit, thresholdPixels), 1u);
+	CHECK_EQUAL(Simplifier::SelectLevel(levels, 4, 40.0f, pixelsPerUnit, thresholdPixels), 2u);
+	CHECK_EQUAL(Simplifier::SelectLevel(levels, 4, 1000.0f, pixelsPerUnit, thresholdPixels), 3u);
+	CHECK_EQUAL(Simplifier::SelectLevel(levels, 1, 1000.0f, pixelsPerUnit, thresholdPixels), 0u);
+
+	size_t previous = 0;
+	for (float distance = 0.0f; distance < 500.0f; distance += 0.5f)
+	{
+		const size_t selected = Simplifier::SelectLevel(levels, 4, distance, pixelsPerUnit, thresholdPixels);
+		CHECK(selected >= previous);
+		CHECK(levels[selected].Error * pixelsPerUnit / std::max(distance, 1e-4f) <= thresholdPixels);
+		previous = selected;
+	}
+}
+
+BENCHMARK(SimplifierThroughput)
+{
+	// About 130k triangles, simplified into halving levels as Mesh::BuildLevelsOfDetail does
+	const TestMesh mesh = MakeTerrain(256);
+	size_t target = mesh.Indices.size();
+	for (int i = 1; i < 6; i++)
+	{
+		target = target / 2 / 3 * 3;
+		Level level;
+		const double milliseconds = Test::Measure([&]() { level = Simplify(mesh, target, 0.01f); }, 1);
+
+		char label[64];
+		std::snprintf(label, sizeof(label), "level %d", i);
+		Test::Report(label, milliseconds);
+		std::printf("    %zu -> %zu triangles, error %.5f\n", mesh.Indices.size() / 3, level.Indices.size() / 3, level.Error);
+		CHECK(level.Error <= 0.01f);
+	}
+}
\ No newline at end of file
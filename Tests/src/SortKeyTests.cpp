@@ -0,0 +1,167 @@
+#include "Test.h"
+#include "Rendering/RenderGraph/SortKey.h"
+
+#include <numeric>
+#include <random>
+
+namespace
+{
+	std::vector<uint32_t> ReferenceOrder(const std::vector<uint64_t>& keys)
+	{
+		std::vector<uint32_t> order(keys.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+		return order;
+	}
+
+	void CheckMatchesReference(const std::vector<uint64_t>& input)
+	{
+		std::vector<uint64_t> keys = input, scratchKeys;
+		std::vector<uint32_t> order(keys.size()), scratchOrder;
+		std::iota(order.begin(), order.end(), 0u);
+
+		RadixSort(keys, order, scratchKeys, scratchOrder);
+		CHECK(order == ReferenceOrder(input));
+		CHECK(std::is_sorted(keys.begin(), keys.end()));
+	}
+
+	std::vector<SortKeyInput> RandomDraws(size_t count, uint32_t seed)
+	{
+		std::mt19937_64 generator(seed);
+		std::vector<SortKeyInput> draws(count);
+		for (auto& draw : draws)
+		{
+			draw.Layer = uint8_t(generator() % 3);
+			draw.Translucent = generator() % 8 == 0;
+			draw.Program = generator() % 16 * 0x9E3779B97F4A7C15ull;
+			draw.Material = generator() % 200 * 0xC2B2AE3D27D4EB4Full;
+			draw.Depth = float(generator() % 100000) * 0.01f;
+		}
+		return draws;
+	}
+}
+
+TEST(SortKeyRadixSortIsStable)
+{
+	CheckMatchesReference({});
+	CheckMatchesReference({ 5 });
+
+	// Few distinct keys, so stability decides most of the order
+	std::mt19937_64 generator(7);
+	std::vector<uint64_t> keys(10000);
+	for (auto& key : keys)
+		key = (generator() % 5) << 40 | (generator() % 3);
+	CheckMatchesReference(keys);
+
+	// Only the top digit differs, every other pass is skipped
+	for (auto& key : keys)
+		key = (generator() % 256) << 56 | 0x0011223344556677ull;
+	CheckMatchesReference(keys);
+
+	for (auto& key : keys)
+		key = generator();
+	CheckMatchesReference(keys);
+}
+
+TEST(SortKeyStateFirstOrder)
+{
+	const SortKeyLayout layout = SortKeyLayout::StateFirst();
+	SortKeyInput base;
+	base.Program = 11;
+	base.Material = 3;
+	base.Depth = 5.0f;
+
+	SortKeyInput nearer = base, farther = base, otherLayer = base, translucent = base;
+	nearer.Depth = 1.0f;
+	farther.Depth = 50.0f;
+	otherLayer.Layer = 1;
+	otherLayer.Depth = 0.0f;
+	translucent.Translucent = true;
+
+	// Opaque front to back within a program and material, layers first, translucency after opaque
+	CHECK(layout.Pack(nearer) < layout.Pack(base));
+	CHECK(layout.Pack(base) < layout.Pack(farther));
+	CHECK(layout.Pack(farther) < layout.Pack(translucent));
+	CHECK(layout.Pack(translucent) < layout.Pack(otherLayer));
+
+	// Translucent back to front
+	SortKeyInput translucentNear = translucent, translucentFar = translucent;
+	translucentNear.Depth = 1.0f;
+	translucentFar.Depth = 50.0f;
+	CHECK(layout.Pack(translucentFar) < layout.Pack(translucentNear));
+
+	// Negative depth behaves like zero
+	SortKeyInput behind = base;
+	behind.Depth = -3.0f;
+	base.Depth = 0.0f;
+	CHECK_EQUAL(layout.Pack(behind), layout.Pack(base));
+}
+
+TEST(SortKeyGroupsDrawsByState)
+{
+	const auto draws = RandomDraws(5000, 8);
+	const SortKeyLayout layout = SortKeyLayout::StateFirst();
+
+	std::vector<uint64_t> keys, scratchKeys;
+	std::vector<uint32_t> order(draws.size()), scratchOrder;
+	for (const auto& draw : draws)
+		keys.push_back(layout.Pack(draw));
+	std::iota(order.begin(), order.end(), 0u);
+	RadixSort(keys, order, scratchKeys, scratchOrder);
+
+	// Every opaque program runs as one contiguous block per layer
+	size_t programChanges = 0;
+	for (size_t i = 1; i < order.size(); i++)
+	{
+		const auto& previous = draws[order[i - 1]];
+		const auto& current = draws[order[i]];
+		CHECK(previous.Layer <= current.Layer);
+		if (previous.Layer == current.Layer && !previous.Translucent && !current.Translucent)
+		{
+			if (previous.Program != current.Program)
+				programChanges++;
+			else if (previous.Material == current.Material)
+				CHECK(previous.Depth <= current.Depth);
+		}
+	}
+	CHECK(programChanges <= 3 * 15);
+}
+
+TEST(SortKeyUnsortedKeepsSubmissionOrder)
+{
+	const auto draws = RandomDraws(1000, 9);
+	const SortKeyLayout layout = SortKeyLayout::Unsorted();
+
+	std::vector<uint64_t> keys, scratchKeys;
+	std::vector<uint32_t> order(draws.size()), scratchOrder;
+	for (const auto& draw : draws)
+		keys.push_back(layout.Pack(draw));
+	std::iota(order.begin(), order.end(), 0u);
+	RadixSort(keys, order, scratchKeys, scratchOrder);
+
+	for (uint32_t i = 0; i < order.size(); i++)
+		CHECK_EQUAL(order[i], i);
+}
+
+BENCHMARK(SortKeyRadixSortThroughput)
+{
+	const auto draws = RandomDraws(100000, 10);
+	const SortKeyLayout layout = SortKeyLayout::StateFirst();
+	std::vector<uint64_t> input;
+	for (const auto& draw : draws)
+		input.push_back(layout.Pack(draw));
+
+	std::vector<uint64_t> keys, scratchKeys;
+	std::vector<uint32_t> order, scratchOrder;
+	Test::Report("RadixSort", Test::Measure([&]()
+	{
+		keys = input;
+		order.resize(keys.size());
+		std::iota(order.begin(), order.end(), 0u);
+		RadixSort(keys, order, scratchKeys, scratchOrder);
+	}));
+
+	std::vector<uint32_t> reference;
+	Test::Report("std::stable_sort", Test::Measure([&]() { reference = ReferenceOrder(input); }));
+	CHECK(order == reference);
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "Test.h"
+#include "Rendering/DeviceBackend.h"
+
+#include <cstdint>
+
+namespace
+{
+	// Stand-ins for device objects, only their addresses matter
+	void* Object(uintptr_t id)
+	{
+		return reinterpret_cast<void*>(id << 4);
+	}
+
+	constexpr uint32_t TriangleList = 4;
+	constexpr uint32_t R32Uint = 42;
+
+	constexpr uint32_t Meshes = 30;
+	constexpr uint32_t MeshesPerMaterial = 10;
+	// Nine binding commands, SetVertexBuffer binds the buffer and the topology
+	constexpr uint32_t TrackedCallsPerDraw = 10;
+
+	// A pass drawing Meshes meshes sorted by material, every draw binding its full state the way Task did
+	CommandList RecordSortedPass()
+	{
+		CommandList list;
+		for (uint32_t mesh = 0; mesh < Meshes; mesh++)
+		{
+			const uint32_t material = mesh / MeshesPerMaterial;
+			list.SetVertexBuffer(Object(100 + mesh), 32, TriangleList);
+			list.SetIndexBuffer(Object(200 + mesh), R32Uint);
+			list.SetInputLayout(Object(1));
+			list.SetVertexShader(Object(2));
+			list.SetPixelShader(Object(3));
+			list.VSSetConstantBuffer(0, Object(4));
+			list.PSSetConstantBuffer(0, Object(300 + material));
+			list.PSSetShaderResource(0, Object(400 + material));
+			list.PSSetSampler(0, Object(5));
+			list.DrawIndexed(36, 0);
+		}
+		return list;
+	}
+}
+
+TEST(StateTrackerFiltersRepeatedBindings)
+{
+	StateTracker tracker;
+	CHECK(tracker.SetShader(StateTracker::PixelStage, Object(1)));
+	CHECK(!tracker.SetShader(StateTracker::PixelStage, Object(1)));
+	// Stages and slots are tracked separately
+	CHECK(tracker.SetShader(StateTracker::VertexStage, Object(1)));
+	CHECK(tracker.SetSampler(StateTracker::PixelStage, 0, Object(2)));
+	CHECK(tracker.SetSampler(StateTracker::PixelStage, 1, Object(2)));
+
+	// A different range of the same constant buffer is a different binding
+	CHECK(tracker.SetConstantBuffer(StateTracker::VertexStage, 1, Object(3)));
+	CHECK(tracker.SetConstantBuffer(StateTracker::VertexStage, 1, Object(3), 16, 16));
+	CHECK(!tracker.SetConstantBuffer(StateTracker::VertexStage, 1, Object(3), 16, 16));
+
+	// Unbinding is state too
+	CHECK(tracker.SetShaderResource(StateTracker::PixelStage, 2, nullptr));
+	CHECK(!tracker.SetShaderResource(StateTracker::PixelStage, 2, nullptr));
+
+	CHECK_EQUAL(tracker.GetIssued(), 7u);
+	CHECK_EQUAL(tracker.GetFiltered(), 3u);
+
+	tracker.ResetCounters();
+	CHECK_EQUAL(tracker.GetIssued(), 0u);
+	CHECK_EQUAL(tracker.GetFiltered(), 0u);
+}
+
+TEST(StateTrackerInvalidation)
+{
+	StateTracker tracker;
+	tracker.SetInputLayout(Object(1));
+	tracker.SetShaderResource(StateTracker::PixelStage, 0, Object(2));
+
+	tracker.InvalidateShaderResources();
+	CHECK(!tracker.SetInputLayout(Object(1)));
+	CHECK(tracker.SetShaderResource(StateTracker::PixelStage, 0, Object(2)));
+
+	tracker.Invalidate();
+	CHECK(tracker.SetInputLayout(Object(1)));
+	CHECK(tracker.SetShaderResource(StateTracker::PixelStage, 0, Object(2)));
+
+	// Slots past the tracked range always reach the device
+	CHECK(tracker.SetSampler(StateTracker::PixelStage, StateTracker::SamplerSlots, Object(3)));
+	CHECK(tracker.SetSampler(StateTracker::PixelStage, StateTracker::SamplerSlots, Object(3)));
+	CHECK(tracker.SetVertexBuffer(StateTracker::VertexBufferSlots, Object(4), 12, 0));
+	CHECK(tracker.SetVertexBuffer(StateTracker::VertexBufferSlots, Object(4), 12, 0));
+}
+
+TEST(StateTrackerReplaysRecordedFrames)
+{
+	const CommandList pass = RecordSortedPass();
+	NullBackend backend;
+	const StateTracker& tracker = backend.GetStateTracker();
+
+	backend.BeginFrame();
+	backend.Submit(pass);
+
+	// The first draw binds everything. Every later one rebinds its vertex and index buffer,
+	// and the two material changes rebind the material constant buffer and texture.
+	const size_t firstFrameIssued = TrackedCallsPerDraw + (Meshes - 1) * 2 + (Meshes / MeshesPerMaterial - 1) * 2;
+	CHECK_EQUAL(tracker.GetIssued(), firstFrameIssued);
+	CHECK_EQUAL(tracker.GetIssued() + tracker.GetFiltered(), Meshes * TrackedCallsPerDraw);
+	CHECK_EQUAL(backend.GetDrawCount(), Meshes);
+	CHECK_EQUAL(backend.GetIndexCount(), Meshes * 36u);
+	CHECK_EQUAL(backend.GetCommandCount(), pass.Size());
+
+	// Without a new frame the state carries over, the first draw only changes buffers and material
+	backend.Submit(pass);
+	const size_t carriedOverIssued = 4 + (Meshes - 1) * 2 + (Meshes / MeshesPerMaterial - 1) * 2;
+	CHECK_EQUAL(tracker.GetIssued(), firstFrameIssued + carriedOverIssued);
+
+	// BeginFrame forgets the state left by the previous frame
+	backend.BeginFrame();
+	backend.Submit(pass);
+	CHECK_EQUAL(tracker.GetIssued(), 2 * firstFrameIssued + carriedOverIssued);
+	CHECK_EQUAL(tracker.GetIssued() + tracker.GetFiltered(), 3 * Meshes * TrackedCallsPerDraw);
+}
+
+TEST(StateTrackerSkipsCallbacks)
+{
+	int calls = 0;
+	CommandList list;
+	list.Callback([](const void* counter, uint32_t) { ++*static_cast<int*>(const_cast<void*>(counter)); }, &calls);
+	list.DrawIndexedInstanced(6, 10);
+
+	NullBackend backend;
+	backend.Submit(list);
+	CHECK_EQUAL(calls, 0);
+	CHECK_EQUAL(backend.GetSkippedCallbackCount(), 1u);
+	CHECK_EQUAL(backend.GetDrawCount(), 1u);
+	CHECK_EQUAL(backend.GetIndexCount(), 60u);
+	CHECK_EQUAL(backend.GetStateTracker().GetIssued(), 0u);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Self registering test and benchmark cases, run by Main.cpp. Benchmarks only run with --bench.
+namespace Test
+{
+	struct Case
+	{
+		const char* Name;
+		void (*Function)();
+		bool IsBenchmark;
+	};
+
+	std::vector<Case>& GetCases();
+	// Marks the running case as failed and keeps going
+	void Fail(const char* file, int line, const char* expression);
+
+	struct Registrar
+	{
+		Registrar(const char* name, void (*function)(), bool isBenchmark)
+		{
+			GetCases().push_back({ name, function, isBenchmark });
+		}
+	};
+
+	// Fastest of repetitions runs of function, in milliseconds
+	template<typename F>
+	double Measure(F&& function, int repetitions = 5)
+	{
+		double best = 1e30;
+		for (int i = 0; i < repetitions; i++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count());
+		}
+		return best;
+	}
+
+	inline void Report(const char* label, double milliseconds)
+	{
+		std::printf("    %-40s %10.3f ms\n", label, milliseconds);
+	}
+}
+
+#define TEST_CASE(name, isBenchmark) \
+	static void name(); \
+	static Test::Registrar name##Registrar(#name, name, isBenchmark); \
+	static void name()
+
+#define TEST(name) TEST_CASE(name, false)
+#define BENCHMARK(name) TEST_CASE(name, true)
+
+#define CHECK(x) do { if (!(x)) Test::Fail(__FILE__, __LINE__, #x); } while (0)
+#define CHECK_EQUAL(a, b) CHECK((a) == (b))
+#define CHECK_THROWS(x) do { bool thrown = false; try { x; } catch (...) { thrown = true; } \
+	if (!thrown) Test::Fail(__FILE__, __LINE__, #x " throws"); } while (0)
+#define CHECK_NEAR(a, b, tolerance) CHECK(std::fabs(double(a) - double(b)) <= double(tolerance))
\ No newline at end of file
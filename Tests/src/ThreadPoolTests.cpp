@@ -0,0 +1,83 @@
+#include "Test.h"
+#include "Core/ThreadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+
+TEST(ThreadPoolChunksCoverRangeInOrder)
+{
+	const size_t concurrency = ThreadPool::GetConcurrency();
+	CHECK(concurrency >= 1);
+	CHECK_EQUAL(ThreadPool::GetChunkCount(0, 1), 0u);
+	CHECK_EQUAL(ThreadPool::GetChunkCount(10, 100), 1u);
+	CHECK_EQUAL(ThreadPool::GetChunkCount(1000000, 1), concurrency);
+
+	for (size_t count : { size_t(1), size_t(7), size_t(1000), size_t(12345) })
+	{
+		const size_t chunks = ThreadPool::GetChunkCount(count, 16);
+		std::vector<std::pair<size_t, size_t>> ranges(chunks, { ~size_t(0), 0 });
+		std::vector<std::atomic<int>> visits(count);
+		ThreadPool::ParallelFor(count, 16, [&](size_t chunk, size_t begin, size_t end)
+								{
+									ranges[chunk] = { begin, end };
+									for (size_t i = begin; i < end; i++)
+										visits[i]++;
+								});
+
+		// Contiguous, ascending with the chunk index, every index exactly once
+		size_t expectedBegin = 0;
+		for (const auto& [begin, end] : ranges)
+		{
+			CHECK_EQUAL(begin, expectedBegin);
+			CHECK(end > begin);
+			expectedBegin = end;
+		}
+		CHECK_EQUAL(expectedBegin, count);
+		for (const auto& visit : visits)
+			CHECK_EQUAL(visit.load(), 1);
+	}
+}
+
+TEST(ThreadPoolNestedRegionsComplete)
+{
+	std::atomic<size_t> sum = 0;
+	ThreadPool::ParallelFor(64, 1, [&sum](size_t, size_t begin, size_t end)
+							{
+								for (size_t i = begin; i < end; i++)
+									ThreadPool::ParallelFor(256, 4, [&sum](size_t, size_t innerBegin, size_t innerEnd)
+															{
+																for (size_t j = innerBegin; j < innerEnd; j++)
+																	sum += j;
+															});
+							});
+	CHECK_EQUAL(sum.load(), 64u * (255u * 256u / 2));
+}
+
+TEST(ThreadPoolRethrowsAfterAllChunks)
+{
+	// Whichever chunk throws, the others run to completion before ParallelFor returns
+	const size_t chunks = ThreadPool::GetChunkCount(1000, 1);
+	for (size_t thrower : { size_t(0), chunks / 2, chunks - 1 })
+	{
+		std::atomic<size_t> visited = 0;
+		CHECK_THROWS(ThreadPool::ParallelFor(1000, 1, [&](size_t chunk, size_t begin, size_t end)
+											 {
+												 if (chunk == thrower)
+													 throw std::runtime_error("chunk failed");
+												 for (size_t i = begin; i < end; i++)
+													 visited++;
+											 }));
+
+		const size_t skipped = 1000 * (thrower + 1) / chunks - 1000 * thrower / chunks;
+		CHECK_EQUAL(visited.load(), 1000 - skipped);
+	}
+
+	// The pool keeps working afterwards
+	std::atomic<size_t> sum = 0;
+	ThreadPool::ParallelFor(100, 1, [&sum](size_t, size_t begin, size_t end)
+							{
+								for (size_t i = begin; i < end; i++)
+									sum += i;
+							});
+	CHECK_EQUAL(sum.load(), 4950u);
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "Test.h"
+#include "Rendering/TransformHierarchy.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <random>
+
+namespace
+{
+	using DirectX::XMMATRIX;
+
+	// Two models of four levels, A - C - E - H the deepest branch
+	enum Node : uint32_t { A, B, C, D, E, F, G, H, NodeCount };
+	constexpr uint32_t NodeParents[NodeCount] = { TransformHierarchy::NoParent, TransformHierarchy::NoParent, A, A, C, D, B, E };
+
+	// Parents first either way, the subtree of C is contiguous in one order only
+	constexpr Node DepthFirst[NodeCount] = { A, C, E, H, D, F, B, G };
+	constexpr Node BreadthFirst[NodeCount] = { A, B, C, D, G, E, F, H };
+
+	XMMATRIX MakeTransform(std::mt19937& generator)
+	{
+		std::uniform_real_distribution<float> angle(-3.0f, 3.0f), offset(-10.0f, 10.0f);
+		return DirectX::XMMatrixRotationRollPitchYaw(angle(generator), angle(generator), angle(generator)) *
+			DirectX::XMMatrixTranslation(offset(generator), offset(generator), offset(generator));
+	}
+
+	struct Scene
+	{
+		XMMATRIX Locals[NodeCount];
+		XMMATRIX Root, View;
+
+		explicit Scene(uint32_t seed)
+		{
+			std::mt19937 generator(seed);
+			for (XMMATRIX& local : Locals)
+				local = MakeTransform(generator);
+			Root = MakeTransform(generator);
+			View = MakeTransform(generator);
+		}
+
+		// Parent times local up the logical tree, without the arrays of the hierarchy
+		XMMATRIX GetWorld(uint32_t node) const
+		{
+			const uint32_t parent = NodeParents[node];
+			return (parent == TransformHierarchy::NoParent ? Root : GetWorld(parent)) * Locals[node];
+		}
+	};
+
+	// Adds the nodes in order, returns where each logical node ended up
+	std::array<uint32_t, NodeCount> Build(TransformHierarchy& hierarchy, const Scene& scene, const Node* order, uint32_t dynamicNodes = 0)
+	{
+		std::array<uint32_t, NodeCount> index{};
+		hierarchy.Reset(NodeCount);
+		for (const Node* node = order; node != order + NodeCount; node++)
+		{
+			const uint32_t parent = NodeParents[*node] == TransformHierarchy::NoParent ? TransformHierarchy::NoParent : index[NodeParents[*node]];
+			index[*node] = hierarchy.Add(parent, scene.Locals[*node], !(dynamicNodes & (1u << *node)));
+		}
+		return index;
+	}
+
+	float GetDifference(const DirectX::XMFLOAT4X4A& actual, const XMMATRIX& expected)
+	{
+		DirectX::XMFLOAT4X4 matrix;
+		DirectX::XMStoreFloat4x4(&matrix, expected);
+		float difference = 0.0f;
+		for (int row = 0; row < 4; row++)
+			for (int column = 0; column < 4; column++)
+				difference = std::max(difference, std::abs(actual.m[row][column] - matrix.m[row][column]));
+		return difference;
+	}
+
+	// Bit per logical node that is static
+	uint32_t GetStaticNodes(const TransformHierarchy& hierarchy, const std::array<uint32_t, NodeCount>& index)
+	{
+		uint32_t nodes = 0;
+		for (uint32_t node = 0; node < NodeCount; node++)
+			nodes |= uint32_t(hierarchy.IsStatic(index[node])) << node;
+		return nodes;
+	}
+
+	constexpr uint32_t Bits(std::initializer_list<Node> nodes)
+	{
+		uint32_t bits = 0;
+		for (Node node : nodes)
+			bits |= 1u << node;
+		return bits;
+	}
+	constexpr uint32_t AllNodes = (1u << NodeCount) - 1;
+}
+
+TEST(TransformHierarchyWorldIsParentTimesLocal)
+{
+	Scene scene(91);
+	TransformHierarchy hierarchy;
+	const auto index = Build(hierarchy, scene, DepthFirst);
+	CHECK_EQUAL(hierarchy.Size(), size_t(NodeCount));
+	CHECK_EQUAL(hierarchy.GetParent(index[H]), index[E]);
+
+	hierarchy.Update(scene.Root, scene.View);
+	for (uint32_t node = 0; node < NodeCount; node++)
+	{
+		const XMMATRIX world = scene.GetWorld(node);
+		CHECK(GetDifference(hierarchy.GetWorld(index[node]), world) < 1e-4f);
+		CHECK(GetDifference(hierarchy.GetModelView(index[node]), world * scene.View) < 1e-4f);
+	}
+
+	// Moving C moves its subtree on the next update and nothing else
+	std::mt19937 generator(92);
+	scene.Locals[C] = MakeTransform(generator);
+	hierarchy.SetLocal(index[C], scene.Locals[C]);
+	const DirectX::XMFLOAT4X4A before = hierarchy.GetWorld(index[H]);
+	CHECK(GetDifference(before, scene.GetWorld(H)) > 1e-2f);
+
+	hierarchy.Update(scene.Root, scene.View);
+	for (uint32_t node = 0; node < NodeCount; node++)
+		CHECK(GetDifference(hierarchy.GetWorld(index[node]), scene.GetWorld(node)) < 1e-4f);
+}
+
+TEST(TransformHierarchyOrderIndependent)
+{
+	const Scene scene(93);
+	TransformHierarchy depthFirst, breadthFirst;
+	const auto depthIndex = Build(depthFirst, scene, DepthFirst);
+	const auto breadthIndex = Build(breadthFirst, scene, BreadthFirst);
+	depthFirst.Update(scene.Root, scene.View);
+	breadthFirst.Update(scene.Root, scene.View);
+
+	for (uint32_t node = 0; node < NodeCount; node++)
+	{
+		const DirectX::XMFLOAT4X4A& world = depthFirst.GetWorld(depthIndex[node]);
+		CHECK(GetDifference(breadthFirst.GetWorld(breadthIndex[node]), DirectX::XMLoadFloat4x4A(&world)) < 1e-5f);
+	}
+
+	// The same node turned dynamic takes the same subtree with it, whether that subtree is contiguous or not
+	for (uint32_t node = 0; node < NodeCount; node++)
+	{
+		depthFirst.SetStatic(depthIndex[node], false);
+		breadthFirst.SetStatic(breadthIndex[node], false);
+		CHECK_EQUAL(GetStaticNodes(depthFirst, depthIndex), GetStaticNodes(breadthFirst, breadthIndex));
+
+		depthFirst.SetStatic(depthIndex[node], true);
+		breadthFirst.SetStatic(breadthIndex[node], true);
+		CHECK_EQUAL(GetStaticNodes(breadthFirst, breadthIndex), AllNodes);
+	}
+}
+
+TEST(TransformHierarchyStaticFollowsAncestors)
+{
+	const Scene scene(94);
+	for (const Node* order : { DepthFirst, BreadthFirst })
+	{
+		// G and H added dynamic, everything else static
+		TransformHierarchy hierarchy;
+		const auto index = Build(hierarchy, scene, order, Bits({ G, H }));
+		CHECK_EQUAL(GetStaticNodes(hierarchy, index), AllNodes & ~Bits({ G, H }));
+
+		// A node that starts moving takes its subtree along, the other model keeps its state
+		hierarchy.SetStatic(index[C], false);
+		CHECK_EQUAL(GetStaticNodes(hierarchy, index), Bits({ A, B, D, F }));
+		hierarchy.SetStatic(index[A], false);
+		CHECK_EQUAL(GetStaticNodes(hierarchy, index), Bits({ B }));
+
+		// Marking it static again restores the subtree, except nodes marked dynamic themselves
+		hierarchy.SetStatic(index[A], true);
+		CHECK_EQUAL(GetStaticNodes(hierarchy, index), Bits({ A, B, D, F }));
+		hierarchy.SetStatic(index[C], true);
+		CHECK_EQUAL(GetStaticNodes(hierarchy, index), AllNodes & ~Bits({ G, H }));
+
+		// A node marked static under a dynamic parent stays dynamic until the parent is static too
+		hierarchy.SetStatic(index[E], false);
+		hierarchy.SetStatic(index[H], true);
+		CHECK(!hierarchy.IsStatic(index[H]));
+		hierarchy.SetStatic(index[E], true);
+		CHECK(hierarchy.IsStatic(index[H]));
+
+		// Moving a node is up to the caller, its static state stays what was marked
+		std::mt19937 generator(95);
+		hierarchy.SetLocal(index[D], MakeTransform(generator));
+		hierarchy.Update(scene.Root, scene.View);
+		CHECK(hierarchy.IsStatic(index[D]) && hierarchy.IsStatic(index[F]));
+	}
+}
+
+BENCHMARK(TransformHierarchyThroughput)
+{
+	// Models of a thousand nodes each, parents anywhere earlier in their model
+	constexpr size_t count = 100000, modelSize = 1000;
+	std::mt19937 generator(96);
+	TransformHierarchy hierarchy;
+	hierarchy.Reset(count);
+	std::vector<XMMATRIX> locals;
+	for (size_t node = 0; node < count; node++)
+	{
+		const size_t first = node - node % modelSize;
+		const uint32_t parent = node == first ? TransformHierarchy::NoParent :
+			static_cast<uint32_t>(std::uniform_int_distribution<size_t>(first, node - 1)(generator));
+		locals.push_back(MakeTransform(generator));
+		hierarchy.Add(parent, locals.back(), node % 7 != 0);
+	}
+
+	const Scene scene(97);
+	const double update = Test::Measure([&]() { hierarchy.Update(scene.Root, scene.View); });
+	Test::Report("TransformHierarchy::Update 100k nodes", update);
+	std::printf("    %.1f ns per node\n", update * 1e6 / count);
+
+	// What a node tree walked per mesh does, every node multiplying its way up to the root
+	std::vector<DirectX::XMFLOAT4X4A> walked(count);
+	Test::Report("walk to the root per node 100k", Test::Measure([&]()
+	{
+		for (size_t node = 0; node < count; node++)
+		{
+			XMMATRIX world = locals[node];
+			for (uint32_t parent = hierarchy.GetParent(static_cast<uint32_t>(node)); parent != TransformHierarchy::NoParent;
+				 parent = hierarchy.GetParent(parent))
+				world = locals[parent] * world;
+			DirectX::XMStoreFloat4x4A(&walked[node], scene.Root * world);
+		}
+	}, 1));
+
+	for (size_t node = 0; node < count; node += 997)
+	{
+		const DirectX::XMFLOAT4X4A& world = hierarchy.GetWorld(static_cast<uint32_t>(node));
+		CHECK(GetDifference(walked[node], DirectX::XMLoadFloat4x4A(&world)) < 1e-2f);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "Test.h"
+#include "Rendering/RenderGraph/GraphCompiler.h"
+#include "Rendering/RenderGraph/TransientPlanner.h"
+
+#include <map>
+#include <random>
+
+using TransientPlanner::Request;
+
+TEST(TransientPlannerAliasesDisjointLifetimes)
+{
+	// Two bloom targets alive one after the other and a depth buffer of another format
+	const std::vector<Request> requests = {
+		{ 1, 1024, 0, 1 },
+		{ 1, 1024, 2, 3 },
+		{ 2, 1024, 2, 2 },
+		// Starts where the second ends, both are in use during pass 3
+		{ 1, 1024, 3, 4 },
+	};
+
+	const auto plan = TransientPlanner::Build(requests);
+	CHECK_EQUAL(plan.Physical[0], plan.Physical[1]);
+	CHECK(plan.Physical[2] != plan.Physical[0]);
+	CHECK(plan.Physical[3] != plan.Physical[1]);
+	CHECK_EQUAL(plan.PhysicalBytes.size(), 3u);
+	CHECK_EQUAL(plan.RequestedBytes, 4096u);
+	CHECK_EQUAL(plan.AllocatedBytes, 3072u);
+
+	const auto empty = TransientPlanner::Build({});
+	CHECK(empty.Physical.empty());
+	CHECK_EQUAL(empty.AllocatedBytes, 0u);
+}
+
+TEST(TransientPlannerIsMinimalAndSafe)
+{
+	std::mt19937 generator(11);
+	for (int round = 0; round < 50; round++)
+	{
+		std::vector<Request> requests(1 + generator() % 60);
+		for (auto& request : requests)
+		{
+			request.Key = generator() % 3;
+			request.Bytes = (request.Key + 1) * 4096;
+			request.First = generator() % 20;
+			request.Last = request.First + generator() % 6;
+		}
+
+		const auto plan = TransientPlanner::Build(requests);
+		CHECK_EQUAL(plan.Physical.size(), requests.size());
+
+		uint64_t requested = 0, allocated = 0;
+		for (const auto& request : requests)
+			requested += request.Bytes;
+		for (uint64_t bytes : plan.PhysicalBytes)
+			allocated += bytes;
+		CHECK_EQUAL(plan.RequestedBytes, requested);
+		CHECK_EQUAL(plan.AllocatedBytes, allocated);
+
+		// Requests sharing an allocation have the same key and never overlap
+		for (size_t a = 0; a < requests.size(); a++)
+			for (size_t b = a + 1; b < requests.size(); b++)
+			{
+				if (plan.Physical[a] != plan.Physical[b])
+					continue;
+				CHECK_EQUAL(requests[a].Key, requests[b].Key);
+				CHECK(requests[a].Last < requests[b].First || requests[b].Last < requests[a].First);
+			}
+
+		// One allocation per key for every request alive at the busiest position, no more
+		std::map<uint64_t, uint32_t> peak, allocations;
+		for (uint32_t position = 0; position < 32; position++)
+		{
+			std::map<uint64_t, uint32_t> alive;
+			for (const auto& request : requests)
+				if (request.First <= position && position <= request.Last)
+					alive[request.Key]++;
+			for (const auto& [key, count] : alive)
+				peak[key] = std::max(peak[key], count);
+		}
+
+		std::vector<bool> counted(plan.PhysicalBytes.size(), false);
+		for (size_t i = 0; i < requests.size(); i++)
+			if (!counted[plan.Physical[i]])
+			{
+				counted[plan.Physical[i]] = true;
+				allocations[requests[i].Key]++;
+			}
+		CHECK(allocations == peak);
+	}
+}
+
+TEST(TransientPlannerFollowsCompiledLifetimes)
+{
+	// A chain of blur passes, each reading the previous target, ping-pongs between two allocations
+	GraphCompiler compiler;
+	std::vector<uint32_t> targets;
+	for (int i = 0; i < 6; i++)
+	{
+		const std::string name = "Blur" + std::to_string(i);
+		const uint32_t pass = compiler.AddPass(name);
+		if (i > 0)
+			compiler.AddRead(pass, "Blur" + std::to_string(i - 1), "target");
+		targets.push_back(compiler.AddResource(pass, "target"));
+	}
+	compiler.AddSink("Blur5", "target");
+
+	const auto compiled = compiler.Compile();
+	std::vector<Request> requests;
+	for (uint32_t target : targets)
+	{
+		const auto& lifetime = compiled.Lifetimes[compiled.Roots[target]];
+		requests.push_back({ 7, 1 << 20, lifetime.First, lifetime.Last });
+	}
+
+	const auto plan = TransientPlanner::Build(requests);
+	CHECK_EQUAL(plan.PhysicalBytes.size(), 2u);
+	for (size_t i = 2; i < requests.size(); i++)
+		CHECK_EQUAL(plan.Physical[i], plan.Physical[i - 2]);
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "Test.h"
+#include "Rendering/VertexArray.h"
+
+#include <cstring>
+#include <random>
+
+namespace
+{
+	using namespace VertexAttribute;
+	using LitLayout = StaticLayout<Position3, Normal, TexCoords>;
+	using PackedLayout = StaticLayout<PositionQuantized, NormalOct, TangentOct, TexCoordsHalf>;
+
+	static_assert(LitLayout::Count == 3);
+	static_assert(LitLayout::Stride == 32);
+	static_assert(LitLayout::Offsets[0] == 0 && LitLayout::Offsets[1] == 12 && LitLayout::Offsets[2] == 24);
+	static_assert(std::is_same_v<LitLayout::ElementAt<1>, Normal>);
+
+	static_assert(PackedLayout::Stride == 20);
+	static_assert(PackedLayout::Offsets[1] == 8 && PackedLayout::Offsets[2] == 12 && PackedLayout::Offsets[3] == 16);
+
+	struct LitStreams
+	{
+		std::vector<DirectX::XMFLOAT3> Positions, Normals;
+		std::vector<DirectX::XMFLOAT2> TexCoords;
+	};
+
+	LitStreams RandomStreams(size_t count, uint32_t seed)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+		LitStreams streams;
+		for (size_t i = 0; i < count; i++)
+		{
+			streams.Positions.push_back({ value(generator), value(generator), value(generator) });
+			streams.Normals.push_back({ value(generator), value(generator), value(generator) });
+			streams.TexCoords.push_back({ value(generator), value(generator) });
+		}
+		return streams;
+	}
+
+	BufferLayout MakeLitLayout()
+	{
+		using Element = LayoutElement::ElementType;
+		return BufferLayout{ { Element::Position3 }, { Element::Normal }, { Element::TexCoords } };
+	}
+
+	bool SameBytes(const char* a, size_t aSize, const char* b, size_t bSize)
+	{
+		return aSize == bSize && std::memcmp(a, b, aSize) == 0;
+	}
+}
+
+TEST(BufferLayoutMatchesStaticLayout)
+{
+	const BufferLayout layout = LitLayout::GetBufferLayout();
+	CHECK_EQUAL(layout.GetStride(), LitLayout::Stride);
+	CHECK_EQUAL(layout.GetElementsSize(), LitLayout::Count);
+	for (size_t i = 0; i < LitLayout::Count; i++)
+		CHECK_EQUAL(layout[i].GetOffset(), LitLayout::Offsets[i]);
+	// Position and normal share a data type
+	CHECK_EQUAL(layout.ResolveType<LayoutElement::ElementType::Normal>().GetOffset(), 12u);
+
+	const BufferLayout packed = PackedLayout::GetBufferLayout();
+	CHECK_EQUAL(packed.GetStride(), PackedLayout::Stride);
+	CHECK(packed[0].GetType() == LayoutElement::DataType::Short4Norm && packed[3].GetType() == LayoutElement::DataType::Half2);
+
+	BufferLayout added;
+	added.AddElement({ "Position", LayoutElement::DataType::Float3 }).AddElement({ "Color", LayoutElement::DataType::UChar4Norm });
+	CHECK_EQUAL(added.GetStride(), 16u);
+	CHECK_EQUAL(added[1].GetOffset(), 12u);
+}
+
+TEST(VertexArraysWriteTheSameBytes)
+{
+	// A count off the interleave block size
+	const size_t count = 1000;
+	const LitStreams streams = RandomStreams(count, 11);
+
+	VertexArray emplaced(MakeLitLayout()), interleaved(MakeLitLayout());
+	StaticVertexArray<LitLayout> staticEmplaced, staticInterleaved;
+	for (size_t i = 0; i < count; i++)
+	{
+		emplaced.EmplaceBack(streams.Positions[i], streams.Normals[i], streams.TexCoords[i]);
+		staticEmplaced.EmplaceBack(streams.Positions[i], streams.Normals[i], streams.TexCoords[i]);
+	}
+
+	// Appended in two calls, the second one continuing after the first
+	const size_t split = 300;
+	for (size_t offset : { size_t(0), split })
+	{
+		const size_t chunk = offset ? count - split : split;
+		const VertexStream position{ streams.Positions.data() + offset, sizeof(DirectX::XMFLOAT3) };
+		const VertexStream normal{ streams.Normals.data() + offset, sizeof(DirectX::XMFLOAT3) };
+		const VertexStream texCoord{ streams.TexCoords.data() + offset, sizeof(DirectX::XMFLOAT2) };
+		interleaved.Interleave({ position, normal, texCoord }, chunk);
+		staticInterleaved.Interleave({ position, normal, texCoord }, chunk);
+	}
+
+	CHECK_EQUAL(emplaced.Size(), count);
+	CHECK_EQUAL(staticEmplaced.Size(), count);
+	CHECK_EQUAL(staticInterleaved.Size(), count);
+	CHECK_EQUAL(staticEmplaced.GetByteSize(), count * LitLayout::Stride);
+
+	CHECK(std::memcmp(emplaced.Data() + 5 * LitLayout::Stride + LitLayout::Offsets[2], &streams.TexCoords[5], 8) == 0);
+	CHECK(SameBytes(emplaced.Data(), emplaced.GetByteSize(), staticEmplaced.Data(), staticEmplaced.GetByteSize()));
+	CHECK(SameBytes(emplaced.Data(), emplaced.GetByteSize(), interleaved.Data(), interleaved.GetByteSize()));
+	CHECK(SameBytes(emplaced.Data(), emplaced.GetByteSize(), staticInterleaved.Data(), staticInterleaved.GetByteSize()));
+}
+
+TEST(VertexArraysRemap)
+{
+	const size_t count = 500;
+	const LitStreams streams = RandomStreams(count, 12);
+
+	VertexArray dynamic(MakeLitLayout());
+	StaticVertexArray<LitLayout> fixed;
+	for (size_t i = 0; i < count; i++)
+	{
+		dynamic.EmplaceBack(streams.Positions[i], streams.Normals[i], streams.TexCoords[i]);
+		fixed.EmplaceBack(streams.Positions[i], streams.Normals[i], streams.TexCoords[i]);
+	}
+
+	// Reversed, with every third vertex dropped
+	std::vector<uint32_t> remap(count, ~0u);
+	uint32_t kept = 0;
+	for (size_t i = count; i-- > 0;)
+	{
+		if (i % 3 != 0)
+			remap[i] = kept++;
+	}
+
+	dynamic.Remap(remap, kept);
+	fixed.Remap(remap, kept);
+	CHECK_EQUAL(dynamic.Size(), kept);
+	CHECK_EQUAL(fixed.Size(), kept);
+	CHECK(SameBytes(dynamic.Data(), dynamic.GetByteSize(), fixed.Data(), fixed.GetByteSize()));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (remap[i] == ~0u)
+			continue;
+		CHECK(std::memcmp(fixed.Data() + remap[i] * LitLayout::Stride, &streams.Positions[i], 12) == 0);
+	}
+}
+
+BENCHMARK(VertexArrayThroughput)
+{
+	constexpr size_t count = 5000000;
+	const LitStreams streams = RandomStreams(count, 13);
+	const VertexStream position{ streams.Positions.data(), sizeof(DirectX::XMFLOAT3) };
+	const VertexStream normal{ streams.Normals.data(), sizeof(DirectX::XMFLOAT3) };
+	const VertexStream texCoord{ streams.TexCoords.data(), sizeof(DirectX::XMFLOAT2) };
+
+	// What VertexBufferBuilder does before the upload: a switch on the element type per attribute
+	VertexArray dynamic(MakeLitLayout());
+	Test::Report("VertexArray::EmplaceBack 5M", Test::Measure([&]()
+	{
+		dynamic = VertexArray(MakeLitLayout());
+		for (size_t i = 0; i < count; i++)
+			dynamic.EmplaceBack(streams.Positions[i], streams.Normals[i], streams.TexCoords[i]);
+	}, 3));
+
+	StaticVertexArray<LitLayout> emplaced;
+	Test::Report("StaticVertexArray::EmplaceBack 5M", Test::Measure([&]()
+	{
+		emplaced = {};
+		emplaced.Reserve(count);
+		for (size_t i = 0; i < count; i++)
+			emplaced.EmplaceBack(streams.Positions[i], streams.Normals[i], streams.TexCoords[i]);
+	}, 3));
+
+	StaticVertexArray<LitLayout> interleaved;
+	Test::Report("StaticVertexArray::Interleave 5M", Test::Measure([&]()
+	{
+		interleaved = {};
+		interleaved.Interleave({ position, normal, texCoord }, count);
+	}, 3));
+
+	CHECK(SameBytes(dynamic.Data(), dynamic.GetByteSize(), emplaced.Data(), emplaced.GetByteSize()));
+	CHECK(SameBytes(dynamic.Data(), dynamic.GetByteSize(), interleaved.Data(), interleaved.GetByteSize()));
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "Test.h"
+#include "Rendering/VertexLayout.h"
+
+#include <cstring>
+
+namespace
+{
+	using LitLayout = StaticLayout<VertexAttribute::Position3, VertexAttribute::Normal, VertexAttribute::TexCoords>;
+	using PackedLayout = StaticLayout<VertexAttribute::PositionQuantized, VertexAttribute::NormalOct,
+									  VertexAttribute::TangentOct, VertexAttribute::TexCoordsHalf>;
+
+	constexpr auto LitDescriptors = GetInputDescriptors<LitLayout>();
+	static_assert(LitDescriptors[2].AlignedByteOffset == 24);
+	static_assert(LitDescriptors[2].Format == DXGI_FORMAT_R32G32_FLOAT);
+}
+
+TEST(StaticLayoutInputDescriptors)
+{
+	const auto descriptors = GetInputDescriptors<PackedLayout>();
+	const char* semantics[] = { "Position", "Normal", "Tangent", "TexCoords" };
+	const DXGI_FORMAT formats[] = { DXGI_FORMAT_R16G16B16A16_SNORM, DXGI_FORMAT_R16G16_SNORM,
+									DXGI_FORMAT_R16G16_SNORM, DXGI_FORMAT_R16G16_FLOAT };
+
+	for (size_t i = 0; i < descriptors.size(); i++)
+	{
+		CHECK(std::strcmp(descriptors[i].SemanticName, semantics[i]) == 0);
+		CHECK_EQUAL(descriptors[i].Format, formats[i]);
+		CHECK_EQUAL(descriptors[i].AlignedByteOffset, PackedLayout::Offsets[i]);
+		CHECK_EQUAL(descriptors[i].InputSlot, 0u);
+		CHECK_EQUAL(descriptors[i].InputSlotClass, D3D11_INPUT_PER_VERTEX_DATA);
+	}
+}
\ No newline at end of file
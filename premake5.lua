@@ -1,7 +1,17 @@
+newoption
+{
+    trigger = "directxmath",
+    value = "PATH",
+    description = "DirectXMath headers, plus a sal.h, for building the culling tests outside Windows"
+}
+
 workspace "DXRenderer"
     architecture "x64"
     startproject "DXRenderer"
-    toolset "v143"
+
+    filter "action:vs*"
+        toolset "v143"
+    filter {}
 
     configurations
     {
@@ -95,3 +105,96 @@ project "DXRenderer"
         defines{
             "NDEBUG"
         }
+
+project "Tests"
+    location "Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++latest"
+    staticruntime "on"
+
+    targetdir ("bin/" .. OutputDir .. "/%{prj.name}")
+    objdir ("bin-int/" .. OutputDir .. "/%{prj.name}")
+
+    includedirs
+    {
+        "%{prj.name}/src",
+        "DXRenderer/src"
+    }
+
+    files
+    {
+        "%{prj.name}/src/**.h",
+        "%{prj.name}/src/**.cpp",
+        "DXRenderer/src/Rendering/Interleave.cpp",
+        "DXRenderer/src/Rendering/Quantization.cpp",
+        "DXRenderer/src/Rendering/MeshOptimizer.cpp",
+        "DXRenderer/src/Rendering/RingAllocator.cpp",
+        "DXRenderer/src/Rendering/ResourceHandle.cpp",
+        "DXRenderer/src/Rendering/RenderGraph/SortKey.cpp",
+        "DXRenderer/src/Rendering/StateTracker.cpp",
+        "DXRenderer/src/Rendering/CommandList.cpp",
+        "DXRenderer/src/Rendering/NullBackend.cpp",
+        "DXRenderer/src/Rendering/RenderGraph/GraphCompiler.cpp",
+        "DXRenderer/src/Rendering/RenderGraph/TransientPlanner.cpp",
+        "DXRenderer/src/Core/ThreadPool.cpp",
+        "DXRenderer/src/Rendering/Meshlets.cpp",
+        "DXRenderer/src/Rendering/Culling.cpp",
+        "DXRenderer/src/Rendering/BoundingVolumeHierarchy.cpp",
+        "DXRenderer/src/Rendering/Simplifier.cpp",
+        "DXRenderer/src/Rendering/Occlusion.cpp",
+        "DXRenderer/src/Rendering/Lights/LightClusters.cpp",
+        "DXRenderer/src/Rendering/Lights/Attenuation.cpp",
+        "DXRenderer/src/Rendering/Lights/ShadowCube.cpp",
+        "DXRenderer/src/Rendering/VertexArray.cpp",
+        "DXRenderer/src/Rendering/TransformHierarchy.cpp",
+        "DXRenderer/src/Rendering/DrawPacket.cpp"
+    }
+
+    filter "system:windows"
+        includedirs { "DXRenderer/vendor/DXErr" }
+
+    -- Tests of D3D11 types only compile against the Windows SDK
+    filter "system:not windows"
+        removefiles
+        {
+            "%{prj.name}/src/VertexLayoutTests.cpp",
+            "%{prj.name}/src/DrawPacketTests.cpp",
+            "DXRenderer/src/Rendering/DrawPacket.cpp"
+        }
+        links { "pthread" }
+    filter {}
+
+    -- DirectXMath comes with the Windows SDK, elsewhere the culling, BVH, vertex array, shadow cube and transform hierarchy tests need it from --directxmath
+    if not os.istarget("windows") then
+        if _OPTIONS["directxmath"] then
+            includedirs { _OPTIONS["directxmath"] }
+        else
+            removefiles
+            {
+                "%{prj.name}/src/CullingTests.cpp",
+                "%{prj.name}/src/BoundingVolumeHierarchyTests.cpp",
+                "%{prj.name}/src/VertexArrayTests.cpp",
+                "%{prj.name}/src/ShadowCubeTests.cpp",
+                "%{prj.name}/src/TransformHierarchyTests.cpp",
+                "DXRenderer/src/Rendering/Culling.cpp",
+                "DXRenderer/src/Rendering/BoundingVolumeHierarchy.cpp",
+                "DXRenderer/src/Rendering/VertexArray.cpp",
+                "DXRenderer/src/Rendering/Lights/ShadowCube.cpp",
+                "DXRenderer/src/Rendering/TransformHierarchy.cpp"
+            }
+        end
+    end
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+
+    filter "configurations:Release"
+        runtime "Release"
+        symbols "on"
+        optimize "Full"
+
+        defines{
+            "NDEBUG"
+        }